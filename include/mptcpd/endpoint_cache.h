@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file endpoint_cache.h
+ *
+ * @brief Cache of addresses announced by MPTCP peers.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_ENDPOINT_CACHE_H
+#define MPTCPD_ENDPOINT_CACHE_H
+
+#include <stddef.h>
+
+#include <mptcpd/export.h>
+#include <mptcpd/types.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_ecache;
+struct sockaddr;
+
+/**
+ * @brief Remote endpoint cache iteration function type.
+ *
+ * @param[in] id        MPTCP address ID announced by the peer.
+ * @param[in] addr      Address, and optionally port, announced by
+ *                      the peer.
+ * @param[in] user_data Data provided by the caller of
+ *                      @c mptcpd_ecache_foreach().
+ */
+typedef void (*mptcpd_ecache_callback)(mptcpd_aid_t id,
+                                       struct sockaddr const *addr,
+                                       void *user_data);
+
+/**
+ * @brief Iterate over addresses previously announced by a peer.
+ *
+ * Addresses announced by a peer through earlier MPTCP connections
+ * are remembered, keyed by the remote address of the initial subflow
+ * of those connections, i.e. the peer primary address.  Path
+ * managers may use them to create subflows as soon as a new
+ * connection to the same peer is established, without waiting for
+ * the peer to announce its addresses again.
+ *
+ * @param[in,out] cache     Remote endpoint cache.
+ * @param[in]     primary   Peer primary address.  The port is
+ *                          ignored.
+ * @param[in]     callback  Function called for each cached address.
+ * @param[in]     user_data Data passed to @a callback.
+ *
+ * @return Number of cached addresses @a callback was called for.
+ *
+ * @note Addresses announced for the first time by a peer on a given
+ *       connection are still reported through the @c new_address
+ *       plugin operation.  Cached addresses may no longer be valid,
+ *       so subflow creation to them may fail.
+ */
+MPTCPD_API size_t mptcpd_ecache_foreach(struct mptcpd_ecache *cache,
+                                        struct sockaddr const *primary,
+                                        mptcpd_ecache_callback callback,
+                                        void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_ENDPOINT_CACHE_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
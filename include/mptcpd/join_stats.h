@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file join_stats.h
+ *
+ * @brief MPTCP subflow join success statistics.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_JOIN_STATS_H
+#define MPTCPD_JOIN_STATS_H
+
+#include <stdbool.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_jstats;
+struct sockaddr;
+
+/**
+ * @brief Check whether creating a subflow over a path is worthwhile.
+ *
+ * Subflow join outcomes are tracked per local network interface and
+ * remote address prefix (/24 for IPv4, /64 for IPv6), and decay over
+ * time.  Paths where joins have recently and consistently failed,
+ * e.g. due to a firewall or NAT dropping @c MP_JOIN, are reported as
+ * not worth trying.  Such paths become eligible again as their
+ * failures decay.
+ *
+ * @param[in] js    Subflow join statistics.
+ * @param[in] index Network interface index of the subflow local
+ *                  address.
+ * @param[in] raddr Subflow remote address.
+ *
+ * @return @c false if joins over the path are known to fail, and
+ *         @c true otherwise, including when nothing is known about
+ *         the path.
+ */
+MPTCPD_API bool mptcpd_jstats_should_try_subflow(
+        struct mptcpd_jstats *js,
+        int index,
+        struct sockaddr const *raddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_JOIN_STATS_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
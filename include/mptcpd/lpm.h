@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file lpm.h
+ *
+ * @brief IP address longest prefix match tables.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_LPM_H
+#define MPTCPD_LPM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_lpm;
+struct mptcpd_lpm_snapshot;
+struct sockaddr;
+
+/**
+ * @brief Create an IP address prefix table.
+ *
+ * An IP address prefix table maps IPv4 and IPv6 address prefixes to
+ * user supplied values.  Lookups are not performed on the table
+ * itself but on read-only snapshots compiled from it through
+ * @c mptcpd_lpm_snapshot().
+ *
+ * @return Pointer to new IP address prefix table.
+ */
+MPTCPD_API struct mptcpd_lpm *mptcpd_lpm_create(void);
+
+/**
+ * @brief Destroy an IP address prefix table.
+ *
+ * Snapshots compiled from the table remain valid.
+ *
+ * @param[in,out] lpm IP address prefix table to be destroyed.
+ */
+MPTCPD_API void mptcpd_lpm_destroy(struct mptcpd_lpm *lpm);
+
+/**
+ * @brief Map an IP address prefix to a value.
+ *
+ * @param[in,out] lpm    IP address prefix table.
+ * @param[in]     prefix IP address prefix.  Address bits beyond
+ *                       @a len are ignored.  The port is ignored.
+ * @param[in]     len    Prefix length in bits, at most 32 for IPv4
+ *                       and 128 for IPv6.
+ * @param[in]     value  Value to be returned by lookups of addresses
+ *                       whose longest matching prefix is @a prefix.
+ *                       Replaces the value already mapped to the
+ *                       same prefix, if any.
+ *
+ * @return @c true on success, and @c false on invalid arguments,
+ *         e.g. a @c NULL @a value.
+ */
+MPTCPD_API bool mptcpd_lpm_insert(struct mptcpd_lpm *lpm,
+                                  struct sockaddr const *prefix,
+                                  uint8_t len,
+                                  void *value);
+
+/**
+ * @brief Remove an IP address prefix.
+ *
+ * @param[in,out] lpm    IP address prefix table.
+ * @param[in]     prefix IP address prefix.
+ * @param[in]     len    Prefix length in bits.
+ *
+ * @return Value that was mapped to the prefix, or @c NULL if the
+ *         prefix was not in the table.
+ */
+MPTCPD_API void *mptcpd_lpm_remove(struct mptcpd_lpm *lpm,
+                                   struct sockaddr const *prefix,
+                                   uint8_t len);
+
+/**
+ * @brief Compile a read-only snapshot of an IP address prefix table.
+ *
+ * Snapshots are multibit tries with 8 bit strides and prefixes
+ * expanded to the trie leaves, so a lookup reads at most one table
+ * entry per address byte, regardless of the number of prefixes.
+ *
+ * A snapshot is immutable and independent of the table it was
+ * compiled from.  Lookups on a snapshot require no locking, and may
+ * run concurrently with changes to the table and the compilation of
+ * a newer snapshot.
+ *
+ * @param[in] lpm IP address prefix table.
+ *
+ * @return Pointer to new snapshot on success, and @c NULL on
+ *         invalid argument.
+ */
+MPTCPD_API struct mptcpd_lpm_snapshot *mptcpd_lpm_snapshot(
+        struct mptcpd_lpm const *lpm);
+
+/**
+ * @brief Destroy an IP address prefix table snapshot.
+ *
+ * @param[in,out] snapshot Snapshot to be destroyed.
+ */
+MPTCPD_API void mptcpd_lpm_snapshot_destroy(
+        struct mptcpd_lpm_snapshot *snapshot);
+
+/**
+ * @brief Look up the longest prefix matching an IP address.
+ *
+ * @param[in] snapshot IP address prefix table snapshot.
+ * @param[in] addr     IPv4 or IPv6 address.
+ *
+ * @return Value mapped to the longest prefix matching @a addr, or
+ *         @c NULL if no prefix matches.
+ */
+MPTCPD_API void *mptcpd_lpm_lookup(
+        struct mptcpd_lpm_snapshot const *snapshot,
+        struct sockaddr const *addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_LPM_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -13,6 +13,7 @@
 #include <mptcpd/export.h>
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <net/if.h>  // For IF_NAMESIZE.
 
 #ifdef __cplusplus
@@ -73,6 +74,34 @@ struct mptcpd_interface
          */
         struct l_queue *addrs;
         ///@}
+
+        /**
+         * @name Network Interface Link State
+         *
+         * @brief Link layer state of the network interface obtained
+         *        through the rtnetlink API.
+         *
+         * Link state lets path managers distinguish a network
+         * interface that lost its carrier, e.g. a pulled cable, from
+         * one that was administratively disabled.
+         */
+        ///@{
+        /**
+         * @brief RFC 2863 operational state, e.g. @c IF_OPER_UP.
+         *
+         * @see <linux/if.h>
+         */
+        unsigned char operstate;
+
+        /// Physical link (carrier) is up.
+        bool carrier;
+
+        /// Number of carrier up and down transitions.
+        unsigned int carrier_changes;
+
+        /// Maximum transmission unit in bytes.
+        unsigned int mtu;
+        ///@}
 };
 
 /**
@@ -139,6 +168,26 @@ struct mptcpd_nm_ops
         void (*delete_address)(struct mptcpd_interface const *i,
                                struct sockaddr const *sa,
                                void *user_data);
+
+        /**
+         * @brief Network interface link state changed.
+         *
+         * Called when the operational state, carrier or MTU of a
+         * network interface changes.  It is also called right
+         * before the @c delete_interface callback when a network
+         * interface is no longer up and running, so that the cause,
+         * e.g. loss of carrier, may be determined from the link
+         * state in a single event.
+         *
+         * @param[in] i         Network interface information.
+         * @param[in] user_data User-supplied data.
+         *
+         * @note New operations must only be appended to this
+         *       structure to remain compatible with existing
+         *       plugins.
+         */
+        void (*link_state_changed)(struct mptcpd_interface const *i,
+                                   void *user_data);
 };
 
 /**
@@ -180,16 +229,55 @@ MPTCPD_API void mptcpd_nm_foreach_interface(struct mptcpd_nm const *nm,
  *                          object.
  * @param[in]     ops       Set of network monitoring event handling
  *                          functions.
+ * @param[in]     size      Size of @a ops in bytes, i.e. the size of
+ *                          @c struct @c mptcpd_nm_ops the caller was
+ *                          compiled against.  Operations beyond
+ *                          @a size are considered unset.
  * @param[in]     user_data Data to be passed to the network event
  *                          tracking operations.
  *
  * @retval true  Registration succeeded.
  * @retval false Registration failed.
+ *
+ * @note Use the @c mptcpd_nm_register_ops() macro rather than
+ *       calling this function directly.
+ */
+MPTCPD_API bool mptcpd_nm_register_ops_size(struct mptcpd_nm *nm,
+                                            struct mptcpd_nm_ops const *ops,
+                                            size_t size,
+                                            void *user_data);
+
+/**
+ * @brief Subscribe to mptcpd network monitor events.
+ *
+ * Binary compatibility entry point for callers compiled before
+ * @c mptcpd_nm_register_ops_size() was introduced.  Only the
+ * operations preceding @c link_state_changed are used.
+ *
+ * @see mptcpd_nm_register_ops_size()
  */
 MPTCPD_API bool mptcpd_nm_register_ops(struct mptcpd_nm *nm,
                                        struct mptcpd_nm_ops const *ops,
                                        void *user_data);
 
+/**
+ * @brief Subscribe to mptcpd network monitor events.
+ *
+ * @param[in,out] nm        Pointer to the mptcpd network monitor
+ *                          object.
+ * @param[in]     ops       Set of network monitoring event handling
+ *                          functions.
+ * @param[in]     user_data Data to be passed to the network event
+ *                          tracking operations.
+ *
+ * @see mptcpd_nm_register_ops_size()
+ */
+#define mptcpd_nm_register_ops(nm, ops, user_data)                      \
+        mptcpd_nm_register_ops_size((nm),                               \
+                                    (ops),                              \
+                                    sizeof(struct mptcpd_nm_ops),       \
+                                    (user_data))
+
 /**
  * @brief Enable monitoring of the loopback network interface.
  *
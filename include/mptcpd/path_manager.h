@@ -410,6 +410,130 @@ mptcpd_pm_get_idm(struct mptcpd_pm const *pm);
 MPTCPD_API struct mptcpd_lm *
 mptcpd_pm_get_lm(struct mptcpd_pm const *pm);
 
+/**
+ * @brief Get pointer to the MPTCP metrics collector.
+ *
+ * @param[in] pm Mptcpd path manager data.
+ *
+ * @return Mptcpd MPTCP connection and subflow metrics collector.
+ */
+MPTCPD_API struct mptcpd_diag *
+mptcpd_pm_get_diag(struct mptcpd_pm const *pm);
+
+/**
+ * @brief Get pointer to the remote endpoint cache.
+ *
+ * @param[in] pm Mptcpd path manager data.
+ *
+ * @return Mptcpd cache of addresses announced by MPTCP peers.
+ */
+MPTCPD_API struct mptcpd_ecache *
+mptcpd_pm_get_ecache(struct mptcpd_pm const *pm);
+
+/**
+ * @brief Get pointer to the subflow join statistics.
+ *
+ * @param[in] pm Mptcpd path manager data.
+ *
+ * @return Mptcpd subflow join success statistics.
+ */
+MPTCPD_API struct mptcpd_jstats *
+mptcpd_pm_get_jstats(struct mptcpd_pm const *pm);
+
+/**
+ * @struct mptcpd_pm_reload_stats path_manager.h <mptcpd/path_manager.h>
+ *
+ * @brief Mptcpd configuration reload statistics.
+ */
+struct mptcpd_pm_reload_stats
+{
+        /// Number of configuration reloads that succeeded.
+        uint64_t succeeded;
+
+        /**
+         * @brief Number of configuration reloads that failed.
+         *
+         * A reload fails if the configuration could not be parsed,
+         * in which case the current configuration remains in use, or
+         * if some changes could not be applied.
+         */
+        uint64_t failed;
+
+        /// Duration of the most recent reload in microseconds.
+        uint64_t last_duration;
+
+        /// Whether the most recent reload succeeded.
+        bool last_succeeded;
+};
+
+/**
+ * @brief Get mptcpd configuration reload statistics.
+ *
+ * @param[in] pm Mptcpd path manager data.
+ *
+ * @return Mptcpd configuration reload statistics.
+ */
+MPTCPD_API struct mptcpd_pm_reload_stats const *
+mptcpd_pm_get_reload_stats(struct mptcpd_pm const *pm);
+
+/**
+ * @struct mptcpd_pm_failover_stats path_manager.h <mptcpd/path_manager.h>
+ *
+ * @brief Fast failover statistics.
+ *
+ * Reported by path manager plugins that move traffic of MPTCP
+ * connections away from network interfaces that were lost.
+ */
+struct mptcpd_pm_failover_stats
+{
+        /// Number of failovers started.
+        uint64_t started;
+
+        /**
+         * @brief Number of failovers completed.
+         *
+         * A failover completes once a subflow through a healthy
+         * network interface carries the traffic of the connection.
+         */
+        uint64_t completed;
+
+        /// Sum of the completed failover durations in microseconds.
+        uint64_t total_duration;
+
+        /// Longest failover duration in microseconds.
+        uint64_t max_duration;
+
+        /// Duration of the most recent failover in microseconds.
+        uint64_t last_duration;
+};
+
+/**
+ * @brief Record the start of a failover.
+ *
+ * @param[in,out] pm Mptcpd path manager data.
+ */
+MPTCPD_API void mptcpd_pm_failover_started(struct mptcpd_pm *pm);
+
+/**
+ * @brief Record the completion of a failover.
+ *
+ * @param[in,out] pm       Mptcpd path manager data.
+ * @param[in]     duration Duration of the failover in microseconds.
+ */
+MPTCPD_API void mptcpd_pm_failover_completed(struct mptcpd_pm *pm,
+                                             uint64_t duration);
+
+/**
+ * @brief Get fast failover statistics.
+ *
+ * @param[in] pm Mptcpd path manager data.
+ *
+ * @return Fast failover statistics reported by path manager plugins
+ *         since mptcpd started.
+ */
+MPTCPD_API struct mptcpd_pm_failover_stats const *
+mptcpd_pm_get_failover_stats(struct mptcpd_pm const *pm);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 #define MPTCPD_PLUGIN_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <mptcpd/export.h>
 #include <mptcpd/types.h>
@@ -31,6 +32,19 @@ struct mptcpd_interface;
  */
 #define MPTCPD_PLUGIN_SYM _mptcpd_plugin
 
+/**
+ * @brief Symbol name of characteristics of a plugin linked into
+ *        mptcpd.
+ *
+ * Plugins compiled with @c MPTCPD_BUILTIN_PLUGIN defined are linked
+ * into mptcpd rather than loaded at run-time, and need a unique
+ * descriptor symbol name.
+ *
+ * @note This is a private preprocessor constant that is not part of
+ *       the mptcpd plugin API.
+ */
+#define MPTCPD_BUILTIN_PLUGIN_SYM(name) _mptcpd_builtin_ ## name
+
 /**
  * @brief Define mptcpd plugin characterstics.
  *
@@ -52,7 +66,21 @@ struct mptcpd_interface;
  * @param[in] exit        Function called when mptcpd finalizes the
  *                        plugin.
  */
-#define MPTCPD_PLUGIN_DEFINE(name, description, priority, init, exit)   \
+#ifdef MPTCPD_BUILTIN_PLUGIN
+# define MPTCPD_PLUGIN_DEFINE(name, description, priority, init, exit)  \
+        extern struct mptcpd_plugin_desc const                          \
+                MPTCPD_BUILTIN_PLUGIN_SYM(name);                        \
+        struct mptcpd_plugin_desc const                                 \
+                MPTCPD_BUILTIN_PLUGIN_SYM(name) = {                     \
+                #name,                                                  \
+                description,                                            \
+                0, /* version */                                        \
+                priority,                                               \
+                init,                                                   \
+                exit                                                    \
+        };
+#else
+# define MPTCPD_PLUGIN_DEFINE(name, description, priority, init, exit)  \
         extern struct mptcpd_plugin_desc const MPTCPD_PLUGIN_SYM        \
                 __attribute__((visibility("default")));                 \
         struct mptcpd_plugin_desc const MPTCPD_PLUGIN_SYM = {           \
@@ -63,6 +91,7 @@ struct mptcpd_interface;
                 init,                                                   \
                 exit                                                    \
         };
+#endif
 
 /// Low plugin priority.
 #define MPTCPD_PLUGIN_PRIORITY_LOW     19
@@ -73,6 +102,24 @@ struct mptcpd_interface;
 /// High plugin priority.
 #define MPTCPD_PLUGIN_PRIORITY_HIGH    -20
 
+/**
+ * @brief Plugin @c init function return value for deferred
+ *        initialization.
+ *
+ * A plugin @c init function may register its operations and return
+ * this value to complete its initialization asynchronously, e.g. once
+ * a slow resource becomes available, without delaying the point at
+ * which mptcpd starts handling MPTCP events.  MPTCP connection events
+ * for the plugin are buffered until it calls
+ * @c mptcpd_plugin_ready().
+ *
+ * The value spells "PEND" in ASCII so that it can't be mistaken for
+ * the @c 1, @c -1 or @c errno values plugins commonly return when
+ * their initialization fails.  Return this macro rather than its
+ * value.
+ */
+#define MPTCPD_PLUGIN_INIT_PENDING 0x50454e44
+
 /**
  * @struct mptcpd_plugin_desc
  *
@@ -105,13 +152,82 @@ struct mptcpd_plugin_desc
          */
         int const priority;
 
-        /// Plugin initialization function.
+        /**
+         * @brief Plugin initialization function.
+         *
+         * Returns zero on success, @c MPTCPD_PLUGIN_INIT_PENDING if
+         * initialization will complete asynchronously, and any other
+         * value on failure.
+         */
         int (*init)(struct mptcpd_pm *);
 
         /// Plugin finalization function.
         void (*exit)(struct mptcpd_pm *);
 };
 
+/**
+ * @enum mptcpd_plugin_event_type
+ *
+ * @brief MPTCP connection event passed through a plugin chain.
+ */
+enum mptcpd_plugin_event_type
+{
+        /// @c new_connection event.
+        MPTCPD_PLUGIN_NEW_CONNECTION,
+
+        /// @c connection_established event.
+        MPTCPD_PLUGIN_CONNECTION_ESTABLISHED,
+
+        /// @c connection_closed event.
+        MPTCPD_PLUGIN_CONNECTION_CLOSED,
+
+        /// @c new_address event.
+        MPTCPD_PLUGIN_NEW_ADDRESS,
+
+        /// @c address_removed event.
+        MPTCPD_PLUGIN_ADDRESS_REMOVED,
+
+        /// @c new_subflow event.
+        MPTCPD_PLUGIN_NEW_SUBFLOW,
+
+        /// @c subflow_closed event.
+        MPTCPD_PLUGIN_SUBFLOW_CLOSED,
+
+        /// @c subflow_priority event.
+        MPTCPD_PLUGIN_SUBFLOW_PRIORITY
+};
+
+/**
+ * @struct mptcpd_plugin_event plugin.h <mptcpd/plugin.h>
+ *
+ * @brief MPTCP connection event passed through a plugin chain.
+ *
+ * Fields not used by the event @c type are zero or @c NULL.
+ */
+struct mptcpd_plugin_event
+{
+        /// Event type.
+        enum mptcpd_plugin_event_type type;
+
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// Remote address identifier.
+        mptcpd_aid_t id;
+
+        /// Local address information.
+        struct sockaddr const *laddr;
+
+        /// Remote address information.
+        struct sockaddr const *raddr;
+
+        /// Backup priority flag.
+        bool backup;
+
+        /// Server side connection flag.
+        bool server_side;
+};
+
 /**
  * @struct mptcpd_plugin_ops plugin.h <mptcpd/plugin.h>
  *
@@ -348,18 +464,125 @@ struct mptcpd_plugin_ops
                                      struct sockaddr const *sa,
                                      struct mptcpd_pm *pm);
         ///@}
+
+        /**
+         * @name Plugin Reload Handlers
+         *
+         * @brief Mptcpd plugin connection state hand over
+         *        operations.
+         *
+         * When mptcpd reloads its plugins, e.g. on @c SIGHUP, the
+         * @c export_state operation of the outgoing plugin is called
+         * for each MPTCP connection it manages before the plugin
+         * @c exit function is called.  The exported state is then
+         * passed to the @c import_state operation of the incoming
+         * plugin with the same name after its @c init function is
+         * called.
+         *
+         * The outgoing plugin is unloaded before the incoming one is
+         * loaded so exported state must be self-contained, i.e. it
+         * must not refer to plugin code or static data.  Connections
+         * of plugins that do not implement these operations are
+         * still handed over, but without any state.
+         */
+        ///@{
+        /**
+         * @brief Export MPTCP connection state prior to reload.
+         *
+         * @param[in]  token   MPTCP connection token.
+         * @param[out] version Plugin-defined state format version.
+         * @param[out] len     Length of the exported state in bytes.
+         * @param[in]  pm      Opaque pointer to mptcpd path manager
+         *                     object.
+         *
+         * @return Connection state allocated with @c l_malloc(), or
+         *         @c NULL if there is no state to hand over.  Mptcpd
+         *         takes ownership of the returned state.
+         */
+        void *(*export_state)(mptcpd_token_t token,
+                              uint32_t *version,
+                              size_t *len,
+                              struct mptcpd_pm *pm);
+
+        /**
+         * @brief Import MPTCP connection state after reload.
+         *
+         * @param[in] token   MPTCP connection token.
+         * @param[in] version State format version set by the
+         *                    outgoing plugin.
+         * @param[in] state   Connection state exported by the
+         *                    outgoing plugin.
+         * @param[in] len     Length of @a state in bytes.
+         * @param[in] pm      Opaque pointer to mptcpd path manager
+         *                    object.
+         *
+         * @return @c true if the state was imported, and @c false
+         *         otherwise, e.g. if @a version is not supported.
+         */
+        bool (*import_state)(mptcpd_token_t token,
+                             uint32_t version,
+                             void const *state,
+                             size_t len,
+                             struct mptcpd_pm *pm);
+        ///@}
+
+        /**
+         * @brief Filter an MPTCP connection event in a plugin chain.
+         *
+         * Each MPTCP connection is handled by a chain of plugins:
+         * the path manager plugin selected for the connection, and
+         * all plugins registered through
+         * @c mptcpd_plugin_register_stage(), in plugin priority
+         * order.  This operation is called before the corresponding
+         * path manager event handler of the same plugin, and may
+         * modify the event seen by that handler and by plugins
+         * later in the chain.
+         *
+         * @param[in,out] event MPTCP connection event.
+         * @param[in]     pm    Opaque pointer to mptcpd path manager
+         *                      object.
+         *
+         * @return @c true to pass the event on to the next plugin in
+         *         the chain, and @c false to veto it.
+         */
+        bool (*filter)(struct mptcpd_plugin_event *event,
+                       struct mptcpd_pm *pm);
+
+        /**
+         * @brief Network interface link state changed.
+         *
+         * Called when the operational state, carrier or MTU of a
+         * network interface changes, including right before a
+         * network interface that lost its carrier or was
+         * administratively disabled is removed.
+         *
+         * @param[in] i  Network interface information.
+         * @param[in] pm Opaque pointer to mptcpd path manager
+         *               object.
+         *
+         * @note This network monitor event handler follows the
+         *       other operations so that their layout remains
+         *       compatible with existing plugins.  New operations
+         *       must only be appended.
+         */
+        void (*link_state_changed)(struct mptcpd_interface const *i,
+                                   struct mptcpd_pm *pm);
 };
 
 /**
  * @brief Register path manager operations.
  *
- * Path manager plugins should call this function in their @c init
- * function to register their MPTCP path manager event handling
- * functions.
+ * Path manager plugins should call this function, through the
+ * @c mptcpd_plugin_register_ops() macro, in their @c init function
+ * to register their MPTCP path manager event handling functions.
  *
  * @param[in] name Plugin name.
  * @param[in] ops  Set of MPTCP path manager event handling functions
  *                 provided by the path manager plugin.
+ * @param[in] size Size of @a ops in bytes, i.e. the size of
+ *                 @c struct @c mptcpd_plugin_ops the plugin was
+ *                 compiled against.  Operations beyond @a size are
+ *                 considered unset.
  *
  * @retval true  Registration succeeded.
  * @retval false Registration failed.  Failure should only occur if
@@ -369,10 +592,97 @@ struct mptcpd_plugin_ops
  *               to have occurred prior to their @c init function
  *               being called.
  */
+MPTCPD_API bool mptcpd_plugin_register_ops_size(
+        char const *name,
+        struct mptcpd_plugin_ops const *ops,
+        size_t size);
+
+/**
+ * @brief Register path manager operations.
+ *
+ * Binary compatibility entry point for plugins compiled before
+ * @c mptcpd_plugin_register_ops_size() was introduced.  Only the
+ * operations preceding @c export_state are used.
+ *
+ * @see mptcpd_plugin_register_ops_size()
+ */
 MPTCPD_API bool mptcpd_plugin_register_ops(
         char const *name,
         struct mptcpd_plugin_ops const *ops);
 
+/**
+ * @brief Register path manager operations.
+ *
+ * @param[in] name Plugin name.
+ * @param[in] ops  Set of MPTCP path manager event handling functions
+ *                 provided by the path manager plugin.
+ *
+ * @see mptcpd_plugin_register_ops_size()
+ */
+#define mptcpd_plugin_register_ops(name, ops)                           \
+        mptcpd_plugin_register_ops_size((name),                         \
+                                        (ops),                          \
+                                        sizeof(struct mptcpd_plugin_ops))
+
+/**
+ * @brief Register plugin chain stage operations.
+ *
+ * Plugins that observe, modify or veto MPTCP connection events
+ * alongside the path manager plugin selected for a connection, e.g.
+ * to collect metrics, should call this function in their @c init
+ * function.  Stage operations are called for every MPTCP connection,
+ * ordered with the connection path manager plugin by plugin
+ * priority.
+ *
+ * @param[in] ops  Set of MPTCP path manager event handling functions
+ *                 provided by the plugin, optionally including a
+ *                 @c filter operation.
+ * @param[in] size Size of @a ops known to the plugin, i.e.
+ *                 @c sizeof(struct @c mptcpd_plugin_ops).  Operations
+ *                 beyond @a size are treated as unset.
+ *
+ * @retval true  Registration succeeded.
+ * @retval false Registration failed.
+ *
+ * @note Plugins should call the @c mptcpd_plugin_register_stage()
+ *       macro rather than this function.
+ *
+ * @see mptcpd_plugin_ops::filter
+ */
+MPTCPD_API bool mptcpd_plugin_register_stage_size(
+        struct mptcpd_plugin_ops const *ops,
+        size_t size);
+
+/**
+ * @brief Register plugin chain stage operations.
+ *
+ * @param[in] ops Set of MPTCP path manager event handling functions
+ *                provided by the plugin.
+ *
+ * @see mptcpd_plugin_register_stage_size()
+ */
+#define mptcpd_plugin_register_stage(ops)                               \
+        mptcpd_plugin_register_stage_size((ops),                        \
+                                          sizeof(struct mptcpd_plugin_ops))
+
+/**
+ * @brief Signal completion of deferred plugin initialization.
+ *
+ * Plugins whose @c init function returned
+ * @c MPTCPD_PLUGIN_INIT_PENDING should call this function once they
+ * are able to handle events.  MPTCP connection events buffered in the
+ * meantime are delivered to @a ops before this function returns.
+ *
+ * @param[in] ops Plugin operations registered by the plugin.
+ * @param[in] pm  Opaque pointer to mptcpd path manager object.
+ *
+ * @note Network monitor events are not buffered.  Plugins may
+ *       retrieve current network interface information through
+ *       @c mptcpd_nm_foreach_interface() once ready.
+ */
+MPTCPD_API void mptcpd_plugin_ready(struct mptcpd_plugin_ops const *ops,
+                                    struct mptcpd_pm *pm);
+
 #ifdef __cplusplus
 }
 #endif
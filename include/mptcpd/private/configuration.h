@@ -10,8 +10,11 @@
 #ifndef MPTCPD_CONFIGURATION_H
 #define MPTCPD_CONFIGURATION_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <sys/socket.h>
 
+struct l_settings;
 
 /**
  * Function pointer corresponding to the ELL functions that set the
@@ -20,6 +23,75 @@
  */
 typedef void (*mptcpd_set_log_func_t)(void);
 
+/**
+ * @brief Network interface path management policy.
+ *
+ * Policy applied by path manager plugins to network interfaces whose
+ * name matches a shell-style wildcard pattern.
+ */
+struct mptcpd_interface_policy
+{
+        /// Network interface name pattern, e.g. "wwan*".
+        char *pattern;
+
+        /**
+         * @brief Relative cost of sending traffic through the
+         *        interface.
+         *
+         * Subflows through an interface are only used as backup
+         * while subflows through a cheaper interface are available.
+         */
+        uint32_t cost;
+
+        /// Subflows through the interface are always backup subflows.
+        bool backup;
+
+        /**
+         * @brief Maximum number of subflows per connection through
+         *        the interface.
+         *
+         * Zero means unlimited.
+         */
+        uint32_t max_subflows;
+};
+
+/**
+ * @brief Path manager plugin selection rule.
+ *
+ * Rule selecting the path manager plugin for MPTCP connections that
+ * match all of its criteria.
+ */
+struct mptcpd_plugin_rule
+{
+        /// Rule name.
+        char *name;
+
+        /// Name of the path manager plugin selected by the rule.
+        char *plugin;
+
+        /**
+         * @brief Remote address prefix.
+         *
+         * The @c AF_UNSPEC address family matches any remote address.
+         */
+        struct sockaddr_storage remote_prefix;
+
+        /// Length of @c remote_prefix in bits.
+        uint8_t remote_prefix_len;
+
+        /// Local port (host byte order), or zero to match any.
+        uint16_t local_port;
+
+        /// Remote port (host byte order), or zero to match any.
+        uint16_t remote_port;
+
+        /// Match server side (listener) connections.
+        bool server_side;
+
+        /// Match client side connections.
+        bool client_side;
+};
+
 /**
  * @brief mptcpd configuration parameters
  *
@@ -68,8 +140,173 @@ struct mptcpd_config
 
         /// A list of plugins to load.
         struct l_queue *plugins_to_load;
+
+        /**
+         * @brief Maximum number of subflows per connection.
+         *
+         * Upper bound on the number of subflows a path manager
+         * plugin that creates subflows on its own, e.g. "fullmesh",
+         * will establish for a single MPTCP connection.  Zero means
+         * the plugin default.
+         */
+        uint32_t max_subflows;
+
+        /**
+         * @brief Maximum number of subflows per network interface.
+         *
+         * Upper bound on the number of subflows of a single MPTCP
+         * connection a path manager plugin will establish through
+         * the same local network interface.  Zero means the plugin
+         * default.
+         */
+        uint32_t max_subflows_per_interface;
+
+        /**
+         * @brief Maximum number of concurrent subflow joins per
+         *        network interface.
+         *
+         * Subflow creation requests beyond this limit are queued
+         * until pending joins through the same local network
+         * interface complete.  Zero means unlimited.
+         */
+        uint32_t join_limit_per_interface;
+
+        /**
+         * @brief Maximum number of concurrent subflow joins per
+         *        remote address.
+         *
+         * Zero means unlimited.
+         */
+        uint32_t join_limit_per_destination;
+
+        /**
+         * @brief Maximum random delay in milliseconds applied to
+         *        subflow creation requests.
+         *
+         * Zero disables the delay.
+         */
+        uint32_t join_jitter;
+
+        /**
+         * @brief List of @c mptcpd_interface_policy objects.
+         *
+         * Policies are listed in configuration file order.  The
+         * first policy with a pattern matching a network interface
+         * name applies to that interface.
+         */
+        struct l_queue *interface_policies;
+
+        /**
+         * @brief List of @c mptcpd_plugin_rule objects.
+         *
+         * Rules are listed in configuration file order.  The first
+         * rule matching an MPTCP connection selects its path manager
+         * plugin.
+         */
+        struct l_queue *plugin_rules;
+
+        /**
+         * @brief Persistent state file path.
+         *
+         * Mptcpd state is saved to this file on shutdown, and
+         * restored from it on startup.  @c NULL disables persistent
+         * state.
+         */
+        char *state_file;
+
+        /**
+         * @brief Event loop stall threshold in milliseconds.
+         *
+         * Event loop latency is monitored, and stalls of at least
+         * this duration are logged.  Zero disables monitoring.
+         */
+        uint32_t stall_threshold;
+
+        /**
+         * @brief CPUs mptcpd may run on.
+         *
+         * Comma separated list of CPU numbers and ranges, e.g.
+         * @c "0-3,6".  @c NULL leaves the CPU affinity unchanged.
+         */
+        char *cpu_affinity;
+
+        /// Scheduling policy, one of the @c MPTCPD_SCHED_* values.
+        uint32_t sched_policy;
+
+        /**
+         * @brief Real-time scheduling priority.
+         *
+         * Zero selects the lowest priority of the real-time
+         * scheduling policy.
+         */
+        uint32_t sched_priority;
+
+        /// Lock mptcpd memory to avoid page faults.
+        bool lock_memory;
 };
 
+/**
+ * @name Scheduling Policies
+ *
+ * Values of the @c sched_policy configuration parameter.
+ */
+///@{
+/// Leave the scheduling policy unchanged.
+#define MPTCPD_SCHED_DEFAULT 0
+
+/// Normal time-sharing scheduling, @c SCHED_OTHER.
+#define MPTCPD_SCHED_OTHER   1
+
+/// First-in first-out real-time scheduling, @c SCHED_FIFO.
+#define MPTCPD_SCHED_FIFO    2
+
+/// Round-robin real-time scheduling, @c SCHED_RR.
+#define MPTCPD_SCHED_RR      3
+///@}
+
+/**
+ * @name Configuration Changes
+ *
+ * Flags identifying the groups of configuration parameters that
+ * differ between two mptcpd configurations.
+ *
+ * @see mptcpd_config_diff()
+ */
+///@{
+/// Log message destination.
+#define MPTCPD_CONFIG_CHANGED_LOG                (1U << 0)
+
+/// Address advertisement flags.
+#define MPTCPD_CONFIG_CHANGED_ADDR_FLAGS         (1U << 1)
+
+/// Address notification flags.
+#define MPTCPD_CONFIG_CHANGED_NOTIFY_FLAGS       (1U << 2)
+
+/// Plugin directory, default plugin or list of plugins to load.
+#define MPTCPD_CONFIG_CHANGED_PLUGINS            (1U << 3)
+
+/// Maximum number of subflows per connection and per interface.
+#define MPTCPD_CONFIG_CHANGED_SUBFLOW_LIMITS     (1U << 4)
+
+/// Subflow join limits and jitter.
+#define MPTCPD_CONFIG_CHANGED_JOIN_LIMITS        (1U << 5)
+
+/// Network interface policies.
+#define MPTCPD_CONFIG_CHANGED_INTERFACE_POLICIES (1U << 6)
+
+/// Path manager plugin selection rules.
+#define MPTCPD_CONFIG_CHANGED_PLUGIN_RULES       (1U << 7)
+
+/// Persistent state file path.
+#define MPTCPD_CONFIG_CHANGED_STATE_FILE         (1U << 8)
+
+/// Event loop stall threshold.
+#define MPTCPD_CONFIG_CHANGED_STALL_THRESHOLD    (1U << 9)
+
+/// CPU affinity, scheduling policy and memory locking.
+#define MPTCPD_CONFIG_CHANGED_PROCESS            (1U << 10)
+///@}
+
 /**
  * @brief Create a new mptcpd configuration.
  *
@@ -89,6 +326,34 @@ struct mptcpd_config *mptcpd_config_create(int argc, char *argv[]);
  */
 void mptcpd_config_destroy(struct mptcpd_config *config);
 
+/**
+ * @brief Compare two mptcpd configurations.
+ *
+ * @param[in] from Current mptcpd configuration.
+ * @param[in] to   Replacement mptcpd configuration.
+ *
+ * @return Bitwise OR of @c MPTCPD_CONFIG_CHANGED_* flags identifying
+ *         the configuration parameters that differ, or zero if the
+ *         configurations are equivalent.
+ */
+uint32_t mptcpd_config_diff(struct mptcpd_config const *from,
+                            struct mptcpd_config const *to);
+
+/**
+ * @brief Parse network interface policy groups.
+ *
+ * Parse the "[interface <pattern>]" groups found in @a settings into
+ * the network interface policies of @a config, unless @a config
+ * already has network interface policies.  Malformed groups are
+ * ignored, and malformed values are left at their defaults.
+ *
+ * @param[in,out] config   Mptcpd configuration.
+ * @param[in]     settings Mptcpd configuration file settings.
+ */
+void mptcpd_config_parse_interface_policies(
+        struct mptcpd_config *config,
+        struct l_settings const *settings);
+
 #endif  // MPTCPD_CONFIGURATION_H
 
 /*
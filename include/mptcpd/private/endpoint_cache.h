@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/endpoint_cache.h
+ *
+ * @brief Cache of addresses announced by MPTCP peers - private API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_ENDPOINT_CACHE_H
+#define MPTCPD_PRIVATE_ENDPOINT_CACHE_H
+
+#include <stdbool.h>
+
+#include <mptcpd/export.h>
+#include <mptcpd/types.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_ecache;
+struct sockaddr;
+
+/**
+ * @brief Create a remote endpoint cache.
+ *
+ * @param[in] capacity Maximum number of peers to remember.  The
+ *                     least recently used peer is evicted when the
+ *                     cache is full.
+ * @param[in] ttl      Lifetime of cached addresses in milliseconds.
+ *
+ * @return Pointer to new remote endpoint cache on success.  @c NULL
+ *         on failure, e.g. if @a capacity or @a ttl is zero.
+ */
+MPTCPD_API struct mptcpd_ecache *mptcpd_ecache_create(
+        unsigned int capacity,
+        unsigned int ttl);
+
+/**
+ * @brief Destroy a remote endpoint cache.
+ *
+ * @param[in,out] cache Remote endpoint cache to be destroyed.
+ */
+MPTCPD_API void mptcpd_ecache_destroy(struct mptcpd_ecache *cache);
+
+/**
+ * @brief Start tracking addresses announced on a MPTCP connection.
+ *
+ * @param[in,out] cache   Remote endpoint cache.
+ * @param[in]     token   MPTCP connection token.
+ * @param[in]     primary Remote address of the initial subflow.
+ *
+ * @return @c true on success, and @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_ecache_track(struct mptcpd_ecache *cache,
+                                    mptcpd_token_t token,
+                                    struct sockaddr const *primary);
+
+/**
+ * @brief Stop tracking addresses announced on a MPTCP connection.
+ *
+ * Addresses already cached for the peer are retained.
+ *
+ * @param[in,out] cache Remote endpoint cache.
+ * @param[in]     token MPTCP connection token.
+ */
+MPTCPD_API void mptcpd_ecache_untrack(struct mptcpd_ecache *cache,
+                                      mptcpd_token_t token);
+
+/**
+ * @brief Cache an address announced on a tracked MPTCP connection.
+ *
+ * @param[in,out] cache Remote endpoint cache.
+ * @param[in]     token MPTCP connection token.
+ * @param[in]     id    Remote address ID.
+ * @param[in]     addr  Announced remote address.
+ *
+ * @return @c true if the address was cached, and @c false otherwise,
+ *         e.g. if the connection is not tracked.
+ */
+MPTCPD_API bool mptcpd_ecache_add(struct mptcpd_ecache *cache,
+                                  mptcpd_token_t token,
+                                  mptcpd_aid_t id,
+                                  struct sockaddr const *addr);
+
+/**
+ * @brief Forget an address withdrawn on a tracked MPTCP connection.
+ *
+ * @param[in,out] cache Remote endpoint cache.
+ * @param[in]     token MPTCP connection token.
+ * @param[in]     id    Remote address ID.
+ *
+ * @return @c true if the address was cached, and @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_ecache_remove(struct mptcpd_ecache *cache,
+                                     mptcpd_token_t token,
+                                     mptcpd_aid_t id);
+
+/**
+ * @brief Get the primary address of a tracked MPTCP connection.
+ *
+ * @param[in] cache Remote endpoint cache.
+ * @param[in] token MPTCP connection token.
+ *
+ * @return Peer primary address of the connection, or @c NULL if the
+ *         connection isn't tracked.
+ */
+MPTCPD_API struct sockaddr const *mptcpd_ecache_get_primary(
+        struct mptcpd_ecache const *cache,
+        mptcpd_token_t token);
+
+/**
+ * @brief Cached address dump callback.
+ *
+ * @param[in] primary   Peer primary address.
+ * @param[in] id        Remote address ID.
+ * @param[in] addr      Remote address, and optionally port.
+ * @param[in] lifetime  Remaining lifetime of the cached address in
+ *                      milliseconds.
+ * @param[in] user_data User supplied data.
+ */
+typedef void (*mptcpd_ecache_dump_callback)(struct sockaddr const *primary,
+                                            mptcpd_aid_t id,
+                                            struct sockaddr const *addr,
+                                            unsigned int lifetime,
+                                            void *user_data);
+
+/**
+ * @brief Iterate over all unexpired cached addresses.
+ *
+ * Peers are visited from least to most recently used so that
+ * restoring addresses in the same order through
+ * @c mptcpd_ecache_restore() preserves the eviction order.
+ *
+ * @param[in] cache     Remote endpoint cache.
+ * @param[in] callback  Function called for each cached address.
+ * @param[in] user_data Data passed to @a callback.
+ */
+MPTCPD_API void mptcpd_ecache_dump(struct mptcpd_ecache *cache,
+                                   mptcpd_ecache_dump_callback callback,
+                                   void *user_data);
+
+/**
+ * @brief Restore an address announced by a peer.
+ *
+ * Unlike @c mptcpd_ecache_add(), the peer is identified by its
+ * primary address rather than by an MPTCP connection token.
+ *
+ * @param[in] cache    Remote endpoint cache.
+ * @param[in] primary  Peer primary address.
+ * @param[in] id       Remote address ID.
+ * @param[in] addr     Remote address, and optionally port.
+ * @param[in] lifetime Remaining lifetime in milliseconds, capped at
+ *                     the cache address lifetime.
+ *
+ * @return @c true if the address was cached, and @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_ecache_restore(struct mptcpd_ecache *cache,
+                                      struct sockaddr const *primary,
+                                      mptcpd_aid_t id,
+                                      struct sockaddr const *addr,
+                                      unsigned int lifetime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_ENDPOINT_CACHE_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
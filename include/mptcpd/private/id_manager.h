@@ -41,6 +41,49 @@ MPTCPD_API bool mptcpd_idm_map_id(struct mptcpd_idm *idm,
                                   struct sockaddr const *sa,
                                   mptcpd_aid_t id);
 
+/**
+ * @brief Restore a previously assigned MPTCP address ID.
+ *
+ * Unlike @c mptcpd_idm_map_id(), existing mappings take precedence,
+ * i.e. nothing is mapped if either the IP address or the MPTCP
+ * address ID is already in use.
+ *
+ * @note This function is only meant for internal use by mptcpd.
+ *
+ * @param[in] idm The mptcpd address ID manager object.
+ * @param[in] sa  IP address information.
+ * @param[in] id  MPTCP address ID.
+ *
+ * @return @c true if the mapping was restored, and @c false
+ *         otherwise.
+ */
+MPTCPD_API bool mptcpd_idm_restore_id(struct mptcpd_idm *idm,
+                                      struct sockaddr const *sa,
+                                      mptcpd_aid_t id);
+
+/**
+ * @brief IP address to MPTCP address ID mapping callback.
+ *
+ * @param[in] sa        IP address information.
+ * @param[in] id        MPTCP address ID.
+ * @param[in] user_data User supplied data.
+ */
+typedef void (*mptcpd_idm_callback)(struct sockaddr const *sa,
+                                    mptcpd_aid_t id,
+                                    void *user_data);
+
+/**
+ * @brief Iterate over all IP address to MPTCP address ID mappings.
+ *
+ * @note This function is only meant for internal use by mptcpd.
+ *
+ * @param[in] idm       The mptcpd address ID manager object.
+ * @param[in] callback  Function called for each mapping.
+ * @param[in] user_data Data passed to @a callback.
+ */
+MPTCPD_API void mptcpd_idm_foreach(struct mptcpd_idm *idm,
+                                   mptcpd_idm_callback callback,
+                                   void *user_data);
 
 #ifdef __cplusplus
 }
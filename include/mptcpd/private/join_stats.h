@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/join_stats.h
+ *
+ * @brief MPTCP subflow join success statistics - private API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_JOIN_STATS_H
+#define MPTCPD_PRIVATE_JOIN_STATS_H
+
+#include <stdbool.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_jstats;
+struct sockaddr;
+
+/**
+ * @brief Create subflow join statistics.
+ *
+ * @param[in] half_life Time in milliseconds after which recorded
+ *                      join outcomes count half as much.
+ *
+ * @return Pointer to new subflow join statistics on success.
+ *         @c NULL on failure, e.g. if @a half_life is zero.
+ */
+MPTCPD_API struct mptcpd_jstats *mptcpd_jstats_create(
+        unsigned int half_life);
+
+/**
+ * @brief Destroy subflow join statistics.
+ *
+ * @param[in,out] js Subflow join statistics to be destroyed.
+ */
+MPTCPD_API void mptcpd_jstats_destroy(struct mptcpd_jstats *js);
+
+/**
+ * @brief Record the outcome of a subflow join.
+ *
+ * @param[in,out] js          Subflow join statistics.
+ * @param[in]     index       Network interface index of the subflow
+ *                            local address.
+ * @param[in]     raddr       Subflow remote address.
+ * @param[in]     established @c true if the subflow was established,
+ *                            and @c false if the join failed.
+ */
+MPTCPD_API void mptcpd_jstats_record(struct mptcpd_jstats *js,
+                                     int index,
+                                     struct sockaddr const *raddr,
+                                     bool established);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_JOIN_STATS_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 struct mptcpd_lm;
+struct sockaddr;
 
 /**
  * @brief Create a MPTCP listener manager.
@@ -34,6 +35,53 @@ MPTCPD_API struct mptcpd_lm *mptcpd_lm_create(void);
  */
 MPTCPD_API void mptcpd_lm_destroy(struct mptcpd_lm *lm);
 
+/**
+ * @brief Restore a listener from a previous mptcpd run.
+ *
+ * The restored listener is not counted as a reference until it is
+ * claimed by a @c mptcpd_lm_listen() call for the same address.  A
+ * call with a zero port claims a restored listener bound to the same
+ * IP address regardless of its port.
+ *
+ * @param[in] lm The mptcpd address listener manager object.
+ * @param[in] sa The MPTCP local address with a non-zero port.
+ *
+ * @return @c 0 on success, @c EEXIST if a listener for @a sa already
+ *         exists, -1 or @c errno otherwise, e.g. if @a sa is no longer
+ *         a local address.
+ */
+MPTCPD_API int mptcpd_lm_restore(struct mptcpd_lm *lm,
+                                 struct sockaddr const *sa);
+
+/**
+ * @brief Close restored listeners that were not claimed.
+ *
+ * @param[in] lm The mptcpd address listener manager object.
+ *
+ * @return Number of listeners closed.
+ */
+MPTCPD_API unsigned int mptcpd_lm_release_restored(struct mptcpd_lm *lm);
+
+/**
+ * @brief Listener callback.
+ *
+ * @param[in] sa        MPTCP local address, including the port.
+ * @param[in] user_data User supplied data.
+ */
+typedef void (*mptcpd_lm_callback)(struct sockaddr const *sa,
+                                   void *user_data);
+
+/**
+ * @brief Iterate over claimed listeners.
+ *
+ * @param[in] lm        The mptcpd address listener manager object.
+ * @param[in] callback  Function called for each listener.
+ * @param[in] user_data Data passed to @a callback.
+ */
+MPTCPD_API void mptcpd_lm_foreach(struct mptcpd_lm *lm,
+                                  mptcpd_lm_callback callback,
+                                  void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/loop_monitor.h
+ *
+ * @brief Event loop latency monitor - private API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_LOOP_MONITOR_H
+#define MPTCPD_PRIVATE_LOOP_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of event loop latency histogram buckets.
+ *
+ * Bucket @c 0 counts durations below 1 microsecond, and bucket @c i
+ * durations of at least 2<sup>i-1</sup> and less than 2<sup>i</sup>
+ * microseconds.  The last bucket also counts all longer durations.
+ */
+#define MPTCPD_LOOPMON_BUCKETS 20
+
+/**
+ * @struct mptcpd_loopmon_stats
+ *
+ * @brief Event loop latency statistics.
+ */
+struct mptcpd_loopmon_stats
+{
+        /// Histogram of lag probe scheduling delays.
+        uint64_t lag[MPTCPD_LOOPMON_BUCKETS];
+
+        /// Histogram of monitored handler run times.
+        uint64_t work[MPTCPD_LOOPMON_BUCKETS];
+
+        /// Longest lag probe scheduling delay in microseconds.
+        uint64_t max_lag;
+
+        /// Longest monitored handler run time in microseconds.
+        uint64_t max_work;
+
+        /// Number of detected event loop stalls.
+        uint64_t stalls;
+};
+
+/**
+ * @brief Start monitoring event loop latency.
+ *
+ * Periodically measure how late a lag probe timeout is dispatched by
+ * the event loop, and how long the handlers bracketed by
+ * @c mptcpd_loopmon_enter() and @c mptcpd_loopmon_leave() run.  A
+ * warning naming the handler responsible, if any, is logged when the
+ * event loop stalls for @a threshold milliseconds or more.
+ *
+ * Restarting the monitor changes the threshold and keeps the
+ * statistics collected so far.
+ *
+ * @param[in] threshold Stall threshold in milliseconds.  Zero stops
+ *                      the monitor.
+ *
+ * @return @c true on success, and @c false otherwise.
+ *
+ * @note Call after @c l_main_init().
+ */
+MPTCPD_API bool mptcpd_loopmon_start(unsigned int threshold);
+
+/**
+ * @brief Stop monitoring event loop latency.
+ *
+ * Statistics collected so far remain available.
+ */
+MPTCPD_API void mptcpd_loopmon_stop(void);
+
+/**
+ * @brief Mark the start of an event loop handler.
+ *
+ * Nested calls are accounted to the outermost handler.  This
+ * function does nothing while the monitor is stopped.
+ *
+ * @param[in] source Event source, e.g. @c "genl" or @c "rtnl", with
+ *                   static storage duration.
+ * @param[in] type   Source specific event type, e.g. a generic
+ *                   netlink command or rtnetlink message type.
+ */
+MPTCPD_API void mptcpd_loopmon_enter(char const *source, unsigned int type);
+
+/**
+ * @brief Mark the end of an event loop handler.
+ *
+ * @see mptcpd_loopmon_enter()
+ */
+MPTCPD_API void mptcpd_loopmon_leave(void);
+
+/**
+ * @brief Get event loop latency statistics.
+ *
+ * @return Statistics collected since the monitor was first started.
+ */
+MPTCPD_API struct mptcpd_loopmon_stats const *mptcpd_loopmon_get_stats(void);
+
+/**
+ * @brief Log a summary of event loop latency statistics.
+ */
+MPTCPD_API void mptcpd_loopmon_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_LOOP_MONITOR_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
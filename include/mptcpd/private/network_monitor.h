@@ -66,6 +66,46 @@ MPTCPD_API struct mptcpd_nm *mptcpd_nm_create(uint32_t flags);
  */
 MPTCPD_API void mptcpd_nm_destroy(struct mptcpd_nm *nm);
 
+/**
+ * @brief Change network monitor address notification flags.
+ *
+ * The flags apply to address notifications that follow.
+ * @c MPTCPD_NOTIFY_FLAG_EXISTING only matters before the initial
+ * network interface dump completes.
+ *
+ * @param[in,out] nm    Network monitor.
+ * @param[in]     flags Flags controlling address notification.
+ *
+ * @see mptcpd_nm_create()
+ */
+MPTCPD_API void mptcpd_nm_set_notify_flags(struct mptcpd_nm *nm,
+                                           uint32_t flags);
+
+/**
+ * @brief Network monitor synchronization callback type.
+ *
+ * @param[in] user_data Data passed to @c mptcpd_nm_notify_synced().
+ */
+typedef void (*mptcpd_nm_synced_func)(void *user_data);
+
+/**
+ * @brief Get notified when the initial network dump completes.
+ *
+ * The initial dump of network interfaces and addresses completes a
+ * few event loop iterations after the network monitor is created.
+ * Addresses that existed at that point have been reported to
+ * subscribers by then if @c MPTCPD_NOTIFY_FLAG_EXISTING is set.
+ *
+ * @param[in,out] nm        Network monitor.
+ * @param[in]     callback  Function called once the initial dump
+ *                          completes, right away if it already has.
+ *                          Replaces any previously set callback.
+ * @param[in]     user_data Data passed to @a callback.
+ */
+MPTCPD_API void mptcpd_nm_notify_synced(struct mptcpd_nm *nm,
+                                        mptcpd_nm_synced_func callback,
+                                        void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
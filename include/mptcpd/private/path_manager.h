@@ -12,7 +12,9 @@
 
 #include <stdbool.h>
 
+#include <mptcpd/export.h>
 #include <mptcpd/types.h>
+#include <mptcpd/path_manager.h>  // For mptcpd_pm_*_stats.
 
 
 #ifdef __cplusplus
@@ -32,6 +34,13 @@ struct mptcpd_limit;
 struct mptcpd_nm;
 struct mptcpd_idm;
 struct mptcpd_lm;
+struct mptcpd_diag;
+struct mptcpd_ecache;
+struct mptcpd_jstats;
+struct mptcpd_sched;
+struct mptcpd_sched_limits;
+struct mptcpd_plugin_policy;
+struct mptcpd_state_restore;
 
 /**
  * @struct mptcpd_pm path_manager.h <mptcpd/private/path_manager.h>
@@ -103,6 +112,69 @@ struct mptcpd_pm
          */
         struct mptcpd_lm *lm;
 
+        /**
+         * @brief MPTCP connection and subflow metrics collector.
+         *
+         * Periodically collects metrics of all MPTCP subflows
+         * through sock_diag dumps on behalf of plugins.
+         */
+        struct mptcpd_diag *diag;
+
+        /**
+         * @brief Remote endpoint cache.
+         *
+         * Addresses announced by peers, retained across MPTCP
+         * connections to the same peer.
+         */
+        struct mptcpd_ecache *ecache;
+
+        /**
+         * @brief Subflow join success statistics.
+         *
+         * Outcome of subflow joins per local network interface and
+         * remote address prefix.
+         */
+        struct mptcpd_jstats *jstats;
+
+        /**
+         * @brief Subflow creation scheduler.
+         *
+         * Paces subflow creation requests made by plugins through
+         * @c mptcpd_pm_add_subflow().
+         */
+        struct mptcpd_sched *sched;
+
+        /**
+         * @brief Per-connection plugin selection policy.
+         *
+         * Compiled from the plugin selection rules in the mptcpd
+         * configuration.  @c NULL if no rules were configured.
+         */
+        struct mptcpd_plugin_policy *policy;
+
+        /**
+         * @brief State restored from the persistent state file.
+         *
+         * Restored state pending validation against the kernel, or
+         * @c NULL if there is none.
+         */
+        struct mptcpd_state_restore *restore;
+
+        /// Path manager plugins have been loaded.
+        bool plugins_loaded;
+
+        /// Initial MPTCP path manager initialization completed.
+        bool initialized;
+
+        /// Initial network interface and address dump completed.
+        bool nm_synced;
+
+        /// Configuration reload statistics.
+        struct mptcpd_pm_reload_stats reload_stats;
+
+        /// Fast failover statistics reported by plugins.
+        struct mptcpd_pm_failover_stats failover_stats;
+
         /// List of @c pm_ops_info objects.
         struct l_queue *event_ops;
 };
@@ -407,6 +479,31 @@ struct mptcpd_kpm_cmd_ops
 };
 
 
+/**
+ * @brief Create a subflow creation scheduler for the path manager.
+ *
+ * @param[in] pm     The mptcpd path manager object.
+ * @param[in] limits Scheduler parameters.
+ *
+ * @return Pointer to new subflow creation scheduler on success.
+ *         @c NULL on failure.
+ */
+MPTCPD_API struct mptcpd_sched *mptcpd_pm_sched_create(
+        struct mptcpd_pm *pm,
+        struct mptcpd_sched_limits const *limits);
+
+/**
+ * @brief Get the network interface index of a local address.
+ *
+ * @param[in] pm    The mptcpd path manager object.
+ * @param[in] laddr Local IP address.
+ *
+ * @return Index of the monitored network interface @a laddr is
+ *         assigned to, or @c 0 if it isn't assigned to any of them.
+ */
+MPTCPD_API int mptcpd_pm_addr_to_index(struct mptcpd_pm const *pm,
+                                       struct sockaddr const *laddr);
+
 #ifdef __cplusplus
 }
 #endif
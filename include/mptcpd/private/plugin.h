@@ -11,6 +11,7 @@
 #define MPTCPD_PRIVATE_PLUGIN_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <mptcpd/export.h>
 #include <mptcpd/types.h>
@@ -23,6 +24,7 @@ extern "C" {
 struct sockaddr;
 struct mptcpd_pm;
 struct mptcpd_interface;
+struct mptcpd_plugin_desc;
 
 /**
  * @name MPTCP Path Manager Generic Netlink Event Handlers
@@ -45,6 +47,23 @@ MPTCPD_API bool mptcpd_plugin_load(char const *dir,
                                    struct l_queue const *plugins_to_load,
                                    struct mptcpd_pm *pm);
 
+/**
+ * @brief Register plugins linked into mptcpd.
+ *
+ * Plugins linked into mptcpd, e.g. through the
+ * @c --enable-builtin-plugins configure option, are loaded along
+ * with plugins found in the plugin directory, without @c dlopen().
+ * They take precedence over plugin files of the same name, and are
+ * loaded even if the plugin directory does not exist.
+ *
+ * @param[in] plugins @c NULL terminated array of plugin descriptors
+ *                    with static storage duration.
+ *
+ * @note Call before @c mptcpd_plugin_load().
+ */
+MPTCPD_API void mptcpd_plugin_register_builtin(
+        struct mptcpd_plugin_desc const *const *plugins);
+
 /**
  * @brief Unload mptcpd plugins.
  *
@@ -52,6 +71,100 @@ MPTCPD_API bool mptcpd_plugin_load(char const *dir,
  */
 MPTCPD_API void mptcpd_plugin_unload(struct mptcpd_pm *pm);
 
+/**
+ * @brief Reload mptcpd plugins.
+ *
+ * Unload all plugins, and load them again from the plugin directory,
+ * picking up plugin binaries that were replaced since they were
+ * loaded as well as changes to the set of plugins to load.  MPTCP
+ * connections are handed over to the reloaded plugin with the same
+ * name, or to the default plugin, along with state exported through
+ * the @c export_state and @c import_state plugin operations.  If no
+ * plugin could be loaded, the previously loaded plugins are loaded
+ * again, and connections are handed over to them instead.
+ *
+ * @param[in] dir             Directory from which plugins will be
+ *                            loaded.
+ * @param[in] default_name    Name of plugin to be considered the
+ *                            default.
+ * @param[in] plugins_to_load List of plugins to be loaded.
+ * @param[in] pm              Opaque pointer to mptcpd path manager
+ *                            object.
+ *
+ * @return @c true on successful reload, @c false otherwise.
+ *
+ * @note This function must not be called from within a plugin
+ *       operation since the plugin is unloaded.  Call it from an
+ *       idle callback to let pending events drain first.
+ */
+MPTCPD_API bool mptcpd_plugin_reload(char const *dir,
+                                     char const *default_name,
+                                     struct l_queue const *plugins_to_load,
+                                     struct mptcpd_pm *pm);
+
+/**
+ * @brief MPTCP connection state callback.
+ *
+ * @param[in] token     MPTCP connection token.
+ * @param[in] name      Name of the plugin managing the connection, or
+ *                      @c NULL if unknown.
+ * @param[in] version   Plugin-defined state format version.
+ * @param[in] state     Connection state exported by the plugin, or
+ *                      @c NULL if there is none.
+ * @param[in] len       Length of @a state in bytes.
+ * @param[in] user_data User supplied data.
+ */
+typedef void (*mptcpd_plugin_state_func)(mptcpd_token_t token,
+                                         char const *name,
+                                         uint32_t version,
+                                         void const *state,
+                                         size_t len,
+                                         void *user_data);
+
+/**
+ * @brief Export the state of all MPTCP connections.
+ *
+ * Connection state is retrieved through the @c export_state
+ * operation of the plugin managing each connection, e.g. to persist
+ * it across mptcpd restarts.  Plugins keep managing the connections.
+ *
+ * @param[in] callback  Function called for each MPTCP connection.
+ * @param[in] user_data Data passed to @a callback.
+ * @param[in] pm        Opaque pointer to mptcpd path manager object.
+ */
+MPTCPD_API void mptcpd_plugin_export_states(
+        mptcpd_plugin_state_func callback,
+        void *user_data,
+        struct mptcpd_pm *pm);
+
+/**
+ * @brief Resume management of an MPTCP connection.
+ *
+ * Map an MPTCP connection that existed prior to mptcpd startup to
+ * the plugin with the given name, or to the default plugin, and
+ * pass it the previously exported connection state through the
+ * @c import_state plugin operation.
+ *
+ * @param[in] token   MPTCP connection token.
+ * @param[in] name    Plugin name, or @c NULL for the default plugin.
+ * @param[in] version Plugin-defined state format version.
+ * @param[in] state   Previously exported connection state, or
+ *                    @c NULL if there is none.
+ * @param[in] len     Length of @a state in bytes.
+ * @param[in] pm      Opaque pointer to mptcpd path manager object.
+ *
+ * @return @c true if the connection was mapped to a plugin, and
+ *         @c false otherwise, e.g. if the connection is already
+ *         managed by a plugin.
+ */
+MPTCPD_API bool mptcpd_plugin_restore_connection(
+        mptcpd_token_t token,
+        char const *name,
+        uint32_t version,
+        void const *state,
+        size_t len,
+        struct mptcpd_pm *pm);
+
 /**
  * @brief Notify plugin of new MPTCP connection pending completion.
  *
@@ -230,6 +343,16 @@ MPTCPD_API void mptcpd_plugin_delete_interface(
         struct mptcpd_interface const *i,
         void *pm);
 
+/**
+ * @brief Notify plugin of network interface link state change.
+ *
+ * @param[in] i  Network interface information.
+ * @param[in] pm Opaque pointer to mptcpd path manager object.
+ */
+MPTCPD_API void mptcpd_plugin_link_state_changed(
+        struct mptcpd_interface const *i,
+        void *pm);
+
 /**
  * @brief Notify plugin of new network address.
  *
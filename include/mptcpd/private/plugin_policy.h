@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/plugin_policy.h
+ *
+ * @brief Per-connection path manager plugin selection - private API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_PLUGIN_POLICY_H
+#define MPTCPD_PRIVATE_PLUGIN_POLICY_H
+
+#include <stdbool.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_plugin_policy;
+struct l_queue;
+struct sockaddr;
+
+/**
+ * @brief Create a path manager plugin selection policy.
+ *
+ * Compile plugin selection rules into lookup tables for fast
+ * per-connection plugin selection.
+ *
+ * @param[in] rules List of @c mptcpd_plugin_rule objects, in order
+ *                  of precedence.  Only the first 32 rules are used.
+ *
+ * @return Pointer to new plugin selection policy on success.
+ *         @c NULL if @a rules is @c NULL or empty.
+ */
+MPTCPD_API struct mptcpd_plugin_policy *mptcpd_plugin_policy_create(
+        struct l_queue const *rules);
+
+/**
+ * @brief Destroy a path manager plugin selection policy.
+ *
+ * @param[in,out] policy Plugin selection policy to be destroyed.
+ */
+MPTCPD_API void mptcpd_plugin_policy_destroy(
+        struct mptcpd_plugin_policy *policy);
+
+/**
+ * @brief Select the path manager plugin of an MPTCP connection.
+ *
+ * @param[in] policy      Plugin selection policy.
+ * @param[in] laddr       Local address information.
+ * @param[in] raddr       Remote address information.
+ * @param[in] server_side Server side connection flag.
+ *
+ * @return Name of the plugin selected by the first matching rule, or
+ *         @c NULL if no rule matches, in which case the default
+ *         plugin should be used.
+ */
+MPTCPD_API char const *mptcpd_plugin_policy_select(
+        struct mptcpd_plugin_policy const *policy,
+        struct sockaddr const *laddr,
+        struct sockaddr const *raddr,
+        bool server_side);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_PLUGIN_POLICY_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
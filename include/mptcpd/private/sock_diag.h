@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/sock_diag.h
+ *
+ * @brief mptcpd metrics collector - internal API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_SOCK_DIAG_H
+#define MPTCPD_PRIVATE_SOCK_DIAG_H
+
+#include <mptcpd/export.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mptcpd_diag;
+
+/**
+ * @brief Create a metrics collector.
+ *
+ * @param[in] interval Collection interval in milliseconds.
+ *
+ * @return Pointer to new metrics collector on success.  @c NULL on
+ *         failure.
+ */
+MPTCPD_API struct mptcpd_diag *mptcpd_diag_create(unsigned int interval);
+
+/**
+ * @brief Destroy a metrics collector.
+ *
+ * @param[in,out] diag Metrics collector to be destroyed.
+ */
+MPTCPD_API void mptcpd_diag_destroy(struct mptcpd_diag *diag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_SOCK_DIAG_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/state_file.h
+ *
+ * @brief mptcpd persistent state file - private API.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_STATE_FILE_H
+#define MPTCPD_PRIVATE_STATE_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mptcpd/export.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the state file layout.
+ *
+ * Increment whenever the layout of the state file header, record
+ * framing or any record payload changes.  State files with a
+ * different version are ignored.
+ */
+#define MPTCPD_STATE_FILE_VERSION 1
+
+struct mptcpd_state_file;
+struct mptcpd_state_writer;
+
+/**
+ * @brief State file record callback.
+ *
+ * @param[in] data      Record payload, aligned on an 8 byte boundary.
+ *                      Only valid until the state file is closed.
+ * @param[in] len       Length of @a data in bytes.
+ * @param[in] user_data User supplied data.
+ */
+typedef void (*mptcpd_state_record_func)(void const *data,
+                                         size_t len,
+                                         void *user_data);
+
+/**
+ * @brief Create a state file writer.
+ *
+ * Records are accumulated in memory until the writer is committed
+ * to a file.
+ *
+ * @return Pointer to new state file writer.
+ */
+MPTCPD_API struct mptcpd_state_writer *mptcpd_state_writer_create(void);
+
+/**
+ * @brief Destroy a state file writer.
+ *
+ * @param[in,out] w State file writer to be destroyed.
+ */
+MPTCPD_API void mptcpd_state_writer_destroy(struct mptcpd_state_writer *w);
+
+/**
+ * @brief Append a record to a state file.
+ *
+ * @param[in,out] w    State file writer.
+ * @param[in]     type Non-zero caller-defined record type.
+ * @param[in]     data Record payload.  May be @c NULL if @a len is
+ *                     zero.
+ * @param[in]     len  Length of @a data in bytes.
+ *
+ * @return @c true on success, and @c false on invalid arguments.
+ */
+MPTCPD_API bool mptcpd_state_writer_add(struct mptcpd_state_writer *w,
+                                        uint16_t type,
+                                        void const *data,
+                                        size_t len);
+
+/**
+ * @brief Write the accumulated records to a state file.
+ *
+ * The file is written through a shared memory mapping of a temporary
+ * file that is synchronized to storage and renamed over @a path, so
+ * readers never observe a partially written state file.
+ *
+ * @param[in] w    State file writer.
+ * @param[in] path State file path.
+ *
+ * @return @c true on success, and @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_state_writer_commit(
+        struct mptcpd_state_writer const *w,
+        char const *path);
+
+/**
+ * @brief Map a state file into memory.
+ *
+ * The state file magic, version, size and checksum are validated, as
+ * is the framing of every record, before the file is made available.
+ *
+ * @param[in] path State file path.
+ *
+ * @return Pointer to the mapped state file on success, and @c NULL
+ *         if the file doesn't exist or is invalid.
+ */
+MPTCPD_API struct mptcpd_state_file *mptcpd_state_file_open(
+        char const *path);
+
+/**
+ * @brief Unmap a state file.
+ *
+ * @param[in,out] sf State file to be closed.
+ */
+MPTCPD_API void mptcpd_state_file_close(struct mptcpd_state_file *sf);
+
+/**
+ * @brief Was the state file written since the last system boot?
+ *
+ * Kernel state, such as MPTCP connections, doesn't survive a reboot.
+ *
+ * @param[in] sf State file.
+ *
+ * @return @c true if the state file was written during the current
+ *         boot, and @c false otherwise, including when the boot ID
+ *         is unavailable.
+ */
+MPTCPD_API bool mptcpd_state_file_same_boot(
+        struct mptcpd_state_file const *sf);
+
+/**
+ * @brief Iterate over state file records of a given type.
+ *
+ * Records are visited in the order in which they were added.
+ *
+ * @param[in] sf        State file.
+ * @param[in] type      Record type.
+ * @param[in] callback  Function called for each record of @a type.
+ * @param[in] user_data Data passed to @a callback.
+ *
+ * @return Number of records visited.
+ */
+MPTCPD_API size_t mptcpd_state_file_foreach(
+        struct mptcpd_state_file const *sf,
+        uint16_t type,
+        mptcpd_state_record_func callback,
+        void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_STATE_FILE_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
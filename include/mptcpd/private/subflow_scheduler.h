@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file private/subflow_scheduler.h
+ *
+ * @brief MPTCP subflow creation scheduler.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PRIVATE_SUBFLOW_SCHEDULER_H
+#define MPTCPD_PRIVATE_SUBFLOW_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+#include <mptcpd/export.h>
+#include <mptcpd/types.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sockaddr;
+struct mptcpd_sched;
+
+/**
+ * @struct mptcpd_sched_request
+ *
+ * @brief Subflow creation request.
+ */
+struct mptcpd_sched_request
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// MPTCP local address ID.
+        mptcpd_aid_t local_id;
+
+        /// MPTCP remote address ID.
+        mptcpd_aid_t remote_id;
+
+        /**
+         * @brief Subflow local address and port.
+         *
+         * The address family is @c AF_UNSPEC if no local address
+         * was requested.
+         */
+        struct sockaddr_storage laddr;
+
+        /// Subflow remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Set the subflow backup priority flag.
+        bool backup;
+};
+
+/**
+ * @struct mptcpd_sched_limits
+ *
+ * @brief Subflow creation scheduler parameters.
+ *
+ * Zero disables the corresponding limit.
+ */
+struct mptcpd_sched_limits
+{
+        /**
+         * @brief Maximum number of pending subflow joins per local
+         *        network interface.
+         */
+        unsigned int per_interface;
+
+        /**
+         * @brief Maximum number of pending subflow joins per remote
+         *        IP address.
+         */
+        unsigned int per_destination;
+
+        /**
+         * @brief Maximum random delay in milliseconds before a
+         *        subflow creation request is issued.
+         */
+        unsigned int jitter;
+};
+
+/**
+ * @struct mptcpd_sched_ops
+ *
+ * @brief Subflow creation scheduler callbacks.
+ */
+struct mptcpd_sched_ops
+{
+        /**
+         * @brief Issue a subflow creation request.
+         *
+         * @return @c 0 on success, and @c errno otherwise.
+         */
+        int (*issue)(struct mptcpd_sched_request const *req,
+                     void *user_data);
+
+        /**
+         * @brief Get network interface index of a local address.
+         *
+         * @return Network interface index, or zero if unknown.
+         */
+        int (*get_index)(struct sockaddr const *laddr, void *user_data);
+
+        /**
+         * @brief Get MPTCP connection scheduling weight.
+         *
+         * Requests of connections with a larger weight, e.g. more
+         * data in flight, are issued first.  Optional.
+         */
+        uint64_t (*get_weight)(mptcpd_token_t token, void *user_data);
+};
+
+/**
+ * @struct mptcpd_sched_stats
+ *
+ * @brief Subflow creation scheduler statistics.
+ */
+struct mptcpd_sched_stats
+{
+        /// Number of subflow creation requests issued.
+        uint64_t issued;
+
+        /// Number of issued requests that were deferred.
+        uint64_t deferred;
+
+        /// Number of subflow joins that succeeded.
+        uint64_t established;
+
+        /**
+         * @brief Number of subflow joins that failed, timed out or
+         *        whose request could not be issued.
+         */
+        uint64_t failed;
+
+        /**
+         * @brief Join latency histogram.
+         *
+         * Bucket @c i counts joins that completed in less than
+         * 2<sup>i</sup> milliseconds, with the last bucket counting
+         * all slower joins.
+         */
+        uint64_t latency[16];
+};
+
+/**
+ * @brief Create a subflow creation scheduler.
+ *
+ * @param[in] limits    Scheduler parameters.
+ * @param[in] ops       Scheduler callbacks.
+ * @param[in] user_data Data passed to @a ops.
+ *
+ * @return Pointer to new subflow creation scheduler on success.
+ *         @c NULL on failure.
+ */
+MPTCPD_API struct mptcpd_sched *mptcpd_sched_create(
+        struct mptcpd_sched_limits const *limits,
+        struct mptcpd_sched_ops const *ops,
+        void *user_data);
+
+/**
+ * @brief Destroy a subflow creation scheduler.
+ *
+ * Queued requests are dropped.
+ *
+ * @param[in,out] sched Subflow creation scheduler to be destroyed.
+ */
+MPTCPD_API void mptcpd_sched_destroy(struct mptcpd_sched *sched);
+
+/**
+ * @brief Change subflow creation scheduler parameters.
+ *
+ * Queued requests allowed by the new limits are issued right away.
+ * Joins already in flight count against the new limits.
+ *
+ * @param[in,out] sched  Subflow creation scheduler.
+ * @param[in]     limits Scheduler parameters.
+ */
+MPTCPD_API void mptcpd_sched_set_limits(
+        struct mptcpd_sched *sched,
+        struct mptcpd_sched_limits const *limits);
+
+/**
+ * @brief Schedule a subflow creation request.
+ *
+ * The request is issued immediately if the scheduler limits allow
+ * it, and is otherwise queued until they do.
+ *
+ * @param[in,out] sched Subflow creation scheduler.
+ * @param[in]     req   Subflow creation request.
+ *
+ * @return @c 0 if the request was issued or queued, and @c errno
+ *         if it could not be issued.
+ */
+MPTCPD_API int mptcpd_sched_add_subflow(
+        struct mptcpd_sched *sched,
+        struct mptcpd_sched_request const *req);
+
+/**
+ * @brief Report the outcome of a subflow join.
+ *
+ * Completing a join releases its scheduling slot.  Subflows not
+ * created through the scheduler are ignored.
+ *
+ * @param[in,out] sched       Subflow creation scheduler.
+ * @param[in]     token       MPTCP connection token.
+ * @param[in]     laddr       Subflow local address.
+ * @param[in]     raddr       Subflow remote address.
+ * @param[in]     established @c true if the subflow was established,
+ *                            and @c false if the join failed.
+ */
+MPTCPD_API void mptcpd_sched_complete(struct mptcpd_sched *sched,
+                                      mptcpd_token_t token,
+                                      struct sockaddr const *laddr,
+                                      struct sockaddr const *raddr,
+                                      bool established);
+
+/**
+ * @brief Drop all requests of a MPTCP connection.
+ *
+ * @param[in,out] sched Subflow creation scheduler.
+ * @param[in]     token MPTCP connection token.
+ */
+MPTCPD_API void mptcpd_sched_cancel(struct mptcpd_sched *sched,
+                                    mptcpd_token_t token);
+
+/**
+ * @brief Get subflow creation scheduler statistics.
+ *
+ * @param[in] sched Subflow creation scheduler.
+ *
+ * @return Subflow creation scheduler statistics.
+ */
+MPTCPD_API struct mptcpd_sched_stats const *
+mptcpd_sched_get_stats(struct mptcpd_sched const *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_PRIVATE_SUBFLOW_SCHEDULER_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file sock_diag.h
+ *
+ * @brief mptcpd MPTCP connection and subflow metrics collector.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_SOCK_DIAG_H
+#define MPTCPD_SOCK_DIAG_H
+
+#include <mptcpd/export.h>
+#include <mptcpd/types.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sockaddr_storage;
+struct mptcpd_diag;
+
+/**
+ * @struct mptcpd_diag_connections sock_diag.h <mptcpd/sock_diag.h>
+ *
+ * @brief MPTCP connection metrics.
+ *
+ * Connection metrics are stored in columns.  All columns have
+ * @c count entries, and entries at the same position in each column
+ * correspond to the same MPTCP connection.
+ */
+struct mptcpd_diag_connections
+{
+        /// Number of MPTCP connections.
+        size_t count;
+
+        /// MPTCP connection tokens.
+        mptcpd_token_t *token;
+
+        /**
+         * @brief Position of the first subflow of the connection.
+         *
+         * Subflows of the same connection are stored contiguously in
+         * the @c mptcpd_diag_subflows columns, starting at this
+         * position.
+         */
+        size_t *first;
+
+        /// Number of subflows of the connection.
+        size_t *subflows;
+};
+
+/**
+ * @struct mptcpd_diag_subflows sock_diag.h <mptcpd/sock_diag.h>
+ *
+ * @brief MPTCP subflow metrics.
+ *
+ * Subflow metrics are stored in columns.  All columns have @c count
+ * entries, and entries at the same position in each column correspond
+ * to the same subflow.
+ */
+struct mptcpd_diag_subflows
+{
+        /// Number of subflows.
+        size_t count;
+
+        /// Token of the MPTCP connection the subflow belongs to.
+        mptcpd_token_t *token;
+
+        /// Subflow local address and port.
+        struct sockaddr_storage *laddr;
+
+        /// Subflow remote address and port.
+        struct sockaddr_storage *raddr;
+
+        /// Smoothed round trip time in microseconds.
+        uint32_t *rtt;
+
+        /// Congestion window in segments.
+        uint32_t *cwnd;
+
+        /// Number of bytes acknowledged by the peer.
+        uint64_t *bytes_acked;
+
+        /// Total number of retransmitted segments.
+        uint32_t *retrans;
+
+        /// Total number of segments sent.
+        uint32_t *segs_out;
+
+        /// Delivery rate in bytes per second.
+        uint64_t *delivery_rate;
+
+        /// Subflow has the local backup priority.
+        bool *backup;
+};
+
+/**
+ * @struct mptcpd_diag_snapshot sock_diag.h <mptcpd/sock_diag.h>
+ *
+ * @brief Metrics of all MPTCP connections collected in one round.
+ *
+ * Snapshot memory is owned by the collector, and is reused for
+ * subsequent rounds.  Do not retain pointers to snapshot contents
+ * beyond the @c mptcpd_diag_ops::snapshot callback.
+ */
+struct mptcpd_diag_snapshot
+{
+        /// Collection round, starting at one.
+        uint64_t round;
+
+        /// Monotonic time of round completion in microseconds.
+        uint64_t timestamp;
+
+        /// MPTCP connection metrics.
+        struct mptcpd_diag_connections connections;
+
+        /// MPTCP subflow metrics.
+        struct mptcpd_diag_subflows subflows;
+};
+
+/**
+ * @struct mptcpd_diag_ops sock_diag.h <mptcpd/sock_diag.h>
+ *
+ * @brief Metrics collector event tracking callbacks.
+ */
+struct mptcpd_diag_ops
+{
+        /**
+         * @brief A collection round completed.
+         *
+         * @param[in] snapshot  Metrics collected in the round.
+         * @param[in] user_data User supplied data.
+         */
+        void (*snapshot)(struct mptcpd_diag_snapshot const *snapshot,
+                         void *user_data);
+};
+
+/**
+ * @brief Subscribe to metrics collector events.
+ *
+ * Metrics are only collected while at least one set of operations is
+ * registered.
+ *
+ * @param[in] diag      Metrics collector.
+ * @param[in] ops       Metrics collector event handling operations.
+ * @param[in] user_data Pointer to user data passed to the event
+ *                      handling operations.
+ *
+ * @return @c true on success, and @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_diag_register_ops(struct mptcpd_diag *diag,
+                                         struct mptcpd_diag_ops const *ops,
+                                         void *user_data);
+
+/**
+ * @brief Unsubscribe from metrics collector events.
+ *
+ * @param[in] diag      Metrics collector.
+ * @param[in] ops       Operations previously passed to
+ *                      @c mptcpd_diag_register_ops().
+ * @param[in] user_data User data previously passed to
+ *                      @c mptcpd_diag_register_ops().
+ *
+ * @return @c true if the operations were registered, and @c false
+ *         otherwise.
+ */
+MPTCPD_API bool mptcpd_diag_unregister_ops(
+        struct mptcpd_diag *diag,
+        struct mptcpd_diag_ops const *ops,
+        void *user_data);
+
+/**
+ * @brief Get the most recently completed metrics snapshot.
+ *
+ * @param[in] diag Metrics collector.
+ *
+ * @return Most recent snapshot, or @c NULL if no collection round
+ *         has completed yet.
+ */
+MPTCPD_API struct mptcpd_diag_snapshot const *
+mptcpd_diag_get_snapshot(struct mptcpd_diag const *diag);
+
+/**
+ * @brief Find a connection in the most recent metrics snapshot.
+ *
+ * @param[in]  diag  Metrics collector.
+ * @param[in]  token MPTCP connection token.
+ * @param[out] index Position of the connection in the
+ *                   @c mptcpd_diag_connections columns of the
+ *                   snapshot returned by
+ *                   @c mptcpd_diag_get_snapshot().
+ *
+ * @return @c true if the connection is in the snapshot, and
+ *         @c false otherwise.
+ */
+MPTCPD_API bool mptcpd_diag_find_connection(struct mptcpd_diag const *diag,
+                                            mptcpd_token_t token,
+                                            size_t *index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MPTCPD_SOCK_DIAG_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
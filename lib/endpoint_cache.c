@@ -0,0 +1,512 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file endpoint_cache.c
+ *
+ * @brief Cache of addresses announced by MPTCP peers.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/endpoint_cache.h>
+#include <mptcpd/endpoint_cache.h>
+
+#include "hash_sockaddr.h"
+
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct ecache_addr
+ *
+ * @brief Address announced by a peer.
+ */
+struct ecache_addr
+{
+        /// Remote address ID.
+        mptcpd_aid_t id;
+
+        /// Remote address, and optionally port.
+        struct sockaddr_storage addr;
+
+        /// Expiration time (microseconds) from @c l_time_now().
+        uint64_t expires;
+};
+
+/**
+ * @struct ecache_peer
+ *
+ * @brief Addresses announced by a peer, keyed by primary address.
+ *
+ * Peers are kept in a doubly linked list ordered from most to least
+ * recently used to allow constant time LRU updates and eviction.
+ */
+struct ecache_peer
+{
+        /// Peer primary address, i.e. the hash map key.
+        struct sockaddr_storage primary;
+
+        /// List of @c struct @c ecache_addr announced by the peer.
+        struct l_queue *addrs;
+
+        /// More recently used peer.
+        struct ecache_peer *prev;
+
+        /// Less recently used peer.
+        struct ecache_peer *next;
+};
+
+/**
+ * @struct mptcpd_ecache
+ *
+ * @brief Internal mptcpd remote endpoint cache data.
+ */
+struct mptcpd_ecache
+{
+        /// Map of peer primary address to @c struct @c ecache_peer.
+        struct l_hashmap *peers;
+
+        /// Map of MPTCP connection token to peer primary address.
+        struct l_hashmap *tokens;
+
+        /// Most recently used peer.
+        struct ecache_peer *head;
+
+        /// Least recently used peer.
+        struct ecache_peer *tail;
+
+        /// Number of cached peers.
+        unsigned int count;
+
+        /// Maximum number of cached peers.
+        unsigned int capacity;
+
+        /// Cached address lifetime in microseconds.
+        uint64_t ttl;
+
+        /// MurmurHash3 seed value.
+        uint32_t seed;
+};
+
+// ----------------------------------------------------------------------
+
+static bool is_inet(struct sockaddr const *sa)
+{
+        return sa->sa_family == AF_INET || sa->sa_family == AF_INET6;
+}
+
+static size_t sockaddr_size(struct sockaddr const *sa)
+{
+        return sa->sa_family == AF_INET
+                ? sizeof(struct sockaddr_in)
+                : sizeof(struct sockaddr_in6);
+}
+
+static bool ecache_addr_id_match(void const *a, void const *b)
+{
+        struct ecache_addr const *const addr = a;
+        mptcpd_aid_t const id = L_PTR_TO_UINT(b);
+
+        return addr->id == id;
+}
+
+static bool ecache_addr_expired(void *data, void *user_data)
+{
+        struct ecache_addr *const addr = data;
+        uint64_t const *const now = user_data;
+
+        if (addr->expires > *now)
+                return false;
+
+        l_free(addr);
+
+        return true;
+}
+
+static void ecache_peer_unlink(struct mptcpd_ecache *cache,
+                               struct ecache_peer *peer)
+{
+        if (peer->prev != NULL)
+                peer->prev->next = peer->next;
+        else
+                cache->head = peer->next;
+
+        if (peer->next != NULL)
+                peer->next->prev = peer->prev;
+        else
+                cache->tail = peer->prev;
+
+        peer->prev = NULL;
+        peer->next = NULL;
+}
+
+static void ecache_peer_push(struct mptcpd_ecache *cache,
+                             struct ecache_peer *peer)
+{
+        peer->prev = NULL;
+        peer->next = cache->head;
+
+        if (cache->head != NULL)
+                cache->head->prev = peer;
+        else
+                cache->tail = peer;
+
+        cache->head = peer;
+}
+
+static void ecache_peer_touch(struct mptcpd_ecache *cache,
+                              struct ecache_peer *peer)
+{
+        if (cache->head == peer)
+                return;
+
+        ecache_peer_unlink(cache, peer);
+        ecache_peer_push(cache, peer);
+}
+
+static void ecache_peer_destroy(void *data)
+{
+        struct ecache_peer *const peer = data;
+
+        l_queue_destroy(peer->addrs, l_free);
+        l_free(peer);
+}
+
+static void ecache_peer_evict(struct mptcpd_ecache *cache,
+                              struct ecache_peer *peer)
+{
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = (struct sockaddr const *) &peer->primary,
+                .seed = cache->seed
+        };
+
+        ecache_peer_unlink(cache, peer);
+
+        (void) l_hashmap_remove(cache->peers, &key);
+        --cache->count;
+
+        ecache_peer_destroy(peer);
+}
+
+static struct ecache_peer *ecache_peer_lookup(
+        struct mptcpd_ecache *cache,
+        struct sockaddr const *primary)
+{
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = primary, .seed = cache->seed
+        };
+
+        return l_hashmap_lookup(cache->peers, &key);
+}
+
+static struct ecache_peer *ecache_peer_get(struct mptcpd_ecache *cache,
+                                           struct sockaddr const *primary)
+{
+        struct ecache_peer *peer = ecache_peer_lookup(cache, primary);
+
+        if (peer != NULL) {
+                ecache_peer_touch(cache, peer);
+
+                return peer;
+        }
+
+        if (cache->count == cache->capacity)
+                ecache_peer_evict(cache, cache->tail);
+
+        peer = l_new(struct ecache_peer, 1);
+        memcpy(&peer->primary, primary, sockaddr_size(primary));
+        peer->addrs = l_queue_new();
+
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = (struct sockaddr const *) &peer->primary,
+                .seed = cache->seed
+        };
+
+        if (!l_hashmap_insert(cache->peers, &key, peer)) {
+                ecache_peer_destroy(peer);
+
+                return NULL;
+        }
+
+        ecache_peer_push(cache, peer);
+        ++cache->count;
+
+        return peer;
+}
+
+static struct ecache_peer *ecache_peer_by_token(
+        struct mptcpd_ecache *cache,
+        mptcpd_token_t token)
+{
+        struct sockaddr const *const primary =
+                l_hashmap_lookup(cache->tokens, L_UINT_TO_PTR(token));
+
+        if (primary == NULL)
+                return NULL;
+
+        return ecache_peer_get(cache, primary);
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_ecache *mptcpd_ecache_create(unsigned int capacity,
+                                           unsigned int ttl)
+{
+        if (capacity == 0 || ttl == 0)
+                return NULL;
+
+        struct mptcpd_ecache *const cache = l_new(struct mptcpd_ecache, 1);
+
+        cache->peers    = l_hashmap_new();
+        cache->tokens   = l_hashmap_new();
+        cache->capacity = capacity;
+        cache->ttl      = (uint64_t) ttl * L_USEC_PER_MSEC;
+        cache->seed     = l_getrandom_uint32();
+
+        if (!l_hashmap_set_hash_function(cache->peers,
+                                         mptcpd_hash_sockaddr)
+            || !l_hashmap_set_compare_function(cache->peers,
+                                               mptcpd_hash_sockaddr_compare)
+            || !l_hashmap_set_key_copy_function(cache->peers,
+                                                mptcpd_hash_sockaddr_key_copy)
+            || !l_hashmap_set_key_free_function(cache->peers,
+                                                mptcpd_hash_sockaddr_key_free)) {
+                mptcpd_ecache_destroy(cache);
+
+                return NULL;
+        }
+
+        return cache;
+}
+
+void mptcpd_ecache_destroy(struct mptcpd_ecache *cache)
+{
+        if (cache == NULL)
+                return;
+
+        l_hashmap_destroy(cache->tokens, l_free);
+        l_hashmap_destroy(cache->peers, ecache_peer_destroy);
+        l_free(cache);
+}
+
+bool mptcpd_ecache_track(struct mptcpd_ecache *cache,
+                         mptcpd_token_t token,
+                         struct sockaddr const *primary)
+{
+        if (cache == NULL || primary == NULL || !is_inet(primary))
+                return false;
+
+        void *const old = l_hashmap_remove(cache->tokens,
+                                           L_UINT_TO_PTR(token));
+        l_free(old);
+
+        return l_hashmap_insert(cache->tokens,
+                                L_UINT_TO_PTR(token),
+                                l_memdup(primary, sockaddr_size(primary)));
+}
+
+void mptcpd_ecache_untrack(struct mptcpd_ecache *cache,
+                           mptcpd_token_t token)
+{
+        if (cache == NULL)
+                return;
+
+        l_free(l_hashmap_remove(cache->tokens, L_UINT_TO_PTR(token)));
+}
+
+static void ecache_peer_set(struct ecache_peer *peer,
+                            mptcpd_aid_t id,
+                            struct sockaddr const *addr,
+                            uint64_t expires)
+{
+        struct ecache_addr *entry =
+                l_queue_find(peer->addrs,
+                             ecache_addr_id_match,
+                             L_UINT_TO_PTR(id));
+
+        if (entry == NULL) {
+                entry = l_new(struct ecache_addr, 1);
+                entry->id = id;
+
+                (void) l_queue_push_tail(peer->addrs, entry);
+        }
+
+        memset(&entry->addr, 0, sizeof(entry->addr));
+        memcpy(&entry->addr, addr, sockaddr_size(addr));
+        entry->expires = expires;
+}
+
+bool mptcpd_ecache_add(struct mptcpd_ecache *cache,
+                       mptcpd_token_t token,
+                       mptcpd_aid_t id,
+                       struct sockaddr const *addr)
+{
+        if (cache == NULL || addr == NULL || !is_inet(addr))
+                return false;
+
+        struct ecache_peer *const peer = ecache_peer_by_token(cache, token);
+
+        if (peer == NULL)
+                return false;
+
+        ecache_peer_set(peer, id, addr, l_time_now() + cache->ttl);
+
+        return true;
+}
+
+bool mptcpd_ecache_remove(struct mptcpd_ecache *cache,
+                          mptcpd_token_t token,
+                          mptcpd_aid_t id)
+{
+        if (cache == NULL)
+                return false;
+
+        struct sockaddr const *const primary =
+                l_hashmap_lookup(cache->tokens, L_UINT_TO_PTR(token));
+
+        if (primary == NULL)
+                return false;
+
+        struct ecache_peer *const peer =
+                ecache_peer_lookup(cache, primary);
+
+        if (peer == NULL)
+                return false;
+
+        struct ecache_addr *const entry =
+                l_queue_remove_if(peer->addrs,
+                                  ecache_addr_id_match,
+                                  L_UINT_TO_PTR(id));
+
+        if (entry == NULL)
+                return false;
+
+        l_free(entry);
+
+        return true;
+}
+
+size_t mptcpd_ecache_foreach(struct mptcpd_ecache *cache,
+                             struct sockaddr const *primary,
+                             mptcpd_ecache_callback callback,
+                             void *user_data)
+{
+        if (cache == NULL || primary == NULL || callback == NULL
+            || !is_inet(primary))
+                return 0;
+
+        struct ecache_peer *const peer =
+                ecache_peer_lookup(cache, primary);
+
+        if (peer == NULL)
+                return 0;
+
+        uint64_t now = l_time_now();
+
+        (void) l_queue_foreach_remove(peer->addrs,
+                                      ecache_addr_expired,
+                                      &now);
+
+        if (l_queue_isempty(peer->addrs)) {
+                ecache_peer_evict(cache, peer);
+
+                return 0;
+        }
+
+        ecache_peer_touch(cache, peer);
+
+        size_t count = 0;
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(peer->addrs);
+             e != NULL;
+             e = e->next, ++count) {
+                struct ecache_addr const *const entry = e->data;
+
+                callback(entry->id,
+                         (struct sockaddr const *) &entry->addr,
+                         user_data);
+        }
+
+        return count;
+}
+
+struct sockaddr const *mptcpd_ecache_get_primary(
+        struct mptcpd_ecache const *cache,
+        mptcpd_token_t token)
+{
+        if (cache == NULL)
+                return NULL;
+
+        return l_hashmap_lookup(cache->tokens, L_UINT_TO_PTR(token));
+}
+
+void mptcpd_ecache_dump(struct mptcpd_ecache *cache,
+                        mptcpd_ecache_dump_callback callback,
+                        void *user_data)
+{
+        if (cache == NULL || callback == NULL)
+                return;
+
+        uint64_t const now = l_time_now();
+
+        for (struct ecache_peer const *peer = cache->tail;
+             peer != NULL;
+             peer = peer->prev) {
+                for (struct l_queue_entry const *e =
+                             l_queue_get_entries(peer->addrs);
+                     e != NULL;
+                     e = e->next) {
+                        struct ecache_addr const *const entry = e->data;
+
+                        if (entry->expires <= now)
+                                continue;
+
+                        callback((struct sockaddr const *) &peer->primary,
+                                 entry->id,
+                                 (struct sockaddr const *) &entry->addr,
+                                 (entry->expires - now) / L_USEC_PER_MSEC,
+                                 user_data);
+                }
+        }
+}
+
+bool mptcpd_ecache_restore(struct mptcpd_ecache *cache,
+                           struct sockaddr const *primary,
+                           mptcpd_aid_t id,
+                           struct sockaddr const *addr,
+                           unsigned int lifetime)
+{
+        if (cache == NULL || primary == NULL || addr == NULL
+            || !is_inet(primary) || !is_inet(addr) || lifetime == 0)
+                return false;
+
+        struct ecache_peer *const peer = ecache_peer_get(cache, primary);
+
+        if (peer == NULL)
+                return false;
+
+        uint64_t const ttl =
+                L_MIN((uint64_t) lifetime * L_USEC_PER_MSEC, cache->ttl);
+
+        ecache_peer_set(peer, id, addr, l_time_now() + ttl);
+
+        return true;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -23,6 +23,30 @@
 #include "hash_sockaddr.h"
 
 
+unsigned int mptcpd_hash_sockaddr(void const *p)
+{
+        struct mptcpd_hash_sockaddr_key const *const key = p;
+        struct sockaddr const *const sa = key->sa;
+
+        assert(sa->sa_family == AF_INET || sa->sa_family == AF_INET6);
+
+        if (sa->sa_family == AF_INET) {
+                struct sockaddr_in const *const sa4 =
+                        (struct sockaddr_in const *) sa;
+
+                return mptcpd_murmur_hash3(&sa4->sin_addr.s_addr,
+                                           sizeof(sa4->sin_addr.s_addr),
+                                           key->seed);
+        } else {
+                struct sockaddr_in6 const *const sa6 =
+                        (struct sockaddr_in6 const *) sa;
+
+                return mptcpd_murmur_hash3(sa6->sin6_addr.s6_addr,
+                                           sizeof(sa6->sin6_addr.s6_addr),
+                                           key->seed);
+        }
+}
+
 static int compare_sockaddr_in(struct sockaddr const *lsa,
                         struct sockaddr const *rsa)
 {
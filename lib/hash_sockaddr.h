@@ -45,6 +45,18 @@ struct mptcpd_hash_sockaddr_key
         uint32_t seed;
 };
 
+/**
+ * @brief Generate a hash value based on IP address alone.
+ *
+ * @param[in] p @c struct @c mptcpd_hash_sockaddr_key instance
+ *              containing the IP address to be hashed.
+ *
+ * @return The hash value.
+ *
+ * @note Ports are not hashed.
+ */
+unsigned int mptcpd_hash_sockaddr(void const *p);
+
 /**
  * @brief Compare hash map keys based on IP address alone.
  *
@@ -21,7 +21,6 @@
 
 #include <ell/ell.h>
 
-#include <mptcpd/private/murmur_hash.h>
 #include <mptcpd/private/id_manager.h>
 #include <mptcpd/id_manager.h>
 
@@ -82,59 +81,6 @@ static bool mptcpd_hashmap_replace(struct l_hashmap *map,
 
 // ----------------------------------------------------------------------
 
-static inline
-unsigned int hash_sockaddr_in(struct sockaddr_in const *sa,
-                                      uint32_t seed)
-{
-        return mptcpd_murmur_hash3(&sa->sin_addr.s_addr,
-                                   sizeof(sa->sin_addr.s_addr),
-                                   seed);
-}
-
-static inline
-unsigned int hash_sockaddr_in6(struct sockaddr_in6 const *sa,
-                               uint32_t seed)
-{
-        /**
-         * @todo Should we include other sockaddr_in6 members, e.g.
-         *       sin6_flowinfo and sin6_scope_id, as part of the key?
-         */
-
-        return mptcpd_murmur_hash3(sa->sin6_addr.s6_addr,
-                                   sizeof(sa->sin6_addr.s6_addr),
-                                   seed);
-}
-
-/**
- * @brief Generate a hash value based on IP address alone.
- *
- * @param[in] p @c struct @c mptcpd_hash_sockaddr_key instance
- *              containing the IP address to be hashed.
- *
- * @return The hash value.
- */
-static unsigned int hash_sockaddr(void const *p)
-{
-        struct mptcpd_hash_sockaddr_key const *const key = p;
-        struct sockaddr const *const sa = key->sa;
-
-        assert(sa->sa_family == AF_INET || sa->sa_family == AF_INET6);
-
-        if (sa->sa_family == AF_INET) {
-                struct sockaddr_in const *sa4 =
-                        (struct sockaddr_in const *) sa;
-
-                return hash_sockaddr_in(sa4, key->seed);
-        } else {
-                struct sockaddr_in6 const *sa6 =
-                        (struct sockaddr_in6 const *) sa;
-
-                return hash_sockaddr_in6(sa6, key->seed);
-        }
-}
-
-// ----------------------------------------------------------------------
-
 struct mptcpd_idm *mptcpd_idm_create(void)
 {
         struct mptcpd_idm *idm = l_new(struct mptcpd_idm, 1);
@@ -145,7 +91,7 @@ struct mptcpd_idm *mptcpd_idm_create(void)
         idm->map = l_hashmap_new();
         idm->seed = l_getrandom_uint32();
 
-        if (!l_hashmap_set_hash_function(idm->map, hash_sockaddr)
+        if (!l_hashmap_set_hash_function(idm->map, mptcpd_hash_sockaddr)
             || !l_hashmap_set_compare_function(idm->map,
                                                mptcpd_hash_sockaddr_compare)
             || !l_hashmap_set_key_copy_function(idm->map,
@@ -200,6 +146,63 @@ bool mptcpd_idm_map_id(struct mptcpd_idm *idm,
         return true;
 }
 
+bool mptcpd_idm_restore_id(struct mptcpd_idm *idm,
+                           struct sockaddr const *sa,
+                           mptcpd_aid_t id)
+{
+        if (idm == NULL || sa == NULL)
+                return false;
+
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = sa, .seed = idm->seed
+        };
+
+        if (l_uintset_contains(idm->ids, id)
+            || l_hashmap_lookup(idm->map, &key) != NULL)
+                return false;
+
+        return mptcpd_idm_map_id(idm, sa, id);
+}
+
+/**
+ * @struct idm_foreach_info
+ *
+ * @brief Convenience structure to bundle ID iteration information.
+ */
+struct idm_foreach_info
+{
+        /// Function called for each mapping.
+        mptcpd_idm_callback const callback;
+
+        /// Data passed to @c callback.
+        void *const user_data;
+};
+
+static void idm_foreach_entry(void const *key,
+                              void *value,
+                              void *user_data)
+{
+        struct mptcpd_hash_sockaddr_key const *const k = key;
+        struct idm_foreach_info const *const info = user_data;
+
+        info->callback(k->sa, L_PTR_TO_UINT(value), info->user_data);
+}
+
+void mptcpd_idm_foreach(struct mptcpd_idm *idm,
+                        mptcpd_idm_callback callback,
+                        void *user_data)
+{
+        if (idm == NULL || callback == NULL)
+                return;
+
+        struct idm_foreach_info info = {
+                .callback  = callback,
+                .user_data = user_data
+        };
+
+        l_hashmap_foreach(idm->map, idm_foreach_entry, &info);
+}
+
 mptcpd_aid_t mptcpd_idm_get_id(struct mptcpd_idm *idm,
                                struct sockaddr const *sa)
 {
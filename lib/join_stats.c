@@ -0,0 +1,249 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file join_stats.c
+ *
+ * @brief MPTCP subflow join success statistics.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/murmur_hash.h>
+#include <mptcpd/private/join_stats.h>
+#include <mptcpd/join_stats.h>
+
+
+/**
+ * @brief Number of paths tracked.
+ *
+ * Must be a power of two.  Paths that hash to the same slot replace
+ * each other, which at worst causes a known-bad path to be tried
+ * again.
+ */
+#define JSTATS_SLOTS 1024
+
+/// Counter increment for a single join outcome.
+#define JSTATS_ONE 16
+
+/// Minimum number of recent failed joins before skipping a path.
+#define JSTATS_MIN_FAILURES 3
+
+/**
+ * @brief Success to failure ratio below which a path is skipped.
+ *
+ * A path is skipped if fewer than one in @c JSTATS_SUCCESS_RATIO
+ * joins succeed.
+ */
+#define JSTATS_SUCCESS_RATIO 5
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct jstats_key
+ *
+ * @brief Path identifier: local interface and remote prefix.
+ */
+struct jstats_key
+{
+        /// Network interface index of the local address.
+        int32_t index;
+
+        /// Remote address family, or zero for an unused slot.
+        uint8_t family;
+
+        /// Remote IPv4 /24 or IPv6 /64 prefix, zero padded.
+        uint8_t prefix[8];
+};
+
+/**
+ * @struct jstats_entry
+ *
+ * @brief Decaying join outcome counters of a path.
+ */
+struct jstats_entry
+{
+        /// Path identifier.
+        struct jstats_key key;
+
+        /// Decayed successful joins, in @c JSTATS_ONE units.
+        uint16_t success;
+
+        /// Decayed failed joins, in @c JSTATS_ONE units.
+        uint16_t failure;
+
+        /// Monotonic time (milliseconds) of the last decay.
+        uint64_t stamp;
+};
+
+/**
+ * @struct mptcpd_jstats
+ *
+ * @brief Internal mptcpd subflow join statistics data.
+ */
+struct mptcpd_jstats
+{
+        /// Direct-mapped table of tracked paths.
+        struct jstats_entry entries[JSTATS_SLOTS];
+
+        /// Counter half-life in milliseconds.
+        uint64_t half_life;
+
+        /// MurmurHash3 seed value.
+        uint32_t seed;
+};
+
+// ----------------------------------------------------------------------
+
+static bool jstats_init_key(struct jstats_key *key,
+                            int index,
+                            struct sockaddr const *raddr)
+{
+        memset(key, 0, sizeof(*key));
+
+        key->index  = index;
+        key->family = raddr->sa_family;
+
+        if (raddr->sa_family == AF_INET) {
+                struct sockaddr_in const *const sa =
+                        (struct sockaddr_in const *) raddr;
+
+                // /24 prefix.
+                memcpy(key->prefix, &sa->sin_addr.s_addr, 3);
+        } else if (raddr->sa_family == AF_INET6) {
+                struct sockaddr_in6 const *const sa =
+                        (struct sockaddr_in6 const *) raddr;
+
+                // /64 prefix.
+                memcpy(key->prefix, sa->sin6_addr.s6_addr, 8);
+        } else {
+                return false;
+        }
+
+        return true;
+}
+
+static struct jstats_entry *jstats_slot(struct mptcpd_jstats *js,
+                                        struct jstats_key const *key)
+{
+        unsigned int const hash =
+                mptcpd_murmur_hash3(key, sizeof(*key), js->seed);
+
+        return &js->entries[hash & (JSTATS_SLOTS - 1)];
+}
+
+static void jstats_decay(struct mptcpd_jstats const *js,
+                         struct jstats_entry *e,
+                         uint64_t now)
+{
+        uint64_t const halvings = (now - e->stamp) / js->half_life;
+
+        if (halvings == 0)
+                return;
+
+        if (halvings >= 16) {
+                e->success = 0;
+                e->failure = 0;
+                e->stamp   = now;
+        } else {
+                e->success >>= halvings;
+                e->failure >>= halvings;
+                e->stamp   += halvings * js->half_life;
+        }
+}
+
+static uint64_t jstats_now(void)
+{
+        return l_time_now() / L_USEC_PER_MSEC;
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_jstats *mptcpd_jstats_create(unsigned int half_life)
+{
+        if (half_life == 0)
+                return NULL;
+
+        struct mptcpd_jstats *const js = l_new(struct mptcpd_jstats, 1);
+
+        js->half_life = half_life;
+        js->seed      = l_getrandom_uint32();
+
+        return js;
+}
+
+void mptcpd_jstats_destroy(struct mptcpd_jstats *js)
+{
+        l_free(js);
+}
+
+void mptcpd_jstats_record(struct mptcpd_jstats *js,
+                          int index,
+                          struct sockaddr const *raddr,
+                          bool established)
+{
+        struct jstats_key key;
+
+        if (js == NULL
+            || raddr == NULL
+            || !jstats_init_key(&key, index, raddr))
+                return;
+
+        struct jstats_entry *const e = jstats_slot(js, &key);
+        uint64_t const now = jstats_now();
+
+        if (memcmp(&e->key, &key, sizeof(key)) != 0) {
+                // Unused slot, or replace another path.
+                memset(e, 0, sizeof(*e));
+                memcpy(&e->key, &key, sizeof(key));  // Including padding.
+                e->stamp = now;
+        } else {
+                jstats_decay(js, e, now);
+        }
+
+        uint16_t *const counter =
+                established ? &e->success : &e->failure;
+
+        if (*counter <= UINT16_MAX - JSTATS_ONE)
+                *counter += JSTATS_ONE;
+}
+
+bool mptcpd_jstats_should_try_subflow(struct mptcpd_jstats *js,
+                                      int index,
+                                      struct sockaddr const *raddr)
+{
+        struct jstats_key key;
+
+        if (js == NULL
+            || raddr == NULL
+            || !jstats_init_key(&key, index, raddr))
+                return true;
+
+        struct jstats_entry *const e = jstats_slot(js, &key);
+
+        if (memcmp(&e->key, &key, sizeof(key)) != 0)
+                return true;  // Unknown path.
+
+        jstats_decay(js, e, jstats_now());
+
+        uint32_t const success = e->success;
+        uint32_t const total   = success + e->failure;
+
+        return e->failure < JSTATS_MIN_FAILURES * JSTATS_ONE
+                || success * JSTATS_SUCCESS_RATIO >= total;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -46,6 +46,9 @@ struct mptcpd_lm
 
         /// MurmurHash3 seed value.
         uint32_t seed;
+
+        /// Number of restored listeners not claimed by a plugin yet.
+        unsigned int unclaimed;
 };
 
 // ----------------------------------------------------------------------
@@ -64,84 +67,14 @@ struct lm_value
          * @brief Listener reference count.
          *
          * Mptcpd listeners are reference counted to allow sharing.
+         * Listeners restored from a previous mptcpd run have a zero
+         * reference count until claimed.
          */
         int refcnt;
 };
 
 // ----------------------------------------------------------------------
 
-/**
- * @brief Bundle IPv4 address and port as a hash key.
- *
- * A @c padding member is added to allow the padding bytes to be
- * initialized to zero in a designated initializer, e.g.:
- * @code
- * struct key_in key = {
- *     .addr = 0xC0000202,
- *     .port = 0x4321
- * };
- * The goal is to avoid hashing uninitialized bytes in the hash key.
- * @endcode
- */
-struct key_in
-{
-        in_addr_t const addr;
-        in_port_t const port;
-        uint16_t  const padding;    // Initialize to zero.
-};
-
-/**
- * @brief Bundle IPv6 address and port as a hash key.
- *
- * A @c padding member is added to allow the padding bytes to be
- * initialized to zero in a designated initializer, e.g.:
- * @code
- * struct key_in6 key = {
- *     .addr = { .s6_addr = { [0]  = 0x20,
- *                            [1]  = 0x01,
- *                            [2]  = 0x0D,
- *                            [3]  = 0xB8,
- *                            [14] = 0x01,
- *                            [15] = 0x02 } },
- *     .port = 0x4321
- * };
- * The goal is to avoid hashing uninitialized bytes in the hash key.
- * @endcode
- */
-struct key_in6
-{
-        struct in6_addr addr;
-        in_port_t const port;
-        uint16_t  const padding;  // Initialize to zero.
-};
-
-static unsigned int hash_sockaddr_in(struct sockaddr_in const *sa,
-                                     uint32_t seed)
-{
-        struct key_in const key = {
-                .addr = sa->sin_addr.s_addr,
-                .port = sa->sin_port
-        };
-
-        return mptcpd_murmur_hash3(&key, sizeof(key), seed);
-}
-
-static unsigned int hash_sockaddr_in6(struct sockaddr_in6 const *sa,
-                                      uint32_t seed)
-{
-        /**
-         * @todo Should we include other sockaddr_in6 members, e.g.
-         *       sin6_flowinfo and sin6_scope_id, as part of the key?
-         */
-        struct key_in6 key = { .port = sa->sin6_port };
-
-        memcpy(key.addr.s6_addr,
-               sa->sin6_addr.s6_addr,
-               sizeof(key.addr.s6_addr));
-
-        return mptcpd_murmur_hash3(&key, sizeof(key), seed);
-}
-
 /**
  * @brief Generate a hash value based on IP address and port.
  *
@@ -155,19 +88,15 @@ static unsigned int hash_sockaddr(void const *p)
         struct mptcpd_hash_sockaddr_key const *const key = p;
         struct sockaddr const *const sa = key->sa;
 
-        assert(sa->sa_family == AF_INET || sa->sa_family == AF_INET6);
-
-        if (sa->sa_family == AF_INET) {
-                struct sockaddr_in const *sa4 =
-                        (struct sockaddr_in const *) sa;
-
-                return hash_sockaddr_in(sa4, key->seed);
-        } else {
-                struct sockaddr_in6 const *sa6 =
-                        (struct sockaddr_in6 const *) sa;
+        in_port_t const port =
+                sa->sa_family == AF_INET
+                ? ((struct sockaddr_in const *) sa)->sin_port
+                : ((struct sockaddr_in6 const *) sa)->sin6_port;
 
-                return hash_sockaddr_in6(sa6, key->seed);
-        }
+        // Mix the port into the shared IP address hash.
+        return mptcpd_murmur_hash3(&port,
+                                   sizeof(port),
+                                   mptcpd_hash_sockaddr(key));
 }
 
 static inline int compare_port(in_port_t lhs, in_port_t rhs)
@@ -230,6 +159,13 @@ static socklen_t get_addr_size(struct sockaddr const *sa)
                 : sizeof(struct sockaddr_in6);
 }
 
+static in_port_t *get_port(struct sockaddr *sa)
+{
+        return sa->sa_family == AF_INET
+                ? &((struct sockaddr_in *) sa)->sin_port
+                : &((struct sockaddr_in6 *) sa)->sin6_port;
+}
+
 /**
  * @brief Is IP address not bound to a specific network interface?
  *
@@ -313,7 +249,9 @@ static void close_listener(void *value)
         l_free(data);
 }
 
-static int make_listener(struct mptcpd_lm* lm, struct sockaddr *sa)
+static int make_listener(struct mptcpd_lm* lm,
+                         struct sockaddr *sa,
+                         int refcnt)
 {
         int const fd = open_listener(sa);
         if (fd < 0)
@@ -355,11 +293,115 @@ static int make_listener(struct mptcpd_lm* lm, struct sockaddr *sa)
         }
 
         data->fd     = fd;
-        data->refcnt = 1;
+        data->refcnt = refcnt;
 
         return 0;
 }
 
+/**
+ * @struct lm_claim_info
+ *
+ * @brief Convenience structure to bundle listener claim information.
+ */
+struct lm_claim_info
+{
+        /// Local address, with a zero port, to be claimed.
+        struct mptcpd_hash_sockaddr_key const *const key;
+
+        /// Unclaimed listener bound to the local address, if any.
+        struct lm_value *data;
+
+        /// Port the unclaimed listener is bound to.
+        in_port_t port;
+};
+
+static void find_unclaimed(void const *key, void *value, void *user_data)
+{
+        struct mptcpd_hash_sockaddr_key const *const k = key;
+        struct lm_value *const data = value;
+        struct lm_claim_info *const info = user_data;
+
+        // Ports are ignored by mptcpd_hash_sockaddr_compare().
+        if (info->data != NULL
+            || data->refcnt != 0
+            || mptcpd_hash_sockaddr_compare(k, info->key) != 0)
+                return;
+
+        info->data = data;
+        info->port = *get_port((struct sockaddr *) k->sa);
+}
+
+/**
+ * @brief Claim a restored listener bound to the given address.
+ *
+ * Reusing the port of a restored listener allows a local address to
+ * be announced with the same port as before mptcpd was restarted.
+ *
+ * @return @c true if a restored listener was claimed, in which case
+ *         its port is assigned to @a sa, and @c false otherwise.
+ */
+static bool claim_restored(struct mptcpd_lm *lm, struct sockaddr *sa)
+{
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = sa, .seed = lm->seed
+        };
+
+        struct lm_claim_info info = { .key = &key };
+
+        l_hashmap_foreach(lm->map, find_unclaimed, &info);
+
+        if (info.data == NULL)
+                return false;
+
+        info.data->refcnt = 1;
+        --lm->unclaimed;
+
+        *get_port(sa) = info.port;
+
+        return true;
+}
+
+static bool remove_unclaimed(void const *key, void *value, void *user_data)
+{
+        (void) key;
+
+        struct lm_value *const data = value;
+        unsigned int *const released = user_data;
+
+        if (data->refcnt != 0)
+                return false;
+
+        close_listener(data);
+        ++*released;
+
+        return true;
+}
+
+/**
+ * @struct lm_foreach_info
+ *
+ * @brief Convenience structure to bundle listener iteration
+ *        information.
+ */
+struct lm_foreach_info
+{
+        /// Function called for each listener.
+        mptcpd_lm_callback const callback;
+
+        /// Data passed to @c callback.
+        void *const user_data;
+};
+
+static void lm_foreach_entry(void const *key, void *value, void *user_data)
+{
+        struct mptcpd_hash_sockaddr_key const *const k = key;
+        struct lm_value const *const data = value;
+        struct lm_foreach_info const *const info = user_data;
+
+        if (data->refcnt != 0)
+                info->callback(k->sa, info->user_data);
+}
+
 // ----------------------------------------------------------------------
 
 struct mptcpd_lm *mptcpd_lm_create(void)
@@ -415,15 +457,22 @@ int mptcpd_lm_listen(struct mptcpd_lm *lm, struct sockaddr *sa)
           Increment the reference count.
         */
         if (data != NULL) {
-                data->refcnt++;
+                if (data->refcnt++ == 0)
+                        --lm->unclaimed;
+
                 return 0;
         }
 
+        // Prefer the port of a listener from a previous mptcpd run.
+        if (lm->unclaimed != 0 && *get_port(sa) == 0
+            && claim_restored(lm, sa))
+                return 0;
+
         /*
           The sockaddr doesn't exist in the map.  Make a new
           listener.
         */
-        return make_listener(lm, sa);
+        return make_listener(lm, sa, 1);
 }
 
 int mptcpd_lm_close(struct mptcpd_lm *lm, struct sockaddr const *sa)
@@ -438,7 +487,7 @@ int mptcpd_lm_close(struct mptcpd_lm *lm, struct sockaddr const *sa)
         struct lm_value *const data = l_hashmap_lookup(lm->map, &key);
 
         // No listener associated with the given address.
-        if (data == NULL)
+        if (data == NULL || data->refcnt == 0)
                 return EINVAL;
 
         /*
@@ -454,6 +503,65 @@ int mptcpd_lm_close(struct mptcpd_lm *lm, struct sockaddr const *sa)
         return 0;
 }
 
+int mptcpd_lm_restore(struct mptcpd_lm *lm, struct sockaddr const *sa)
+{
+        if (lm == NULL || sa == NULL)
+                return EINVAL;
+
+        if ((sa->sa_family != AF_INET && sa->sa_family != AF_INET6)
+            || is_unbound_address(sa))
+                return EINVAL;
+
+        struct sockaddr_storage addr;
+        memcpy(&addr, sa, get_addr_size(sa));
+
+        if (*get_port((struct sockaddr *) &addr) == 0)
+                return EINVAL;
+
+        struct mptcpd_hash_sockaddr_key const key = {
+                .sa = (struct sockaddr *) &addr, .seed = lm->seed
+        };
+
+        if (l_hashmap_lookup(lm->map, &key) != NULL)
+                return EEXIST;
+
+        int const error = make_listener(lm, (struct sockaddr *) &addr, 0);
+
+        if (error == 0)
+                ++lm->unclaimed;
+
+        return error;
+}
+
+unsigned int mptcpd_lm_release_restored(struct mptcpd_lm *lm)
+{
+        if (lm == NULL || lm->unclaimed == 0)
+                return 0;
+
+        unsigned int released = 0;
+
+        (void) l_hashmap_foreach_remove(lm->map, remove_unclaimed, &released);
+
+        lm->unclaimed = 0;
+
+        return released;
+}
+
+void mptcpd_lm_foreach(struct mptcpd_lm *lm,
+                       mptcpd_lm_callback callback,
+                       void *user_data)
+{
+        if (lm == NULL || callback == NULL)
+                return;
+
+        struct lm_foreach_info info = {
+                .callback  = callback,
+                .user_data = user_data
+        };
+
+        l_hashmap_foreach(lm->map, lm_foreach_entry, &info);
+}
+
 
 /*
   Local Variables:
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file loop_monitor.c
+ *
+ * @brief Event loop latency monitor.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <inttypes.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/loop_monitor.h>
+
+
+/**
+ * @brief Shortest lag probe interval in milliseconds.
+ *
+ * The lag probe runs once per stall threshold, but no more often
+ * than this to keep the monitor lightweight.
+ */
+#define LOOPMON_MIN_INTERVAL_MS 10
+
+/**
+ * @struct loopmon_handler
+ *
+ * @brief Event loop handler being run.
+ */
+struct loopmon_handler
+{
+        /// Event source.
+        char const *source;
+
+        /// Source specific event type.
+        unsigned int type;
+
+        /// Time the handler started running.
+        uint64_t start;
+};
+
+/**
+ * @struct loopmon_info
+ *
+ * @brief Event loop latency monitor state.
+ */
+struct loopmon_info
+{
+        /// Lag probe timeout, @c NULL while the monitor is stopped.
+        struct l_timeout *probe;
+
+        /// Lag probe interval in milliseconds.
+        unsigned int interval;
+
+        /// Stall threshold in microseconds.
+        uint64_t threshold;
+
+        /// Time the lag probe is expected to be dispatched.
+        uint64_t expected;
+
+        /// Outermost handler being run.
+        struct loopmon_handler handler;
+
+        /// Handler nesting depth.
+        unsigned int depth;
+
+        /// A stall was reported since the last lag probe.
+        bool stall_reported;
+
+        /// Statistics.
+        struct mptcpd_loopmon_stats stats;
+};
+
+static struct loopmon_info _loopmon;
+
+// ----------------------------------------------------------------------
+
+static unsigned int get_bucket(uint64_t usec)
+{
+        unsigned int bucket = 0;
+
+        for (; usec != 0 && bucket < MPTCPD_LOOPMON_BUCKETS - 1; usec >>= 1)
+                ++bucket;
+
+        return bucket;
+}
+
+static void record(uint64_t *histogram, uint64_t *max, uint64_t usec)
+{
+        ++histogram[get_bucket(usec)];
+
+        if (usec > *max)
+                *max = usec;
+}
+
+/**
+ * @brief Upper bound of a histogram percentile in microseconds.
+ *
+ * @return Upper bound of the bucket containing the @a percent
+ *         percentile, or @c 0 if the histogram is empty.
+ */
+static uint64_t get_percentile(uint64_t const *histogram,
+                               unsigned int percent)
+{
+        uint64_t total = 0;
+
+        for (unsigned int i = 0; i < MPTCPD_LOOPMON_BUCKETS; ++i)
+                total += histogram[i];
+
+        if (total == 0)
+                return 0;
+
+        uint64_t const rank = (total * percent + 99) / 100;
+        uint64_t count = 0;
+        unsigned int i = 0;
+
+        for (; i < MPTCPD_LOOPMON_BUCKETS - 1; ++i) {
+                count += histogram[i];
+
+                if (count >= rank)
+                        break;
+        }
+
+        return UINT64_C(1) << i;
+}
+
+static void probe_arm(void)
+{
+        _loopmon.expected =
+                l_time_now() + _loopmon.interval * L_USEC_PER_MSEC;
+
+        l_timeout_modify_ms(_loopmon.probe, _loopmon.interval);
+}
+
+static void probe_lag(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        uint64_t const now = l_time_now();
+        uint64_t const lag =
+                now > _loopmon.expected ? now - _loopmon.expected : 0;
+
+        record(_loopmon.stats.lag, &_loopmon.stats.max_lag, lag);
+
+        /*
+          Stalls caused by monitored handlers were already reported
+          with the handler responsible.
+        */
+        if (lag >= _loopmon.threshold && !_loopmon.stall_reported) {
+                ++_loopmon.stats.stalls;
+
+                uint64_t const msec = lag / L_USEC_PER_MSEC;
+
+                l_warn("Event loop stalled for %" PRIu64 " ms outside "
+                       "of monitored handlers.",
+                       msec);
+        }
+
+        _loopmon.stall_reported = false;
+
+        probe_arm();
+}
+
+// ----------------------------------------------------------------------
+
+bool mptcpd_loopmon_start(unsigned int threshold)
+{
+        if (threshold == 0) {
+                mptcpd_loopmon_stop();
+                return true;
+        }
+
+        _loopmon.threshold = threshold * L_USEC_PER_MSEC;
+        _loopmon.interval  = threshold < LOOPMON_MIN_INTERVAL_MS
+                ? LOOPMON_MIN_INTERVAL_MS
+                : threshold;
+
+        _loopmon.depth          = 0;
+        _loopmon.stall_reported = false;
+
+        if (_loopmon.probe == NULL) {
+                _loopmon.probe = l_timeout_create_ms(_loopmon.interval,
+                                                     probe_lag,
+                                                     NULL,
+                                                     NULL);
+
+                if (_loopmon.probe == NULL) {
+                        l_error("Unable to create event loop lag probe.");
+                        return false;
+                }
+        }
+
+        probe_arm();
+
+        return true;
+}
+
+void mptcpd_loopmon_stop(void)
+{
+        l_timeout_remove(_loopmon.probe);
+        _loopmon.probe = NULL;
+}
+
+void mptcpd_loopmon_enter(char const *source, unsigned int type)
+{
+        if (_loopmon.probe == NULL || _loopmon.depth++ != 0)
+                return;
+
+        _loopmon.handler.source = source;
+        _loopmon.handler.type   = type;
+        _loopmon.handler.start  = l_time_now();
+}
+
+void mptcpd_loopmon_leave(void)
+{
+        // The monitor may have been (re)started by the handler.
+        if (_loopmon.probe == NULL
+            || _loopmon.depth == 0
+            || --_loopmon.depth != 0)
+                return;
+
+        uint64_t const work =
+                l_time_diff(_loopmon.handler.start, l_time_now());
+
+        record(_loopmon.stats.work, &_loopmon.stats.max_work, work);
+
+        if (work >= _loopmon.threshold) {
+                ++_loopmon.stats.stalls;
+                _loopmon.stall_reported = true;
+
+                uint64_t const msec = work / L_USEC_PER_MSEC;
+
+                l_warn("Event loop stalled for %" PRIu64 " ms in %s "
+                       "handler (type %u).",
+                       msec,
+                       _loopmon.handler.source,
+                       _loopmon.handler.type);
+        }
+}
+
+struct mptcpd_loopmon_stats const *mptcpd_loopmon_get_stats(void)
+{
+        return &_loopmon.stats;
+}
+
+void mptcpd_loopmon_log_stats(void)
+{
+        struct mptcpd_loopmon_stats const *const s = &_loopmon.stats;
+
+        l_info("Event loop lag: p50 < %" PRIu64 " us, "
+               "p99 < %" PRIu64 " us, max %" PRIu64 " us",
+               get_percentile(s->lag, 50),
+               get_percentile(s->lag, 99),
+               s->max_lag);
+
+        l_info("Event loop handlers: p50 < %" PRIu64 " us, "
+               "p99 < %" PRIu64 " us, max %" PRIu64 " us",
+               get_percentile(s->work, 50),
+               get_percentile(s->work, 99),
+               s->max_work);
+
+        l_info("Event loop stalls: %" PRIu64, s->stalls);
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
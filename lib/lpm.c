@@ -0,0 +1,418 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file lpm.c
+ *
+ * @brief IP address longest prefix match tables.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/lpm.h>
+
+
+/// Number of address bits consumed per trie level.
+#define LPM_STRIDE 8
+
+/// Number of entries in a trie node.
+#define LPM_NODE_SIZE (1U << LPM_STRIDE)
+
+/**
+ * @brief Trie entry flag denoting a child node index.
+ *
+ * Other non-zero trie entries are one-based value indices, and zero
+ * entries match no prefix.
+ */
+#define LPM_CHILD 0x80000000U
+
+/// Maximum prefix length in bytes.
+#define LPM_ADDR_MAX 16
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct lpm_prefix
+ *
+ * @brief IP address prefix and its value.
+ */
+struct lpm_prefix
+{
+        /// Address prefix, with bits beyond @c len cleared.
+        uint8_t addr[LPM_ADDR_MAX];
+
+        /// Address family.
+        sa_family_t family;
+
+        /// Prefix length in bits.
+        uint8_t len;
+
+        /// User supplied value.
+        void *value;
+};
+
+/**
+ * @struct mptcpd_lpm
+ *
+ * @brief Mutable IP address prefix table.
+ *
+ * Prefixes are kept in a flat array since the table is only scanned
+ * when compiling snapshots.
+ */
+struct mptcpd_lpm
+{
+        /// IP address prefixes.
+        struct lpm_prefix *prefixes;
+
+        /// Number of IP address prefixes.
+        size_t count;
+
+        /// Number of allocated IP address prefixes.
+        size_t capacity;
+};
+
+/**
+ * @struct mptcpd_lpm_snapshot
+ *
+ * @brief Read-only multibit trie.
+ *
+ * All trie nodes live in a single array.  The IPv4 and IPv6 root
+ * nodes are the first and second nodes, respectively.
+ */
+struct mptcpd_lpm_snapshot
+{
+        /// Trie nodes, @c LPM_NODE_SIZE entries each.
+        uint32_t *nodes;
+
+        /// Values, indexed by trie entries.
+        void **values;
+};
+
+/**
+ * @struct lpm_builder
+ *
+ * @brief Snapshot under construction.
+ */
+struct lpm_builder
+{
+        /// Trie nodes.
+        uint32_t *nodes;
+
+        /// Number of trie nodes in use.
+        uint32_t count;
+
+        /// Number of allocated trie nodes.
+        uint32_t capacity;
+};
+
+// ----------------------------------------------------------------------
+
+/**
+ * @brief Get the address bytes of an IPv4 or IPv6 address.
+ *
+ * @param[in]  sa  IP address.
+ * @param[out] len Address length in bytes.
+ *
+ * @return Pointer to the address bytes in network byte order, or
+ *         @c NULL for an unsupported address family.
+ */
+static uint8_t const *get_addr(struct sockaddr const *sa, size_t *len)
+{
+        if (sa->sa_family == AF_INET) {
+                *len = sizeof(struct in_addr);
+
+                return (uint8_t const *)
+                        &((struct sockaddr_in const *) sa)->sin_addr;
+        } else if (sa->sa_family == AF_INET6) {
+                *len = sizeof(struct in6_addr);
+
+                return ((struct sockaddr_in6 const *) sa)->sin6_addr.s6_addr;
+        }
+
+        return NULL;
+}
+
+static bool prefix_init(struct lpm_prefix *p,
+                        struct sockaddr const *prefix,
+                        uint8_t len)
+{
+        size_t addr_len = 0;
+        uint8_t const *const addr =
+                prefix == NULL ? NULL : get_addr(prefix, &addr_len);
+
+        if (addr == NULL || len > addr_len * 8)
+                return false;
+
+        memset(p, 0, sizeof(*p));
+
+        p->family = prefix->sa_family;
+        p->len    = len;
+
+        size_t const full = len / 8;
+
+        memcpy(p->addr, addr, full);
+
+        if (len % 8 != 0)
+                p->addr[full] = addr[full] & (uint8_t) (0xFF << (8 - len % 8));
+
+        return true;
+}
+
+static struct lpm_prefix *find_prefix(struct mptcpd_lpm const *lpm,
+                                      struct lpm_prefix const *p)
+{
+        for (size_t i = 0; i < lpm->count; ++i) {
+                struct lpm_prefix *const q = &lpm->prefixes[i];
+
+                if (q->family == p->family
+                    && q->len == p->len
+                    && memcmp(q->addr, p->addr, sizeof(q->addr)) == 0)
+                        return q;
+        }
+
+        return NULL;
+}
+
+static int prefix_len_compare(void const *a, void const *b)
+{
+        struct lpm_prefix const *const *const lhs = a;
+        struct lpm_prefix const *const *const rhs = b;
+
+        return (int) (*lhs)->len - (int) (*rhs)->len;
+}
+
+static uint32_t builder_new_node(struct lpm_builder *b, uint32_t fill)
+{
+        if (b->count == b->capacity) {
+                b->capacity *= 2;
+                b->nodes = l_realloc(b->nodes,
+                                     (size_t) b->capacity
+                                     * LPM_NODE_SIZE
+                                     * sizeof(*b->nodes));
+        }
+
+        uint32_t const node = b->count++;
+        uint32_t *const entries = &b->nodes[node * LPM_NODE_SIZE];
+
+        for (unsigned int i = 0; i < LPM_NODE_SIZE; ++i)
+                entries[i] = fill;
+
+        return node;
+}
+
+/**
+ * @brief Add a prefix to the trie under construction.
+ *
+ * Prefixes must be added in order of increasing length so that
+ * longer prefixes override the entries expanded from shorter ones.
+ */
+static void builder_add(struct lpm_builder *b,
+                        struct lpm_prefix const *p,
+                        uint32_t value)
+{
+        uint32_t node = p->family == AF_INET ? 0 : 1;
+        unsigned int level = 0;
+
+        // Walk down to the level where the prefix ends.
+        while (p->len > (level + 1) * LPM_STRIDE) {
+                uint32_t const slot =
+                        node * LPM_NODE_SIZE + p->addr[level];
+                uint32_t const entry = b->nodes[slot];
+
+                if (entry & LPM_CHILD) {
+                        node = entry & ~LPM_CHILD;
+                } else {
+                        /*
+                          Push the value of the shorter prefix
+                          covering this slot down to the new node.
+                        */
+                        node = builder_new_node(b, entry);
+                        b->nodes[slot] = node | LPM_CHILD;
+                }
+
+                ++level;
+        }
+
+        // Expand the prefix to all entries it covers in this node.
+        unsigned int const bits = p->len - level * LPM_STRIDE;
+        unsigned int const first =
+                bits == 0 ? 0 : p->addr[level] & (0xFFU << (8 - bits));
+        unsigned int const count = 1U << (LPM_STRIDE - bits);
+
+        uint32_t *const entries = &b->nodes[node * LPM_NODE_SIZE];
+
+        for (unsigned int i = first; i < first + count; ++i)
+                entries[i] = value;
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_lpm *mptcpd_lpm_create(void)
+{
+        return l_new(struct mptcpd_lpm, 1);
+}
+
+void mptcpd_lpm_destroy(struct mptcpd_lpm *lpm)
+{
+        if (lpm == NULL)
+                return;
+
+        l_free(lpm->prefixes);
+        l_free(lpm);
+}
+
+bool mptcpd_lpm_insert(struct mptcpd_lpm *lpm,
+                       struct sockaddr const *prefix,
+                       uint8_t len,
+                       void *value)
+{
+        struct lpm_prefix p;
+
+        if (lpm == NULL || value == NULL || !prefix_init(&p, prefix, len))
+                return false;
+
+        struct lpm_prefix *const q = find_prefix(lpm, &p);
+
+        if (q != NULL) {
+                q->value = value;
+
+                return true;
+        }
+
+        if (lpm->count == lpm->capacity) {
+                lpm->capacity = lpm->capacity == 0 ? 8 : lpm->capacity * 2;
+                lpm->prefixes = l_realloc(lpm->prefixes,
+                                          lpm->capacity
+                                          * sizeof(*lpm->prefixes));
+        }
+
+        p.value = value;
+        lpm->prefixes[lpm->count++] = p;
+
+        return true;
+}
+
+void *mptcpd_lpm_remove(struct mptcpd_lpm *lpm,
+                        struct sockaddr const *prefix,
+                        uint8_t len)
+{
+        struct lpm_prefix p;
+
+        if (lpm == NULL || !prefix_init(&p, prefix, len))
+                return NULL;
+
+        struct lpm_prefix *const q = find_prefix(lpm, &p);
+
+        if (q == NULL)
+                return NULL;
+
+        void *const value = q->value;
+
+        // Order of prefixes is irrelevant.
+        *q = lpm->prefixes[--lpm->count];
+
+        return value;
+}
+
+struct mptcpd_lpm_snapshot *mptcpd_lpm_snapshot(
+        struct mptcpd_lpm const *lpm)
+{
+        if (lpm == NULL)
+                return NULL;
+
+        struct lpm_prefix const **const sorted =
+                l_new(struct lpm_prefix const *, lpm->count + 1);
+
+        for (size_t i = 0; i < lpm->count; ++i)
+                sorted[i] = &lpm->prefixes[i];
+
+        qsort(sorted, lpm->count, sizeof(*sorted), prefix_len_compare);
+
+        struct lpm_builder b = { .capacity = 8 };
+
+        b.nodes = l_new(uint32_t, (size_t) b.capacity * LPM_NODE_SIZE);
+
+        (void) builder_new_node(&b, 0);  // IPv4 root
+        (void) builder_new_node(&b, 0);  // IPv6 root
+
+        struct mptcpd_lpm_snapshot *const snapshot =
+                l_new(struct mptcpd_lpm_snapshot, 1);
+
+        snapshot->values = l_new(void *, lpm->count + 1);
+
+        for (size_t i = 0; i < lpm->count; ++i) {
+                snapshot->values[i] = sorted[i]->value;
+
+                // One-based value index, zero means no match.
+                builder_add(&b, sorted[i], (uint32_t) i + 1);
+        }
+
+        l_free(sorted);
+
+        // Release unused trie nodes.
+        snapshot->nodes = l_realloc(b.nodes,
+                                    (size_t) b.count
+                                    * LPM_NODE_SIZE
+                                    * sizeof(*b.nodes));
+
+        return snapshot;
+}
+
+void mptcpd_lpm_snapshot_destroy(struct mptcpd_lpm_snapshot *snapshot)
+{
+        if (snapshot == NULL)
+                return;
+
+        l_free(snapshot->nodes);
+        l_free(snapshot->values);
+        l_free(snapshot);
+}
+
+void *mptcpd_lpm_lookup(struct mptcpd_lpm_snapshot const *snapshot,
+                        struct sockaddr const *addr)
+{
+        if (snapshot == NULL || addr == NULL)
+                return NULL;
+
+        size_t len = 0;
+        uint8_t const *const bytes = get_addr(addr, &len);
+
+        if (bytes == NULL)
+                return NULL;
+
+        uint32_t node = addr->sa_family == AF_INET ? 0 : 1;
+
+        /*
+          Prefixes never extend past the last address byte, so the
+          entry for that byte is never a child node.
+        */
+        for (size_t i = 0; i < len; ++i) {
+                uint32_t const entry =
+                        snapshot->nodes[node * LPM_NODE_SIZE + bytes[i]];
+
+                if (!(entry & LPM_CHILD))
+                        return entry == 0
+                                ? NULL
+                                : snapshot->values[entry - 1];
+
+                node = entry & ~LPM_CHILD;
+        }
+
+        return NULL;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file netlink.c
+ *
+ * @brief ELL netlink related helper functions.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <ell/ell.h>
+
+#include "netlink.h"
+
+
+unsigned int mptcpd_netlink_send(struct l_netlink *netlink,
+                                 uint16_t type,
+                                 uint16_t flags,
+                                 void const *data,
+                                 uint32_t len,
+                                 l_netlink_command_func_t function,
+                                 void *user_data,
+                                 l_netlink_destroy_func_t destroy)
+{
+#ifdef HAVE_L_NETLINK_MESSAGE_NEW_SIZED
+        // ELL >= 0.68
+        struct l_netlink_message *const message =
+                l_netlink_message_new_sized(type, flags, len);
+
+        l_netlink_message_add_header(message, data, len);
+
+        return l_netlink_send(netlink,
+                              message,
+                              function,
+                              user_data,
+                              destroy);
+#else
+        // ELL < 0.68
+        return l_netlink_send(netlink,
+                              type,
+                              flags,
+                              data,
+                              len,
+                              function,
+                              user_data,
+                              destroy);
+#endif
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
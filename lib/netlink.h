@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file netlink.h
+ *
+ * @brief ELL netlink related helper functions.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_NETLINK_H
+#define MPTCPD_NETLINK_H
+
+#include <stdint.h>
+
+#include <ell/netlink.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wrap different versions of ELL @c l_netlink_send().
+ *
+ * ELL 0.68 changed the API for @c l_netlink_send().  This helper
+ * function wraps the two different function calls so that mptcpd will
+ * work with both pre- and post-0.68 @c l_netlink_send() APIs.
+ *
+ * @note This function is only used internally, and is not exported
+ *       from libmptcpd.
+ */
+unsigned int mptcpd_netlink_send(struct l_netlink *netlink,
+                                 uint16_t type,
+                                 uint16_t flags,
+                                 void const *data,
+                                 uint32_t len,
+                                 l_netlink_command_func_t function,
+                                 void *user_data,
+                                 l_netlink_destroy_func_t destroy);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // MPTCPD_NETLINK_H
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
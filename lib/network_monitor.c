@@ -27,9 +27,21 @@
 
 #include <mptcpd/private/path_manager.h>
 #include <mptcpd/private/sockaddr.h>
+#include <mptcpd/private/loop_monitor.h>
 #include <mptcpd/private/network_monitor.h>
 #include <mptcpd/network_monitor.h>
 
+#include "netlink.h"
+
+/**
+ * @brief Driver signals L1 up.
+ *
+ * Defined in <linux/if.h>, which conflicts with <net/if.h>, but not
+ * in <net/if.h> itself.
+ */
+#ifndef IFF_LOWER_UP
+# define IFF_LOWER_UP 0x10000
+#endif
 
 
 // See IETF RFC 3849: IPv6 Address Prefix Reserved for Documentation.
@@ -43,6 +55,12 @@ static struct in_addr const test_net_v4 = {
 
 // -------------------------------------------------------------------
 
+/**
+ * @brief Size of @c struct @c mptcpd_nm_ops before the
+ *        @c link_state_changed operation was added.
+ */
+#define NM_OPS_SIZE_V1 offsetof(struct mptcpd_nm_ops, link_state_changed)
+
 /**
  * @struct nm_ops_info
  *
@@ -50,8 +68,13 @@ static struct in_addr const test_net_v4 = {
  */
 struct nm_ops_info
 {
-        /// Network monitor event tracking operations.
-        struct mptcpd_nm_ops const *ops;
+        /**
+         * @brief Network monitor event tracking operations.
+         *
+         * Copy of the registered operations, with operations unknown
+         * to the caller unset.
+         */
+        struct mptcpd_nm_ops ops;
 
         /// Data passed to the network event tracking operations.
         void *user_data;
@@ -85,52 +108,16 @@ struct mptcpd_nm
 
         /// Enable/disable loopback network interface monitoring.
         bool monitor_loopback;
-};
 
-// -------------------------------------------------------------------
-//                         Helper Functions
-// -------------------------------------------------------------------
+        /// Initial network interface and address dump completed.
+        bool synced;
 
-/**
- * @brief Wrap different versions of ELL @c l_netlink_send().
- *
- * ELL 0.68 changed the API for @c l_netlink_send().  This helper
- * function wraps the two different function calls so that mptcpd will
- * work with both pre- and post-0.68 @c l_netlink_send() APIs.
- */
-static unsigned int netlink_send(struct l_netlink *netlink,
-                                 uint16_t type,
-                                 uint16_t flags,
-                                 void const *data,
-                                 uint32_t len,
-                                 l_netlink_command_func_t function,
-                                 void *user_data,
-                                 l_netlink_destroy_func_t destroy)
-{
-#ifdef HAVE_L_NETLINK_MESSAGE_NEW_SIZED
-        // ELL >= 0.68
-        struct l_netlink_message *const message =
-                l_netlink_message_new_sized(type, flags, len);
-
-        l_netlink_message_add_header(message, data, len);
-
-        return l_netlink_send(netlink,
-                              message,
-                              function,
-                              user_data,
-                              destroy);
-#else
-        // ELL < 0.68
-        return l_netlink_send(netlink,
-                              type,
-                              flags,
-                              data,
-                              len,
-                              function,
-                              user_data,
-                              destroy);
-#endif
-}
+        /// Function called when the initial dump completes.
+        mptcpd_nm_synced_func synced_callback;
+
+        /// Data passed to @c synced_callback.
+        void *synced_data;
+};
 
 // -------------------------------------------------------------------
 //               Network Address Information Handling
@@ -399,6 +386,66 @@ struct mptcpd_interface_callback_data
         void *user_data;
 };
 
+/**
+ * @brief Update network interface information from @c IFLA_*
+ *        attributes.
+ *
+ * @param[in,out] interface Network interface information.
+ * @param[in]     ifi       Network interface-specific information
+ *                          retrieved from the @c RTM_NEWLINK message.
+ * @param[in]     len       Length of the @c RTM_NEWLINK Netlink
+ *                          message, potentially including @c rtattr
+ *                          attributes.
+ */
+static void parse_link_attrs(struct mptcpd_interface *interface,
+                             struct ifinfomsg const *ifi,
+                             uint32_t len)
+{
+        // Fallback for kernels that do not report IFLA_CARRIER.
+        interface->carrier = (ifi->ifi_flags & IFF_LOWER_UP) != 0;
+
+        size_t bytes = len - NLMSG_ALIGN(sizeof(*ifi));
+
+        for (struct rtattr const *rta = IFLA_RTA(ifi);
+             RTA_OK(rta, bytes);
+             rta = RTA_NEXT(rta, bytes)) {
+                switch (rta->rta_type) {
+                case IFLA_IFNAME:
+                        if (RTA_PAYLOAD(rta) < IF_NAMESIZE) {
+                                l_strlcpy(interface->name,
+                                          RTA_DATA(rta),
+                                          L_ARRAY_SIZE(interface->name));
+
+                                l_debug("link found: %s",
+                                        interface->name);
+                        }
+                        break;
+                case IFLA_OPERSTATE:
+                        if (RTA_PAYLOAD(rta) >= sizeof(uint8_t))
+                                interface->operstate =
+                                        *(uint8_t const *) RTA_DATA(rta);
+                        break;
+                case IFLA_CARRIER:
+                        if (RTA_PAYLOAD(rta) >= sizeof(uint8_t))
+                                interface->carrier =
+                                        *(uint8_t const *) RTA_DATA(rta);
+                        break;
+                case IFLA_CARRIER_CHANGES:
+                        if (RTA_PAYLOAD(rta) >= sizeof(uint32_t))
+                                interface->carrier_changes =
+                                        *(uint32_t const *) RTA_DATA(rta);
+                        break;
+                case IFLA_MTU:
+                        if (RTA_PAYLOAD(rta) >= sizeof(uint32_t))
+                                interface->mtu =
+                                        *(uint32_t const *) RTA_DATA(rta);
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
 /**
  * @brief Create an object that contains network interface-specific
  *        information.
@@ -446,8 +493,6 @@ mptcpd_interface_create(struct ifinfomsg const *ifi, uint32_t len)
         interface->index  = ifi->ifi_index;
         interface->flags  = ifi->ifi_flags;
 
-        size_t bytes = len - NLMSG_ALIGN(sizeof(*ifi));
-
         /**
          * @todo Can we retrieve the IP address associated with each
          *       network interface from IFLA_* attributes?  It seemed
@@ -462,24 +507,7 @@ mptcpd_interface_create(struct ifinfomsg const *ifi, uint32_t len)
          *       on whether or not they have been marked MPTCP-enabled
          *       through an mptcpd configuration/setting.
          */
-        for (struct rtattr const *rta = IFLA_RTA(ifi);
-             RTA_OK(rta, bytes);
-             rta = RTA_NEXT(rta, bytes)) {
-                switch (rta->rta_type) {
-                case IFLA_IFNAME:
-                        if (RTA_PAYLOAD(rta) < IF_NAMESIZE) {
-                                l_strlcpy(interface->name,
-                                          RTA_DATA(rta),
-                                          L_ARRAY_SIZE(interface->name));
-
-                                l_debug("link found: %s",
-                                        interface->name);
-                        }
-                        break;
-                default:
-                        break;
-                }
-        }
+        parse_link_attrs(interface, ifi, len);
 
         interface->addrs = l_queue_new();
 
@@ -600,7 +628,7 @@ static bool is_interface_ready(struct mptcpd_nm const *nm,
 static void notify_new_interface(void *data, void *user_data)
 {
         struct nm_ops_info            *const info = data;
-        struct mptcpd_nm_ops    const *const ops  = info->ops;
+        struct mptcpd_nm_ops    const *const ops  = &info->ops;
         struct mptcpd_interface const *const i    = user_data;
 
         if (ops->new_interface)
@@ -616,7 +644,7 @@ static void notify_new_interface(void *data, void *user_data)
 static void notify_update_interface(void *data, void *user_data)
 {
         struct nm_ops_info            *const info = data;
-        struct mptcpd_nm_ops    const *const ops  = info->ops;
+        struct mptcpd_nm_ops    const *const ops  = &info->ops;
         struct mptcpd_interface const *const i    = user_data;
 
         if (ops->update_interface)
@@ -632,13 +660,57 @@ static void notify_update_interface(void *data, void *user_data)
 static void notify_delete_interface(void *data, void *user_data)
 {
         struct nm_ops_info            *const info = data;
-        struct mptcpd_nm_ops    const *const ops  = info->ops;
+        struct mptcpd_nm_ops    const *const ops  = &info->ops;
         struct mptcpd_interface const *const i    = user_data;
 
         if (ops->delete_interface)
                 ops->delete_interface(i, info->user_data);
 }
 
+/**
+ * @brief Notify network interface link state change event subscriber.
+ *
+ * @param[in] data      Set of network event tracking callbacks.
+ * @param[in] user_data @c mptcpd network interface information.
+ */
+static void notify_link_state_changed(void *data, void *user_data)
+{
+        struct nm_ops_info            *const info = data;
+        struct mptcpd_nm_ops    const *const ops  = &info->ops;
+        struct mptcpd_interface const *const i    = user_data;
+
+        if (ops->link_state_changed)
+                ops->link_state_changed(i, info->user_data);
+}
+
+/**
+ * @brief Update monitored network interface link state.
+ *
+ * @param[in,out] i   Network interface information.
+ * @param[in]     ifi Network interface-specific information retrieved
+ *                    from the @c RTM_NEWLINK messages.
+ * @param[in]     len Length of the Netlink message.
+ *
+ * @return @c true if the link state of the network interface changed,
+ *         and @c false otherwise.
+ */
+static bool update_link_state(struct mptcpd_interface *i,
+                              struct ifinfomsg const *ifi,
+                              uint32_t len)
+{
+        unsigned char const operstate = i->operstate;
+        bool          const carrier   = i->carrier;
+        unsigned int  const mtu       = i->mtu;
+
+        i->flags = ifi->ifi_flags;
+
+        parse_link_attrs(i, ifi, len);
+
+        return i->operstate != operstate
+                || i->carrier != carrier
+                || i->mtu != mtu;
+}
+
 /**
  * @brief Register network interface (link) with network monitor.
  *
@@ -700,10 +772,15 @@ static void update_link(struct ifinfomsg const *ifi,
                         l_queue_foreach(nm->ops, notify_new_interface, i);
 
         } else {
-                i->flags = ifi->ifi_flags;
+                bool const changed = update_link_state(i, ifi, len);
 
                 // Notify updated network interface event observers.
                 l_queue_foreach(nm->ops, notify_update_interface, i);
+
+                if (changed)
+                        l_queue_foreach(nm->ops,
+                                        notify_link_state_changed,
+                                        i);
         }
 }
 
@@ -739,6 +816,37 @@ static void remove_link(struct ifinfomsg const *ifi,
         mptcpd_interface_destroy(interface);
 }
 
+/**
+ * @brief Stop monitoring a network interface that is no longer
+ *        ready.
+ *
+ * Report the final link state of the network interface, e.g. loss
+ * of carrier, before it is removed.
+ *
+ * @param[in] ifi Network interface-specific information retrieved
+ *                from the @c RTM_NEWLINK messages.
+ * @param[in] len Length of the Netlink message.
+ * @param[in] nm  Pointer to the @c mptcpd_nm object that contains the
+ *                list (queue) of monitored network interfaces.
+ */
+static void disable_link(struct ifinfomsg const *ifi,
+                         uint32_t len,
+                         struct mptcpd_nm *nm)
+{
+        struct mptcpd_interface *const i =
+                l_queue_find(nm->interfaces,
+                             mptcpd_interface_match,
+                             &ifi->ifi_index);
+
+        if (i != NULL) {
+                (void) update_link_state(i, ifi, len);
+
+                l_queue_foreach(nm->ops, notify_link_state_changed, i);
+        }
+
+        remove_link(ifi, nm);
+}
+
 /**
  * @brief Handle changes to network interfaces.
  *
@@ -760,12 +868,14 @@ static void handle_link(uint16_t type,
         struct ifinfomsg const *const ifi = data;
         struct mptcpd_nm *const       nm  = user_data;
 
+        mptcpd_loopmon_enter("rtnl", type);
+
         switch (type) {
         case RTM_NEWLINK:
                 if (is_interface_ready(nm, ifi))
                         update_link(ifi, len, nm);
                 else
-                        remove_link(ifi, nm);  // Interface disabled.
+                        disable_link(ifi, len, nm);  // Interface disabled.
 
                 break;
         case RTM_DELLINK:
@@ -776,6 +886,8 @@ static void handle_link(uint16_t type,
                 l_error("Unexpected message in RTNLGRP_LINK handler");
                 break;
         }
+
+        mptcpd_loopmon_leave();
 }
 
 /**
@@ -787,7 +899,7 @@ static void handle_link(uint16_t type,
 static void notify_new_address(void *data, void *user_data)
 {
         struct nm_ops_info         *const info = data;
-        struct mptcpd_nm_ops const *const ops  = info->ops;
+        struct mptcpd_nm_ops const *const ops  = &info->ops;
         struct nm_addr_info  const *const ai   = user_data;
 
         if (ops->new_address)
@@ -805,7 +917,7 @@ static void notify_new_address(void *data, void *user_data)
 static void notify_delete_address(void *data, void *user_data)
 {
         struct nm_ops_info         *const info = data;
-        struct mptcpd_nm_ops const *const ops  = info->ops;
+        struct mptcpd_nm_ops const *const ops  = &info->ops;
         struct nm_addr_info  const *const ai   = user_data;
 
         if (ops->delete_address)
@@ -1052,14 +1164,14 @@ static void check_default_route(struct nm_addr_info *ai)
          */
         mptcpd_addr_get(ai);
 
-        if (netlink_send(ai->nm->rtnl,
-                         RTM_GETROUTE,
-                         0,
-                         &store,
-                         buf - (char *) &store,
-                         handle_rtm_getroute,
-                         ai,
-                         NULL) == 0) {
+        if (mptcpd_netlink_send(ai->nm->rtnl,
+                                RTM_GETROUTE,
+                                0,
+                                &store,
+                                buf - (char *) &store,
+                                handle_rtm_getroute,
+                                ai,
+                                NULL) == 0) {
                 l_debug("Route lookup failed");
                 mptcpd_addr_put(ai);
         }
@@ -1246,27 +1358,15 @@ static void foreach_ifaddr(struct ifaddrmsg const *ifa,
 }
 
 /**
- * @brief Handle changes to network addresses.
- *
- * This is the @c RTNLGRP_IPV4_IFADDR and @c RTNLGRP_IPV6_IFADDR
- * message handler.
+ * @brief Process a network address change.
  *
- * @param[in] type      Netlink message content type (unused).
- * @param[in] data      Pointer to rtnetlink @c ifaddrmsg object
- *                      corresponding to a specific network interface.
- * @param[in] len       Length of the Netlink message.
- * @param[in] user_data Pointer to the @c mptcpd_nm object that
- *                      contains the list (queue) to which network
- *                      interface information will be inserted.
+ * @see handle_ifaddr()
  */
-static void handle_ifaddr(uint16_t type,
-                          void const *data,
-                          uint32_t len,
-                          void *user_data)
+static void process_ifaddr(uint16_t type,
+                           struct ifaddrmsg const *ifa,
+                           uint32_t len,
+                           struct mptcpd_nm *nm)
 {
-        struct ifaddrmsg const *const ifa = data;
-        struct mptcpd_nm *const       nm  = user_data;
-
         struct mptcpd_interface *const interface =
                 get_mptcpd_interface(ifa, nm);
 
@@ -1295,6 +1395,32 @@ static void handle_ifaddr(uint16_t type,
         foreach_ifaddr(ifa, len, nm, interface, handler);
 }
 
+/**
+ * @brief Handle changes to network addresses.
+ *
+ * This is the @c RTNLGRP_IPV4_IFADDR and @c RTNLGRP_IPV6_IFADDR
+ * message handler.
+ *
+ * @param[in] type      Netlink message content type.
+ * @param[in] data      Pointer to rtnetlink @c ifaddrmsg object
+ *                      corresponding to a specific network interface.
+ * @param[in] len       Length of the Netlink message.
+ * @param[in] user_data Pointer to the @c mptcpd_nm object that
+ *                      contains the list (queue) to which network
+ *                      interface information will be inserted.
+ */
+static void handle_ifaddr(uint16_t type,
+                          void const *data,
+                          uint32_t len,
+                          void *user_data)
+{
+        mptcpd_loopmon_enter("rtnl", type);
+
+        process_ifaddr(type, data, len, user_data);
+
+        mptcpd_loopmon_leave();
+}
+
 // -------------------------------------------------------------------
 //                  rtnetlink Command Handling
 // -------------------------------------------------------------------
@@ -1405,6 +1531,24 @@ static void handle_rtm_getaddr(int error,
         foreach_ifaddr(ifa, len, nm, interface, handler);
 }
 
+/**
+ * @brief Complete the initial network interface and address dump.
+ *
+ * @param[in] user_data Pointer to the @c mptcpd_nm object.
+ */
+static void complete_sync(void *user_data)
+{
+        struct mptcpd_nm *const nm = user_data;
+
+        if (nm->synced)
+                return;
+
+        nm->synced = true;
+
+        if (nm->synced_callback != NULL)
+                nm->synced_callback(nm->synced_data);
+}
+
 /**
  * @brief Send rtnetlink command to retrieve network addresses.
  *
@@ -1420,21 +1564,25 @@ static void send_getaddr_command(void *user_data)
           Don't bother attempting to retrieve IP addresses if no
           network interfaces are being tracked.
          */
-        if (l_queue_isempty(nm->interfaces))
+        if (l_queue_isempty(nm->interfaces)) {
+                complete_sync(nm);
                 return;
+        }
 
         // Get IP addresses.
         struct ifaddrmsg addr_msg = { .ifa_family = AF_UNSPEC };
-        if (netlink_send(nm->rtnl,
-                         RTM_GETADDR,
-                         NLM_F_DUMP,
-                         &addr_msg,
-                         sizeof(addr_msg),
-                         handle_rtm_getaddr,
-                         nm,
-                         NULL) == 0) {
+        if (mptcpd_netlink_send(nm->rtnl,
+                                RTM_GETADDR,
+                                NLM_F_DUMP,
+                                &addr_msg,
+                                sizeof(addr_msg),
+                                handle_rtm_getaddr,
+                                nm,
+                                complete_sync) == 0) {
                 l_error("Unable to obtain IP addresses.");
 
+                complete_sync(nm);
+
                 /*
                   Continue running since addresses may be appear
                   dynamically later on.
@@ -1518,14 +1666,14 @@ struct mptcpd_nm *mptcpd_nm_create(uint32_t flags)
          *       resulted in an EBUSY error.
          */
         struct ifinfomsg link_msg = { .ifi_family = AF_UNSPEC };
-        if (netlink_send(nm->rtnl,
-                         RTM_GETLINK,
-                         NLM_F_DUMP,
-                         &link_msg,
-                         sizeof(link_msg),
-                         handle_rtm_getlink,
-                         nm,
-                         send_getaddr_command)
+        if (mptcpd_netlink_send(nm->rtnl,
+                                RTM_GETLINK,
+                                NLM_F_DUMP,
+                                &link_msg,
+                                sizeof(link_msg),
+                                handle_rtm_getlink,
+                                nm,
+                                send_getaddr_command)
             == 0) {
                 l_error("Unable to obtain network devices.");
                 mptcpd_nm_destroy(nm);
@@ -1552,6 +1700,9 @@ void mptcpd_nm_destroy(struct mptcpd_nm *nm)
             && !l_netlink_unregister(nm->rtnl, nm->ipv6_id))
                 l_error("Failed to unregister IPv6 monitor.");
 
+        // Pending dumps are cancelled below.  Don't report them.
+        nm->synced_callback = NULL;
+
         l_queue_destroy(nm->ops, l_free);
         nm->ops = NULL;
 
@@ -1562,6 +1713,28 @@ void mptcpd_nm_destroy(struct mptcpd_nm *nm)
         l_free(nm);
 }
 
+void mptcpd_nm_set_notify_flags(struct mptcpd_nm *nm, uint32_t flags)
+{
+        if (nm == NULL)
+                return;
+
+        nm->notify_flags = flags;
+}
+
+void mptcpd_nm_notify_synced(struct mptcpd_nm *nm,
+                             mptcpd_nm_synced_func callback,
+                             void *user_data)
+{
+        if (nm == NULL)
+                return;
+
+        nm->synced_callback = callback;
+        nm->synced_data     = user_data;
+
+        if (nm->synced && callback != NULL)
+                callback(user_data);
+}
+
 void mptcpd_nm_foreach_interface(struct mptcpd_nm const *nm,
                                  mptcpd_nm_callback callback,
                                  void *callback_data)
@@ -1579,28 +1752,38 @@ void mptcpd_nm_foreach_interface(struct mptcpd_nm const *nm,
                         &cb_data);
 }
 
-bool mptcpd_nm_register_ops(struct mptcpd_nm *nm,
-                            struct mptcpd_nm_ops const *ops,
-                            void *user_data)
+bool mptcpd_nm_register_ops_size(struct mptcpd_nm *nm,
+                                 struct mptcpd_nm_ops const *ops,
+                                 size_t size,
+                                 void *user_data)
 {
-        if (nm == NULL || ops == NULL)
+        if (nm == NULL || ops == NULL || size < NM_OPS_SIZE_V1)
                 return false;
 
-        if (ops->new_interface       == NULL
-            && ops->update_interface == NULL
-            && ops->delete_interface == NULL
-            && ops->new_address      == NULL
-            && ops->delete_address   == NULL) {
+        struct nm_ops_info *const info = l_new(struct nm_ops_info, 1);
+
+        /*
+          Callers compiled against an older header only provide the
+          operations preceding the ones added since.
+        */
+        memcpy(&info->ops, ops, L_MIN(size, sizeof(info->ops)));
+        info->user_data = user_data;
+
+        ops = &info->ops;
+
+        if (ops->new_interface         == NULL
+            && ops->update_interface   == NULL
+            && ops->delete_interface   == NULL
+            && ops->new_address        == NULL
+            && ops->delete_address     == NULL
+            && ops->link_state_changed == NULL) {
                 l_error("No network monitor event tracking "
                         "ops were set.");
 
+                l_free(info);
                 return false;
         }
 
-        struct nm_ops_info *const info = l_malloc(sizeof(*info));
-        info->ops = ops;
-        info->user_data = user_data;
-
         bool const registered = l_queue_push_tail(nm->ops, info);
 
         if (!registered)
@@ -1609,6 +1792,16 @@ bool mptcpd_nm_register_ops(struct mptcpd_nm *nm,
         return registered;
 }
 
+bool (mptcpd_nm_register_ops)(struct mptcpd_nm *nm,
+                              struct mptcpd_nm_ops const *ops,
+                              void *user_data)
+{
+        return mptcpd_nm_register_ops_size(nm,
+                                           ops,
+                                           NM_OPS_SIZE_V1,
+                                           user_data);
+}
+
 bool mptcpd_nm_monitor_loopback(struct mptcpd_nm *nm, bool enable)
 {
         if (nm == NULL)
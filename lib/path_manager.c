@@ -13,6 +13,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
 
 #include <netinet/in.h>
 
@@ -22,6 +23,11 @@
 #include <mptcpd/private/path_manager.h>
 #include <mptcpd/plugin.h>
 #include <mptcpd/private/netlink_pm.h>
+#include <mptcpd/private/subflow_scheduler.h>
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/sock_diag.h>
+
+#include "hash_sockaddr.h"
 
 
 // -------------------------------------------------------------------
@@ -37,6 +43,134 @@ static bool is_pm_ready(struct mptcpd_pm const *pm, char const *fname)
         return ready;
 }
 
+static size_t sockaddr_size(struct sockaddr const *sa)
+{
+        return sa->sa_family == AF_INET
+                ? sizeof(struct sockaddr_in)
+                : sizeof(struct sockaddr_in6);
+}
+
+// --------------------------------------------------------------------
+//                 Subflow Creation Scheduler Operations
+// --------------------------------------------------------------------
+
+static int sched_issue(struct mptcpd_sched_request const *req,
+                       void *user_data)
+{
+        struct mptcpd_pm *const pm = user_data;
+
+        // The MPTCP family may have vanished while the request waited.
+        if (!is_pm_ready(pm, __func__))
+                return EAGAIN;
+
+        struct sockaddr const *const laddr =
+                req->laddr.ss_family == AF_UNSPEC
+                ? NULL
+                : (struct sockaddr const *) &req->laddr;
+
+        return pm->netlink_pm->cmd_ops->add_subflow(
+                pm,
+                req->token,
+                req->local_id,
+                req->remote_id,
+                laddr,
+                (struct sockaddr const *) &req->raddr,
+                req->backup);
+}
+
+/**
+ * @struct sched_index_data
+ *
+ * @brief Type used to return index associated with local address.
+ */
+struct sched_index_data
+{
+        /// Local address information.        (IN)
+        struct mptcpd_hash_sockaddr_key const key;
+
+        /// Network interface (link) index.   (OUT)
+        int index;
+};
+
+static bool sched_addr_match(void const *a, void const *b)
+{
+        struct mptcpd_hash_sockaddr_key const key = { .sa = a };
+
+        return mptcpd_hash_sockaddr_compare(&key, b) == 0;
+}
+
+static void sched_get_index(struct mptcpd_interface const *i, void *data)
+{
+        struct sched_index_data *const d = data;
+
+        if (d->index == 0
+            && l_queue_find(i->addrs, sched_addr_match, &d->key))
+                d->index = i->index;
+}
+
+int mptcpd_pm_addr_to_index(struct mptcpd_pm const *pm,
+                            struct sockaddr const *laddr)
+{
+        if (pm == NULL || laddr == NULL)
+                return 0;
+
+        struct sched_index_data data = {
+                .key = { .sa = laddr },
+                .index = 0
+        };
+
+        mptcpd_nm_foreach_interface(pm->nm, sched_get_index, &data);
+
+        return data.index;
+}
+
+static int sched_addr_to_index(struct sockaddr const *laddr,
+                               void *user_data)
+{
+        return mptcpd_pm_addr_to_index(user_data, laddr);
+}
+
+/**
+ * @brief Approximate the data in flight on a MPTCP connection.
+ *
+ * The congestion windows of all subflows of the connection in the
+ * most recent metrics snapshot are added up.  Connections without
+ * metrics get the lowest weight.
+ */
+static uint64_t sched_get_weight(mptcpd_token_t token, void *user_data)
+{
+        struct mptcpd_pm const *const pm = user_data;
+
+        struct mptcpd_diag_snapshot const *const s =
+                mptcpd_diag_get_snapshot(pm->diag);
+
+        size_t i;
+
+        if (s == NULL || !mptcpd_diag_find_connection(pm->diag, token, &i))
+                return 0;
+
+        struct mptcpd_diag_connections const *const c = &s->connections;
+        uint64_t weight = 0;
+
+        for (size_t j = c->first[i]; j < c->first[i] + c->subflows[i]; ++j)
+                weight += s->subflows.cwnd[j];
+
+        return weight;
+}
+
+static struct mptcpd_sched_ops const sched_ops = {
+        .issue      = sched_issue,
+        .get_index  = sched_addr_to_index,
+        .get_weight = sched_get_weight
+};
+
+struct mptcpd_sched *mptcpd_pm_sched_create(
+        struct mptcpd_pm *pm,
+        struct mptcpd_sched_limits const *limits)
+{
+        return mptcpd_sched_create(limits, &sched_ops, pm);
+}
+
 // --------------------------------------------------------------------
 
 bool mptcpd_pm_register_ops(struct mptcpd_pm *pm,
@@ -313,13 +447,28 @@ int mptcpd_pm_add_subflow(struct mptcpd_pm *pm,
         if (ops == NULL || ops->add_subflow == NULL)
                 return ENOTSUP;
 
-        return ops->add_subflow(pm,
-                                token,
-                                local_address_id,
-                                remote_address_id,
-                                local_addr,
-                                remote_addr,
-                                backup);
+        if (pm->sched == NULL)
+                return ops->add_subflow(pm,
+                                        token,
+                                        local_address_id,
+                                        remote_address_id,
+                                        local_addr,
+                                        remote_addr,
+                                        backup);
+
+        struct mptcpd_sched_request req = {
+                .token     = token,
+                .local_id  = local_address_id,
+                .remote_id = remote_address_id,
+                .backup    = backup
+        };
+
+        if (local_addr != NULL)
+                memcpy(&req.laddr, local_addr, sockaddr_size(local_addr));
+
+        memcpy(&req.raddr, remote_addr, sockaddr_size(remote_addr));
+
+        return mptcpd_sched_add_subflow(pm->sched, &req);
 }
 
 int mptcpd_pm_set_backup(struct mptcpd_pm *pm,
@@ -387,6 +536,54 @@ struct mptcpd_lm * mptcpd_pm_get_lm(struct mptcpd_pm const *pm)
         return pm->lm;
 }
 
+struct mptcpd_diag * mptcpd_pm_get_diag(struct mptcpd_pm const *pm)
+{
+        return pm->diag;
+}
+
+struct mptcpd_ecache * mptcpd_pm_get_ecache(struct mptcpd_pm const *pm)
+{
+        return pm->ecache;
+}
+
+struct mptcpd_jstats * mptcpd_pm_get_jstats(struct mptcpd_pm const *pm)
+{
+        return pm->jstats;
+}
+
+struct mptcpd_pm_reload_stats const *
+mptcpd_pm_get_reload_stats(struct mptcpd_pm const *pm)
+{
+        return &pm->reload_stats;
+}
+
+void mptcpd_pm_failover_started(struct mptcpd_pm *pm)
+{
+        if (pm != NULL)
+                ++pm->failover_stats.started;
+}
+
+void mptcpd_pm_failover_completed(struct mptcpd_pm *pm, uint64_t duration)
+{
+        if (pm == NULL)
+                return;
+
+        struct mptcpd_pm_failover_stats *const stats = &pm->failover_stats;
+
+        ++stats->completed;
+        stats->total_duration += duration;
+        stats->last_duration   = duration;
+
+        if (duration > stats->max_duration)
+                stats->max_duration = duration;
+}
+
+struct mptcpd_pm_failover_stats const *
+mptcpd_pm_get_failover_stats(struct mptcpd_pm const *pm)
+{
+        return &pm->failover_stats;
+}
+
 
 /*
   Local Variables:
@@ -18,7 +18,6 @@
 #include <dlfcn.h>
 #include <errno.h>
 #include <unistd.h>
-#include <assert.h>
 
 #include <ell/ell.h>
 
@@ -37,6 +36,7 @@
 #endif
 
 #include <mptcpd/private/plugin.h>
+#include <mptcpd/private/sockaddr.h>
 #include <mptcpd/plugin.h>
 
 
@@ -56,13 +56,13 @@
 static struct l_hashmap *_pm_plugins;
 
 /**
- * @brief Connection token to path manager plugin operations map.
+ * @brief Connection token to plugin chain map.
  *
  * @todo Determine if use of a hashmap scales well, in terms
  *       of both performance and resource usage, in the
  *       presence of a large number of MPTCP connections.
  */
-static struct l_hashmap *_token_to_ops;
+static struct l_hashmap *_token_to_chain;
 
 /**
  * @brief Name of default plugin.
@@ -83,6 +83,74 @@ static char _default_name[MPTCP_PM_NAME_LEN + 1];
  */
 static struct mptcpd_plugin_ops const *_default_ops;
 
+/**
+ * @brief Registered plugin operations in plugin priority order.
+ *
+ * List of @c plugin_ops_entry objects, each with distinct plugin
+ * operations.
+ */
+static struct l_queue *_ops_order;
+
+/**
+ * @brief Map of path manager plugin operations to plugin chain.
+ *
+ * Cache of plugin chains compiled from @c _ops_order, cleared
+ * whenever plugin operations are registered.
+ */
+static struct l_hashmap *_chains;
+
+/**
+ * @brief List of compiled @c plugin_chain objects.
+ *
+ * Plugin chains are retained until plugins are unloaded since
+ * connections may still refer to chains no longer in @c _chains.
+ */
+static struct l_queue *_chain_list;
+
+struct plugin_info;
+
+/// Plugin currently being initialized, if any.
+static struct plugin_info const *_init_plugin;
+
+/// Priority of the plugin currently being initialized.
+static int _init_priority = MPTCPD_PLUGIN_PRIORITY_DEFAULT;
+
+/// Directory from which the current set of plugins was loaded.
+static char *_plugin_dir;
+
+/**
+ * @brief Names of the current set of plugins.
+ *
+ * @c NULL if all plugins in @c _plugin_dir were loaded.
+ */
+static struct l_queue *_plugins_to_load;
+
+/**
+ * @brief Maximum number of MPTCP connection events buffered for
+ *        plugin operations that are not ready.
+ */
+#define PLUGIN_PENDING_MAX 4096
+
+/**
+ * @brief Size of @c struct @c mptcpd_plugin_ops before the plugin
+ *        reload operations were added.
+ *
+ * Plugins registering their operations through the
+ * @c mptcpd_plugin_register_ops() function rather than the macro of
+ * the same name were compiled against a header of that size.
+ */
+#define PLUGIN_OPS_SIZE_V1 offsetof(struct mptcpd_plugin_ops, export_state)
+
+/**
+ * @brief Smallest @c struct @c mptcpd_plugin_ops accepted for chain
+ *        stages.
+ *
+ * Chain stages were introduced along with the @c filter operation.
+ */
+#define PLUGIN_STAGE_OPS_SIZE_MIN                               \
+        (offsetof(struct mptcpd_plugin_ops, filter)             \
+         + sizeof(((struct mptcpd_plugin_ops *) NULL)->filter))
+
 // ----------------------------------------------------------------
 //                      Implementation Details
 // ----------------------------------------------------------------
@@ -138,19 +206,351 @@ static struct mptcpd_plugin_ops const *name_to_ops(char const *name)
         return ops;
 }
 
-static struct mptcpd_plugin_ops const *token_to_ops(mptcpd_token_t token)
+// ----------------------------------------------------------------
+//                          Plugin Chaining
+// ----------------------------------------------------------------
+
+/**
+ * @struct plugin_ops_entry
+ *
+ * @brief Registered plugin operations.
+ */
+struct plugin_ops_entry
+{
+        /// Plugin operations, as registered by the plugin.
+        struct mptcpd_plugin_ops const *registered;
+
+        /**
+         * @brief Copy of the registered plugin operations.
+         *
+         * Operations added since the plugin was compiled are unset.
+         */
+        struct mptcpd_plugin_ops ops;
+
+        /// Priority of the plugin that registered @c ops.
+        int priority;
+
+        /// Include @c ops in the plugin chain of all connections.
+        bool stage;
+
+        /// Plugin that registered @c ops, if any.
+        struct plugin_info const *owner;
+
+        /**
+         * @brief MPTCP connection events buffered until the plugin
+         *        is ready, or @c NULL if the plugin is ready.
+         */
+        struct l_queue *pending;
+
+        /// Number of MPTCP connection events dropped while buffering.
+        unsigned int dropped;
+
+        /// Time (microseconds) at which plugin initialization started.
+        uint64_t init_start;
+};
+
+/**
+ * @struct plugin_pending_event
+ *
+ * @brief MPTCP connection event buffered for a plugin.
+ */
+struct plugin_pending_event
+{
+        /// MPTCP connection event referring to the copies below.
+        struct mptcpd_plugin_event event;
+
+        /// Copy of the event local address.
+        struct sockaddr *laddr;
+
+        /// Copy of the event remote address.
+        struct sockaddr *raddr;
+};
+
+/**
+ * @struct plugin_chain
+ *
+ * @brief Per-connection plugin dispatch vector.
+ */
+struct plugin_chain
+{
+        /// Path manager plugin operations selected for a connection.
+        struct mptcpd_plugin_ops const *primary;
+
+        /// Number of plugin operations in the chain.
+        size_t len;
+
+        /// Plugin operations in plugin priority order.
+        struct plugin_ops_entry *entries[];
+};
+
+static int compare_ops_priority(void const *a,
+                                void const *b,
+                                void *user_data)
+{
+        (void) user_data;
+
+        struct plugin_ops_entry const *const new      = a;
+        struct plugin_ops_entry const *const existing = b;
+
+        // Plugin operations of equal priority retain their order.
+        return new->priority < existing->priority ? -1 : 1;
+}
+
+static bool ops_entry_match(void const *a, void const *b)
+{
+        struct plugin_ops_entry const *const entry = a;
+
+        return entry->registered == b;
+}
+
+static struct plugin_ops_entry *add_ops_entry(
+        struct mptcpd_plugin_ops const *ops,
+        size_t size)
+{
+        if (_ops_order == NULL)
+                _ops_order = l_queue_new();
+
+        struct plugin_ops_entry *entry =
+                l_queue_find(_ops_order, ops_entry_match, ops);
+
+        if (entry == NULL) {
+                entry = l_new(struct plugin_ops_entry, 1);
+                entry->registered = ops;
+                entry->priority   = _init_priority;
+                entry->owner      = _init_plugin;
+
+                memcpy(&entry->ops,
+                       ops,
+                       L_MIN(size, sizeof(entry->ops)));
+
+                (void) l_queue_insert(_ops_order,
+                                      entry,
+                                      compare_ops_priority,
+                                      NULL);
+        }
+
+        // Recompile plugin chains on next use.
+        l_hashmap_destroy(_chains, NULL);
+        _chains = NULL;
+
+        return entry;
+}
+
+static void pending_event_destroy(void *data)
+{
+        struct plugin_pending_event *const p = data;
+
+        l_free(p->laddr);
+        l_free(p->raddr);
+        l_free(p);
+}
+
+static void ops_entry_destroy(void *data)
+{
+        struct plugin_ops_entry *const entry = data;
+
+        l_queue_destroy(entry->pending, pending_event_destroy);
+        l_free(entry);
+}
+
+static void reset_chains(void)
+{
+        l_hashmap_destroy(_chains, NULL);
+        l_queue_destroy(_chain_list, l_free);
+        l_queue_destroy(_ops_order, ops_entry_destroy);
+
+        _chains     = NULL;
+        _chain_list = NULL;
+        _ops_order  = NULL;
+}
+
+/**
+ * @brief Get the plugin chain of a path manager plugin.
+ *
+ * @param[in] primary Path manager plugin operations selected for a
+ *                    connection.
+ *
+ * @return Stage operations and @a primary in plugin priority order,
+ *         or @c NULL if @a primary is @c NULL.
+ */
+static struct plugin_chain const *compile_chain(
+        struct mptcpd_plugin_ops const *primary)
+{
+        if (primary == NULL)
+                return NULL;
+
+        if (_chains == NULL)
+                _chains = l_hashmap_new();
+
+        struct plugin_chain *chain = l_hashmap_lookup(_chains, primary);
+
+        if (chain != NULL)
+                return chain;
+
+        size_t len = 0;
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(_ops_order);
+             e != NULL;
+             e = e->next) {
+                struct plugin_ops_entry const *const entry = e->data;
+
+                if (entry->stage || &entry->ops == primary)
+                        ++len;
+        }
+
+        chain = l_malloc(sizeof(*chain)
+                         + len * sizeof(chain->entries[0]));
+        chain->primary = primary;
+        chain->len     = 0;
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(_ops_order);
+             e != NULL;
+             e = e->next) {
+                struct plugin_ops_entry *const entry = e->data;
+
+                if (entry->stage || &entry->ops == primary)
+                        chain->entries[chain->len++] = entry;
+        }
+
+        if (_chain_list == NULL)
+                _chain_list = l_queue_new();
+
+        l_queue_push_tail(_chain_list, chain);
+        (void) l_hashmap_insert(_chains, primary, chain);
+
+        return chain;
+}
+
+static struct plugin_chain const *token_to_chain(mptcpd_token_t token)
 {
         /**
          * @todo Should we reject a zero valued token?
          */
-        struct mptcpd_plugin_ops const *const ops =
-                l_hashmap_lookup(_token_to_ops,
+        struct plugin_chain const *const chain =
+                l_hashmap_lookup(_token_to_chain,
                                  L_UINT_TO_PTR(token));
 
-        if (ops == NULL)
+        if (chain == NULL)
                 l_error("Unable to match token to plugin.");
 
-        return ops;
+        return chain;
+}
+
+static void dispatch_event(struct mptcpd_plugin_ops const *ops,
+                           struct mptcpd_plugin_event const *e,
+                           struct mptcpd_pm *pm)
+{
+        switch (e->type) {
+        case MPTCPD_PLUGIN_NEW_CONNECTION:
+                if (ops->new_connection)
+                        ops->new_connection(e->token,
+                                            e->laddr,
+                                            e->raddr,
+                                            e->server_side,
+                                            pm);
+                break;
+
+        case MPTCPD_PLUGIN_CONNECTION_ESTABLISHED:
+                if (ops->connection_established)
+                        ops->connection_established(e->token,
+                                                    e->laddr,
+                                                    e->raddr,
+                                                    e->server_side,
+                                                    pm);
+                break;
+
+        case MPTCPD_PLUGIN_CONNECTION_CLOSED:
+                if (ops->connection_closed)
+                        ops->connection_closed(e->token, pm);
+                break;
+
+        case MPTCPD_PLUGIN_NEW_ADDRESS:
+                if (ops->new_address)
+                        ops->new_address(e->token, e->id, e->raddr, pm);
+                break;
+
+        case MPTCPD_PLUGIN_ADDRESS_REMOVED:
+                if (ops->address_removed)
+                        ops->address_removed(e->token, e->id, pm);
+                break;
+
+        case MPTCPD_PLUGIN_NEW_SUBFLOW:
+                if (ops->new_subflow)
+                        ops->new_subflow(e->token,
+                                         e->laddr,
+                                         e->raddr,
+                                         e->backup,
+                                         pm);
+                break;
+
+        case MPTCPD_PLUGIN_SUBFLOW_CLOSED:
+                if (ops->subflow_closed)
+                        ops->subflow_closed(e->token,
+                                            e->laddr,
+                                            e->raddr,
+                                            e->backup,
+                                            pm);
+                break;
+
+        case MPTCPD_PLUGIN_SUBFLOW_PRIORITY:
+                if (ops->subflow_priority)
+                        ops->subflow_priority(e->token,
+                                              e->laddr,
+                                              e->raddr,
+                                              e->backup,
+                                              pm);
+                break;
+        }
+}
+
+static void buffer_event(struct plugin_ops_entry *entry,
+                         struct mptcpd_plugin_event const *e)
+{
+        if (l_queue_length(entry->pending) >= PLUGIN_PENDING_MAX) {
+                ++entry->dropped;
+                return;
+        }
+
+        struct plugin_pending_event *const p =
+                l_new(struct plugin_pending_event, 1);
+
+        p->laddr = mptcpd_sockaddr_copy(e->laddr);
+        p->raddr = mptcpd_sockaddr_copy(e->raddr);
+
+        p->event       = *e;
+        p->event.laddr = p->laddr;
+        p->event.raddr = p->raddr;
+
+        l_queue_push_tail(entry->pending, p);
+}
+
+static void dispatch(struct plugin_chain const *chain,
+                     struct mptcpd_plugin_event *e,
+                     struct mptcpd_pm *pm)
+{
+        if (chain == NULL)
+                return;
+
+        for (size_t i = 0; i < chain->len; ++i) {
+                struct plugin_ops_entry *const entry = chain->entries[i];
+
+                if (entry->pending != NULL) {
+                        // Plugin is not ready, and can't veto.
+                        buffer_event(entry, e);
+                        continue;
+                }
+
+                struct mptcpd_plugin_ops const *const ops = &entry->ops;
+
+                bool const pass = ops->filter == NULL || ops->filter(e, pm);
+
+                dispatch_event(ops, e, pm);
+
+                if (!pass)
+                        break;  // Vetoed by this plugin.
+        }
 }
 
 // ----------------------------------------------------------------
@@ -164,16 +564,29 @@ static struct mptcpd_plugin_ops const *token_to_ops(mptcpd_token_t token)
  */
 struct plugin_info
 {
-        /// Handle returned from call to @c dlopen().
+        /**
+         * Handle returned from call to @c dlopen(), or @c NULL for
+         * plugins linked into mptcpd.
+         */
         void *handle;
 
         /// Plugin descriptor.
         struct mptcpd_plugin_desc const *desc;
+
+        /// Time (microseconds) spent loading the plugin.
+        uint64_t load_time;
 };
 
 /// List of @c plugin_info objects.
 static struct l_queue *_plugin_infos;
 
+/**
+ * @brief @c NULL terminated array of plugins linked into mptcpd.
+ *
+ * @see @c mptcpd_plugin_register_builtin()
+ */
+static struct mptcpd_plugin_desc const *const *_builtin_plugins;
+
 /**
  * @brief Compare plugin priorities.
  *
@@ -217,13 +630,117 @@ static void init_plugin(void *data, void *user_data)
         struct plugin_info const *const p  = data;
         struct mptcpd_pm         *const pm = user_data;
 
-        if (p->desc->init && p->desc->init(pm) != 0)
+        // Order plugin operations registered by the plugin.
+        _init_plugin   = p;
+        _init_priority = p->desc->priority;
+
+        uint64_t const start = l_time_now();
+        int const result = p->desc->init ? p->desc->init(pm) : 0;
+
+        _init_plugin   = NULL;
+        _init_priority = MPTCPD_PLUGIN_PRIORITY_DEFAULT;
+
+        if (result == MPTCPD_PLUGIN_INIT_PENDING) {
+                // Buffer events until the plugin is ready.
+                for (struct l_queue_entry const *e =
+                             l_queue_get_entries(_ops_order);
+                     e != NULL;
+                     e = e->next) {
+                        struct plugin_ops_entry *const entry = e->data;
+
+                        if (entry->owner == p && entry->pending == NULL) {
+                                entry->pending    = l_queue_new();
+                                entry->init_start = start;
+                        }
+                }
+        } else if (result != 0) {
                 l_warn("Plugin \"%s\" failed to initialize",
                        p->desc->name);
+        }
+
+        l_debug("Plugin \"%s\" loaded in %" PRIu64 " us, "
+                "%s in %" PRIu64 " us",
+                p->desc->name,
+                p->load_time,
+                result == MPTCPD_PLUGIN_INIT_PENDING
+                ? "initialization deferred" : "initialized",
+                l_time_diff(start, l_time_now()));
+}
+
+static bool plugin_name_match(void const *a, void const *b)
+{
+        struct plugin_info const *const p = a;
+
+        return strcmp(p->desc->name, b) == 0;
+}
+
+static struct mptcpd_plugin_desc const *find_builtin(char const *name)
+{
+        if (_builtin_plugins == NULL)
+                return NULL;
+
+        for (struct mptcpd_plugin_desc const *const *d = _builtin_plugins;
+             *d != NULL;
+             ++d)
+                if (strcmp((*d)->name, name) == 0)
+                        return *d;
+
+        return NULL;
+}
+
+static bool register_plugin(void *handle,
+                            struct mptcpd_plugin_desc const *desc,
+                            uint64_t load_time)
+{
+        /*
+          A plugin linked into mptcpd takes precedence over a stale
+          plugin file of the same name in the plugin directory.
+        */
+        if (l_queue_find(_plugin_infos, plugin_name_match, desc->name)) {
+                l_warn("Plugin \"%s\" already loaded, ignoring "
+                       "duplicate.",
+                       desc->name);
+                return false;
+        }
+
+        struct plugin_info *const p = l_new(struct plugin_info, 1);
+        p->handle    = handle;
+        p->desc      = desc;
+        p->load_time = load_time;
+
+        // Register plugin.
+        if (!l_queue_insert(_plugin_infos,
+                            p,
+                            compare_plugin_priority,
+                            NULL)) {
+                /*
+                  We should never get here.  The only way to get here
+                  is if either the l_queue pointer argument,
+                  i.e. _plugin_infos, is NULL or if the comparison
+                  function argument is NULL.
+                */
+                l_error("Unexpected error registering plugin \"%s\"",
+                        desc->name);
+                l_free(p);
+                return false;
+        }
+
+        /*
+          Initialization will be performed after all plugins are
+          loaded to taken into account plugin priority.
+        */
+        return true;
 }
 
 static void load_plugin(char const *filename)
 {
+        uint64_t const start = l_time_now();
+
+        /*
+          Plugins are linked with "-z now" so lazy binding would not
+          defer symbol resolution.  Resolve symbols here to detect
+          unresolved symbols before the plugin is used.
+        */
         void *const handle = dlopen(filename, RTLD_NOW);
 
         if (handle == NULL) {
@@ -254,31 +771,37 @@ static void load_plugin(char const *filename)
                 return;
         }
 
-        struct plugin_info *const p = l_new(struct plugin_info, 1);
-        p->handle = handle;
-        p->desc   = desc;
-
-        // Register plugin.
-        if (!l_queue_insert(_plugin_infos,
-                            p,
-                            compare_plugin_priority,
-                            NULL)) {
-                /*
-                  We should never get here.  The only way to get here
-                  is if either the l_queue pointer argument,
-                  i.e. _plugin_infos, is NULL or if the comparison
-                  function argument is NULL.
-                */
-                l_error("Unexpected error registering plugin \"%s\"",
-                        filename);
-                l_free(p);
+        if (!register_plugin(handle,
+                             desc,
+                             l_time_diff(start, l_time_now())))
                 dlclose(handle);
-        }
+}
 
-        /*
-          Initialization will be performed after all plugins are
-          loaded to taken into account plugin priority.
-        */
+static bool queue_name_match(void const *a, void const *b)
+{
+        return strcmp(a, b) == 0;
+}
+
+/**
+ * @brief Register plugins linked into mptcpd.
+ *
+ * @param[in] plugins_to_load List of plugins to be loaded, or
+ *                            @c NULL to load all plugins.
+ */
+static void load_builtin_plugins(struct l_queue const *plugins_to_load)
+{
+        if (_builtin_plugins == NULL)
+                return;
+
+        for (struct mptcpd_plugin_desc const *const *d = _builtin_plugins;
+             *d != NULL;
+             ++d) {
+                if (plugins_to_load == NULL
+                    || l_queue_find((struct l_queue *) plugins_to_load,
+                                    queue_name_match,
+                                    (*d)->name))
+                        (void) register_plugin(NULL, *d, 0);
+        }
 }
 
 static void load_plugins_queue(char const *dir,
@@ -289,6 +812,13 @@ static void load_plugins_queue(char const *dir,
 
         while (entry) {
                 char const *const plugin_name = (char *) entry->data;
+
+                // Plugins linked into mptcpd were already registered.
+                if (find_builtin(plugin_name) != NULL) {
+                        entry = entry->next;
+                        continue;
+                }
+
                 char *const path = l_strdup_printf("%s/%s.so",
                                                    dir,
                                                    plugin_name);
@@ -365,26 +895,38 @@ static int load_plugins(char const *dir,
          *       the TOCTOU race condition.
          */
 
+        int ret = 0;
         int const fd = open(dir, O_RDONLY | O_DIRECTORY);
 
         if (fd == -1) {
-                report_error(errno, "Unable to open plugin directory");
+                int const error = errno;
 
-                return -1;
-        }
+                /*
+                  Plugins linked into mptcpd don't require a plugin
+                  directory, e.g. on systems without loadable
+                  plugins.
+                */
+                load_builtin_plugins(plugins_to_load);
 
-        // Plugin directory permissions sanity check.
-        if (!check_directory_perms(dir, fd)) {
-                (void) close(fd);
-                return -1;
-        }
+                if (l_queue_isempty(_plugin_infos)) {
+                        report_error(error,
+                                     "Unable to open plugin directory");
 
-        int ret = 0;
+                        return -1;
+                }
 
-        if (plugins_to_load) {
+                l_debug("Plugin directory unavailable, "
+                        "using builtin plugins only.");
+        } else if (!check_directory_perms(dir, fd)) {
+                // Plugin directory permissions sanity check.
+                (void) close(fd);
+                return -1;
+        } else if (plugins_to_load) {
+                load_builtin_plugins(plugins_to_load);
                 load_plugins_queue(dir, plugins_to_load);
                 (void) close(fd);
         } else {
+                load_builtin_plugins(plugins_to_load);
                 ret = load_plugins_all(fd, dir);
                 /*
                   No need call close() since the fdopendir() call in
@@ -407,12 +949,31 @@ static bool unload_plugin(void *data, void *user_data)
         if (p->desc->exit)
                 p->desc->exit(pm);
 
-        dlclose(p->handle);
+        if (p->handle != NULL)
+                dlclose(p->handle);
         l_free(p);
 
         return true;
 }
 
+static void set_default_name(char const *default_name)
+{
+        memset(_default_name, 0, sizeof(_default_name));
+
+        if (default_name == NULL)
+                return;
+
+        size_t const len = L_ARRAY_SIZE(_default_name);
+
+        size_t const src_len = l_strlcpy(_default_name, default_name, len);
+
+        if (src_len > len)
+                l_warn("Default plugin name length truncated "
+                       "from %zu to %zu.",
+                       src_len,
+                       len);
+}
+
 static void unload_plugins(struct mptcpd_pm *pm)
 {
         /*
@@ -427,6 +988,51 @@ static void unload_plugins(struct mptcpd_pm *pm)
         _plugin_infos = NULL;
 }
 
+static void copy_plugin_name(void *data, void *user_data)
+{
+        struct l_queue *const names = user_data;
+
+        l_queue_push_tail(names, l_strdup(data));
+}
+
+/**
+ * @brief Remember how the current set of plugins was loaded.
+ *
+ * @param[in] dir             Directory from which plugins were
+ *                            loaded.
+ * @param[in] plugins_to_load List of plugins that were loaded.
+ */
+static void save_plugin_set(char const *dir,
+                            struct l_queue const *plugins_to_load)
+{
+        struct l_queue *names = NULL;
+
+        if (plugins_to_load != NULL) {
+                names = l_queue_new();
+                l_queue_foreach((struct l_queue *) plugins_to_load,
+                                copy_plugin_name,
+                                names);
+        }
+
+        // Copy first in case the arguments refer to the saved set.
+        char *const plugin_dir = l_strdup(dir);
+
+        l_free(_plugin_dir);
+        l_queue_destroy(_plugins_to_load, l_free);
+
+        _plugin_dir      = plugin_dir;
+        _plugins_to_load = names;
+}
+
+static void forget_plugin_set(void)
+{
+        l_free(_plugin_dir);
+        l_queue_destroy(_plugins_to_load, l_free);
+
+        _plugin_dir      = NULL;
+        _plugins_to_load = NULL;
+}
+
 bool mptcpd_plugin_load(char const *dir,
                         char const *default_name,
                         struct l_queue const *plugins_to_load,
@@ -449,25 +1055,13 @@ bool mptcpd_plugin_load(char const *dir,
                   failure.
                 */
 
-                if (default_name != NULL) {
-                        size_t const len = L_ARRAY_SIZE(_default_name);
-
-                        size_t const src_len =
-                                l_strlcpy(_default_name,
-                                          default_name,
-                                          len);
-
-                        if (src_len > len)
-                                l_warn("Default plugin name length truncated "
-                                       "from %zu to %zu.",
-                                       src_len,
-                                       len);
-                }
+                set_default_name(default_name);
 
                 if (load_plugins(dir, plugins_to_load, pm) != 0
                     || l_hashmap_isempty(_pm_plugins)) {
                         l_hashmap_destroy(_pm_plugins, NULL);
                         _pm_plugins = NULL;
+                        reset_chains();
                         unload_plugins(pm);
 
                         return false;  // Plugin load and registration
@@ -488,14 +1082,22 @@ bool mptcpd_plugin_load(char const *dir,
                  *       hash function, assuming @c unsigned @c int is a 32
                  *       bit type.
                  */
-                _token_to_ops = l_hashmap_new();  // Aborts on memory
-                                                  // allocation
-                                                  // failure.
+                _token_to_chain = l_hashmap_new();  // Aborts on memory
+                                                    // allocation
+                                                    // failure.
+
+                save_plugin_set(dir, plugins_to_load);
         }
 
         return !l_hashmap_isempty(_pm_plugins);
 }
 
+void mptcpd_plugin_register_builtin(
+        struct mptcpd_plugin_desc const *const *plugins)
+{
+        _builtin_plugins = plugins;
+}
+
 void mptcpd_plugin_unload(struct mptcpd_pm *pm)
 {
         /**
@@ -504,22 +1106,368 @@ void mptcpd_plugin_unload(struct mptcpd_pm *pm)
          *       different threads.  However, right now there doesn't
          *       appear to be a need to support that.
          */
-        l_hashmap_destroy(_token_to_ops, NULL);
+        l_hashmap_destroy(_token_to_chain, NULL);
         l_hashmap_destroy(_pm_plugins, NULL);
+        reset_chains();
 
-        _token_to_ops  = NULL;
-        _pm_plugins  = NULL;
-        _default_ops = NULL;
+        _token_to_chain = NULL;
+        _pm_plugins     = NULL;
+        _default_ops    = NULL;
         memset(_default_name, 0, sizeof(_default_name));
 
         unload_plugins(pm);
+        forget_plugin_set();
+}
+
+// ----------------------------------------------------------------
+//                          Plugin Reload
+// ----------------------------------------------------------------
+
+/**
+ * @struct plugin_conn_state
+ *
+ * @brief MPTCP connection handed over across a plugin reload.
+ */
+struct plugin_conn_state
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// Name of the plugin managing the connection.
+        char *name;
+
+        /// Plugin-defined state format version.
+        uint32_t version;
+
+        /// Exported connection state, or @c NULL if none.
+        void *data;
+
+        /// Length of @c data in bytes.
+        size_t len;
+};
+
+/**
+ * @struct plugin_name_info
+ *
+ * @brief Plugin operations to plugin name lookup information.
+ */
+struct plugin_name_info
+{
+        /// Plugin operations to look up.
+        struct mptcpd_plugin_ops const *const ops;
+
+        /// Name under which @c ops were registered.
+        char const *name;
+};
+
+/**
+ * @struct plugin_export_info
+ *
+ * @brief Convenience structure to bundle state export information.
+ */
+struct plugin_export_info
+{
+        /// List of @c plugin_conn_state objects.
+        struct l_queue *const states;
+
+        /// Mptcpd path manager object.
+        struct mptcpd_pm *const pm;
+};
+
+static void find_plugin_name(void const *key,
+                             void *value,
+                             void *user_data)
+{
+        struct plugin_name_info *const info = user_data;
+
+        if (value == info->ops)
+                info->name = key;
+}
+
+static void export_conn_state(void const *key,
+                              void *value,
+                              void *user_data)
+{
+        struct plugin_chain       const *const chain = value;
+        struct plugin_export_info const *const info  = user_data;
+
+        struct mptcpd_plugin_ops const *const ops =
+                chain != NULL ? chain->primary : NULL;
+
+        struct plugin_name_info name_info = { .ops = ops };
+        l_hashmap_foreach(_pm_plugins, find_plugin_name, &name_info);
+
+        struct plugin_conn_state *const s =
+                l_new(struct plugin_conn_state, 1);
+
+        s->token = L_PTR_TO_UINT(key);
+        s->name  = l_strdup(name_info.name);
+
+        if (ops != NULL && ops->export_state)
+                s->data = ops->export_state(s->token,
+                                            &s->version,
+                                            &s->len,
+                                            info->pm);
+
+        l_queue_push_tail(info->states, s);
+}
+
+/**
+ * @brief Map an MPTCP connection to a plugin, and hand over its state.
+ *
+ * @return @c true if the connection was mapped to a plugin, and
+ *         @c false otherwise.
+ */
+static bool import_connection(mptcpd_token_t token,
+                              char const *name,
+                              uint32_t version,
+                              void const *state,
+                              size_t len,
+                              struct mptcpd_pm *pm)
+{
+        struct mptcpd_plugin_ops const *ops = NULL;
+
+        if (name != NULL)
+                ops = l_hashmap_lookup(_pm_plugins, name);
+
+        if (ops == NULL)
+                ops = _default_ops;
+
+        if (ops == NULL
+            || !l_hashmap_insert(_token_to_chain,
+                                 L_UINT_TO_PTR(token),
+                                 (void *) compile_chain(ops))) {
+                l_error("Unable to map connection to plugin.");
+                return false;
+        }
+
+        if (state != NULL
+            && (ops->import_state == NULL
+                || !ops->import_state(token, version, state, len, pm)))
+                l_warn("Plugin state of connection 0x%" PRIx32
+                       " discarded.",
+                       token);
+
+        return true;
+}
+
+static void import_conn_state(void *data, void *user_data)
+{
+        struct plugin_conn_state const *const s  = data;
+        struct mptcpd_pm               *const pm = user_data;
+
+        (void) import_connection(s->token,
+                                 s->name,
+                                 s->version,
+                                 s->data,
+                                 s->len,
+                                 pm);
+}
+
+static void plugin_conn_state_destroy(void *data)
+{
+        struct plugin_conn_state *const s = data;
+
+        l_free(s->data);
+        l_free(s->name);
+        l_free(s);
+}
+
+/**
+ * @brief Unload the current set of plugins.
+ *
+ * @param[in] pm Mptcpd path manager object.
+ */
+static void discard_plugin_set(struct mptcpd_pm *pm)
+{
+        unload_plugins(pm);
+
+        l_hashmap_destroy(_token_to_chain, NULL);
+        l_hashmap_destroy(_pm_plugins, NULL);
+        reset_chains();
+
+        _token_to_chain = NULL;
+        _pm_plugins     = NULL;
+        _default_ops    = NULL;
+}
+
+/**
+ * @brief Load and initialize a set of plugins.
+ *
+ * Plugin files are reopened by name so plugin binaries replaced
+ * since they were last loaded are picked up.
+ *
+ * @return @c true if at least one plugin registered its operations,
+ *         and @c false otherwise, in which case the partially loaded
+ *         set of plugins is unloaded.
+ */
+static bool load_plugin_set(char const *dir,
+                            char const *default_name,
+                            struct l_queue const *plugins_to_load,
+                            struct mptcpd_pm *pm)
+{
+        _token_to_chain = l_hashmap_new();
+        _pm_plugins     = l_hashmap_string_new();
+
+        if (_plugin_infos == NULL)
+                _plugin_infos = l_queue_new();
+
+        set_default_name(default_name);
+
+        if (load_plugins(dir, plugins_to_load, pm) == 0
+            && !l_hashmap_isempty(_pm_plugins))
+                return true;
+
+        discard_plugin_set(pm);
+
+        return false;
 }
 
-bool mptcpd_plugin_register_ops(char const *name,
-                                struct mptcpd_plugin_ops const *ops)
+bool mptcpd_plugin_reload(char const *dir,
+                          char const *default_name,
+                          struct l_queue const *plugins_to_load,
+                          struct mptcpd_pm *pm)
 {
-        if (name == NULL || ops == NULL)
+        if (dir == NULL) {
+                l_error("No plugin directory specified.");
                 return false;
+        }
+
+        if (_plugin_dir == NULL) {
+                l_error("No plugins to reload.");
+                return false;
+        }
+
+        /*
+          Export connection state while the outgoing plugins are
+          still loaded.
+        */
+        struct plugin_export_info info = {
+                .states = l_queue_new(),
+                .pm     = pm
+        };
+
+        l_hashmap_foreach(_token_to_chain, export_conn_state, &info);
+
+        char previous_default[sizeof(_default_name)];
+        memcpy(previous_default, _default_name, sizeof(previous_default));
+
+        /*
+          Plugins share their static state across loads, e.g. through
+          the same dlopen() handle, so the outgoing plugins must be
+          unloaded before the incoming ones are initialized.
+        */
+        discard_plugin_set(pm);
+
+        bool const reloaded =
+                load_plugin_set(dir, default_name, plugins_to_load, pm);
+
+        if (reloaded) {
+                save_plugin_set(dir, plugins_to_load);
+        } else {
+                l_error("Unable to load plugins from %s, "
+                        "restoring previous plugins.",
+                        dir);
+
+                if (!load_plugin_set(_plugin_dir,
+                                     previous_default,
+                                     _plugins_to_load,
+                                     pm))
+                        l_error("Unable to restore previous plugins.");
+        }
+
+        // Hand over existing connections to the incoming plugins.
+        if (_pm_plugins != NULL)
+                l_queue_foreach(info.states, import_conn_state, pm);
+
+        l_queue_destroy(info.states, plugin_conn_state_destroy);
+
+        return reloaded;
+}
+
+/**
+ * @struct plugin_state_callback_info
+ *
+ * @brief Convenience structure to bundle state callback information.
+ */
+struct plugin_state_callback_info
+{
+        /// Function called for each MPTCP connection.
+        mptcpd_plugin_state_func const callback;
+
+        /// Data passed to @c callback.
+        void *const user_data;
+};
+
+static void report_conn_state(void *data, void *user_data)
+{
+        struct plugin_conn_state           const *const s    = data;
+        struct plugin_state_callback_info  const *const info = user_data;
+
+        info->callback(s->token,
+                       s->name,
+                       s->version,
+                       s->data,
+                       s->len,
+                       info->user_data);
+}
+
+void mptcpd_plugin_export_states(mptcpd_plugin_state_func callback,
+                                 void *user_data,
+                                 struct mptcpd_pm *pm)
+{
+        if (callback == NULL || _token_to_chain == NULL)
+                return;
+
+        struct plugin_export_info info = {
+                .states = l_queue_new(),
+                .pm     = pm
+        };
+
+        l_hashmap_foreach(_token_to_chain, export_conn_state, &info);
+
+        struct plugin_state_callback_info cb_info = {
+                .callback  = callback,
+                .user_data = user_data
+        };
+
+        l_queue_foreach(info.states, report_conn_state, &cb_info);
+        l_queue_destroy(info.states, plugin_conn_state_destroy);
+}
+
+bool mptcpd_plugin_restore_connection(mptcpd_token_t token,
+                                      char const *name,
+                                      uint32_t version,
+                                      void const *state,
+                                      size_t len,
+                                      struct mptcpd_pm *pm)
+{
+        if (_pm_plugins == NULL)
+                return false;
+
+        // Connections already known to the plugins take precedence.
+        if (l_hashmap_lookup(_token_to_chain, L_UINT_TO_PTR(token)))
+                return false;
+
+        return import_connection(token, name, version, state, len, pm);
+}
+
+bool mptcpd_plugin_register_ops_size(char const *name,
+                                     struct mptcpd_plugin_ops const *ops,
+                                     size_t size)
+{
+        if (name == NULL
+            || ops == NULL
+            || size < PLUGIN_OPS_SIZE_V1
+            || _pm_plugins == NULL)
+                return false;
+
+        bool const existing =
+                l_queue_find(_ops_order, ops_entry_match, ops) != NULL;
+
+        struct plugin_ops_entry *const entry = add_ops_entry(ops, size);
+
+        ops = &entry->ops;
 
         /**
          * @todo Should we return @c false if all of the callbacks in
@@ -536,8 +1484,10 @@ bool mptcpd_plugin_register_ops(char const *name,
             && ops->new_interface          == NULL
             && ops->update_interface       == NULL
             && ops->delete_interface       == NULL
+            && ops->link_state_changed     == NULL
             && ops->new_local_address      == NULL
-            && ops->delete_local_address   == NULL)
+            && ops->delete_local_address   == NULL
+            && ops->filter                 == NULL)
                 l_warn("No plugin operations were set.");
 
         bool const first_registration = l_hashmap_isempty(_pm_plugins);
@@ -561,11 +1511,78 @@ bool mptcpd_plugin_register_ops(char const *name,
                         _default_ops = ops;
                 else if (first_registration)
                         _default_ops = ops;
+        } else if (!existing) {
+                (void) l_queue_remove(_ops_order, entry);
+                ops_entry_destroy(entry);
         }
 
         return registered;
 }
 
+bool (mptcpd_plugin_register_ops)(char const *name,
+                                  struct mptcpd_plugin_ops const *ops)
+{
+        return mptcpd_plugin_register_ops_size(name,
+                                               ops,
+                                               PLUGIN_OPS_SIZE_V1);
+}
+
+bool mptcpd_plugin_register_stage_size(struct mptcpd_plugin_ops const *ops,
+                                       size_t size)
+{
+        if (ops == NULL
+            || size < PLUGIN_STAGE_OPS_SIZE_MIN
+            || _pm_plugins == NULL)
+                return false;
+
+        add_ops_entry(ops, size)->stage = true;
+
+        return true;
+}
+
+void mptcpd_plugin_ready(struct mptcpd_plugin_ops const *ops,
+                         struct mptcpd_pm *pm)
+{
+        struct plugin_ops_entry *const entry =
+                l_queue_find(_ops_order, ops_entry_match, ops);
+
+        if (entry == NULL || entry->pending == NULL)
+                return;  // Unknown or already ready.
+
+        struct l_queue *const pending = entry->pending;
+        entry->pending = NULL;
+
+        ops = &entry->ops;
+
+        l_debug("Plugin ready after %" PRIu64 " us, "
+                "%u buffered events, %u dropped",
+                l_time_diff(entry->init_start, l_time_now()),
+                l_queue_length(pending),
+                entry->dropped);
+
+        if (entry->dropped != 0)
+                l_warn("%u MPTCP events dropped before plugin was ready.",
+                       entry->dropped);
+
+        entry->dropped = 0;
+
+        /*
+          Deliver buffered events in order.  Later plugins in the
+          chain have already seen them so vetoes no longer apply.
+        */
+        struct plugin_pending_event *p;
+
+        while ((p = l_queue_pop_head(pending)) != NULL) {
+                if (ops->filter)
+                        (void) ops->filter(&p->event, pm);
+
+                dispatch_event(ops, &p->event, pm);
+                pending_event_destroy(p);
+        }
+
+        l_queue_destroy(pending, NULL);
+}
+
 // ----------------------------------------------------------------
 //               Plugin Operation Callback Invocation
 // ----------------------------------------------------------------
@@ -577,16 +1594,24 @@ void mptcpd_plugin_new_connection(char const *name,
                                   bool server_side,
                                   struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = name_to_ops(name);
+        struct plugin_chain const *const chain =
+                compile_chain(name_to_ops(name));
 
-        // Map connection token to the path manager plugin operations.
-        if (!l_hashmap_insert(_token_to_ops,
+        // Map connection token to the plugin chain.
+        if (!l_hashmap_insert(_token_to_chain,
                               L_UINT_TO_PTR(token),
-                              (void *) ops))
+                              (void *) chain))
                 l_error("Unable to map connection to plugin.");
 
-        if (ops && ops->new_connection)
-                ops->new_connection(token, laddr, raddr, server_side, pm);
+        struct mptcpd_plugin_event event = {
+                .type        = MPTCPD_PLUGIN_NEW_CONNECTION,
+                .token       = token,
+                .laddr       = laddr,
+                .raddr       = raddr,
+                .server_side = server_side
+        };
+
+        dispatch(chain, &event, pm);
 }
 
 void mptcpd_plugin_connection_established(mptcpd_token_t token,
@@ -595,23 +1620,32 @@ void mptcpd_plugin_connection_established(mptcpd_token_t token,
                                           bool server_side,
                                           struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
+        struct mptcpd_plugin_event event = {
+                .type        = MPTCPD_PLUGIN_CONNECTION_ESTABLISHED,
+                .token       = token,
+                .laddr       = laddr,
+                .raddr       = raddr,
+                .server_side = server_side
+        };
 
-        if (ops && ops->connection_established)
-                ops->connection_established(token,
-                                            laddr,
-                                            raddr,
-                                            server_side,
-                                            pm);
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_connection_closed(mptcpd_token_t token,
                                      struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
+        struct mptcpd_plugin_event event = {
+                .type  = MPTCPD_PLUGIN_CONNECTION_CLOSED,
+                .token = token
+        };
+
+        dispatch(token_to_chain(token), &event, pm);
 
-        if (ops && ops->connection_closed)
-                ops->connection_closed(token, pm);
+        /*
+          Forget the connection so that its state is no longer
+          exported on plugin reload or state save.
+        */
+        (void) l_hashmap_remove(_token_to_chain, L_UINT_TO_PTR(token));
 }
 
 void mptcpd_plugin_new_address(mptcpd_token_t token,
@@ -619,20 +1653,27 @@ void mptcpd_plugin_new_address(mptcpd_token_t token,
                                struct sockaddr const *addr,
                                struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
+        struct mptcpd_plugin_event event = {
+                .type  = MPTCPD_PLUGIN_NEW_ADDRESS,
+                .token = token,
+                .id    = id,
+                .raddr = addr
+        };
 
-        if (ops && ops->new_address)
-                ops->new_address(token, id, addr, pm);
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_address_removed(mptcpd_token_t token,
                                    mptcpd_aid_t id,
                                    struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
+        struct mptcpd_plugin_event event = {
+                .type  = MPTCPD_PLUGIN_ADDRESS_REMOVED,
+                .token = token,
+                .id    = id
+        };
 
-        if (ops && ops->address_removed)
-                ops->address_removed(token, id, pm);
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_new_subflow(mptcpd_token_t token,
@@ -641,10 +1682,15 @@ void mptcpd_plugin_new_subflow(mptcpd_token_t token,
                                bool backup,
                                struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
+        struct mptcpd_plugin_event event = {
+                .type   = MPTCPD_PLUGIN_NEW_SUBFLOW,
+                .token  = token,
+                .laddr  = laddr,
+                .raddr  = raddr,
+                .backup = backup
+        };
 
-        if (ops && ops->new_subflow)
-                ops->new_subflow(token, laddr, raddr, backup, pm);
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_subflow_closed(mptcpd_token_t token,
@@ -653,11 +1699,15 @@ void mptcpd_plugin_subflow_closed(mptcpd_token_t token,
                                   bool backup,
                                   struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
-
-        if (ops && ops->subflow_closed)
-                ops->subflow_closed(token, laddr, raddr, backup, pm);
+        struct mptcpd_plugin_event event = {
+                .type   = MPTCPD_PLUGIN_SUBFLOW_CLOSED,
+                .token  = token,
+                .laddr  = laddr,
+                .raddr  = raddr,
+                .backup = backup
+        };
 
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_subflow_priority(mptcpd_token_t token,
@@ -666,11 +1716,15 @@ void mptcpd_plugin_subflow_priority(mptcpd_token_t token,
                                     bool backup,
                                     struct mptcpd_pm *pm)
 {
-        struct mptcpd_plugin_ops const *const ops = token_to_ops(token);
-
-        if (ops && ops->subflow_priority)
-                ops->subflow_priority(token, laddr, raddr, backup, pm);
+        struct mptcpd_plugin_event event = {
+                .type   = MPTCPD_PLUGIN_SUBFLOW_PRIORITY,
+                .token  = token,
+                .laddr  = laddr,
+                .raddr  = raddr,
+                .backup = backup
+        };
 
+        dispatch(token_to_chain(token), &event, pm);
 }
 
 void mptcpd_plugin_listener_created(char const *name,
@@ -730,76 +1784,63 @@ struct plugin_interface_info
         struct mptcpd_pm *const pm;
 };
 
-static void new_interface(void const *key, void *value, void *user_data)
+static void new_interface(void *data, void *user_data)
 {
-        (void) key;
-
-        assert(value != NULL);
+        struct plugin_ops_entry      const *const entry = data;
+        struct mptcpd_plugin_ops     const *const ops   = &entry->ops;
+        struct plugin_interface_info const *const i     = user_data;
 
-        struct mptcpd_plugin_ops     const *const ops = value;
-        struct plugin_interface_info const *const i   = user_data;
-
-        if (ops->new_interface)
+        if (entry->pending == NULL && ops->new_interface)
                 ops->new_interface(i->interface, i->pm);
 }
 
-static void update_interface(void const *key,
-                             void *value,
-                             void *user_data)
+static void update_interface(void *data, void *user_data)
 {
-        (void) key;
-
-        assert(value != NULL);
+        struct plugin_ops_entry      const *const entry = data;
+        struct mptcpd_plugin_ops     const *const ops   = &entry->ops;
+        struct plugin_interface_info const *const i     = user_data;
 
-        struct mptcpd_plugin_ops     const *const ops = value;
-        struct plugin_interface_info const *const i   = user_data;
-
-        if (ops->update_interface)
+        if (entry->pending == NULL && ops->update_interface)
                 ops->update_interface(i->interface, i->pm);
 }
 
-static void delete_interface(void const *key,
-                             void *value,
-                             void *user_data)
+static void delete_interface(void *data, void *user_data)
 {
-        (void) key;
-
-        assert(value != NULL);
+        struct plugin_ops_entry      const *const entry = data;
+        struct mptcpd_plugin_ops     const *const ops   = &entry->ops;
+        struct plugin_interface_info const *const i     = user_data;
 
-        struct mptcpd_plugin_ops     const *const ops = value;
-        struct plugin_interface_info const *const i   = user_data;
-
-        if (ops->delete_interface)
+        if (entry->pending == NULL && ops->delete_interface)
                 ops->delete_interface(i->interface, i->pm);
 }
 
-static void new_local_address(void const *key,
-                              void *value,
-                              void *user_data)
+static void link_state_changed(void *data, void *user_data)
 {
-        (void) key;
+        struct plugin_ops_entry      const *const entry = data;
+        struct mptcpd_plugin_ops     const *const ops   = &entry->ops;
+        struct plugin_interface_info const *const i     = user_data;
 
-        assert(value != NULL);
+        if (entry->pending == NULL && ops->link_state_changed)
+                ops->link_state_changed(i->interface, i->pm);
+}
 
-        struct mptcpd_plugin_ops   const *const ops = value;
-        struct plugin_address_info const *const i   = user_data;
+static void new_local_address(void *data, void *user_data)
+{
+        struct plugin_ops_entry    const *const entry = data;
+        struct mptcpd_plugin_ops   const *const ops   = &entry->ops;
+        struct plugin_address_info const *const i     = user_data;
 
-        if (ops->new_local_address)
+        if (entry->pending == NULL && ops->new_local_address)
                 ops->new_local_address(i->interface, i->address, i->pm);
 }
 
-static void delete_local_address(void const *key,
-                                 void *value,
-                                 void *user_data)
+static void delete_local_address(void *data, void *user_data)
 {
-        (void) key;
-
-        assert(value != NULL);
+        struct plugin_ops_entry    const *const entry = data;
+        struct mptcpd_plugin_ops   const *const ops   = &entry->ops;
+        struct plugin_address_info const *const i     = user_data;
 
-        struct mptcpd_plugin_ops    const *const ops = value;
-        struct plugin_address_info  const *const i   = user_data;
-
-        if (ops->delete_local_address)
+        if (entry->pending == NULL && ops->delete_local_address)
                 ops->delete_local_address(i->interface, i->address, i->pm);
 }
 
@@ -811,7 +1852,7 @@ void mptcpd_plugin_new_interface(struct mptcpd_interface const *i,
                 .pm        = pm
         };
 
-        l_hashmap_foreach(_pm_plugins, new_interface, &info);
+        l_queue_foreach(_ops_order, new_interface, &info);
 }
 
 void mptcpd_plugin_update_interface(struct mptcpd_interface const *i,
@@ -822,7 +1863,7 @@ void mptcpd_plugin_update_interface(struct mptcpd_interface const *i,
                 .pm        = pm
         };
 
-        l_hashmap_foreach(_pm_plugins, update_interface, &info);
+        l_queue_foreach(_ops_order, update_interface, &info);
 }
 
 void mptcpd_plugin_delete_interface(struct mptcpd_interface const *i,
@@ -833,7 +1874,18 @@ void mptcpd_plugin_delete_interface(struct mptcpd_interface const *i,
                 .pm        = pm
         };
 
-        l_hashmap_foreach(_pm_plugins, delete_interface, &info);
+        l_queue_foreach(_ops_order, delete_interface, &info);
+}
+
+void mptcpd_plugin_link_state_changed(struct mptcpd_interface const *i,
+                                      void *pm)
+{
+        struct plugin_interface_info info = {
+                .interface = i,
+                .pm        = pm
+        };
+
+        l_queue_foreach(_ops_order, link_state_changed, &info);
 }
 
 void mptcpd_plugin_new_local_address(struct mptcpd_interface const *i,
@@ -846,7 +1898,7 @@ void mptcpd_plugin_new_local_address(struct mptcpd_interface const *i,
                 .pm        = pm
         };
 
-        l_hashmap_foreach(_pm_plugins, new_local_address, &info);
+        l_queue_foreach(_ops_order, new_local_address, &info);
 }
 
 void mptcpd_plugin_delete_local_address(struct mptcpd_interface const *i,
@@ -859,7 +1911,7 @@ void mptcpd_plugin_delete_local_address(struct mptcpd_interface const *i,
                 .pm        = pm
         };
 
-        l_hashmap_foreach(_pm_plugins, delete_local_address, &info);
+        l_queue_foreach(_ops_order, delete_local_address, &info);
 }
 
 
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file plugin_policy.c
+ *
+ * @brief Per-connection path manager plugin selection.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/configuration.h>
+#include <mptcpd/private/plugin_policy.h>
+#include <mptcpd/lpm.h>
+
+
+/**
+ * @brief Maximum number of plugin selection rules.
+ *
+ * Rules matching a connection are tracked as bits in a @c uint32_t.
+ */
+#define POLICY_MAX_RULES 32
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct mptcpd_plugin_policy
+ *
+ * @brief Compiled path manager plugin selection rules.
+ *
+ * Each criterion maps to the set of rules it satisfies.  The rule
+ * selected for a connection is the first one in the intersection of
+ * those sets.
+ */
+struct mptcpd_plugin_policy
+{
+        /// Plugin names of each rule.
+        char *plugins[POLICY_MAX_RULES];
+
+        /// Rules matching server side connections.
+        uint32_t server_side;
+
+        /// Rules matching client side connections.
+        uint32_t client_side;
+
+        /// Rules matching any local port.
+        uint32_t any_local_port;
+
+        /// Map of local port to rules requiring that port.
+        struct l_hashmap *local_ports;
+
+        /// Rules matching any remote port.
+        uint32_t any_remote_port;
+
+        /// Map of remote port to rules requiring that port.
+        struct l_hashmap *remote_ports;
+
+        /// Rules matching any remote address.
+        uint32_t any_addr;
+
+        /**
+         * @brief Map of remote address prefix to rules.
+         *
+         * Each prefix maps to the rules of that prefix and of all
+         * shorter prefixes containing it, so that the longest
+         * matching prefix yields all rules matching an address.
+         */
+        struct mptcpd_lpm_snapshot *addrs;
+};
+
+// ----------------------------------------------------------------------
+
+/**
+ * @brief Check whether a rule address prefix contains another.
+ */
+static bool prefix_contains(struct mptcpd_plugin_rule const *outer,
+                            struct mptcpd_plugin_rule const *inner)
+{
+        if (outer->remote_prefix.ss_family != inner->remote_prefix.ss_family
+            || outer->remote_prefix_len > inner->remote_prefix_len)
+                return false;
+
+        uint8_t const *lhs, *rhs;
+
+        if (outer->remote_prefix.ss_family == AF_INET) {
+                lhs = (uint8_t const *) &((struct sockaddr_in const *)
+                                          &outer->remote_prefix)->sin_addr;
+                rhs = (uint8_t const *) &((struct sockaddr_in const *)
+                                          &inner->remote_prefix)->sin_addr;
+        } else {
+                lhs = ((struct sockaddr_in6 const *)
+                       &outer->remote_prefix)->sin6_addr.s6_addr;
+                rhs = ((struct sockaddr_in6 const *)
+                       &inner->remote_prefix)->sin6_addr.s6_addr;
+        }
+
+        unsigned int const len = outer->remote_prefix_len;
+        unsigned int const full = len / 8;
+
+        if (memcmp(lhs, rhs, full) != 0)
+                return false;
+
+        if (len % 8 == 0)
+                return true;
+
+        uint8_t const mask = (uint8_t) (0xFF << (8 - len % 8));
+
+        return ((lhs[full] ^ rhs[full]) & mask) == 0;
+}
+
+static bool has_prefix(struct mptcpd_plugin_rule const *r)
+{
+        return r->remote_prefix.ss_family == AF_INET
+                || r->remote_prefix.ss_family == AF_INET6;
+}
+
+static void ports_insert(struct l_hashmap *ports,
+                         uint16_t port,
+                         uint32_t rule)
+{
+        void *const key = L_UINT_TO_PTR(port);
+
+        uint32_t const rules =
+                L_PTR_TO_UINT(l_hashmap_remove(ports, key)) | rule;
+
+        (void) l_hashmap_insert(ports, key, L_UINT_TO_PTR(rules));
+}
+
+static uint32_t ports_lookup(struct l_hashmap *ports, uint16_t port)
+{
+        return L_PTR_TO_UINT(l_hashmap_lookup(ports, L_UINT_TO_PTR(port)));
+}
+
+static uint16_t get_port(struct sockaddr const *sa)
+{
+        if (sa == NULL)
+                return 0;
+
+        if (sa->sa_family == AF_INET)
+                return ntohs(((struct sockaddr_in const *) sa)->sin_port);
+        else if (sa->sa_family == AF_INET6)
+                return ntohs(((struct sockaddr_in6 const *) sa)->sin6_port);
+
+        return 0;
+}
+
+static void policy_add_rule(struct mptcpd_plugin_policy *policy,
+                            struct mptcpd_plugin_rule const *r,
+                            unsigned int index)
+{
+        uint32_t const rule = UINT32_C(1) << index;
+
+        policy->plugins[index] = l_strdup(r->plugin);
+
+        if (r->server_side)
+                policy->server_side |= rule;
+
+        if (r->client_side)
+                policy->client_side |= rule;
+
+        if (r->local_port == 0)
+                policy->any_local_port |= rule;
+        else
+                ports_insert(policy->local_ports, r->local_port, rule);
+
+        if (r->remote_port == 0)
+                policy->any_remote_port |= rule;
+        else
+                ports_insert(policy->remote_ports, r->remote_port, rule);
+
+        if (!has_prefix(r))
+                policy->any_addr |= rule;
+}
+
+/**
+ * @brief Compile the remote address prefixes of the rules.
+ */
+static void policy_add_prefixes(struct mptcpd_plugin_policy *policy,
+                                struct mptcpd_plugin_rule const **rules,
+                                unsigned int count)
+{
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+
+        for (unsigned int i = 0; i < count; ++i) {
+                if (!has_prefix(rules[i]))
+                        continue;
+
+                uint32_t mask = 0;
+
+                for (unsigned int j = 0; j < count; ++j)
+                        if (has_prefix(rules[j])
+                            && prefix_contains(rules[j], rules[i]))
+                                mask |= UINT32_C(1) << j;
+
+                (void) mptcpd_lpm_insert(
+                        lpm,
+                        (struct sockaddr const *) &rules[i]->remote_prefix,
+                        rules[i]->remote_prefix_len,
+                        L_UINT_TO_PTR(mask));
+        }
+
+        policy->addrs = mptcpd_lpm_snapshot(lpm);
+
+        mptcpd_lpm_destroy(lpm);
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_plugin_policy *mptcpd_plugin_policy_create(
+        struct l_queue const *rules)
+{
+        if (l_queue_isempty((struct l_queue *) rules))
+                return NULL;
+
+        struct mptcpd_plugin_policy *const policy =
+                l_new(struct mptcpd_plugin_policy, 1);
+
+        policy->local_ports  = l_hashmap_new();
+        policy->remote_ports = l_hashmap_new();
+
+        struct mptcpd_plugin_rule const *compiled[POLICY_MAX_RULES];
+        unsigned int index = 0;
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries((struct l_queue *) rules);
+             e != NULL;
+             e = e->next, ++index) {
+                if (index == POLICY_MAX_RULES) {
+                        l_warn("Ignoring plugin selection rules beyond "
+                               "the first %u.", POLICY_MAX_RULES);
+                        break;
+                }
+
+                compiled[index] = e->data;
+                policy_add_rule(policy, compiled[index], index);
+        }
+
+        policy_add_prefixes(policy, compiled, index);
+
+        return policy;
+}
+
+void mptcpd_plugin_policy_destroy(struct mptcpd_plugin_policy *policy)
+{
+        if (policy == NULL)
+                return;
+
+        for (unsigned int i = 0; i < POLICY_MAX_RULES; ++i)
+                l_free(policy->plugins[i]);
+
+        l_hashmap_destroy(policy->local_ports, NULL);
+        l_hashmap_destroy(policy->remote_ports, NULL);
+        mptcpd_lpm_snapshot_destroy(policy->addrs);
+        l_free(policy);
+}
+
+char const *mptcpd_plugin_policy_select(
+        struct mptcpd_plugin_policy const *policy,
+        struct sockaddr const *laddr,
+        struct sockaddr const *raddr,
+        bool server_side)
+{
+        if (policy == NULL || raddr == NULL)
+                return NULL;
+
+        uint32_t rules =
+                server_side ? policy->server_side : policy->client_side;
+
+        rules &= policy->any_local_port
+                | ports_lookup(policy->local_ports, get_port(laddr));
+
+        rules &= policy->any_remote_port
+                | ports_lookup(policy->remote_ports, get_port(raddr));
+
+        if (rules == 0)
+                return NULL;
+
+        uint32_t const addr_rules =
+                policy->any_addr
+                | L_PTR_TO_UINT(mptcpd_lpm_lookup(policy->addrs, raddr));
+
+        rules &= addr_rules;
+
+        // The first matching rule takes precedence.
+        return rules == 0 ? NULL : policy->plugins[ffs((int) rules) - 1];
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,729 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file sock_diag.c
+ *
+ * @brief mptcpd MPTCP connection and subflow metrics collector.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>  // For NDEBUG
+#endif
+
+#include <string.h>
+#include <assert.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/tcp.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/mptcp_upstream.h>
+#include <mptcpd/private/loop_monitor.h>
+#include <mptcpd/private/sock_diag.h>
+#include <mptcpd/sock_diag.h>
+
+#include "netlink.h"
+
+
+/// TCP established state bit for the inet_diag state filter.
+#define DIAG_TCPF_ESTABLISHED (1U << 1)
+
+/**
+ * @brief Address families dumped in each collection round.
+ *
+ * The inet_diag API dumps a single address family per request.
+ */
+static uint8_t const diag_families[] = { AF_INET, AF_INET6 };
+
+/**
+ * @struct diag_ops_info
+ *
+ * @brief Metrics collector event tracking callback information.
+ */
+struct diag_ops_info
+{
+        /// Metrics collector event tracking operations.
+        struct mptcpd_diag_ops const *ops;
+
+        /// Data passed to the metrics collector event tracking operations.
+        void *user_data;
+};
+
+/**
+ * @struct mptcpd_diag
+ *
+ * @brief Data needed to run the metrics collector.
+ */
+struct mptcpd_diag
+{
+        /// sock_diag netlink connection.
+        struct l_netlink *diag;
+
+        /// Collection interval timer.
+        struct l_timeout *timer;
+
+        /// Collection interval in milliseconds.
+        unsigned int interval;
+
+        /// List of @c diag_ops_info objects.
+        struct l_queue *ops;
+
+        /**
+         * @brief Published snapshot.
+         *
+         * Subflows are grouped by connection.
+         */
+        struct mptcpd_diag_snapshot snapshot;
+
+        /**
+         * @brief Rows collected during the current round.
+         *
+         * Rows are stored in dump order, and are regrouped by
+         * connection into @c snapshot once the round completes.
+         */
+        struct mptcpd_diag_subflows rows;
+
+        /// Connection index of each row in @c rows.
+        size_t *row_conn;
+
+        /// Connections seen during the current round.
+        struct mptcpd_diag_connections conns;
+
+        /// Number of entries allocated in the @c conns columns.
+        size_t conns_capacity;
+
+        /// Number of entries allocated in the @c rows columns.
+        size_t rows_capacity;
+
+        /// Number of entries allocated in the snapshot subflow columns.
+        size_t subflows_capacity;
+
+        /// Number of entries allocated in the connection columns.
+        size_t connections_capacity;
+
+        /// Map of connection token to connection index plus one.
+        struct l_hashmap *tokens;
+
+        /// Map of @c tokens published along with @c snapshot.
+        struct l_hashmap *snapshot_tokens;
+
+        /// Index in @c diag_families of the current dump.
+        size_t family;
+
+        /// Collection round in progress.
+        bool collecting;
+};
+
+// -------------------------------------------------------------------
+//                       Column Management
+// -------------------------------------------------------------------
+
+/// Grow column @a col to @a n entries.
+#define DIAG_GROW(col, n) (col) = l_realloc((col), (n) * sizeof(*(col)))
+
+/**
+ * @brief Make sure subflow columns have room for @a n entries.
+ *
+ * Columns grow geometrically, and are never shrunk so that the
+ * memory is reused between collection rounds.
+ */
+static void reserve_subflows(struct mptcpd_diag_subflows *s,
+                             size_t *capacity,
+                             size_t n)
+{
+        if (n <= *capacity)
+                return;
+
+        size_t const c = L_MAX(n, *capacity * 2);
+
+        DIAG_GROW(s->token,         c);
+        DIAG_GROW(s->laddr,         c);
+        DIAG_GROW(s->raddr,         c);
+        DIAG_GROW(s->rtt,           c);
+        DIAG_GROW(s->cwnd,          c);
+        DIAG_GROW(s->bytes_acked,   c);
+        DIAG_GROW(s->retrans,       c);
+        DIAG_GROW(s->segs_out,      c);
+        DIAG_GROW(s->delivery_rate, c);
+        DIAG_GROW(s->backup,        c);
+
+        *capacity = c;
+}
+
+static void free_subflows(struct mptcpd_diag_subflows *s)
+{
+        l_free(s->token);
+        l_free(s->laddr);
+        l_free(s->raddr);
+        l_free(s->rtt);
+        l_free(s->cwnd);
+        l_free(s->bytes_acked);
+        l_free(s->retrans);
+        l_free(s->segs_out);
+        l_free(s->delivery_rate);
+        l_free(s->backup);
+}
+
+/**
+ * @brief Make sure connection columns have room for @a n entries.
+ */
+static void reserve_connections(struct mptcpd_diag_connections *conns,
+                                size_t *capacity,
+                                size_t n)
+{
+        if (n <= *capacity)
+                return;
+
+        size_t const c = L_MAX(n, *capacity * 2);
+
+        DIAG_GROW(conns->token,    c);
+        DIAG_GROW(conns->first,    c);
+        DIAG_GROW(conns->subflows, c);
+
+        *capacity = c;
+}
+
+static void free_connections(struct mptcpd_diag_connections *conns)
+{
+        l_free(conns->token);
+        l_free(conns->first);
+        l_free(conns->subflows);
+}
+
+/**
+ * @brief Copy row @a from of @a src to row @a to of @a dst.
+ */
+static void copy_subflow(struct mptcpd_diag_subflows *dst,
+                         size_t to,
+                         struct mptcpd_diag_subflows const *src,
+                         size_t from)
+{
+        dst->token[to]         = src->token[from];
+        dst->laddr[to]         = src->laddr[from];
+        dst->raddr[to]         = src->raddr[from];
+        dst->rtt[to]           = src->rtt[from];
+        dst->cwnd[to]          = src->cwnd[from];
+        dst->bytes_acked[to]   = src->bytes_acked[from];
+        dst->retrans[to]       = src->retrans[from];
+        dst->segs_out[to]      = src->segs_out[from];
+        dst->delivery_rate[to] = src->delivery_rate[from];
+        dst->backup[to]        = src->backup[from];
+}
+
+// -------------------------------------------------------------------
+//                        Dump Parsing
+// -------------------------------------------------------------------
+
+/**
+ * @brief Initialize a subflow address from an inet_diag socket ID.
+ */
+static void set_addr(struct sockaddr_storage *ss,
+                     uint8_t family,
+                     __be32 const *addr,
+                     __be16 port)
+{
+        memset(ss, 0, sizeof(*ss));
+
+        if (family == AF_INET) {
+                struct sockaddr_in *const sin = (struct sockaddr_in *) ss;
+
+                sin->sin_family = AF_INET;
+                sin->sin_port   = port;
+                memcpy(&sin->sin_addr, addr, sizeof(sin->sin_addr));
+        } else {
+                struct sockaddr_in6 *const sin6 =
+                        (struct sockaddr_in6 *) ss;
+
+                sin6->sin6_family = AF_INET6;
+                sin6->sin6_port   = port;
+                memcpy(&sin6->sin6_addr, addr, sizeof(sin6->sin6_addr));
+        }
+}
+
+/**
+ * @brief Parse the MPTCP subflow upper layer protocol information.
+ *
+ * @param[in]  data   Nested @c INET_DIAG_ULP_INFO attributes.
+ * @param[in]  len    Length of @a data.
+ * @param[out] token  Local MPTCP connection token.
+ * @param[out] backup Local backup priority of the subflow.
+ *
+ * @return @c true if the socket is an MPTCP subflow, and @c false
+ *         otherwise.
+ */
+static bool parse_ulp_info(struct rtattr const *data,
+                           unsigned int len,
+                           mptcpd_token_t *token,
+                           bool *backup)
+{
+        bool is_mptcp  = false;
+        bool has_token = false;
+
+        for (struct rtattr const *rta = data;
+             RTA_OK(rta, len);
+             rta = RTA_NEXT(rta, len)) {
+                if (rta->rta_type == INET_ULP_INFO_NAME) {
+                        is_mptcp = strncmp(RTA_DATA(rta),
+                                           "mptcp",
+                                           RTA_PAYLOAD(rta)) == 0;
+
+                        continue;
+                }
+
+                if (rta->rta_type != INET_ULP_INFO_MPTCP)
+                        continue;
+
+                unsigned int sublen = RTA_PAYLOAD(rta);
+
+                for (struct rtattr const *sub = RTA_DATA(rta);
+                     RTA_OK(sub, sublen);
+                     sub = RTA_NEXT(sub, sublen)) {
+                        uint32_t value;
+
+                        if (RTA_PAYLOAD(sub) < sizeof(value))
+                                continue;
+
+                        memcpy(&value, RTA_DATA(sub), sizeof(value));
+
+                        if (sub->rta_type == MPTCP_SUBFLOW_ATTR_TOKEN_LOC) {
+                                *token    = value;
+                                has_token = true;
+                        } else if (sub->rta_type
+                                   == MPTCP_SUBFLOW_ATTR_FLAGS) {
+                                *backup =
+                                        (value
+                                         & MPTCP_SUBFLOW_FLAG_BKUP_LOC)
+                                        != 0;
+                        }
+                }
+        }
+
+        return is_mptcp && has_token;
+}
+
+/**
+ * @brief Get the connection index of @a token in the current round.
+ */
+static size_t get_connection(struct mptcpd_diag *diag,
+                             mptcpd_token_t token)
+{
+        size_t index =
+                L_PTR_TO_UINT(l_hashmap_lookup(diag->tokens,
+                                               L_UINT_TO_PTR(token)));
+
+        if (index != 0)
+                return index - 1;
+
+        struct mptcpd_diag_connections *const conns = &diag->conns;
+
+        index = conns->count++;
+
+        reserve_connections(conns, &diag->conns_capacity, conns->count);
+        conns->token[index]    = token;
+        conns->subflows[index] = 0;
+
+        (void) l_hashmap_insert(diag->tokens,
+                                L_UINT_TO_PTR(token),
+                                L_UINT_TO_PTR(index + 1));
+
+        return index;
+}
+
+/**
+ * @brief Handle a single socket from a sock_diag dump.
+ *
+ * Only MPTCP subflows, i.e. TCP sockets with the "mptcp" upper layer
+ * protocol, are collected.
+ */
+static void handle_diag_dump(int error,
+                             uint16_t type,
+                             void const *data,
+                             uint32_t len,
+                             void *user_data)
+{
+        (void) type;
+
+        if (error != 0) {
+                l_debug("sock_diag dump failed: %s", strerror(-error));
+                return;
+        }
+
+        struct mptcpd_diag *const diag = user_data;
+        struct inet_diag_msg const *const msg = data;
+        size_t const hdrlen = NLMSG_ALIGN(sizeof(*msg));
+
+        if (len < hdrlen
+            || (msg->idiag_family != AF_INET
+                && msg->idiag_family != AF_INET6))
+                return;
+
+        struct tcp_info info;
+        bool has_info      = false;
+        mptcpd_token_t token = 0;
+        bool backup        = false;
+        bool is_mptcp      = false;
+
+        memset(&info, 0, sizeof(info));
+
+        unsigned int attrlen = len - hdrlen;
+
+        for (struct rtattr const *rta =
+                     (struct rtattr const *) ((char const *) msg + hdrlen);
+             RTA_OK(rta, attrlen);
+             rta = RTA_NEXT(rta, attrlen)) {
+                if (rta->rta_type == INET_DIAG_INFO) {
+                        // Older kernels provide a shorter tcp_info.
+                        memcpy(&info,
+                               RTA_DATA(rta),
+                               L_MIN(RTA_PAYLOAD(rta), sizeof(info)));
+
+                        has_info = true;
+                } else if (rta->rta_type == INET_DIAG_ULP_INFO) {
+                        is_mptcp = parse_ulp_info(RTA_DATA(rta),
+                                                  RTA_PAYLOAD(rta),
+                                                  &token,
+                                                  &backup);
+                }
+        }
+
+        if (!is_mptcp || !has_info)
+                return;
+
+        struct mptcpd_diag_subflows *const rows = &diag->rows;
+        size_t const row = rows->count;
+
+        reserve_subflows(rows, &diag->rows_capacity, row + 1);
+        DIAG_GROW(diag->row_conn, diag->rows_capacity);
+
+        size_t const conn = get_connection(diag, token);
+
+        diag->row_conn[row] = conn;
+        ++diag->conns.subflows[conn];
+
+        rows->token[row] = token;
+        set_addr(&rows->laddr[row],
+                 msg->idiag_family,
+                 msg->id.idiag_src,
+                 msg->id.idiag_sport);
+        set_addr(&rows->raddr[row],
+                 msg->idiag_family,
+                 msg->id.idiag_dst,
+                 msg->id.idiag_dport);
+        rows->rtt[row]           = info.tcpi_rtt;
+        rows->cwnd[row]          = info.tcpi_snd_cwnd;
+        rows->bytes_acked[row]   = info.tcpi_bytes_acked;
+        rows->retrans[row]       = info.tcpi_total_retrans;
+        rows->segs_out[row]      = info.tcpi_segs_out;
+        rows->delivery_rate[row] = info.tcpi_delivery_rate;
+        rows->backup[row]        = backup;
+
+        rows->count = row + 1;
+}
+
+// -------------------------------------------------------------------
+//                       Collection Rounds
+// -------------------------------------------------------------------
+
+static void notify_snapshot(void *data, void *user_data)
+{
+        struct diag_ops_info const *const info = data;
+        struct mptcpd_diag_snapshot const *const snapshot = user_data;
+
+        if (info->ops->snapshot)
+                info->ops->snapshot(snapshot, info->user_data);
+}
+
+/**
+ * @brief Publish the rows collected in the current round.
+ *
+ * Rows are regrouped so that subflows of the same connection are
+ * contiguous, using a single counting sort pass.
+ */
+static void publish_snapshot(struct mptcpd_diag *diag)
+{
+        mptcpd_loopmon_enter("diag", 0);
+
+        struct mptcpd_diag_snapshot *const s = &diag->snapshot;
+        struct mptcpd_diag_connections *const conns = &s->connections;
+        struct mptcpd_diag_subflows const *const rows = &diag->rows;
+
+        reserve_subflows(&s->subflows, &diag->subflows_capacity, rows->count);
+        reserve_connections(conns,
+                            &diag->connections_capacity,
+                            diag->conns.count);
+
+        size_t first = 0;
+        for (size_t c = 0; c < diag->conns.count; ++c) {
+                conns->token[c]    = diag->conns.token[c];
+                conns->first[c]    = first;
+                conns->subflows[c] = 0;
+                first             += diag->conns.subflows[c];
+        }
+
+        conns->count = diag->conns.count;
+
+        for (size_t r = 0; r < rows->count; ++r) {
+                size_t const c = diag->row_conn[r];
+
+                copy_subflow(&s->subflows,
+                             conns->first[c] + conns->subflows[c]++,
+                             rows,
+                             r);
+        }
+
+        s->subflows.count = rows->count;
+        s->timestamp      = l_time_now();
+        ++s->round;
+
+        /*
+          Connections keep their round index in the snapshot.  Reuse
+          the round token map for snapshot lookups, and recycle the
+          previous one for the next round.
+        */
+        struct l_hashmap *const tokens = diag->snapshot_tokens;
+
+        diag->snapshot_tokens = diag->tokens;
+        diag->tokens          = tokens;
+
+        diag->collecting = false;
+
+        l_queue_foreach(diag->ops, notify_snapshot, s);
+
+        mptcpd_loopmon_leave();
+}
+
+static bool send_dump(struct mptcpd_diag *diag);
+
+static void dump_done(void *user_data)
+{
+        struct mptcpd_diag *const diag = user_data;
+
+        /*
+          Send the next dump only after the multipart response of the
+          previous one has been fully read.  See mptcpd_nm_create().
+        */
+        ++diag->family;
+
+        if (diag->family == L_ARRAY_SIZE(diag_families)
+            || !send_dump(diag)) {
+                publish_snapshot(diag);
+
+                // The timer is removed if all ops were unregistered.
+                if (diag->timer != NULL)
+                        l_timeout_modify_ms(diag->timer, diag->interval);
+        }
+}
+
+/**
+ * @brief Dump established TCP sockets of the current address family.
+ */
+static bool send_dump(struct mptcpd_diag *diag)
+{
+        struct inet_diag_req_v2 const req = {
+                .sdiag_family   = diag_families[diag->family],
+                .sdiag_protocol = IPPROTO_TCP,
+                .idiag_ext      = 1 << (INET_DIAG_INFO - 1),
+                .idiag_states   = DIAG_TCPF_ESTABLISHED
+        };
+
+        if (mptcpd_netlink_send(diag->diag,
+                                SOCK_DIAG_BY_FAMILY,
+                                NLM_F_DUMP,
+                                &req,
+                                sizeof(req),
+                                handle_diag_dump,
+                                diag,
+                                dump_done) == 0) {
+                l_error("Unable to collect MPTCP subflow metrics.");
+
+                return false;
+        }
+
+        return true;
+}
+
+static void start_round(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+
+        struct mptcpd_diag *const diag = user_data;
+
+        if (diag->collecting)
+                return;
+
+        diag->collecting  = true;
+        diag->family      = 0;
+        diag->rows.count  = 0;
+        diag->conns.count = 0;
+
+        l_hashmap_destroy(diag->tokens, NULL);
+        diag->tokens = l_hashmap_new();
+
+        /*
+          The timer is rearmed once the round completes so that
+          rounds never overlap, regardless of dump duration.
+        */
+        if (!send_dump(diag)) {
+                diag->collecting = false;
+                l_timeout_modify_ms(diag->timer, diag->interval);
+        }
+}
+
+// -------------------------------------------------------------------
+//                  Metrics Collector Public API
+// -------------------------------------------------------------------
+
+struct mptcpd_diag *mptcpd_diag_create(unsigned int interval)
+{
+        if (interval == 0)
+                return NULL;
+
+        struct mptcpd_diag *const diag = l_new(struct mptcpd_diag, 1);
+
+        diag->diag = l_netlink_new(NETLINK_SOCK_DIAG);
+        if (diag->diag == NULL) {
+                l_error("Unable to initialize sock_diag connection.");
+                l_free(diag);
+
+                return NULL;
+        }
+
+        diag->interval        = interval;
+        diag->ops             = l_queue_new();
+        diag->tokens          = l_hashmap_new();
+        diag->snapshot_tokens = l_hashmap_new();
+
+        return diag;
+}
+
+void mptcpd_diag_destroy(struct mptcpd_diag *diag)
+{
+        if (diag == NULL)
+                return;
+
+        l_timeout_remove(diag->timer);
+        l_netlink_destroy(diag->diag);
+        l_hashmap_destroy(diag->tokens, NULL);
+        l_hashmap_destroy(diag->snapshot_tokens, NULL);
+        l_queue_destroy(diag->ops, l_free);
+
+        free_subflows(&diag->rows);
+        free_subflows(&diag->snapshot.subflows);
+        free_connections(&diag->conns);
+        free_connections(&diag->snapshot.connections);
+        l_free(diag->row_conn);
+
+        l_free(diag);
+}
+
+bool mptcpd_diag_register_ops(struct mptcpd_diag *diag,
+                              struct mptcpd_diag_ops const *ops,
+                              void *user_data)
+{
+        if (diag == NULL || ops == NULL)
+                return false;
+
+        if (ops->snapshot == NULL) {
+                l_error("No metrics collector event tracking "
+                        "ops were set.");
+
+                return false;
+        }
+
+        struct diag_ops_info *const info = l_malloc(sizeof(*info));
+        info->ops = ops;
+        info->user_data = user_data;
+
+        bool const registered = l_queue_push_tail(diag->ops, info);
+
+        if (!registered) {
+                l_free(info);
+
+                return registered;
+        }
+
+        // Start collecting once somebody is interested.
+        if (diag->timer == NULL)
+                diag->timer = l_timeout_create_ms(diag->interval,
+                                                  start_round,
+                                                  diag,
+                                                  NULL);
+
+        return registered;
+}
+
+static bool diag_ops_info_match(void const *a, void const *b)
+{
+        struct diag_ops_info const *const lhs = a;
+        struct diag_ops_info const *const rhs = b;
+
+        return lhs->ops == rhs->ops && lhs->user_data == rhs->user_data;
+}
+
+bool mptcpd_diag_unregister_ops(struct mptcpd_diag *diag,
+                                struct mptcpd_diag_ops const *ops,
+                                void *user_data)
+{
+        if (diag == NULL || ops == NULL)
+                return false;
+
+        struct diag_ops_info const key = {
+                .ops       = ops,
+                .user_data = user_data
+        };
+
+        struct diag_ops_info *const info =
+                l_queue_remove_if(diag->ops, diag_ops_info_match, &key);
+
+        // Stop collecting once nobody is interested.
+        if (info != NULL && l_queue_isempty(diag->ops)) {
+                l_timeout_remove(diag->timer);
+                diag->timer = NULL;
+        }
+
+        l_free(info);
+
+        return info != NULL;
+}
+
+struct mptcpd_diag_snapshot const *
+mptcpd_diag_get_snapshot(struct mptcpd_diag const *diag)
+{
+        if (diag == NULL || diag->snapshot.round == 0)
+                return NULL;
+
+        return &diag->snapshot;
+}
+
+bool mptcpd_diag_find_connection(struct mptcpd_diag const *diag,
+                                 mptcpd_token_t token,
+                                 size_t *index)
+{
+        if (diag == NULL || index == NULL)
+                return false;
+
+        size_t const i =
+                L_PTR_TO_UINT(l_hashmap_lookup(diag->snapshot_tokens,
+                                               L_UINT_TO_PTR(token)));
+
+        if (i == 0)
+                return false;
+
+        *index = i - 1;
+
+        return true;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
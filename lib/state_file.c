@@ -0,0 +1,509 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file state_file.c
+ *
+ * @brief mptcpd persistent state file.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/murmur_hash.h>
+#include <mptcpd/private/state_file.h>
+
+
+/// State file magic, not NUL terminated.
+static char const STATE_MAGIC[8] = {
+        'M', 'P', 'T', 'C', 'P', 'D', 'S', 'T'
+};
+
+/// Record payload alignment.
+#define STATE_ALIGN 8
+
+/// Source of the current boot ID.
+#define BOOT_ID_FILE "/proc/sys/kernel/random/boot_id"
+
+/// Length of a boot ID in bytes.
+#define BOOT_ID_LEN 16
+
+/// MurmurHash3 seed used for state file checksums.
+#define STATE_CHECKSUM_SEED 0x6d707463U
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct state_header
+ *
+ * @brief State file header.
+ *
+ * The state file is only meant to be read back by mptcpd on the same
+ * host, so all fields are in host byte order.
+ */
+struct state_header
+{
+        /// State file magic.
+        char magic[sizeof(STATE_MAGIC)];
+
+        /// State file layout version.
+        uint32_t version;
+
+        /// MurmurHash3 of all records following the header.
+        uint32_t checksum;
+
+        /// Total file size in bytes, including the header.
+        uint64_t size;
+
+        /// Number of records.
+        uint32_t count;
+
+        /// Reserved, zero.
+        uint32_t reserved;
+
+        /// Boot ID at the time the file was written, or all zeros.
+        uint8_t boot_id[BOOT_ID_LEN];
+};
+
+/**
+ * @struct state_record
+ *
+ * @brief State file record header.
+ *
+ * Each record header is followed by its payload, padded with zeros
+ * to a multiple of @c STATE_ALIGN bytes.
+ */
+struct state_record
+{
+        /// Caller-defined record type.
+        uint16_t type;
+
+        /// Reserved, zero.
+        uint16_t reserved;
+
+        /// Length of the payload in bytes, excluding padding.
+        uint32_t len;
+};
+
+/**
+ * @struct mptcpd_state_writer
+ *
+ * @brief State file records under construction.
+ */
+struct mptcpd_state_writer
+{
+        /// Serialized records.
+        uint8_t *buf;
+
+        /// Number of bytes in use in @c buf.
+        size_t len;
+
+        /// Number of allocated bytes in @c buf.
+        size_t capacity;
+
+        /// Number of records.
+        uint32_t count;
+};
+
+/**
+ * @struct mptcpd_state_file
+ *
+ * @brief Validated read-only mapping of a state file.
+ */
+struct mptcpd_state_file
+{
+        /// Start of the mapping.
+        void *addr;
+
+        /// Length of the mapping in bytes.
+        size_t len;
+};
+
+// ----------------------------------------------------------------------
+
+static size_t align_len(size_t len)
+{
+        return (len + STATE_ALIGN - 1) & ~(size_t) (STATE_ALIGN - 1);
+}
+
+static int hex_value(char c)
+{
+        if (c >= '0' && c <= '9')
+                return c - '0';
+
+        if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+
+        if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+
+        return -1;
+}
+
+/**
+ * @brief Retrieve the ID of the current system boot.
+ *
+ * @param[out] id Boot ID, or all zeros if unavailable.
+ */
+static void get_boot_id(uint8_t id[BOOT_ID_LEN])
+{
+        memset(id, 0, BOOT_ID_LEN);
+
+        int const fd = open(BOOT_ID_FILE, O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1)
+                return;
+
+        // UUID string, e.g. "01234567-89ab-cdef-0123-456789abcdef".
+        char str[64];
+        ssize_t const len = read(fd, str, sizeof(str) - 1);
+
+        (void) close(fd);
+
+        if (len <= 0)
+                return;
+
+        str[len] = '\0';
+
+        uint8_t tmp[BOOT_ID_LEN];
+        size_t n = 0;
+
+        for (char const *s = str; *s != '\0' && n < BOOT_ID_LEN * 2; ++s) {
+                if (*s == '-')
+                        continue;
+
+                int const v = hex_value(*s);
+
+                if (v < 0)
+                        return;
+
+                if (n % 2 == 0)
+                        tmp[n / 2] = (uint8_t) (v << 4);
+                else
+                        tmp[n / 2] |= (uint8_t) v;
+
+                ++n;
+        }
+
+        if (n == BOOT_ID_LEN * 2)
+                memcpy(id, tmp, BOOT_ID_LEN);
+}
+
+static uint32_t checksum(void const *data, size_t len)
+{
+        return mptcpd_murmur_hash3(data, (int) len, STATE_CHECKSUM_SEED);
+}
+
+/**
+ * @brief Validate the header and record framing of a state file.
+ */
+static bool validate(void const *addr, size_t len)
+{
+        struct state_header const *const h = addr;
+
+        if (len < sizeof(*h)
+            || memcmp(h->magic, STATE_MAGIC, sizeof(h->magic)) != 0) {
+                l_debug("Not an mptcpd state file.");
+                return false;
+        }
+
+        if (h->version != MPTCPD_STATE_FILE_VERSION) {
+                l_info("Ignoring state file version %u, expected %u.",
+                       h->version,
+                       MPTCPD_STATE_FILE_VERSION);
+                return false;
+        }
+
+        if (h->size != len || len - sizeof(*h) > INT_MAX) {
+                l_warn("Ignoring truncated state file.");
+                return false;
+        }
+
+        uint8_t const *const records = (uint8_t const *) (h + 1);
+        size_t const records_len = len - sizeof(*h);
+
+        if (checksum(records, records_len) != h->checksum) {
+                l_warn("Ignoring corrupt state file.");
+                return false;
+        }
+
+        size_t offset = 0;
+        uint32_t count = 0;
+
+        while (offset < records_len) {
+                struct state_record const *const r =
+                        (struct state_record const *) (records + offset);
+
+                if (records_len - offset < sizeof(*r)
+                    || align_len(r->len)
+                       > records_len - offset - sizeof(*r)) {
+                        l_warn("Ignoring state file with bad record.");
+                        return false;
+                }
+
+                offset += sizeof(*r) + align_len(r->len);
+                ++count;
+        }
+
+        if (count != h->count) {
+                l_warn("Ignoring state file with bad record count.");
+                return false;
+        }
+
+        return true;
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_state_writer *mptcpd_state_writer_create(void)
+{
+        return l_new(struct mptcpd_state_writer, 1);
+}
+
+void mptcpd_state_writer_destroy(struct mptcpd_state_writer *w)
+{
+        if (w == NULL)
+                return;
+
+        l_free(w->buf);
+        l_free(w);
+}
+
+bool mptcpd_state_writer_add(struct mptcpd_state_writer *w,
+                             uint16_t type,
+                             void const *data,
+                             size_t len)
+{
+        if (w == NULL || type == 0 || (data == NULL && len != 0)
+            || len > UINT32_MAX)
+                return false;
+
+        size_t const needed = sizeof(struct state_record) + align_len(len);
+
+        if (w->capacity - w->len < needed) {
+                while (w->capacity - w->len < needed)
+                        w->capacity = w->capacity == 0
+                                ? 4096
+                                : w->capacity * 2;
+
+                w->buf = l_realloc(w->buf, w->capacity);
+        }
+
+        struct state_record const r = {
+                .type = type,
+                .len  = (uint32_t) len
+        };
+
+        uint8_t *const p = w->buf + w->len;
+
+        memcpy(p, &r, sizeof(r));
+
+        if (len != 0)
+                memcpy(p + sizeof(r), data, len);
+
+        // Zero padding keeps the file contents deterministic.
+        memset(p + sizeof(r) + len, 0, align_len(len) - len);
+
+        w->len += needed;
+        ++w->count;
+
+        return true;
+}
+
+bool mptcpd_state_writer_commit(struct mptcpd_state_writer const *w,
+                                char const *path)
+{
+        if (w == NULL || path == NULL || w->len > INT_MAX)
+                return false;
+
+        struct state_header h = {
+                .version  = MPTCPD_STATE_FILE_VERSION,
+                .checksum = checksum(w->buf, w->len),
+                .size     = sizeof(h) + w->len,
+                .count    = w->count
+        };
+
+        memcpy(h.magic, STATE_MAGIC, sizeof(h.magic));
+        get_boot_id(h.boot_id);
+
+        char *const tmp = l_strdup_printf("%s.tmp", path);
+        bool committed = false;
+
+        int const fd = open(tmp,
+                            O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                            S_IRUSR | S_IWUSR);
+
+        if (fd == -1) {
+                l_error("Unable to create state file %s: %s",
+                        tmp,
+                        strerror(errno));
+                l_free(tmp);
+
+                return false;
+        }
+
+        void *addr = MAP_FAILED;
+
+        if (ftruncate(fd, (off_t) h.size) == 0)
+                addr = mmap(NULL,
+                            h.size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            fd,
+                            0);
+
+        if (addr != MAP_FAILED) {
+                memcpy(addr, &h, sizeof(h));
+
+                if (w->len != 0)
+                        memcpy((uint8_t *) addr + sizeof(h),
+                               w->buf,
+                               w->len);
+
+                committed = msync(addr, h.size, MS_SYNC) == 0;
+
+                (void) munmap(addr, h.size);
+        }
+
+        committed = close(fd) == 0 && committed
+                && rename(tmp, path) == 0;
+
+        if (!committed) {
+                l_error("Unable to write state file %s: %s",
+                        path,
+                        strerror(errno));
+
+                (void) unlink(tmp);
+        }
+
+        l_free(tmp);
+
+        return committed;
+}
+
+struct mptcpd_state_file *mptcpd_state_file_open(char const *path)
+{
+        if (path == NULL)
+                return NULL;
+
+        int const fd = open(path, O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1) {
+                if (errno != ENOENT)
+                        l_warn("Unable to open state file %s: %s",
+                               path,
+                               strerror(errno));
+
+                return NULL;
+        }
+
+        struct stat sb;
+        void *addr = MAP_FAILED;
+
+        if (fstat(fd, &sb) == 0
+            && S_ISREG(sb.st_mode)
+            && (size_t) sb.st_size >= sizeof(struct state_header))
+                addr = mmap(NULL,
+                            (size_t) sb.st_size,
+                            PROT_READ,
+                            MAP_PRIVATE,
+                            fd,
+                            0);
+
+        // The mapping remains valid after the file is closed.
+        (void) close(fd);
+
+        if (addr == MAP_FAILED) {
+                l_warn("Unable to map state file %s.", path);
+
+                return NULL;
+        }
+
+        if (!validate(addr, (size_t) sb.st_size)) {
+                (void) munmap(addr, (size_t) sb.st_size);
+
+                return NULL;
+        }
+
+        struct mptcpd_state_file *const sf =
+                l_new(struct mptcpd_state_file, 1);
+
+        sf->addr = addr;
+        sf->len  = (size_t) sb.st_size;
+
+        return sf;
+}
+
+void mptcpd_state_file_close(struct mptcpd_state_file *sf)
+{
+        if (sf == NULL)
+                return;
+
+        (void) munmap(sf->addr, sf->len);
+        l_free(sf);
+}
+
+bool mptcpd_state_file_same_boot(struct mptcpd_state_file const *sf)
+{
+        if (sf == NULL)
+                return false;
+
+        static uint8_t const none[BOOT_ID_LEN];
+        uint8_t id[BOOT_ID_LEN];
+
+        get_boot_id(id);
+
+        struct state_header const *const h = sf->addr;
+
+        return memcmp(id, none, sizeof(id)) != 0
+                && memcmp(id, h->boot_id, sizeof(id)) == 0;
+}
+
+size_t mptcpd_state_file_foreach(struct mptcpd_state_file const *sf,
+                                 uint16_t type,
+                                 mptcpd_state_record_func callback,
+                                 void *user_data)
+{
+        if (sf == NULL || callback == NULL)
+                return 0;
+
+        uint8_t const *const records =
+                (uint8_t const *) sf->addr + sizeof(struct state_header);
+        size_t const records_len = sf->len - sizeof(struct state_header);
+
+        size_t count = 0;
+
+        // Record framing was validated when the file was opened.
+        for (size_t offset = 0; offset < records_len; ) {
+                struct state_record const *const r =
+                        (struct state_record const *) (records + offset);
+
+                if (r->type == type) {
+                        callback(r + 1, r->len, user_data);
+                        ++count;
+                }
+
+                offset += sizeof(*r) + align_len(r->len);
+        }
+
+        return count;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,590 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file subflow_scheduler.c
+ *
+ * @brief MPTCP subflow creation scheduler.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/loop_monitor.h>
+#include <mptcpd/private/subflow_scheduler.h>
+
+
+/**
+ * @brief Time in milliseconds after which an unanswered join no
+ *        longer holds a scheduling slot.
+ *
+ * Covers the initial SYN and a few retransmissions.
+ */
+#define SCHED_JOIN_TIMEOUT_MS 10000
+
+// ----------------------------------------------------------------------
+
+/**
+ * @struct sched_entry
+ *
+ * @brief Queued or in-flight subflow creation request.
+ */
+struct sched_entry
+{
+        /// Subflow creation request.
+        struct mptcpd_sched_request req;
+
+        /// Network interface index of the local address, or zero.
+        int index;
+
+        /// Monotonic time (microseconds) before which not to issue.
+        uint64_t not_before;
+
+        /// Monotonic time (microseconds) the request was issued.
+        uint64_t issued;
+
+        /// Scheduling weight, refreshed on each scheduling pass.
+        uint64_t weight;
+};
+
+/**
+ * @struct mptcpd_sched
+ *
+ * @brief Internal mptcpd subflow creation scheduler data.
+ */
+struct mptcpd_sched
+{
+        /// Scheduler parameters.
+        struct mptcpd_sched_limits limits;
+
+        /// Scheduler callbacks.
+        struct mptcpd_sched_ops const *ops;
+
+        /// Data passed to the scheduler callbacks.
+        void *user_data;
+
+        /// Queued requests (@c struct @c sched_entry), oldest first.
+        struct l_queue *pending;
+
+        /// Issued requests (@c struct @c sched_entry) awaiting a join.
+        struct l_queue *inflight;
+
+        /// Timer armed for the next jittered request or join timeout.
+        struct l_timeout *timer;
+
+        /// Scheduler statistics.
+        struct mptcpd_sched_stats stats;
+};
+
+// ----------------------------------------------------------------------
+
+static bool sched_is_enabled(struct mptcpd_sched const *sched)
+{
+        return sched->limits.per_interface != 0
+                || sched->limits.per_destination != 0
+                || sched->limits.jitter != 0;
+}
+
+static bool sched_ip_match(struct sockaddr const *a,
+                           struct sockaddr const *b)
+{
+        if (a->sa_family != b->sa_family)
+                return false;
+
+        if (a->sa_family == AF_INET) {
+                struct sockaddr_in const *const a4 =
+                        (struct sockaddr_in const *) a;
+                struct sockaddr_in const *const b4 =
+                        (struct sockaddr_in const *) b;
+
+                return a4->sin_addr.s_addr == b4->sin_addr.s_addr;
+        }
+
+        struct sockaddr_in6 const *const a6 =
+                (struct sockaddr_in6 const *) a;
+        struct sockaddr_in6 const *const b6 =
+                (struct sockaddr_in6 const *) b;
+
+        return memcmp(&a6->sin6_addr,
+                      &b6->sin6_addr,
+                      sizeof(a6->sin6_addr)) == 0;
+}
+
+/**
+ * @struct sched_slot_data
+ *
+ * @brief In-flight join count for a given interface and destination.
+ */
+struct sched_slot_data
+{
+        /// Request whose slot is being checked.          (IN)
+        struct sched_entry const *const entry;
+
+        /// In-flight joins through the same interface.   (OUT)
+        unsigned int interface;
+
+        /// In-flight joins to the same destination.      (OUT)
+        unsigned int destination;
+};
+
+static void sched_count_slot(void *data, void *user_data)
+{
+        struct sched_entry const *const e = data;
+        struct sched_slot_data *const d = user_data;
+
+        if (e->index != 0 && e->index == d->entry->index)
+                ++d->interface;
+
+        if (sched_ip_match((struct sockaddr const *) &e->req.raddr,
+                           (struct sockaddr const *) &d->entry->req.raddr))
+                ++d->destination;
+}
+
+static bool sched_has_slot(struct mptcpd_sched const *sched,
+                           struct sched_entry const *entry)
+{
+        struct sched_slot_data data = { .entry = entry };
+
+        l_queue_foreach(sched->inflight, sched_count_slot, &data);
+
+        unsigned int const if_limit  = sched->limits.per_interface;
+        unsigned int const dst_limit = sched->limits.per_destination;
+
+        return (if_limit == 0 || entry->index == 0
+                || data.interface < if_limit)
+                && (dst_limit == 0 || data.destination < dst_limit);
+}
+
+static void sched_record_latency(struct mptcpd_sched *sched,
+                                 uint64_t usec)
+{
+        uint64_t const msec = usec / L_USEC_PER_MSEC;
+        size_t const last = L_ARRAY_SIZE(sched->stats.latency) - 1;
+        size_t i = 0;
+
+        while (i < last && msec >= (UINT64_C(1) << i))
+                ++i;
+
+        ++sched->stats.latency[i];
+}
+
+static int sched_issue(struct mptcpd_sched *sched,
+                       struct sched_entry *entry)
+{
+        int const result = sched->ops->issue(&entry->req,
+                                             sched->user_data);
+
+        if (result != 0) {
+                ++sched->stats.failed;
+                l_free(entry);
+
+                return result;
+        }
+
+        ++sched->stats.issued;
+        entry->issued = l_time_now();
+
+        if (!l_queue_push_tail(sched->inflight, entry))
+                l_free(entry);
+
+        return 0;
+}
+
+static bool sched_expire_join(void *data, void *user_data)
+{
+        struct sched_entry *const e = data;
+        struct mptcpd_sched *const sched = user_data;
+        uint64_t const deadline =
+                e->issued + SCHED_JOIN_TIMEOUT_MS * L_USEC_PER_MSEC;
+
+        if (deadline > l_time_now())
+                return false;
+
+        l_debug("subflow join for token 0x%" PRIx32 " timed out",
+                e->req.token);
+
+        ++sched->stats.failed;
+        l_free(e);
+
+        return true;
+}
+
+static void sched_update_weight(void *data, void *user_data)
+{
+        struct sched_entry *const e = data;
+        struct mptcpd_sched const *const sched = user_data;
+
+        e->weight = sched->ops->get_weight == NULL
+                ? 0
+                : sched->ops->get_weight(e->req.token, sched->user_data);
+}
+
+/**
+ * @struct sched_pick_data
+ *
+ * @brief Next request to issue, and next time to run the scheduler.
+ */
+struct sched_pick_data
+{
+        /// Subflow creation scheduler.                   (IN)
+        struct mptcpd_sched const *const sched;
+
+        /// Current monotonic time in microseconds.       (IN)
+        uint64_t const now;
+
+        /// Heaviest request that may be issued now.      (OUT)
+        struct sched_entry *best;
+
+        /// Earliest time a jittered request is due.       (OUT)
+        uint64_t wakeup;
+};
+
+static void sched_pick(void *data, void *user_data)
+{
+        struct sched_entry *const e = data;
+        struct sched_pick_data *const d = user_data;
+
+        if (e->not_before > d->now) {
+                if (e->not_before < d->wakeup)
+                        d->wakeup = e->not_before;
+
+                return;
+        }
+
+        // Ties are resolved in favor of the oldest request.
+        if ((d->best == NULL || e->weight > d->best->weight)
+            && sched_has_slot(d->sched, e))
+                d->best = e;
+}
+
+static void sched_oldest_join(void *data, void *user_data)
+{
+        struct sched_entry const *const e = data;
+        uint64_t *const wakeup = user_data;
+        uint64_t const deadline =
+                e->issued + SCHED_JOIN_TIMEOUT_MS * L_USEC_PER_MSEC;
+
+        if (deadline < *wakeup)
+                *wakeup = deadline;
+}
+
+static void sched_run(struct mptcpd_sched *sched);
+
+static void sched_timeout(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+
+        mptcpd_loopmon_enter("sched", 0);
+
+        sched_run(user_data);
+
+        mptcpd_loopmon_leave();
+}
+
+static void sched_arm(struct mptcpd_sched *sched,
+                      uint64_t now,
+                      uint64_t wakeup)
+{
+        if (wakeup == UINT64_MAX)
+                return;
+
+        // l_timeout does not accept a zero timeout.
+        uint64_t const msec =
+                wakeup > now
+                ? (wakeup - now + L_USEC_PER_MSEC - 1) / L_USEC_PER_MSEC
+                : 1;
+
+        if (sched->timer == NULL)
+                sched->timer = l_timeout_create_ms(msec,
+                                                   sched_timeout,
+                                                   sched,
+                                                   NULL);
+        else
+                l_timeout_modify_ms(sched->timer, msec);
+}
+
+/**
+ * @brief Issue queued requests allowed by the scheduler limits.
+ *
+ * The heaviest eligible request is issued first, until no queued
+ * request is eligible.
+ */
+static void sched_run(struct mptcpd_sched *sched)
+{
+        (void) l_queue_foreach_remove(sched->inflight,
+                                      sched_expire_join,
+                                      sched);
+
+        l_queue_foreach(sched->pending, sched_update_weight, sched);
+
+        uint64_t const now = l_time_now();
+        uint64_t wakeup = UINT64_MAX;
+
+        for (;;) {
+                struct sched_pick_data data = {
+                        .sched  = sched,
+                        .now    = now,
+                        .wakeup = UINT64_MAX
+                };
+
+                l_queue_foreach(sched->pending, sched_pick, &data);
+
+                wakeup = data.wakeup;
+
+                if (data.best == NULL)
+                        break;
+
+                (void) l_queue_remove(sched->pending, data.best);
+
+                ++sched->stats.deferred;
+
+                int const result = sched_issue(sched, data.best);
+
+                if (result != 0)
+                        l_warn("Unable to issue deferred subflow "
+                               "creation request: %s",
+                               strerror(result));
+        }
+
+        l_queue_foreach(sched->inflight, sched_oldest_join, &wakeup);
+
+        sched_arm(sched, now, wakeup);
+}
+
+static bool sched_entry_token_match(void *data, void *user_data)
+{
+        struct sched_entry *const e = data;
+        mptcpd_token_t const token = L_PTR_TO_UINT(user_data);
+
+        if (e->req.token != token)
+                return false;
+
+        l_free(e);
+
+        return true;
+}
+
+/**
+ * @struct sched_join
+ *
+ * @brief Subflow join looked up among in-flight requests.
+ */
+struct sched_join
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// Subflow local address.
+        struct sockaddr const *laddr;
+
+        /// Subflow remote address.
+        struct sockaddr const *raddr;
+};
+
+static bool sched_join_match(void const *a, void const *b)
+{
+        struct sched_entry const *const e = a;
+        struct sched_join const *const j = b;
+        struct sockaddr const *const laddr =
+                (struct sockaddr const *) &e->req.laddr;
+
+        return e->req.token == j->token
+                && sched_ip_match(
+                        (struct sockaddr const *) &e->req.raddr,
+                        j->raddr)
+                && (laddr->sa_family == AF_UNSPEC
+                    || sched_ip_match(laddr, j->laddr));
+}
+
+// ----------------------------------------------------------------------
+
+struct mptcpd_sched *mptcpd_sched_create(
+        struct mptcpd_sched_limits const *limits,
+        struct mptcpd_sched_ops const *ops,
+        void *user_data)
+{
+        if (limits == NULL
+            || ops == NULL
+            || ops->issue == NULL
+            || ops->get_index == NULL)
+                return NULL;
+
+        struct mptcpd_sched *const sched = l_new(struct mptcpd_sched, 1);
+
+        sched->limits    = *limits;
+        sched->ops       = ops;
+        sched->user_data = user_data;
+        sched->pending   = l_queue_new();
+        sched->inflight  = l_queue_new();
+
+        return sched;
+}
+
+void mptcpd_sched_destroy(struct mptcpd_sched *sched)
+{
+        if (sched == NULL)
+                return;
+
+        if (sched_is_enabled(sched) && sched->stats.issued != 0) {
+                struct mptcpd_sched_stats const *const s = &sched->stats;
+                uint64_t const joins = s->established;
+                uint64_t const rank = joins - joins / 100;
+                uint64_t seen = 0;
+                size_t i = 0;
+
+                // Upper bound of the 99th percentile join latency.
+                while (i < L_ARRAY_SIZE(s->latency) - 1
+                       && (seen += s->latency[i]) < rank)
+                        ++i;
+
+                l_info("subflow scheduler: %" PRIu64 " issued "
+                       "(%" PRIu64 " deferred), %" PRIu64 " established, "
+                       "%" PRIu64 " failed, p99 join latency < %" PRIu64
+                       " ms",
+                       s->issued,
+                       s->deferred,
+                       s->established,
+                       s->failed,
+                       UINT64_C(1) << i);
+        }
+
+        l_timeout_remove(sched->timer);
+        l_queue_destroy(sched->inflight, l_free);
+        l_queue_destroy(sched->pending, l_free);
+        l_free(sched);
+}
+
+void mptcpd_sched_set_limits(struct mptcpd_sched *sched,
+                             struct mptcpd_sched_limits const *limits)
+{
+        if (sched == NULL || limits == NULL)
+                return;
+
+        sched->limits = *limits;
+
+        sched_run(sched);
+}
+
+int mptcpd_sched_add_subflow(struct mptcpd_sched *sched,
+                             struct mptcpd_sched_request const *req)
+{
+        if (sched == NULL || req == NULL)
+                return EINVAL;
+
+        // Pass the request through untracked if scheduling is off.
+        if (!sched_is_enabled(sched))
+                return sched->ops->issue(req, sched->user_data);
+
+        struct sched_entry *const entry = l_new(struct sched_entry, 1);
+
+        entry->req = *req;
+
+        if (req->laddr.ss_family != AF_UNSPEC)
+                entry->index = sched->ops->get_index(
+                        (struct sockaddr const *) &req->laddr,
+                        sched->user_data);
+
+        /*
+          Issue the request right away, reporting errors to the
+          caller, if nothing is queued ahead of it and a slot is
+          available.
+        */
+        if (sched->limits.jitter == 0
+            && l_queue_isempty(sched->pending)
+            && sched_has_slot(sched, entry)) {
+                int const result = sched_issue(sched, entry);
+
+                if (result == 0)
+                        sched_run(sched);  // Arm the join timeout.
+
+                return result;
+        }
+
+        if (sched->limits.jitter != 0)
+                entry->not_before =
+                        l_time_now()
+                        + (l_getrandom_uint32() % sched->limits.jitter)
+                        * L_USEC_PER_MSEC;
+
+        if (!l_queue_push_tail(sched->pending, entry)) {
+                l_free(entry);
+
+                return ENOMEM;
+        }
+
+        sched_run(sched);
+
+        return 0;
+}
+
+void mptcpd_sched_complete(struct mptcpd_sched *sched,
+                           mptcpd_token_t token,
+                           struct sockaddr const *laddr,
+                           struct sockaddr const *raddr,
+                           bool established)
+{
+        if (sched == NULL || laddr == NULL || raddr == NULL)
+                return;
+
+        struct sched_join const join = {
+                .token = token,
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        struct sched_entry *const e =
+                l_queue_remove_if(sched->inflight, sched_join_match, &join);
+
+        if (e == NULL)
+                return;
+
+        if (established) {
+                ++sched->stats.established;
+                sched_record_latency(sched, l_time_now() - e->issued);
+        } else {
+                ++sched->stats.failed;
+        }
+
+        l_free(e);
+
+        sched_run(sched);
+}
+
+void mptcpd_sched_cancel(struct mptcpd_sched *sched, mptcpd_token_t token)
+{
+        if (sched == NULL)
+                return;
+
+        unsigned int const dropped =
+                l_queue_foreach_remove(sched->pending,
+                                       sched_entry_token_match,
+                                       L_UINT_TO_PTR(token))
+                + l_queue_foreach_remove(sched->inflight,
+                                         sched_entry_token_match,
+                                         L_UINT_TO_PTR(token));
+
+        if (dropped != 0)
+                sched_run(sched);
+}
+
+struct mptcpd_sched_stats const *
+mptcpd_sched_get_stats(struct mptcpd_sched const *sched)
+{
+        return sched == NULL ? NULL : &sched->stats;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,1057 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file failover.c
+ *
+ * @brief MPTCP fast failover path manager plugin.
+ *
+ * React to network interfaces going down by immediately dropping the
+ * subflows through them and switching traffic to subflows through
+ * the remaining network interfaces, rather than waiting for TCP to
+ * time out the lost subflows.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>  // For NDEBUG and mptcpd VERSION.
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/id_manager.h>
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/path_manager.h>
+#include <mptcpd/plugin.h>
+
+
+/**
+ * @brief Format version of the exported connection state.
+ *
+ * The exported state is a @c failover_state object followed by its
+ * @c failover_subflow_state objects.
+ */
+#define FAILOVER_STATE_VERSION 1
+
+struct failover_connection;
+
+/**
+ * @struct failover_subflow
+ *
+ * @brief MPTCP subflow tracked by this plugin.
+ */
+struct failover_subflow
+{
+        /// Local address and port.
+        struct sockaddr_storage laddr;
+
+        /// Remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Network interface index corresponding to @c laddr.
+        int index;
+
+        /// Current subflow backup priority.
+        bool backup;
+
+        /**
+         * @brief The network interface of the subflow went down.
+         *
+         * Lost subflows are only kept, as backup subflows, while
+         * they are the last subflows of the connection.
+         */
+        bool lost;
+
+        /// MPTCP connection the subflow belongs to.
+        struct failover_connection *conn;
+};
+
+/**
+ * @struct failover_connection
+ *
+ * @brief MPTCP connection state.
+ */
+struct failover_connection
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// Local address of the initial subflow.
+        struct sockaddr_storage laddr;
+
+        /// Remote address of the initial subflow.
+        struct sockaddr_storage raddr;
+
+        /// List of @c failover_subflow objects.
+        struct l_queue *subflows;
+
+        /**
+         * @brief Monotonic time the ongoing failover started at, in
+         *        microseconds.
+         *
+         * Zero if no failover is in progress.
+         */
+        uint64_t failover_start;
+
+        /// Pointer to path manager.
+        struct mptcpd_pm *pm;
+};
+
+/**
+ * @struct failover_state
+ *
+ * @brief Exported MPTCP connection state.
+ */
+struct failover_state
+{
+        /// Local address of the initial subflow.
+        struct sockaddr_storage laddr;
+
+        /// Remote address of the initial subflow.
+        struct sockaddr_storage raddr;
+
+        /// Monotonic start time of the ongoing failover, if any.
+        uint64_t failover_start;
+
+        /// Number of @c failover_subflow_state objects that follow.
+        uint32_t subflows;
+};
+
+/**
+ * @struct failover_subflow_state
+ *
+ * @brief Exported MPTCP subflow state.
+ */
+struct failover_subflow_state
+{
+        /// Local address and port.
+        struct sockaddr_storage laddr;
+
+        /// Remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Network interface index corresponding to @c laddr.
+        int32_t index;
+
+        /// Current subflow backup priority.
+        uint8_t backup;
+
+        /// The network interface of the subflow went down.
+        uint8_t lost;
+};
+
+/**
+ * @brief Map of MPTCP connection token to @c failover_connection.
+ *
+ * Only client side connections are tracked.
+ */
+static struct l_hashmap *failover_connections;
+
+/**
+ * @brief Map of network interface index to subflows.
+ *
+ * Each entry is a list of pointers to the @c failover_subflow
+ * objects, owned by their connection, going through the network
+ * interface.
+ */
+static struct l_hashmap *failover_index;
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Match the IP addresses of two @c sockaddr objects.
+ *
+ * @param[in] a     Address to compare.
+ * @param[in] b     Address to compare.
+ * @param[in] ports Compare the ports of @a a and @a b as well.
+ *
+ * @return @c true if the @c family and IP address in @a a and @a b
+ *         match, and @c false otherwise.
+ */
+static bool failover_sockaddr_match(struct sockaddr const *a,
+                                    struct sockaddr const *b,
+                                    bool ports)
+{
+        assert(a);
+        assert(b);
+
+        if (a->sa_family != b->sa_family)
+                return false;
+
+        if (a->sa_family == AF_INET) {
+                struct sockaddr_in const *const l =
+                        (struct sockaddr_in const *) a;
+                struct sockaddr_in const *const r =
+                        (struct sockaddr_in const *) b;
+
+                return l->sin_addr.s_addr == r->sin_addr.s_addr
+                        && (!ports || l->sin_port == r->sin_port);
+        } else if (a->sa_family == AF_INET6) {
+                struct sockaddr_in6 const *const l =
+                        (struct sockaddr_in6 const *) a;
+                struct sockaddr_in6 const *const r =
+                        (struct sockaddr_in6 const *) b;
+
+                return memcmp(&l->sin6_addr,
+                              &r->sin6_addr,
+                              sizeof(l->sin6_addr)) == 0
+                        && (!ports || l->sin6_port == r->sin6_port);
+        }
+
+        return false;
+}
+
+/**
+ * @brief Copy a @c sockaddr to a @c sockaddr_storage object.
+ *
+ * @param[in]  src       Source IPv4 or IPv6 address.
+ * @param[out] dst       Destination storage.
+ * @param[in]  keep_port Retain the @a src port, otherwise clear it.
+ */
+static void failover_sockaddr_copy(struct sockaddr const *src,
+                                   struct sockaddr_storage *dst,
+                                   bool keep_port)
+{
+        memset(dst, 0, sizeof(*dst));
+
+        if (src->sa_family == AF_INET) {
+                struct sockaddr_in *const in = (struct sockaddr_in *) dst;
+
+                memcpy(in, src, sizeof(*in));
+
+                if (!keep_port)
+                        in->sin_port = 0;
+        } else if (src->sa_family == AF_INET6) {
+                struct sockaddr_in6 *const in6 =
+                        (struct sockaddr_in6 *) dst;
+
+                memcpy(in6, src, sizeof(*in6));
+
+                if (!keep_port)
+                        in6->sin6_port = 0;
+        }
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @struct failover_index_data
+ *
+ * @brief Type used to return index associated with local address.
+ */
+struct failover_index_data
+{
+        /// Local address information.        (IN)
+        struct sockaddr const *const addr;
+
+        /// Network interface (link) index.   (OUT)
+        int index;
+};
+
+static bool failover_addr_match(void const *a, void const *b)
+{
+        return failover_sockaddr_match(a, b, false);
+}
+
+static void failover_get_index(struct mptcpd_interface const *i,
+                               void *data)
+{
+        struct failover_index_data *const d = data;
+
+        if (d->index == 0
+            && l_queue_find(i->addrs, failover_addr_match, d->addr))
+                d->index = i->index;
+}
+
+/**
+ * @brief Reverse lookup network interface index from IP address.
+ *
+ * @return Index of the network interface with address @a addr, or
+ *         zero if no such interface is tracked by the network
+ *         monitor.
+ */
+static int failover_addr_to_index(struct mptcpd_pm const *pm,
+                                  struct sockaddr const *addr)
+{
+        struct failover_index_data data = { .addr = addr, .index = 0 };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(pm),
+                                    failover_get_index,
+                                    &data);
+
+        return data.index;
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @struct failover_pair
+ *
+ * @brief Address pair used to look up a @c failover_subflow.
+ */
+struct failover_pair
+{
+        /// Local address.
+        struct sockaddr const *laddr;
+
+        /// Remote address.
+        struct sockaddr const *raddr;
+};
+
+static bool failover_subflow_match(void const *a, void const *b)
+{
+        struct failover_subflow const *const sf = a;
+        struct failover_pair const *const pair = b;
+
+        return failover_sockaddr_match(
+                        (struct sockaddr const *) &sf->laddr,
+                        pair->laddr,
+                        true)
+                && failover_sockaddr_match(
+                        (struct sockaddr const *) &sf->raddr,
+                        pair->raddr,
+                        true);
+}
+
+static void failover_index_add(struct failover_subflow *sf)
+{
+        struct l_queue *subflows =
+                l_hashmap_lookup(failover_index,
+                                 L_INT_TO_PTR(sf->index));
+
+        if (subflows == NULL) {
+                subflows = l_queue_new();
+
+                l_hashmap_insert(failover_index,
+                                 L_INT_TO_PTR(sf->index),
+                                 subflows);
+        }
+
+        l_queue_push_tail(subflows, sf);
+}
+
+static void failover_index_remove(struct failover_subflow *sf)
+{
+        struct l_queue *const subflows =
+                l_hashmap_lookup(failover_index,
+                                 L_INT_TO_PTR(sf->index));
+
+        if (subflows == NULL)
+                return;
+
+        (void) l_queue_remove(subflows, sf);
+
+        if (l_queue_isempty(subflows)) {
+                (void) l_hashmap_remove(failover_index,
+                                        L_INT_TO_PTR(sf->index));
+                l_queue_destroy(subflows, NULL);
+        }
+}
+
+static void failover_subflow_add(struct failover_connection *conn,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool backup)
+{
+        struct failover_subflow *const sf =
+                l_new(struct failover_subflow, 1);
+
+        failover_sockaddr_copy(laddr, &sf->laddr, true);
+        failover_sockaddr_copy(raddr, &sf->raddr, true);
+        sf->index  = failover_addr_to_index(conn->pm, laddr);
+        sf->backup = backup;
+        sf->conn   = conn;
+
+        l_queue_push_tail(conn->subflows, sf);
+        failover_index_add(sf);
+}
+
+static void failover_subflow_destroy(void *data)
+{
+        struct failover_subflow *const sf = data;
+
+        failover_index_remove(sf);
+        l_free(sf);
+}
+
+static void failover_connection_destroy(void *data)
+{
+        struct failover_connection *const conn = data;
+
+        if (conn == NULL)
+                return;
+
+        l_queue_destroy(conn->subflows, failover_subflow_destroy);
+        l_free(conn);
+}
+
+static struct failover_connection *
+failover_connection_lookup(mptcpd_token_t token)
+{
+        return l_hashmap_lookup(failover_connections,
+                                L_UINT_TO_PTR(token));
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Record completion of a failover on @a conn.
+ */
+static void failover_complete(struct failover_connection *conn)
+{
+        if (conn->failover_start == 0)
+                return;
+
+        uint64_t const elapsed =
+                l_time_diff(conn->failover_start, l_time_now());
+
+        conn->failover_start = 0;
+
+        mptcpd_pm_failover_completed(conn->pm, elapsed);
+
+        l_info("token 0x%" PRIx32 ": failover completed in %" PRIu64
+               " us",
+               conn->token,
+               elapsed);
+}
+
+static bool failover_remove_lost(void *data, void *user_data)
+{
+        struct failover_subflow *const sf = data;
+        struct failover_connection *const conn = user_data;
+
+        if (!sf->lost)
+                return false;
+
+        if (mptcpd_pm_remove_subflow(conn->pm,
+                                     conn->token,
+                                     (struct sockaddr const *) &sf->laddr,
+                                     (struct sockaddr const *) &sf->raddr)
+            != 0)
+                l_warn("token 0x%" PRIx32 ": unable to remove subflow "
+                       "on lost interface %d",
+                       conn->token,
+                       sf->index);
+
+        failover_subflow_destroy(sf);
+
+        return true;
+}
+
+static bool failover_is_usable(void const *data, void const *user_data)
+{
+        (void) user_data;
+
+        struct failover_subflow const *const sf = data;
+
+        return !sf->lost;
+}
+
+static bool failover_is_active(void const *data, void const *user_data)
+{
+        (void) user_data;
+
+        struct failover_subflow const *const sf = data;
+
+        return !sf->lost && !sf->backup;
+}
+
+/**
+ * @brief Promote a surviving backup subflow to carry traffic.
+ *
+ * @return @c true if a subflow on a healthy network interface now
+ *         carries regular traffic, and @c false otherwise.
+ */
+static bool failover_promote(struct failover_connection *conn)
+{
+        if (l_queue_find(conn->subflows, failover_is_active, NULL))
+                return true;
+
+        struct failover_subflow *const sf =
+                l_queue_find(conn->subflows, failover_is_usable, NULL);
+
+        if (sf == NULL)
+                return false;
+
+        if (mptcpd_pm_set_backup(conn->pm,
+                                 conn->token,
+                                 (struct sockaddr const *) &sf->laddr,
+                                 (struct sockaddr const *) &sf->raddr,
+                                 false) != 0) {
+                l_warn("token 0x%" PRIx32 ": unable to promote backup "
+                       "subflow",
+                       conn->token);
+
+                return false;
+        }
+
+        sf->backup = false;
+
+        return true;
+}
+
+/**
+ * @struct failover_replace_data
+ *
+ * @brief State passed through the replacement subflow search.
+ */
+struct failover_replace_data
+{
+        /// MPTCP connection.
+        struct failover_connection *const conn;
+
+        /// Network interface that went down.
+        int lost_index;
+
+        /// A replacement subflow was requested.
+        bool requested;
+};
+
+static void failover_replace_addr(void *data, void *user_data)
+{
+        struct sockaddr const *const laddr = data;
+        struct failover_replace_data *const replace = user_data;
+        struct failover_connection *const conn = replace->conn;
+        struct sockaddr const *const raddr =
+                (struct sockaddr const *) &conn->raddr;
+
+        if (replace->requested || laddr->sa_family != raddr->sa_family)
+                return;
+
+        /*
+          The local address of the initial subflow already has address
+          ID zero, as far as the kernel is concerned.
+        */
+        mptcpd_aid_t local_id = 0;
+
+        if (!failover_sockaddr_match(laddr,
+                                     (struct sockaddr const *) &conn->laddr,
+                                     false)) {
+                local_id = mptcpd_idm_get_id(mptcpd_pm_get_idm(conn->pm),
+                                             laddr);
+
+                if (local_id == 0)
+                        return;
+        }
+
+        struct sockaddr_storage local;
+
+        failover_sockaddr_copy(laddr, &local, false);
+
+        replace->requested =
+                mptcpd_pm_add_subflow(conn->pm,
+                                      conn->token,
+                                      local_id,
+                                      0,  // Initial remote address.
+                                      (struct sockaddr const *) &local,
+                                      raddr,
+                                      false) == 0;
+}
+
+static void failover_replace_interface(struct mptcpd_interface const *i,
+                                       void *data)
+{
+        struct failover_replace_data *const replace = data;
+
+        if (i->index != replace->lost_index)
+                l_queue_foreach(i->addrs, failover_replace_addr, replace);
+}
+
+/**
+ * @brief Move traffic of @a conn away from a lost network interface.
+ *
+ * Subflows through the lost interface are removed right away unless
+ * they are the last ones of the connection, in which case they are
+ * demoted to backup until a replacement subflow through a healthy
+ * interface is established.
+ *
+ * @param[in,out] conn  MPTCP connection.
+ * @param[in]     index Index of the lost network interface.
+ */
+static void failover_connection(struct failover_connection *conn,
+                                int index)
+{
+        if (conn->failover_start == 0) {
+                conn->failover_start = l_time_now();
+                mptcpd_pm_failover_started(conn->pm);
+        }
+
+        if (l_queue_find(conn->subflows, failover_is_usable, NULL)) {
+                // Healthy subflows remain.  Drop the lost ones now.
+                l_queue_foreach_remove(conn->subflows,
+                                       failover_remove_lost,
+                                       conn);
+
+                if (failover_promote(conn)) {
+                        failover_complete(conn);
+
+                        return;
+                }
+        } else {
+                for (struct l_queue_entry const *entry =
+                             l_queue_get_entries(conn->subflows);
+                     entry != NULL;
+                     entry = entry->next) {
+                        struct failover_subflow *const sf = entry->data;
+
+                        if (sf->backup)
+                                continue;
+
+                        if (mptcpd_pm_set_backup(
+                                    conn->pm,
+                                    conn->token,
+                                    (struct sockaddr const *) &sf->laddr,
+                                    (struct sockaddr const *) &sf->raddr,
+                                    true) == 0)
+                                sf->backup = true;
+                }
+        }
+
+        struct failover_replace_data data = {
+                .conn       = conn,
+                .lost_index = index
+        };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(conn->pm),
+                                    failover_replace_interface,
+                                    &data);
+
+        if (!data.requested)
+                l_warn("token 0x%" PRIx32 ": no healthy interface "
+                       "available for failover",
+                       conn->token);
+}
+
+static bool failover_conn_match(void const *a, void const *b)
+{
+        return a == b;
+}
+
+/**
+ * @brief Fail over all connections with subflows through a network
+ *        interface.
+ *
+ * @param[in] index Index of the lost network interface.
+ */
+static void failover_interface(int index)
+{
+        struct l_queue *const subflows =
+                l_hashmap_lookup(failover_index, L_INT_TO_PTR(index));
+
+        if (subflows == NULL)
+                return;
+
+        struct l_queue *const conns = l_queue_new();
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries(subflows);
+             entry != NULL;
+             entry = entry->next) {
+                struct failover_subflow *const sf = entry->data;
+
+                /*
+                  Loss of carrier is followed by removal of the
+                  network interface.  Don't fail over twice.
+                */
+                if (sf->lost)
+                        continue;
+
+                sf->lost = true;
+
+                if (l_queue_find(conns, failover_conn_match, sf->conn)
+                    == NULL)
+                        l_queue_push_tail(conns, sf->conn);
+        }
+
+        /*
+          The index entry may be released while failing over, since
+          lost subflows are removed from it.  Iterate over the
+          affected connections instead.
+        */
+        while (!l_queue_isempty(conns))
+                failover_connection(l_queue_pop_head(conns), index);
+
+        l_queue_destroy(conns, NULL);
+}
+
+// ----------------------------------------------------------------
+//                     Mptcpd Plugin Operations
+// ----------------------------------------------------------------
+
+static void failover_new_connection(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool server_side,
+                                    struct mptcpd_pm *pm)
+{
+        /**
+         * @note Only the client side creates replacement subflows.
+         *       Subflows initiated by a server are commonly blocked by
+         *       middleboxes, such as NATs and firewalls.
+         */
+        if (server_side || failover_connection_lookup(token) != NULL)
+                return;
+
+        struct failover_connection *const conn =
+                l_new(struct failover_connection, 1);
+
+        conn->token    = token;
+        conn->subflows = l_queue_new();
+        conn->pm       = pm;
+
+        failover_sockaddr_copy(laddr, &conn->laddr, false);
+        failover_sockaddr_copy(raddr, &conn->raddr, true);
+
+        if (!l_hashmap_insert(failover_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                l_error("Unable to track connection 0x%" PRIx32 ".",
+                        token);
+                failover_connection_destroy(conn);
+
+                return;
+        }
+
+        // The initial subflow.
+        failover_subflow_add(conn, laddr, raddr, false);
+}
+
+static void failover_connection_closed(mptcpd_token_t token,
+                                       struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        failover_connection_destroy(
+                l_hashmap_remove(failover_connections,
+                                 L_UINT_TO_PTR(token)));
+}
+
+static void failover_new_subflow(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool backup,
+                                 struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct failover_connection *const conn =
+                failover_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct failover_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        if (l_queue_find(conn->subflows, failover_subflow_match, &pair))
+                return;
+
+        failover_subflow_add(conn, laddr, raddr, backup);
+
+        if (conn->failover_start == 0)
+                return;
+
+        // The replacement subflow is up.  Drop the lost ones.
+        l_queue_foreach_remove(conn->subflows,
+                               failover_remove_lost,
+                               conn);
+
+        if (failover_promote(conn))
+                failover_complete(conn);
+}
+
+static void failover_subflow_closed(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool backup,
+                                    struct mptcpd_pm *pm)
+{
+        (void) backup;
+        (void) pm;
+
+        struct failover_connection *const conn =
+                failover_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct failover_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        struct failover_subflow *const sf =
+                l_queue_remove_if(conn->subflows,
+                                  failover_subflow_match,
+                                  &pair);
+
+        if (sf != NULL)
+                failover_subflow_destroy(sf);
+}
+
+static void failover_subflow_priority(mptcpd_token_t token,
+                                      struct sockaddr const *laddr,
+                                      struct sockaddr const *raddr,
+                                      bool backup,
+                                      struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct failover_connection *const conn =
+                failover_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct failover_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        struct failover_subflow *const sf =
+                l_queue_find(conn->subflows,
+                             failover_subflow_match,
+                             &pair);
+
+        if (sf != NULL)
+                sf->backup = backup;
+}
+
+static void failover_delete_interface(struct mptcpd_interface const *i,
+                                      struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        /*
+          The network monitor stops monitoring network interfaces,
+          and reports them as deleted, as soon as they are no longer
+          up and running.
+        */
+        l_debug("interface %s (%d) lost, failing over",
+                i->name,
+                i->index);
+
+        failover_interface(i->index);
+}
+
+static void failover_link_state_changed(struct mptcpd_interface const *i,
+                                        struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        /*
+          Fail over as soon as the carrier is lost, e.g. a pulled
+          cable or a dropped wireless link, rather than once the
+          network monitor stops monitoring the network interface.
+        */
+        if (i->carrier)
+                return;
+
+        l_debug("interface %s (%d) lost carrier, failing over",
+                i->name,
+                i->index);
+
+        failover_interface(i->index);
+}
+
+static void *failover_export_state(mptcpd_token_t token,
+                                   uint32_t *version,
+                                   size_t *len,
+                                   struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct failover_connection const *const conn =
+                failover_connection_lookup(token);
+
+        if (conn == NULL)
+                return NULL;
+
+        struct failover_state state;
+
+        memset(&state, 0, sizeof(state));
+        state.laddr          = conn->laddr;
+        state.raddr          = conn->raddr;
+        state.failover_start = conn->failover_start;
+        state.subflows       = l_queue_length(conn->subflows);
+
+        size_t const size =
+                sizeof(state)
+                + state.subflows * sizeof(struct failover_subflow_state);
+
+        uint8_t *const data = l_malloc(size);
+        uint8_t *p = data;
+
+        memcpy(p, &state, sizeof(state));
+        p += sizeof(state);
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(conn->subflows);
+             e != NULL;
+             e = e->next) {
+                struct failover_subflow const *const sf = e->data;
+                struct failover_subflow_state sf_state;
+
+                memset(&sf_state, 0, sizeof(sf_state));
+                sf_state.laddr  = sf->laddr;
+                sf_state.raddr  = sf->raddr;
+                sf_state.index  = sf->index;
+                sf_state.backup = sf->backup;
+                sf_state.lost   = sf->lost;
+
+                memcpy(p, &sf_state, sizeof(sf_state));
+                p += sizeof(sf_state);
+        }
+
+        *version = FAILOVER_STATE_VERSION;
+        *len     = size;
+
+        return data;
+}
+
+static bool failover_import_state(mptcpd_token_t token,
+                                  uint32_t version,
+                                  void const *state,
+                                  size_t len,
+                                  struct mptcpd_pm *pm)
+{
+        struct failover_state s;
+
+        if (version != FAILOVER_STATE_VERSION
+            || len < sizeof(s)
+            || failover_connection_lookup(token) != NULL)
+                return false;
+
+        // The state is not necessarily aligned.
+        memcpy(&s, state, sizeof(s));
+
+        size_t const left = len - sizeof(s);
+
+        if (s.subflows > left / sizeof(struct failover_subflow_state)
+            || left != s.subflows * sizeof(struct failover_subflow_state))
+                return false;
+
+        struct failover_connection *const conn =
+                l_new(struct failover_connection, 1);
+
+        conn->token          = token;
+        conn->laddr          = s.laddr;
+        conn->raddr          = s.raddr;
+        conn->failover_start = s.failover_start;
+        conn->subflows       = l_queue_new();
+        conn->pm             = pm;
+
+        if (!l_hashmap_insert(failover_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                failover_connection_destroy(conn);
+
+                return false;
+        }
+
+        uint8_t const *p = (uint8_t const *) state + sizeof(s);
+
+        for (uint32_t i = 0; i < s.subflows; ++i) {
+                struct failover_subflow_state sf_state;
+
+                memcpy(&sf_state, p, sizeof(sf_state));
+                p += sizeof(sf_state);
+
+                struct failover_subflow *const sf =
+                        l_new(struct failover_subflow, 1);
+
+                sf->laddr  = sf_state.laddr;
+                sf->raddr  = sf_state.raddr;
+                sf->index  = sf_state.index;
+                sf->backup = sf_state.backup;
+                sf->lost   = sf_state.lost;
+                sf->conn   = conn;
+
+                l_queue_push_tail(conn->subflows, sf);
+                failover_index_add(sf);
+        }
+
+        return true;
+}
+
+static struct mptcpd_plugin_ops const pm_ops = {
+        .new_connection         = failover_new_connection,
+        .connection_established = failover_new_connection,
+        .connection_closed      = failover_connection_closed,
+        .new_subflow            = failover_new_subflow,
+        .subflow_closed         = failover_subflow_closed,
+        .subflow_priority       = failover_subflow_priority,
+        .delete_interface       = failover_delete_interface,
+        .export_state           = failover_export_state,
+        .import_state           = failover_import_state,
+        .link_state_changed     = failover_link_state_changed
+};
+
+static int failover_init(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        static char const name[] = "failover";
+
+        failover_connections = l_hashmap_new();
+        failover_index       = l_hashmap_new();
+
+        if (!mptcpd_plugin_register_ops(name, &pm_ops)) {
+                l_error("Failed to initialize fast failover "
+                        "path manager plugin.");
+
+                l_hashmap_destroy(failover_index, NULL);
+                l_hashmap_destroy(failover_connections, NULL);
+                failover_index       = NULL;
+                failover_connections = NULL;
+
+                return -1;
+        }
+
+        l_info("MPTCP fast failover path manager initialized.");
+
+        return 0;
+}
+
+static void failover_exit(struct mptcpd_pm *pm)
+{
+        l_hashmap_destroy(failover_connections,
+                          failover_connection_destroy);
+        l_hashmap_destroy(failover_index, NULL);
+        failover_connections = NULL;
+        failover_index       = NULL;
+
+        struct mptcpd_pm_failover_stats const *const stats =
+                mptcpd_pm_get_failover_stats(pm);
+
+        if (stats->completed != 0)
+                l_info("failovers: %" PRIu64 " started, %" PRIu64
+                       " completed, average %" PRIu64 " us, max %" PRIu64
+                       " us",
+                       stats->started,
+                       stats->completed,
+                       stats->total_duration / stats->completed,
+                       stats->max_duration);
+
+        l_info("MPTCP fast failover path manager exited.");
+}
+
+MPTCPD_PLUGIN_DEFINE(failover,
+                     "Fast failover path manager",
+                     MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                     failover_init,
+                     failover_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
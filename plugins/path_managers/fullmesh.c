@@ -0,0 +1,1167 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file fullmesh.c
+ *
+ * @brief MPTCP full-mesh path manager plugin.
+ *
+ * Create a subflow for every usable local and remote address pair of
+ * an MPTCP connection, subject to per-connection and per-interface
+ * caps.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>  // For NDEBUG and mptcpd VERSION.
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/path_manager.h>
+#include <mptcpd/private/configuration.h>
+#include <mptcpd/endpoint_cache.h>
+#include <mptcpd/id_manager.h>
+#include <mptcpd/join_stats.h>
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/path_manager.h>
+#include <mptcpd/plugin.h>
+
+
+/**
+ * @brief Default maximum number of subflows per connection.
+ *
+ * This matches the maximum number of subflows allowed by the
+ * kernel.
+ */
+#define FULLMESH_DEFAULT_MAX_SUBFLOWS 8
+
+/// Number of subflow creation attempts per address pair.
+#define FULLMESH_MAX_ATTEMPTS 5
+
+/// Initial subflow creation retry delay in seconds.
+#define FULLMESH_BACKOFF_MIN 1
+
+/// Maximum subflow creation retry delay in seconds.
+#define FULLMESH_BACKOFF_MAX 60
+
+/**
+ * @brief Format version of the exported connection state.
+ *
+ * The exported state is a @c fullmesh_state object followed by its
+ * @c fullmesh_remote and @c fullmesh_subflow objects.
+ */
+#define FULLMESH_STATE_VERSION 1
+
+/// Full-mesh subflow state.
+enum fullmesh_subflow_state
+{
+        /// Subflow creation requested but not yet confirmed.
+        FULLMESH_SUBFLOW_PENDING,
+
+        /// Subflow is established.
+        FULLMESH_SUBFLOW_ESTABLISHED,
+
+        /// Subflow creation failed or the subflow was closed.
+        FULLMESH_SUBFLOW_FAILED
+};
+
+/**
+ * @struct fullmesh_remote
+ *
+ * @brief Remote address available to an MPTCP connection.
+ */
+struct fullmesh_remote
+{
+        /// Remote address ID.
+        mptcpd_aid_t id;
+
+        /// Remote address, including port.
+        struct sockaddr_storage addr;
+};
+
+/**
+ * @struct fullmesh_subflow
+ *
+ * @brief Local/remote address pair tracked by this plugin.
+ */
+struct fullmesh_subflow
+{
+        /// Local address, port is not significant.
+        struct sockaddr_storage laddr;
+
+        /// Remote address.
+        struct sockaddr_storage raddr;
+
+        /// Network interface index corresponding to @c laddr.
+        int index;
+
+        /// Current subflow state.
+        enum fullmesh_subflow_state state;
+
+        /// Number of subflow creation requests sent for this pair.
+        unsigned int attempts;
+};
+
+/**
+ * @struct fullmesh_connection
+ *
+ * @brief MPTCP connection state.
+ */
+struct fullmesh_connection
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// Local address of the initial subflow.
+        struct sockaddr_storage laddr;
+
+        /**
+         * @brief List of @c fullmesh_remote objects.
+         *
+         * The remote address of the initial subflow is always the
+         * first entry, and has address ID zero.
+         */
+        struct l_queue *remotes;
+
+        /// List of @c fullmesh_subflow objects.
+        struct l_queue *subflows;
+
+        /// Consecutive subflow creation failures.
+        unsigned int failures;
+
+        /// Subflow creation retry timer, armed during backoff.
+        struct l_timeout *retry;
+
+        /// Subflow creation is suspended until @c retry expires.
+        bool backoff;
+
+        /// Pointer to path manager.
+        struct mptcpd_pm *pm;
+};
+
+/**
+ * @struct fullmesh_state
+ *
+ * @brief Exported MPTCP connection state.
+ */
+struct fullmesh_state
+{
+        /// Local address of the initial subflow.
+        struct sockaddr_storage laddr;
+
+        /// Consecutive subflow creation failures.
+        uint32_t failures;
+
+        /// Subflow creation is suspended after a failure.
+        uint32_t backoff;
+
+        /// Number of @c fullmesh_remote objects that follow.
+        uint32_t remotes;
+
+        /// Number of @c fullmesh_subflow objects that follow.
+        uint32_t subflows;
+};
+
+/**
+ * @brief Map of MPTCP connection token to @c fullmesh_connection.
+ *
+ * Only client side connections are tracked.
+ */
+static struct l_hashmap *fullmesh_connections;
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Match the IP addresses of two @c sockaddr objects.
+ *
+ * Port numbers are ignored since the kernel reports ephemeral local
+ * ports that are never known before a subflow is created.
+ *
+ * @return @c true if the @c family and IP address in @a a and @a b
+ *         match, and @c false otherwise.
+ */
+static bool fullmesh_sockaddr_match(struct sockaddr const *a,
+                                    struct sockaddr const *b)
+{
+        assert(a);
+        assert(b);
+
+        if (a->sa_family != b->sa_family)
+                return false;
+
+        if (a->sa_family == AF_INET) {
+                struct sockaddr_in const *const l =
+                        (struct sockaddr_in const *) a;
+                struct sockaddr_in const *const r =
+                        (struct sockaddr_in const *) b;
+
+                return l->sin_addr.s_addr == r->sin_addr.s_addr;
+        } else if (a->sa_family == AF_INET6) {
+                struct sockaddr_in6 const *const l =
+                        (struct sockaddr_in6 const *) a;
+                struct sockaddr_in6 const *const r =
+                        (struct sockaddr_in6 const *) b;
+
+                return memcmp(&l->sin6_addr,
+                              &r->sin6_addr,
+                              sizeof(l->sin6_addr)) == 0;
+        }
+
+        return false;
+}
+
+/**
+ * @brief Copy a @c sockaddr to a @c sockaddr_storage object.
+ *
+ * @param[in]  src  Source IPv4 or IPv6 address.
+ * @param[out] dst  Destination storage.
+ * @param[in]  port Port to set in @a dst (network byte order), or
+ *                  @c -1 to retain the @a src port.
+ */
+static void fullmesh_sockaddr_copy(struct sockaddr const *src,
+                                   struct sockaddr_storage *dst,
+                                   int port)
+{
+        memset(dst, 0, sizeof(*dst));
+
+        if (src->sa_family == AF_INET) {
+                struct sockaddr_in *const in = (struct sockaddr_in *) dst;
+
+                memcpy(in, src, sizeof(*in));
+
+                if (port >= 0)
+                        in->sin_port = (in_port_t) port;
+        } else if (src->sa_family == AF_INET6) {
+                struct sockaddr_in6 *const in6 =
+                        (struct sockaddr_in6 *) dst;
+
+                memcpy(in6, src, sizeof(*in6));
+
+                if (port >= 0)
+                        in6->sin6_port = (in_port_t) port;
+        }
+}
+
+/**
+ * @brief Get the port of a @c sockaddr in network byte order.
+ */
+static in_port_t fullmesh_get_port(struct sockaddr const *sa)
+{
+        if (sa->sa_family == AF_INET)
+                return ((struct sockaddr_in const *) sa)->sin_port;
+        else if (sa->sa_family == AF_INET6)
+                return ((struct sockaddr_in6 const *) sa)->sin6_port;
+
+        return 0;
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @struct fullmesh_index_data
+ *
+ * @brief Type used to return index associated with local address.
+ */
+struct fullmesh_index_data
+{
+        /// Local address information.        (IN)
+        struct sockaddr const *const addr;
+
+        /// Network interface (link) index.   (OUT)
+        int index;
+};
+
+static bool fullmesh_addr_match(void const *a, void const *b)
+{
+        return fullmesh_sockaddr_match(a, b);
+}
+
+static void fullmesh_get_index(struct mptcpd_interface const *i,
+                               void *data)
+{
+        struct fullmesh_index_data *const d = data;
+
+        if (d->index == 0
+            && l_queue_find(i->addrs, fullmesh_addr_match, d->addr))
+                d->index = i->index;
+}
+
+/**
+ * @brief Reverse lookup network interface index from IP address.
+ *
+ * @return Index of the network interface with address @a addr, or
+ *         zero if no such interface is tracked by the network
+ *         monitor.
+ */
+static int fullmesh_addr_to_index(struct mptcpd_pm const *pm,
+                                  struct sockaddr const *addr)
+{
+        struct fullmesh_index_data data = { .addr = addr, .index = 0 };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(pm),
+                                    fullmesh_get_index,
+                                    &data);
+
+        return data.index;
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @struct fullmesh_pair
+ *
+ * @brief Address pair used to look up a @c fullmesh_subflow.
+ */
+struct fullmesh_pair
+{
+        /// Local address.
+        struct sockaddr const *laddr;
+
+        /// Remote address.
+        struct sockaddr const *raddr;
+};
+
+static bool fullmesh_subflow_match(void const *a, void const *b)
+{
+        struct fullmesh_subflow const *const sf = a;
+        struct fullmesh_pair const *const pair = b;
+
+        return fullmesh_sockaddr_match(
+                        (struct sockaddr const *) &sf->laddr,
+                        pair->laddr)
+                && fullmesh_sockaddr_match(
+                        (struct sockaddr const *) &sf->raddr,
+                        pair->raddr);
+}
+
+static struct fullmesh_subflow *
+fullmesh_subflow_find(struct fullmesh_connection const *conn,
+                      struct sockaddr const *laddr,
+                      struct sockaddr const *raddr)
+{
+        struct fullmesh_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        return l_queue_find(conn->subflows, fullmesh_subflow_match, &pair);
+}
+
+static struct fullmesh_subflow *
+fullmesh_subflow_add(struct fullmesh_connection *conn,
+                     struct sockaddr const *laddr,
+                     struct sockaddr const *raddr,
+                     int index,
+                     enum fullmesh_subflow_state state)
+{
+        struct fullmesh_subflow *const sf =
+                l_new(struct fullmesh_subflow, 1);
+
+        fullmesh_sockaddr_copy(laddr, &sf->laddr, 0);
+        fullmesh_sockaddr_copy(raddr, &sf->raddr, -1);
+        sf->index = index;
+        sf->state = state;
+
+        l_queue_push_tail(conn->subflows, sf);
+
+        return sf;
+}
+
+/**
+ * @struct fullmesh_count_data
+ *
+ * @brief Active subflow counters.
+ */
+struct fullmesh_count_data
+{
+        /// Network interface index of interest.      (IN)
+        int index;
+
+        /// Active subflows on the connection.         (OUT)
+        unsigned int total;
+
+        /// Active subflows through network interface. (OUT)
+        unsigned int on_interface;
+};
+
+static void fullmesh_count_subflow(void *data, void *user_data)
+{
+        struct fullmesh_subflow const *const sf = data;
+        struct fullmesh_count_data *const count = user_data;
+
+        if (sf->state == FULLMESH_SUBFLOW_FAILED)
+                return;
+
+        ++count->total;
+
+        if (sf->index == count->index)
+                ++count->on_interface;
+}
+
+/**
+ * @brief Check if another subflow is allowed on the given interface.
+ *
+ * @param[in] conn  MPTCP connection.
+ * @param[in] index Network interface index.
+ *
+ * @return @c true if neither the per-connection nor the
+ *         per-interface subflow cap would be exceeded.
+ *
+ * @note The caps are read from the current mptcpd configuration
+ *       since it may be replaced while the plugin is loaded.
+ */
+static bool fullmesh_subflow_allowed(struct fullmesh_connection const *conn,
+                                     int index)
+{
+        struct mptcpd_config const *const config = conn->pm->config;
+
+        unsigned int const max_subflows =
+                config->max_subflows != 0
+                ? config->max_subflows
+                : FULLMESH_DEFAULT_MAX_SUBFLOWS;
+
+        struct fullmesh_count_data count = { .index = index };
+
+        l_queue_foreach(conn->subflows, fullmesh_count_subflow, &count);
+
+        if (count.total >= max_subflows)
+                return false;
+
+        return config->max_subflows_per_interface == 0
+                || count.on_interface < config->max_subflows_per_interface;
+}
+
+// ----------------------------------------------------------------
+
+static void fullmesh_fill(struct fullmesh_connection *conn);
+
+static void fullmesh_retry(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+
+        struct fullmesh_connection *const conn = user_data;
+
+        conn->backoff = false;
+
+        fullmesh_fill(conn);
+}
+
+/**
+ * @brief Suspend subflow creation on @a conn after a failure.
+ *
+ * The retry delay doubles with each consecutive failure, starting at
+ * @c FULLMESH_BACKOFF_MIN seconds, up to @c FULLMESH_BACKOFF_MAX
+ * seconds.
+ */
+static void fullmesh_backoff(struct fullmesh_connection *conn)
+{
+        unsigned int seconds = FULLMESH_BACKOFF_MAX;
+
+        ++conn->failures;
+
+        if (conn->failures < 8)
+                seconds = L_MIN(FULLMESH_BACKOFF_MIN << (conn->failures - 1),
+                                FULLMESH_BACKOFF_MAX);
+
+        conn->backoff = true;
+
+        if (conn->retry == NULL)
+                conn->retry = l_timeout_create(seconds,
+                                               fullmesh_retry,
+                                               conn,
+                                               NULL);
+        else
+                l_timeout_modify(conn->retry, seconds);
+
+        l_debug("token 0x%" PRIx32 ": retrying subflow creation in %u s",
+                conn->token,
+                seconds);
+}
+
+/**
+ * @brief Request a subflow for the given address pair.
+ */
+static void fullmesh_create_subflow(struct fullmesh_connection *conn,
+                                    struct fullmesh_subflow *sf,
+                                    mptcpd_aid_t remote_id)
+{
+        struct sockaddr const *const laddr =
+                (struct sockaddr const *) &sf->laddr;
+        struct sockaddr const *const raddr =
+                (struct sockaddr const *) &sf->raddr;
+
+        /*
+          The local address of the initial subflow already has address
+          ID zero, as far as the kernel is concerned.
+        */
+        mptcpd_aid_t local_id = 0;
+
+        if (!fullmesh_sockaddr_match(laddr,
+                                     (struct sockaddr const *) &conn->laddr)) {
+                local_id = mptcpd_idm_get_id(mptcpd_pm_get_idm(conn->pm),
+                                             laddr);
+
+                if (local_id == 0) {
+                        l_error("Unable to map local address to ID.");
+                        sf->state = FULLMESH_SUBFLOW_FAILED;
+                        sf->attempts = FULLMESH_MAX_ATTEMPTS;
+
+                        return;
+                }
+        }
+
+        ++sf->attempts;
+
+        int const result = mptcpd_pm_add_subflow(conn->pm,
+                                                 conn->token,
+                                                 local_id,
+                                                 remote_id,
+                                                 laddr,
+                                                 raddr,
+                                                 false);
+
+        if (result == 0) {
+                sf->state = FULLMESH_SUBFLOW_PENDING;
+        } else {
+                l_warn("Unable to create subflow on interface %d: %d",
+                       sf->index,
+                       result);
+
+                sf->state = FULLMESH_SUBFLOW_FAILED;
+                fullmesh_backoff(conn);
+        }
+}
+
+/**
+ * @struct fullmesh_fill_data
+ *
+ * @brief State passed through the address matrix iteration.
+ */
+struct fullmesh_fill_data
+{
+        /// MPTCP connection.
+        struct fullmesh_connection *const conn;
+
+        /// Network interface currently being iterated.
+        struct mptcpd_interface const *interface;
+};
+
+static void fullmesh_fill_local_addr(void *data, void *user_data)
+{
+        struct sockaddr const *const laddr = data;
+        struct fullmesh_fill_data *const fill = user_data;
+        struct fullmesh_connection *const conn = fill->conn;
+        int const index = fill->interface->index;
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(conn->remotes);
+             e != NULL && !conn->backoff;
+             e = e->next) {
+                struct fullmesh_remote *const remote = e->data;
+                struct sockaddr const *const raddr =
+                        (struct sockaddr const *) &remote->addr;
+
+                if (laddr->sa_family != raddr->sa_family)
+                        continue;
+
+                struct fullmesh_subflow *sf =
+                        fullmesh_subflow_find(conn, laddr, raddr);
+
+                if (sf != NULL
+                    && (sf->state != FULLMESH_SUBFLOW_FAILED
+                        || sf->attempts >= FULLMESH_MAX_ATTEMPTS))
+                        continue;
+
+                if (!fullmesh_subflow_allowed(conn, index))
+                        return;
+
+                // Skip paths where joins are known to fail.
+                if (!mptcpd_jstats_should_try_subflow(
+                            mptcpd_pm_get_jstats(conn->pm),
+                            index,
+                            raddr))
+                        continue;
+
+                if (sf == NULL)
+                        sf = fullmesh_subflow_add(conn,
+                                                  laddr,
+                                                  raddr,
+                                                  index,
+                                                  FULLMESH_SUBFLOW_FAILED);
+
+                fullmesh_create_subflow(conn, sf, remote->id);
+        }
+}
+
+static void fullmesh_fill_interface(struct mptcpd_interface const *i,
+                                    void *data)
+{
+        struct fullmesh_fill_data *const fill = data;
+
+        fill->interface = i;
+
+        l_queue_foreach(i->addrs, fullmesh_fill_local_addr, fill);
+}
+
+/**
+ * @brief Create subflows across the local x remote address matrix.
+ *
+ * @param[in,out] conn MPTCP connection.
+ */
+static void fullmesh_fill(struct fullmesh_connection *conn)
+{
+        if (conn->backoff)
+                return;
+
+        struct fullmesh_fill_data data = { .conn = conn };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(conn->pm),
+                                    fullmesh_fill_interface,
+                                    &data);
+}
+
+static void fullmesh_fill_foreach(void const *key,
+                                  void *value,
+                                  void *user_data)
+{
+        (void) key;
+        (void) user_data;
+
+        fullmesh_fill(value);
+}
+
+// ----------------------------------------------------------------
+
+static void fullmesh_connection_destroy(void *data)
+{
+        struct fullmesh_connection *const conn = data;
+
+        if (conn == NULL)
+                return;
+
+        l_timeout_remove(conn->retry);
+        l_queue_destroy(conn->subflows, l_free);
+        l_queue_destroy(conn->remotes, l_free);
+        l_free(conn);
+}
+
+static struct fullmesh_connection *
+fullmesh_connection_lookup(mptcpd_token_t token)
+{
+        return l_hashmap_lookup(fullmesh_connections, L_UINT_TO_PTR(token));
+}
+
+static bool fullmesh_remote_id_match(void const *a, void const *b)
+{
+        struct fullmesh_remote const *const remote = a;
+        mptcpd_aid_t const id = L_PTR_TO_UINT(b);
+
+        return remote->id == id;
+}
+
+static bool fullmesh_remove_raddr(void *data, void *user_data)
+{
+        struct fullmesh_subflow *const sf = data;
+        struct sockaddr const *const raddr = user_data;
+
+        if (!fullmesh_sockaddr_match((struct sockaddr const *) &sf->raddr,
+                                     raddr))
+                return false;
+
+        l_free(sf);
+
+        return true;
+}
+
+static bool fullmesh_remove_laddr(void *data, void *user_data)
+{
+        struct fullmesh_subflow *const sf = data;
+        struct sockaddr const *const laddr = user_data;
+
+        if (!fullmesh_sockaddr_match((struct sockaddr const *) &sf->laddr,
+                                     laddr))
+                return false;
+
+        l_free(sf);
+
+        return true;
+}
+
+static void fullmesh_forget_laddr(void const *key,
+                                  void *value,
+                                  void *user_data)
+{
+        (void) key;
+
+        struct fullmesh_connection *const conn = value;
+
+        l_queue_foreach_remove(conn->subflows,
+                               fullmesh_remove_laddr,
+                               user_data);
+}
+
+/**
+ * @brief Make a remote address available to a connection.
+ *
+ * @return @c true if @a addr was added, and @c false if an address
+ *         with the same ID is already known.
+ */
+static bool fullmesh_add_remote(struct fullmesh_connection *conn,
+                                mptcpd_aid_t id,
+                                struct sockaddr const *addr)
+{
+        if (l_queue_find(conn->remotes,
+                         fullmesh_remote_id_match,
+                         L_UINT_TO_PTR(id)) != NULL)
+                return false;
+
+        struct fullmesh_remote const *const primary =
+                l_queue_peek_head(conn->remotes);
+
+        /*
+          A remote address advertised without a port is reachable
+          through the port of the initial subflow.
+        */
+        int port = -1;
+
+        if (fullmesh_get_port(addr) == 0)
+                port = fullmesh_get_port(
+                        (struct sockaddr const *) &primary->addr);
+
+        struct fullmesh_remote *const remote =
+                l_new(struct fullmesh_remote, 1);
+
+        remote->id = id;
+        fullmesh_sockaddr_copy(addr, &remote->addr, port);
+
+        l_queue_push_tail(conn->remotes, remote);
+
+        return true;
+}
+
+static void fullmesh_add_cached_remote(mptcpd_aid_t id,
+                                       struct sockaddr const *addr,
+                                       void *user_data)
+{
+        (void) fullmesh_add_remote(user_data, id, addr);
+}
+
+// ----------------------------------------------------------------
+//                     Mptcpd Plugin Operations
+// ----------------------------------------------------------------
+static void fullmesh_new_connection(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool server_side,
+                                    struct mptcpd_pm *pm)
+{
+        /**
+         * @note Only the client side creates additional subflows.
+         *       Subflows initiated by a server are commonly blocked by
+         *       middleboxes, such as NATs and firewalls.
+         */
+        if (server_side)
+                return;
+
+        struct fullmesh_connection *const conn =
+                l_new(struct fullmesh_connection, 1);
+
+        conn->token    = token;
+        conn->remotes  = l_queue_new();
+        conn->subflows = l_queue_new();
+        conn->pm       = pm;
+
+        fullmesh_sockaddr_copy(laddr, &conn->laddr, 0);
+
+        struct fullmesh_remote *const remote =
+                l_new(struct fullmesh_remote, 1);
+
+        fullmesh_sockaddr_copy(raddr, &remote->addr, -1);
+        l_queue_push_tail(conn->remotes, remote);
+
+        // The initial subflow.
+        (void) fullmesh_subflow_add(conn,
+                                    laddr,
+                                    raddr,
+                                    fullmesh_addr_to_index(pm, laddr),
+                                    FULLMESH_SUBFLOW_ESTABLISHED);
+
+        // Drop stale state left over from a reused token, if any.
+        fullmesh_connection_destroy(
+                l_hashmap_remove(fullmesh_connections,
+                                 L_UINT_TO_PTR(token)));
+
+        if (!l_hashmap_insert(fullmesh_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                l_error("Unable to track new connection.");
+                fullmesh_connection_destroy(conn);
+
+                return;
+        }
+}
+
+static void fullmesh_connection_established(mptcpd_token_t token,
+                                            struct sockaddr const *laddr,
+                                            struct sockaddr const *raddr,
+                                            bool server_side,
+                                            struct mptcpd_pm *pm)
+{
+        (void) laddr;
+        (void) server_side;
+
+        struct fullmesh_connection *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        /*
+          Use addresses the peer announced on earlier connections
+          rather than waiting for it to announce them again.
+        */
+        (void) mptcpd_ecache_foreach(mptcpd_pm_get_ecache(pm),
+                                     raddr,
+                                     fullmesh_add_cached_remote,
+                                     conn);
+
+        fullmesh_fill(conn);
+}
+
+static void fullmesh_connection_closed(mptcpd_token_t token,
+                                       struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        fullmesh_connection_destroy(
+                l_hashmap_remove(fullmesh_connections,
+                                 L_UINT_TO_PTR(token)));
+}
+
+static void fullmesh_new_address(mptcpd_token_t token,
+                                 mptcpd_aid_t id,
+                                 struct sockaddr const *addr,
+                                 struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct fullmesh_connection *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn != NULL && fullmesh_add_remote(conn, id, addr))
+                fullmesh_fill(conn);
+}
+
+static void fullmesh_address_removed(mptcpd_token_t token,
+                                     mptcpd_aid_t id,
+                                     struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct fullmesh_connection *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct fullmesh_remote *const remote =
+                l_queue_remove_if(conn->remotes,
+                                  fullmesh_remote_id_match,
+                                  L_UINT_TO_PTR(id));
+
+        if (remote == NULL)
+                return;
+
+        // The kernel closes subflows to the removed address.
+        l_queue_foreach_remove(conn->subflows,
+                               fullmesh_remove_raddr,
+                               &remote->addr);
+
+        l_free(remote);
+}
+
+static void fullmesh_new_subflow(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool backup,
+                                 struct mptcpd_pm *pm)
+{
+        (void) backup;
+
+        struct fullmesh_connection *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct fullmesh_subflow *sf =
+                fullmesh_subflow_find(conn, laddr, raddr);
+
+        if (sf == NULL)
+                sf = fullmesh_subflow_add(conn,
+                                          laddr,
+                                          raddr,
+                                          fullmesh_addr_to_index(pm,
+                                                                 laddr),
+                                          FULLMESH_SUBFLOW_ESTABLISHED);
+
+        sf->state = FULLMESH_SUBFLOW_ESTABLISHED;
+        conn->failures = 0;
+}
+
+static void fullmesh_subflow_closed(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool backup,
+                                    struct mptcpd_pm *pm)
+{
+        (void) backup;
+        (void) pm;
+
+        struct fullmesh_connection *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn == NULL)
+                return;
+
+        struct fullmesh_subflow *const sf =
+                fullmesh_subflow_find(conn, laddr, raddr);
+
+        if (sf == NULL || sf->state == FULLMESH_SUBFLOW_FAILED)
+                return;
+
+        /*
+          Subflows that fail to join, or close later on, are retried
+          after a backoff period, up to FULLMESH_MAX_ATTEMPTS times.
+        */
+        sf->state = FULLMESH_SUBFLOW_FAILED;
+
+        fullmesh_backoff(conn);
+}
+
+static void fullmesh_new_local_address(struct mptcpd_interface const *i,
+                                       struct sockaddr const *sa,
+                                       struct mptcpd_pm *pm)
+{
+        (void) i;
+        (void) sa;
+        (void) pm;
+
+        l_hashmap_foreach(fullmesh_connections,
+                          fullmesh_fill_foreach,
+                          NULL);
+}
+
+static void fullmesh_delete_local_address(
+        struct mptcpd_interface const *i,
+        struct sockaddr const *sa,
+        struct mptcpd_pm *pm)
+{
+        (void) i;
+        (void) pm;
+
+        // The kernel closes subflows using the removed address.
+        l_hashmap_foreach(fullmesh_connections,
+                          fullmesh_forget_laddr,
+                          (void *) sa);
+}
+
+static void *fullmesh_export_state(mptcpd_token_t token,
+                                   uint32_t *version,
+                                   size_t *len,
+                                   struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct fullmesh_connection const *const conn =
+                fullmesh_connection_lookup(token);
+
+        if (conn == NULL)
+                return NULL;
+
+        struct fullmesh_state state;
+
+        memset(&state, 0, sizeof(state));
+        state.laddr    = conn->laddr;
+        state.failures = conn->failures;
+        state.backoff  = conn->backoff;
+        state.remotes  = l_queue_length(conn->remotes);
+        state.subflows = l_queue_length(conn->subflows);
+
+        size_t const size =
+                sizeof(state)
+                + state.remotes * sizeof(struct fullmesh_remote)
+                + state.subflows * sizeof(struct fullmesh_subflow);
+
+        uint8_t *const data = l_malloc(size);
+        uint8_t *p = data;
+
+        memcpy(p, &state, sizeof(state));
+        p += sizeof(state);
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(conn->remotes);
+             e != NULL;
+             e = e->next) {
+                memcpy(p, e->data, sizeof(struct fullmesh_remote));
+                p += sizeof(struct fullmesh_remote);
+        }
+
+        for (struct l_queue_entry const *e =
+                     l_queue_get_entries(conn->subflows);
+             e != NULL;
+             e = e->next) {
+                memcpy(p, e->data, sizeof(struct fullmesh_subflow));
+                p += sizeof(struct fullmesh_subflow);
+        }
+
+        *version = FULLMESH_STATE_VERSION;
+        *len     = size;
+
+        return data;
+}
+
+static bool fullmesh_import_state(mptcpd_token_t token,
+                                  uint32_t version,
+                                  void const *state,
+                                  size_t len,
+                                  struct mptcpd_pm *pm)
+{
+        struct fullmesh_state s;
+
+        if (version != FULLMESH_STATE_VERSION || len < sizeof(s))
+                return false;
+
+        // The state is not necessarily aligned.
+        memcpy(&s, state, sizeof(s));
+
+        size_t const left = len - sizeof(s);
+
+        // The remote address of the initial subflow is always known.
+        if (s.remotes == 0
+            || s.remotes > left / sizeof(struct fullmesh_remote)
+            || s.subflows > left / sizeof(struct fullmesh_subflow)
+            || left != s.remotes * sizeof(struct fullmesh_remote)
+                       + s.subflows * sizeof(struct fullmesh_subflow))
+                return false;
+
+        struct fullmesh_connection *const conn =
+                l_new(struct fullmesh_connection, 1);
+
+        conn->token    = token;
+        conn->laddr    = s.laddr;
+        conn->failures = s.failures;
+        conn->remotes  = l_queue_new();
+        conn->subflows = l_queue_new();
+        conn->pm       = pm;
+
+        uint8_t const *p = (uint8_t const *) state + sizeof(s);
+
+        for (uint32_t i = 0; i < s.remotes; ++i) {
+                struct fullmesh_remote *const remote =
+                        l_memdup(p, sizeof(*remote));
+
+                l_queue_push_tail(conn->remotes, remote);
+                p += sizeof(*remote);
+        }
+
+        for (uint32_t i = 0; i < s.subflows; ++i) {
+                struct fullmesh_subflow *const sf =
+                        l_memdup(p, sizeof(*sf));
+
+                l_queue_push_tail(conn->subflows, sf);
+                p += sizeof(*sf);
+
+                if (sf->state > FULLMESH_SUBFLOW_FAILED) {
+                        fullmesh_connection_destroy(conn);
+
+                        return false;
+                }
+        }
+
+        fullmesh_connection_destroy(
+                l_hashmap_remove(fullmesh_connections,
+                                 L_UINT_TO_PTR(token)));
+
+        if (!l_hashmap_insert(fullmesh_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                fullmesh_connection_destroy(conn);
+
+                return false;
+        }
+
+        /*
+          The retry timer of the outgoing plugin is gone.  Resume the
+          backoff period where the failure count left it.
+        */
+        if (s.backoff && conn->failures != 0) {
+                --conn->failures;
+                fullmesh_backoff(conn);
+        }
+
+        return true;
+}
+
+static struct mptcpd_plugin_ops const pm_ops = {
+        .new_connection         = fullmesh_new_connection,
+        .connection_established = fullmesh_connection_established,
+        .connection_closed      = fullmesh_connection_closed,
+        .new_address            = fullmesh_new_address,
+        .address_removed        = fullmesh_address_removed,
+        .new_subflow            = fullmesh_new_subflow,
+        .subflow_closed         = fullmesh_subflow_closed,
+        .new_local_address      = fullmesh_new_local_address,
+        .delete_local_address   = fullmesh_delete_local_address,
+        .export_state           = fullmesh_export_state,
+        .import_state           = fullmesh_import_state
+};
+
+static int fullmesh_init(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        static char const name[] = "fullmesh";
+
+        fullmesh_connections = l_hashmap_new();
+
+        if (!mptcpd_plugin_register_ops(name, &pm_ops)) {
+                l_error("Failed to initialize full-mesh "
+                        "path manager plugin.");
+
+                return -1;
+        }
+
+        l_info("MPTCP full-mesh path manager initialized.");
+
+        return 0;
+}
+
+static void fullmesh_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        l_hashmap_destroy(fullmesh_connections,
+                          fullmesh_connection_destroy);
+
+        l_info("MPTCP full-mesh path manager exited.");
+}
+
+MPTCPD_PLUGIN_DEFINE(fullmesh,
+                     "Full-mesh path manager",
+                     MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                     fullmesh_init,
+                     fullmesh_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
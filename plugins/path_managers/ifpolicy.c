@@ -0,0 +1,782 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file ifpolicy.c
+ *
+ * @brief MPTCP network interface cost policy path manager plugin.
+ *
+ * Advertise local addresses with per-interface flags, and keep
+ * subflows through expensive network interfaces, e.g. metered
+ * LTE/5G uplinks, as backup subflows according to the network
+ * interface policies found in the mptcpd configuration.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>  // For NDEBUG and mptcpd VERSION.
+#endif
+
+#include <assert.h>
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/path_manager.h>
+#include <mptcpd/private/configuration.h>
+#include <mptcpd/id_manager.h>
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/path_manager.h>
+#include <mptcpd/plugin.h>
+
+
+/**
+ * @brief Format version of the exported connection state.
+ *
+ * The exported state is an array of @c ifpolicy_subflow_state
+ * objects.
+ */
+#define IFPOLICY_STATE_VERSION 1
+
+/**
+ * @struct ifpolicy_subflow
+ *
+ * @brief MPTCP subflow tracked by this plugin.
+ */
+struct ifpolicy_subflow
+{
+        /// Local address and port.
+        struct sockaddr_storage laddr;
+
+        /// Remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Network interface index corresponding to @c laddr.
+        int index;
+
+        /**
+         * @brief Cost of the network interface.
+         *
+         * Copied from the network interface policy since the
+         * configuration may be replaced while the subflow exists.
+         * Zero if no policy applies to the network interface.
+         */
+        uint32_t cost;
+
+        /// Subflow is always a backup subflow by its interface policy.
+        bool policy_backup;
+
+        /// Current subflow backup priority.
+        bool backup;
+};
+
+/**
+ * @struct ifpolicy_connection
+ *
+ * @brief MPTCP connection state.
+ */
+struct ifpolicy_connection
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// List of @c ifpolicy_subflow objects.
+        struct l_queue *subflows;
+};
+
+/**
+ * @struct ifpolicy_subflow_state
+ *
+ * @brief Exported MPTCP subflow state.
+ *
+ * Network interface policies are looked up again on import since
+ * they may have changed along with the mptcpd configuration.
+ */
+struct ifpolicy_subflow_state
+{
+        /// Local address and port.
+        struct sockaddr_storage laddr;
+
+        /// Remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Current subflow backup priority.
+        uint8_t backup;
+};
+
+/// Map of MPTCP connection token to @c ifpolicy_connection.
+static struct l_hashmap *ifpolicy_connections;
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Match the IP addresses of two @c sockaddr objects.
+ *
+ * @param[in] a       Address to compare.
+ * @param[in] b       Address to compare.
+ * @param[in] ports   Compare the ports of @a a and @a b as well.
+ *
+ * @return @c true if the @c family and IP address in @a a and @a b
+ *         match, and @c false otherwise.
+ */
+static bool ifpolicy_sockaddr_match(struct sockaddr const *a,
+                                    struct sockaddr const *b,
+                                    bool ports)
+{
+        assert(a);
+        assert(b);
+
+        if (a->sa_family != b->sa_family)
+                return false;
+
+        if (a->sa_family == AF_INET) {
+                struct sockaddr_in const *const l =
+                        (struct sockaddr_in const *) a;
+                struct sockaddr_in const *const r =
+                        (struct sockaddr_in const *) b;
+
+                return l->sin_addr.s_addr == r->sin_addr.s_addr
+                        && (!ports || l->sin_port == r->sin_port);
+        } else if (a->sa_family == AF_INET6) {
+                struct sockaddr_in6 const *const l =
+                        (struct sockaddr_in6 const *) a;
+                struct sockaddr_in6 const *const r =
+                        (struct sockaddr_in6 const *) b;
+
+                return memcmp(&l->sin6_addr,
+                              &r->sin6_addr,
+                              sizeof(l->sin6_addr)) == 0
+                        && (!ports || l->sin6_port == r->sin6_port);
+        }
+
+        return false;
+}
+
+/**
+ * @brief Copy a @c sockaddr to a @c sockaddr_storage object.
+ */
+static void ifpolicy_sockaddr_copy(struct sockaddr const *src,
+                                   struct sockaddr_storage *dst)
+{
+        memset(dst, 0, sizeof(*dst));
+
+        if (src->sa_family == AF_INET)
+                memcpy(dst, src, sizeof(struct sockaddr_in));
+        else if (src->sa_family == AF_INET6)
+                memcpy(dst, src, sizeof(struct sockaddr_in6));
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Get the policy applicable to a network interface.
+ *
+ * @param[in] pm   Mptcpd path manager.
+ * @param[in] name Network interface name.
+ *
+ * @return The first interface policy with a pattern matching
+ *         @a name, or @c NULL if no policy applies.
+ */
+static struct mptcpd_interface_policy const *
+ifpolicy_get_policy(struct mptcpd_pm const *pm, char const *name)
+{
+        struct l_queue const *const policies =
+                pm->config->interface_policies;
+
+        if (policies == NULL)
+                return NULL;
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries((struct l_queue *) policies);
+             entry != NULL;
+             entry = entry->next) {
+                struct mptcpd_interface_policy const *const policy =
+                        entry->data;
+
+                if (fnmatch(policy->pattern, name, 0) == 0)
+                        return policy;
+        }
+
+        return NULL;
+}
+
+/// Subflow traffic is always confined to backup by its policy.
+static bool ifpolicy_is_backup(struct mptcpd_interface_policy const *p)
+{
+        return p != NULL && p->backup;
+}
+
+/// Cost of a subflow, where no policy means no cost.
+static uint32_t ifpolicy_cost(struct mptcpd_interface_policy const *p)
+{
+        return p == NULL ? 0 : p->cost;
+}
+
+/**
+ * @struct ifpolicy_lookup_data
+ *
+ * @brief Type used to return the interface of a local address.
+ */
+struct ifpolicy_lookup_data
+{
+        /// Local address information.        (IN)
+        struct sockaddr const *const addr;
+
+        /// Path manager.                     (IN)
+        struct mptcpd_pm const *const pm;
+
+        /// Network interface (link) index.   (OUT)
+        int index;
+
+        /// Network interface policy.         (OUT)
+        struct mptcpd_interface_policy const *policy;
+};
+
+static bool ifpolicy_addr_match(void const *a, void const *b)
+{
+        return ifpolicy_sockaddr_match(a, b, false);
+}
+
+static void ifpolicy_lookup(struct mptcpd_interface const *i,
+                            void *data)
+{
+        struct ifpolicy_lookup_data *const d = data;
+
+        if (d->index == 0
+            && l_queue_find(i->addrs, ifpolicy_addr_match, d->addr)) {
+                d->index  = i->index;
+                d->policy = ifpolicy_get_policy(d->pm, i->name);
+        }
+}
+
+// ----------------------------------------------------------------
+
+static void ifpolicy_connection_destroy(void *data)
+{
+        struct ifpolicy_connection *const conn = data;
+
+        if (conn == NULL)
+                return;
+
+        l_queue_destroy(conn->subflows, l_free);
+        l_free(conn);
+}
+
+static struct ifpolicy_connection *
+ifpolicy_connection_get(mptcpd_token_t token)
+{
+        return l_hashmap_lookup(ifpolicy_connections,
+                                L_UINT_TO_PTR(token));
+}
+
+/**
+ * @struct ifpolicy_pair
+ *
+ * @brief Address pair used to look up a @c ifpolicy_subflow.
+ */
+struct ifpolicy_pair
+{
+        /// Local address.
+        struct sockaddr const *laddr;
+
+        /// Remote address.
+        struct sockaddr const *raddr;
+};
+
+static bool ifpolicy_subflow_match(void const *a, void const *b)
+{
+        struct ifpolicy_subflow const *const sf = a;
+        struct ifpolicy_pair const *const pair = b;
+
+        return ifpolicy_sockaddr_match(
+                        (struct sockaddr const *) &sf->laddr,
+                        pair->laddr,
+                        true)
+                && ifpolicy_sockaddr_match(
+                        (struct sockaddr const *) &sf->raddr,
+                        pair->raddr,
+                        true);
+}
+
+/**
+ * @brief Count subflows through a network interface.
+ */
+static unsigned int ifpolicy_count_index(
+        struct ifpolicy_connection const *conn,
+        int index)
+{
+        unsigned int count = 0;
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries(conn->subflows);
+             entry != NULL;
+             entry = entry->next) {
+                struct ifpolicy_subflow const *const sf = entry->data;
+
+                if (sf->index == index)
+                        ++count;
+        }
+
+        return count;
+}
+
+/**
+ * @brief Apply interface policies to all subflows of a connection.
+ *
+ * Subflows through network interfaces whose policy designates them
+ * as backup, as well as those through interfaces more expensive than
+ * the cheapest available one, are given the backup priority.  All
+ * other subflows are given the regular priority.
+ *
+ * @param[in] conn MPTCP connection.
+ * @param[in] pm   Mptcpd path manager.
+ */
+static void ifpolicy_apply(struct ifpolicy_connection *conn,
+                           struct mptcpd_pm *pm)
+{
+        uint32_t min_cost = UINT32_MAX;
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries(conn->subflows);
+             entry != NULL;
+             entry = entry->next) {
+                struct ifpolicy_subflow const *const sf = entry->data;
+
+                if (!sf->policy_backup && sf->cost < min_cost)
+                        min_cost = sf->cost;
+        }
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries(conn->subflows);
+             entry != NULL;
+             entry = entry->next) {
+                struct ifpolicy_subflow *const sf = entry->data;
+
+                bool const backup =
+                        sf->policy_backup || sf->cost > min_cost;
+
+                if (backup == sf->backup)
+                        continue;
+
+                if (mptcpd_pm_set_backup(
+                            pm,
+                            conn->token,
+                            (struct sockaddr const *) &sf->laddr,
+                            (struct sockaddr const *) &sf->raddr,
+                            backup) == 0)
+                        sf->backup = backup;
+                else
+                        l_warn("Unable to set subflow priority on "
+                               "connection 0x%" PRIx32 ".",
+                               conn->token);
+        }
+}
+
+/**
+ * @brief Track a new subflow, subject to the interface policy.
+ *
+ * @return @c true if the subflow is allowed by its interface
+ *         policy, and @c false otherwise.
+ */
+static bool ifpolicy_add_subflow(struct ifpolicy_connection *conn,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool backup,
+                                 struct mptcpd_pm *pm)
+{
+        struct ifpolicy_lookup_data data = {
+                .addr = laddr,
+                .pm   = pm
+        };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(pm),
+                                    ifpolicy_lookup,
+                                    &data);
+
+        if (data.policy != NULL
+            && data.policy->max_subflows != 0
+            && ifpolicy_count_index(conn, data.index)
+               >= data.policy->max_subflows)
+                return false;
+
+        struct ifpolicy_subflow *const sf =
+                l_new(struct ifpolicy_subflow, 1);
+
+        ifpolicy_sockaddr_copy(laddr, &sf->laddr);
+        ifpolicy_sockaddr_copy(raddr, &sf->raddr);
+        sf->index         = data.index;
+        sf->cost          = ifpolicy_cost(data.policy);
+        sf->policy_backup = ifpolicy_is_backup(data.policy);
+        sf->backup        = backup;
+
+        l_queue_push_tail(conn->subflows, sf);
+
+        return true;
+}
+
+// ----------------------------------------------------------------
+//                     Mptcpd Plugin Operations
+// ----------------------------------------------------------------
+
+static void ifpolicy_new_connection(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool server_side,
+                                    struct mptcpd_pm *pm)
+{
+        (void) server_side;
+
+        struct ifpolicy_connection *const conn =
+                l_new(struct ifpolicy_connection, 1);
+
+        conn->token    = token;
+        conn->subflows = l_queue_new();
+
+        // Drop stale state left over from a reused token, if any.
+        ifpolicy_connection_destroy(
+                l_hashmap_remove(ifpolicy_connections,
+                                 L_UINT_TO_PTR(token)));
+
+        if (!l_hashmap_insert(ifpolicy_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                l_error("Unable to track connection 0x%" PRIx32 ".",
+                        token);
+                ifpolicy_connection_destroy(conn);
+
+                return;
+        }
+
+        /*
+          The initial subflow is always allowed, regardless of the
+          interface subflow limit, since removing it would reset the
+          connection.
+        */
+        (void) ifpolicy_add_subflow(conn, laddr, raddr, false, pm);
+
+        ifpolicy_apply(conn, pm);
+}
+
+static void ifpolicy_connection_established(mptcpd_token_t token,
+                                            struct sockaddr const *laddr,
+                                            struct sockaddr const *raddr,
+                                            bool server_side,
+                                            struct mptcpd_pm *pm)
+{
+        if (ifpolicy_connection_get(token) == NULL)
+                ifpolicy_new_connection(token,
+                                        laddr,
+                                        raddr,
+                                        server_side,
+                                        pm);
+}
+
+static void ifpolicy_connection_closed(mptcpd_token_t token,
+                                       struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        ifpolicy_connection_destroy(
+                l_hashmap_remove(ifpolicy_connections,
+                                 L_UINT_TO_PTR(token)));
+}
+
+static void ifpolicy_new_subflow(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool backup,
+                                 struct mptcpd_pm *pm)
+{
+        struct ifpolicy_connection *const conn =
+                ifpolicy_connection_get(token);
+
+        if (conn == NULL)
+                return;
+
+        struct ifpolicy_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        if (l_queue_find(conn->subflows, ifpolicy_subflow_match, &pair))
+                return;
+
+        if (!ifpolicy_add_subflow(conn, laddr, raddr, backup, pm)) {
+                l_debug("Interface subflow limit reached on "
+                        "connection 0x%" PRIx32 ".",
+                        token);
+
+                if (mptcpd_pm_remove_subflow(pm, token, laddr, raddr)
+                    != 0)
+                        l_warn("Unable to remove subflow exceeding "
+                               "interface limit.");
+
+                return;
+        }
+
+        ifpolicy_apply(conn, pm);
+}
+
+static void ifpolicy_subflow_closed(mptcpd_token_t token,
+                                    struct sockaddr const *laddr,
+                                    struct sockaddr const *raddr,
+                                    bool backup,
+                                    struct mptcpd_pm *pm)
+{
+        (void) backup;
+
+        struct ifpolicy_connection *const conn =
+                ifpolicy_connection_get(token);
+
+        if (conn == NULL)
+                return;
+
+        struct ifpolicy_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        struct ifpolicy_subflow *const sf =
+                l_queue_remove_if(conn->subflows,
+                                  ifpolicy_subflow_match,
+                                  &pair);
+
+        if (sf == NULL)
+                return;
+
+        l_free(sf);
+
+        // A cheaper path may have gone away.
+        ifpolicy_apply(conn, pm);
+}
+
+static void ifpolicy_subflow_priority(mptcpd_token_t token,
+                                      struct sockaddr const *laddr,
+                                      struct sockaddr const *raddr,
+                                      bool backup,
+                                      struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct ifpolicy_connection *const conn =
+                ifpolicy_connection_get(token);
+
+        if (conn == NULL)
+                return;
+
+        struct ifpolicy_pair const pair = {
+                .laddr = laddr,
+                .raddr = raddr
+        };
+
+        struct ifpolicy_subflow *const sf =
+                l_queue_find(conn->subflows,
+                             ifpolicy_subflow_match,
+                             &pair);
+
+        if (sf != NULL)
+                sf->backup = backup;
+}
+
+static void ifpolicy_new_local_address(struct mptcpd_interface const *i,
+                                       struct sockaddr const *sa,
+                                       struct mptcpd_pm *pm)
+{
+        struct mptcpd_idm *const idm = mptcpd_pm_get_idm(pm);
+        mptcpd_aid_t const id = mptcpd_idm_get_id(idm, sa);
+
+        if (id == 0) {
+                l_error("Unable to map addr to ID.");
+                return;
+        }
+
+        uint32_t flags = pm->config->addr_flags;
+
+        if (ifpolicy_is_backup(ifpolicy_get_policy(pm, i->name)))
+                flags |= MPTCPD_ADDR_FLAG_BACKUP;
+
+        if (mptcpd_kpm_add_addr(pm, sa, id, flags, i->index) != 0)
+                l_error("Unable to advertise IP address.");
+}
+
+static void ifpolicy_delete_local_address(
+        struct mptcpd_interface const *i,
+        struct sockaddr const *sa,
+        struct mptcpd_pm *pm)
+{
+        (void) i;
+
+        struct mptcpd_idm *const idm = mptcpd_pm_get_idm(pm);
+        mptcpd_aid_t const id = mptcpd_idm_remove_id(idm, sa);
+
+        if (id == 0) {
+                // Not necessarily an error.
+                l_info("No address ID associated with addr.");
+                return;
+        }
+
+        if (mptcpd_kpm_remove_addr(pm, id) != 0)
+                l_error("Unable to stop advertising IP address.");
+}
+
+static void *ifpolicy_export_state(mptcpd_token_t token,
+                                   uint32_t *version,
+                                   size_t *len,
+                                   struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        struct ifpolicy_connection const *const conn =
+                ifpolicy_connection_get(token);
+
+        if (conn == NULL || l_queue_isempty(conn->subflows))
+                return NULL;
+
+        unsigned int const count = l_queue_length(conn->subflows);
+        struct ifpolicy_subflow_state *const states =
+                l_new(struct ifpolicy_subflow_state, count);
+        struct ifpolicy_subflow_state *s = states;
+
+        for (struct l_queue_entry const *entry =
+                     l_queue_get_entries(conn->subflows);
+             entry != NULL;
+             entry = entry->next, ++s) {
+                struct ifpolicy_subflow const *const sf = entry->data;
+
+                s->laddr  = sf->laddr;
+                s->raddr  = sf->raddr;
+                s->backup = sf->backup;
+        }
+
+        *version = IFPOLICY_STATE_VERSION;
+        *len     = count * sizeof(*states);
+
+        return states;
+}
+
+static bool ifpolicy_import_state(mptcpd_token_t token,
+                                  uint32_t version,
+                                  void const *state,
+                                  size_t len,
+                                  struct mptcpd_pm *pm)
+{
+        if (version != IFPOLICY_STATE_VERSION
+            || len % sizeof(struct ifpolicy_subflow_state) != 0
+            || ifpolicy_connection_get(token) != NULL)
+                return false;
+
+        struct ifpolicy_connection *const conn =
+                l_new(struct ifpolicy_connection, 1);
+
+        conn->token    = token;
+        conn->subflows = l_queue_new();
+
+        if (!l_hashmap_insert(ifpolicy_connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                ifpolicy_connection_destroy(conn);
+
+                return false;
+        }
+
+        uint8_t const *const bytes = state;
+
+        for (size_t offset = 0;
+             offset < len;
+             offset += sizeof(struct ifpolicy_subflow_state)) {
+                struct ifpolicy_subflow_state s;
+
+                // The state is not necessarily aligned.
+                memcpy(&s, bytes + offset, sizeof(s));
+
+                struct ifpolicy_subflow *const sf =
+                        l_new(struct ifpolicy_subflow, 1);
+
+                struct ifpolicy_lookup_data data = {
+                        .addr = (struct sockaddr const *) &s.laddr,
+                        .pm   = pm
+                };
+
+                mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(pm),
+                                            ifpolicy_lookup,
+                                            &data);
+
+                sf->laddr         = s.laddr;
+                sf->raddr         = s.raddr;
+                sf->index         = data.index;
+                sf->cost          = ifpolicy_cost(data.policy);
+                sf->policy_backup = ifpolicy_is_backup(data.policy);
+                sf->backup        = s.backup;
+
+                l_queue_push_tail(conn->subflows, sf);
+        }
+
+        // Apply interface policies of the new configuration.
+        ifpolicy_apply(conn, pm);
+
+        return true;
+}
+
+static struct mptcpd_plugin_ops const pm_ops = {
+        .new_connection         = ifpolicy_new_connection,
+        .connection_established = ifpolicy_connection_established,
+        .connection_closed      = ifpolicy_connection_closed,
+        .new_subflow            = ifpolicy_new_subflow,
+        .subflow_closed         = ifpolicy_subflow_closed,
+        .subflow_priority       = ifpolicy_subflow_priority,
+        .new_local_address      = ifpolicy_new_local_address,
+        .delete_local_address   = ifpolicy_delete_local_address,
+        .export_state           = ifpolicy_export_state,
+        .import_state           = ifpolicy_import_state
+};
+
+static int ifpolicy_init(struct mptcpd_pm *pm)
+{
+        static char const name[] = "ifpolicy";
+
+        if (pm->config->interface_policies == NULL)
+                l_warn("No network interface policies configured.");
+
+        ifpolicy_connections = l_hashmap_new();
+
+        if (!mptcpd_plugin_register_ops(name, &pm_ops)) {
+                l_error("Failed to initialize interface policy "
+                        "path manager plugin.");
+
+                l_hashmap_destroy(ifpolicy_connections, NULL);
+                ifpolicy_connections = NULL;
+
+                return -1;
+        }
+
+        l_info("MPTCP interface policy path manager initialized.");
+
+        return 0;
+}
+
+static void ifpolicy_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        l_hashmap_destroy(ifpolicy_connections,
+                          ifpolicy_connection_destroy);
+        ifpolicy_connections = NULL;
+
+        l_info("MPTCP interface policy path manager exited.");
+}
+
+MPTCPD_PLUGIN_DEFINE(ifpolicy,
+                     "Interface cost policy path manager",
+                     MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                     ifpolicy_init,
+                     ifpolicy_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,546 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file quality.c
+ *
+ * @brief MPTCP path quality aware subflow priority plugin.
+ *
+ * Track RTT and retransmissions of all MPTCP subflows through the
+ * mptcpd metrics collector, and demote poorly performing subflows to
+ * backup priority, promoting them again once they recover.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>  // For NDEBUG and mptcpd VERSION.
+#endif
+
+#include <assert.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/path_manager.h>
+#include <mptcpd/plugin.h>
+#include <mptcpd/sock_diag.h>
+
+
+/// Retransmission ratio (percent) above which a subflow is lossy.
+#define QUALITY_LOSS_HIGH 5
+
+/// Retransmission ratio (percent) below which a subflow is healthy.
+#define QUALITY_LOSS_LOW 1
+
+/**
+ * @brief RTT slack in microseconds.
+ *
+ * RTT differences below this value relative to the best subflow are
+ * never considered significant.
+ */
+#define QUALITY_RTT_SLACK_US 20000
+
+/// Consecutive poor samples before a subflow is demoted.
+#define QUALITY_DEMOTE_ROUNDS 2
+
+/// Consecutive good samples before a demoted subflow is promoted.
+#define QUALITY_PROMOTE_ROUNDS 3
+
+/**
+ * @struct quality_subflow
+ *
+ * @brief Per-subflow quality state.
+ */
+struct quality_subflow
+{
+        /// Local address and port.
+        struct sockaddr_storage laddr;
+
+        /// Remote address and port.
+        struct sockaddr_storage raddr;
+
+        /// Smoothed RTT in microseconds.
+        uint32_t rtt;
+
+        /// Total retransmitted segments at last sample.
+        uint32_t total_retrans;
+
+        /// Total segments sent at last sample.
+        uint32_t segs_out;
+
+        /// Delivery rate in bytes per second.
+        uint64_t delivery_rate;
+
+        /// Retransmission ratio during the last interval, in percent.
+        unsigned int loss;
+
+        /// Subflow is currently a backup subflow.
+        bool backup;
+
+        /// Subflow was demoted to backup by this plugin.
+        bool demoted;
+
+        /// Consecutive poor (negative) or good (positive) samples.
+        int streak;
+
+        /// Sampling round in which this subflow was last seen.
+        unsigned int round;
+};
+
+/**
+ * @struct quality_connection
+ *
+ * @brief Per-connection quality state.
+ */
+struct quality_connection
+{
+        /// MPTCP connection token.
+        mptcpd_token_t token;
+
+        /// List of @c quality_subflow objects.
+        struct l_queue *subflows;
+};
+
+/**
+ * @struct quality_sampler
+ *
+ * @brief Subflow sampling state.
+ */
+struct quality_sampler
+{
+        /// Map of MPTCP connection token to @c quality_connection.
+        struct l_hashmap *connections;
+
+        /// Current sampling round.
+        unsigned int round;
+
+        /// Pointer to path manager.
+        struct mptcpd_pm *pm;
+};
+
+/// Sampling state, valid between plugin init and exit.
+static struct quality_sampler *quality;
+
+// ----------------------------------------------------------------
+
+static bool quality_subflow_match(void const *a, void const *b)
+{
+        struct quality_subflow const *const sf = a;
+        struct quality_subflow const *const key = b;
+
+        return memcmp(&sf->laddr, &key->laddr, sizeof(sf->laddr)) == 0
+                && memcmp(&sf->raddr, &key->raddr, sizeof(sf->raddr)) == 0;
+}
+
+static void quality_connection_destroy(void *data)
+{
+        struct quality_connection *const conn = data;
+
+        if (conn == NULL)
+                return;
+
+        l_queue_destroy(conn->subflows, l_free);
+        l_free(conn);
+}
+
+static struct quality_connection *
+quality_connection_get(mptcpd_token_t token)
+{
+        struct quality_connection *conn =
+                l_hashmap_lookup(quality->connections,
+                                 L_UINT_TO_PTR(token));
+
+        if (conn != NULL)
+                return conn;
+
+        conn = l_new(struct quality_connection, 1);
+        conn->token    = token;
+        conn->subflows = l_queue_new();
+
+        if (!l_hashmap_insert(quality->connections,
+                              L_UINT_TO_PTR(token),
+                              conn)) {
+                quality_connection_destroy(conn);
+                return NULL;
+        }
+
+        return conn;
+}
+
+// ----------------------------------------------------------------
+
+/**
+ * @brief Update the quality state of a sampled subflow.
+ *
+ * @param[in,out] conn Connection the subflow belongs to.
+ * @param[in]     s    Sampled subflow metrics.
+ * @param[in]     i    Position of the subflow in @a s.
+ */
+static void update_subflow(struct quality_connection *conn,
+                           struct mptcpd_diag_subflows const *s,
+                           size_t i)
+{
+        struct quality_subflow key = {
+                .laddr = s->laddr[i],
+                .raddr = s->raddr[i]
+        };
+
+        struct quality_subflow *sf =
+                l_queue_find(conn->subflows, quality_subflow_match, &key);
+
+        if (sf == NULL) {
+                sf = l_memdup(&key, sizeof(key));
+                sf->total_retrans = s->retrans[i];
+                sf->segs_out      = s->segs_out[i];
+
+                l_queue_push_tail(conn->subflows, sf);
+        }
+
+        uint32_t const sent    = s->segs_out[i] - sf->segs_out;
+        uint32_t const retrans = s->retrans[i] - sf->total_retrans;
+
+        sf->loss          = sent == 0 ? 0 : retrans * 100 / sent;
+        sf->rtt           = s->rtt[i];
+        sf->total_retrans = s->retrans[i];
+        sf->segs_out      = s->segs_out[i];
+        sf->delivery_rate = s->delivery_rate[i];
+        sf->backup        = s->backup[i];
+        sf->round         = quality->round;
+}
+
+
+// ----------------------------------------------------------------
+
+static void find_best_rtt(void *data, void *user_data)
+{
+        struct quality_subflow const *const sf = data;
+        uint32_t *const best = user_data;
+
+        if (sf->loss < QUALITY_LOSS_HIGH && sf->rtt < *best)
+                *best = sf->rtt;
+}
+
+static void count_active(void *data, void *user_data)
+{
+        struct quality_subflow const *const sf = data;
+        unsigned int *const active = user_data;
+
+        if (!sf->backup)
+                ++*active;
+}
+
+/**
+ * @struct quality_eval_data
+ *
+ * @brief Connection wide data used when evaluating subflows.
+ */
+struct quality_eval_data
+{
+        /// Connection being evaluated.
+        struct quality_connection const *conn;
+
+        /// Lowest RTT of all non-lossy subflows.
+        uint32_t best_rtt;
+
+        /// Number of non-backup subflows.
+        unsigned int active;
+};
+
+static void quality_set_backup(struct quality_connection const *conn,
+                               struct quality_subflow *sf,
+                               bool backup)
+{
+        int const result =
+                mptcpd_pm_set_backup(quality->pm,
+                                     conn->token,
+                                     (struct sockaddr const *) &sf->laddr,
+                                     (struct sockaddr const *) &sf->raddr,
+                                     backup);
+
+        if (result != 0) {
+                l_warn("Unable to change subflow priority: %d", result);
+                return;
+        }
+
+        sf->backup  = backup;
+        sf->demoted = backup;
+        sf->streak  = 0;
+
+        l_debug("token 0x%" PRIx32 ": subflow %s (rtt %" PRIu32
+                " us, loss %u%%)",
+                conn->token,
+                backup ? "demoted" : "promoted",
+                sf->rtt,
+                sf->loss);
+}
+
+static void evaluate_subflow(void *data, void *user_data)
+{
+        struct quality_subflow *const sf = data;
+        struct quality_eval_data *const eval = user_data;
+
+        uint32_t const best = eval->best_rtt;
+
+        bool const slow =
+                sf->rtt > best * 2 && sf->rtt - best > QUALITY_RTT_SLACK_US;
+        bool const poor = sf->loss >= QUALITY_LOSS_HIGH || slow;
+        bool const good =
+                sf->loss < QUALITY_LOSS_LOW
+                && (sf->rtt <= best + best / 2
+                    || sf->rtt - best <= QUALITY_RTT_SLACK_US);
+
+        if (poor)
+                sf->streak = sf->streak > 0 ? -1 : sf->streak - 1;
+        else if (good)
+                sf->streak = sf->streak < 0 ? 1 : sf->streak + 1;
+        else
+                sf->streak = 0;
+
+        if (!sf->backup
+            && sf->streak <= -QUALITY_DEMOTE_ROUNDS
+            && eval->active > 1) {
+                // Never demote the last active subflow.
+                quality_set_backup(eval->conn, sf, true);
+                --eval->active;
+        } else if (sf->backup
+                   && sf->demoted
+                   && sf->streak >= QUALITY_PROMOTE_ROUNDS) {
+                // Only promote subflows demoted by this plugin.
+                quality_set_backup(eval->conn, sf, false);
+                ++eval->active;
+        }
+}
+
+static bool remove_stale_subflow(void *data, void *user_data)
+{
+        struct quality_subflow *const sf = data;
+        unsigned int const round = L_PTR_TO_UINT(user_data);
+
+        if (sf->round == round)
+                return false;
+
+        l_free(sf);
+
+        return true;
+}
+
+/**
+ * @brief Evaluate all subflows of a connection sampled in this round.
+ *
+ * @return @c true if the connection is no longer alive and should be
+ *         removed.
+ */
+static bool evaluate_connection(void const *key,
+                                void *value,
+                                void *user_data)
+{
+        (void) key;
+        (void) user_data;
+
+        struct quality_connection *const conn = value;
+
+        l_queue_foreach_remove(conn->subflows,
+                               remove_stale_subflow,
+                               L_UINT_TO_PTR(quality->round));
+
+        if (l_queue_isempty(conn->subflows)) {
+                quality_connection_destroy(conn);
+                return true;
+        }
+
+        // Nothing to choose from with a single subflow.
+        if (l_queue_length(conn->subflows) < 2)
+                return false;
+
+        struct quality_eval_data eval = {
+                .conn     = conn,
+                .best_rtt = UINT32_MAX
+        };
+
+        l_queue_foreach(conn->subflows, find_best_rtt, &eval.best_rtt);
+
+        // All subflows are lossy.  Leave priorities alone.
+        if (eval.best_rtt == UINT32_MAX)
+                return false;
+
+        l_queue_foreach(conn->subflows, count_active, &eval.active);
+        l_queue_foreach(conn->subflows, evaluate_subflow, &eval);
+
+        return false;
+}
+
+// ----------------------------------------------------------------
+
+static void handle_snapshot(struct mptcpd_diag_snapshot const *snapshot,
+                            void *user_data)
+{
+        (void) user_data;
+
+        struct mptcpd_diag_connections const *const conns =
+                &snapshot->connections;
+
+        ++quality->round;
+
+        for (size_t c = 0; c < conns->count; ++c) {
+                struct quality_connection *const conn =
+                        quality_connection_get(conns->token[c]);
+
+                if (conn == NULL)
+                        continue;
+
+                size_t const end = conns->first[c] + conns->subflows[c];
+
+                for (size_t i = conns->first[c]; i < end; ++i)
+                        update_subflow(conn, &snapshot->subflows, i);
+        }
+
+        l_hashmap_foreach_remove(quality->connections,
+                                 evaluate_connection,
+                                 NULL);
+}
+
+static struct mptcpd_diag_ops const diag_ops = {
+        .snapshot = handle_snapshot
+};
+
+
+// ----------------------------------------------------------------
+
+static bool remove_laddr_subflow(void *data, void *user_data)
+{
+        struct quality_subflow *const sf = data;
+        struct sockaddr const *const sa = user_data;
+
+        bool matched = false;
+
+        if (sa->sa_family != sf->laddr.ss_family)
+                return matched;
+
+        if (sa->sa_family == AF_INET) {
+                struct sockaddr_in const *const l =
+                        (struct sockaddr_in const *) &sf->laddr;
+
+                matched = memcmp(&l->sin_addr,
+                                 &((struct sockaddr_in const *) sa)->sin_addr,
+                                 sizeof(l->sin_addr)) == 0;
+        } else {
+                struct sockaddr_in6 const *const l =
+                        (struct sockaddr_in6 const *) &sf->laddr;
+
+                matched = memcmp(&l->sin6_addr,
+                                 &((struct sockaddr_in6 const *) sa)->sin6_addr,
+                                 sizeof(l->sin6_addr)) == 0;
+        }
+
+        if (matched)
+                l_free(sf);
+
+        return matched;
+}
+
+static void forget_laddr(void const *key, void *value, void *user_data)
+{
+        (void) key;
+
+        struct quality_connection *const conn = value;
+
+        l_queue_foreach_remove(conn->subflows,
+                               remove_laddr_subflow,
+                               user_data);
+}
+
+// ----------------------------------------------------------------
+//                     Mptcpd Plugin Operations
+// ----------------------------------------------------------------
+static void quality_delete_local_address(struct mptcpd_interface const *i,
+                                         struct sockaddr const *sa,
+                                         struct mptcpd_pm *pm)
+{
+        (void) i;
+        (void) pm;
+
+        /*
+          Subflows on a removed address are gone.  Drop their state
+          now rather than after the next sampling round so that no
+          priority change is attempted on them.
+        */
+        l_hashmap_foreach(quality->connections,
+                          forget_laddr,
+                          (void *) sa);
+}
+
+/**
+ * @note This plugin acts on sampled path quality of all MPTCP
+ *       subflows, regardless of the path manager plugin that handles
+ *       the corresponding connections.  It needs no connection
+ *       related callbacks.
+ */
+static struct mptcpd_plugin_ops const pm_ops = {
+        .delete_local_address = quality_delete_local_address
+};
+
+static int quality_init(struct mptcpd_pm *pm)
+{
+        static char const name[] = "quality";
+
+        quality = l_new(struct quality_sampler, 1);
+        quality->pm          = pm;
+        quality->connections = l_hashmap_new();
+
+        if (!mptcpd_diag_register_ops(mptcpd_pm_get_diag(pm),
+                                      &diag_ops,
+                                      NULL)) {
+                l_error("Unable to subscribe to subflow metrics.");
+                l_hashmap_destroy(quality->connections, NULL);
+                l_free(quality);
+                quality = NULL;
+
+                return -1;
+        }
+
+        if (!mptcpd_plugin_register_ops(name, &pm_ops)) {
+                l_error("Failed to initialize path quality plugin.");
+                mptcpd_diag_unregister_ops(mptcpd_pm_get_diag(pm),
+                                           &diag_ops,
+                                           NULL);
+                l_hashmap_destroy(quality->connections, NULL);
+                l_free(quality);
+                quality = NULL;
+
+                return -1;
+        }
+
+        l_info("MPTCP path quality plugin initialized.");
+
+        return 0;
+}
+
+static void quality_exit(struct mptcpd_pm *pm)
+{
+        if (quality != NULL) {
+                mptcpd_diag_unregister_ops(mptcpd_pm_get_diag(pm),
+                                           &diag_ops,
+                                           NULL);
+                l_hashmap_destroy(quality->connections,
+                                  quality_connection_destroy);
+                l_free(quality);
+                quality = NULL;
+        }
+
+        l_info("MPTCP path quality plugin exited.");
+}
+
+MPTCPD_PLUGIN_DEFINE(quality,
+                     "Path quality aware subflow priority",
+                     MPTCPD_PLUGIN_PRIORITY_LOW,
+                     quality_init,
+                     quality_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -13,7 +13,9 @@
 
 #include <assert.h>
 #include <stddef.h>  // For NULL.
+#include <stdint.h>
 #include <limits.h>
+#include <string.h>
 
 #include <netinet/in.h>
 
@@ -29,6 +31,14 @@
  */
 #define SSPI_BAD_INDEX INT_MAX
 
+/**
+ * @brief Format version of the exported connection state.
+ *
+ * The exported state is an array of @c int32_t network interface
+ * indices with a subflow of the connection.
+ */
+#define SSPI_STATE_VERSION 1
+
 /**
  * List of @c sspi_interface_info objects that contain MPTCP
  * connection tokens on each network interface.
@@ -321,6 +331,43 @@ static struct sspi_interface_info *sspi_interface_info_create(int index)
         return info;
 }
 
+/**
+ * @brief Get @c sspi_interface_info object associated with @a index.
+ *
+ * @param[in] index Network interface index.
+ *
+ * @return @c sspi_interface_info object associated with @a index,
+ *         or @c NULL if tracking of the network interface failed.
+ */
+static struct sspi_interface_info *sspi_interface_info_get(int index)
+{
+        /*
+          Check if a network interface with the provided index is
+          currently tracked by this plugin.
+         */
+        struct sspi_interface_info *info =
+                l_queue_find(sspi_interfaces, sspi_index_match, &index);
+
+        if (info == NULL) {
+                /*
+                  No MPTCP connections associated with the network
+                  interface with the local address.  Prepare for
+                  tracking of that network interface.
+                */
+                info = sspi_interface_info_create(index);
+
+                if (!l_queue_insert(sspi_interfaces,
+                                    info,
+                                    sspi_interface_info_compare,
+                                    NULL)) {
+                        sspi_interface_info_destroy(info);
+                        info = NULL;
+                }
+        }
+
+        return info;
+}
+
 /**
  * @brief Get @c sspi_interface_info object associated with @a addr.
  *
@@ -355,32 +402,7 @@ static struct sspi_interface_info *sspi_interface_info_lookup(
                 return NULL;
         }
 
-        /*
-          Check if a network interface with the provided local address
-          (via the index value found above) is currently tracked by
-          this plugin.
-         */
-        struct sspi_interface_info *info =
-                l_queue_find(sspi_interfaces, sspi_index_match, &index);
-
-        if (info == NULL) {
-                /*
-                  No MPTCP connections associated with the network
-                  interface with the local address.  Prepare for
-                  tracking of that network interface.
-                */
-                info = sspi_interface_info_create(index);
-
-                if (!l_queue_insert(sspi_interfaces,
-                                    info,
-                                    sspi_interface_info_compare,
-                                    NULL)) {
-                        sspi_interface_info_destroy(info);
-                        info = NULL;
-                }
-        }
-
-        return info;
+        return sspi_interface_info_get(index);
 }
 
 // ----------------------------------------------------------------
@@ -799,6 +821,105 @@ static void sspi_listener_closed(struct sockaddr const *laddr,
         */
 }
 
+/**
+ * @struct sspi_export_info
+ *
+ * @brief Network interfaces used by an MPTCP connection.
+ */
+struct sspi_export_info
+{
+        /// MPTCP connection token.                        (IN)
+        mptcpd_token_t const token;
+
+        /// Indices of network interfaces used by @c token. (OUT)
+        int32_t *const indices;
+
+        /// Number of entries in @c indices.                (OUT)
+        size_t count;
+};
+
+static void sspi_export_index(void *data, void *user_data)
+{
+        struct sspi_interface_info const *const info = data;
+        struct sspi_export_info *const export = user_data;
+
+        if (l_queue_find(info->tokens,
+                         sspi_token_match,
+                         L_UINT_TO_PTR(export->token)) != NULL)
+                export->indices[export->count++] = info->index;
+}
+
+static void *sspi_export_state(mptcpd_token_t token,
+                               uint32_t *version,
+                               size_t *len,
+                               struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        unsigned int const interfaces = l_queue_length(sspi_interfaces);
+
+        if (interfaces == 0)
+                return NULL;
+
+        struct sspi_export_info info = {
+                .token   = token,
+                .indices = l_new(int32_t, interfaces)
+        };
+
+        l_queue_foreach(sspi_interfaces, sspi_export_index, &info);
+
+        if (info.count == 0) {
+                l_free(info.indices);
+
+                return NULL;
+        }
+
+        *version = SSPI_STATE_VERSION;
+        *len     = info.count * sizeof(*info.indices);
+
+        return info.indices;
+}
+
+static bool sspi_import_state(mptcpd_token_t token,
+                              uint32_t version,
+                              void const *state,
+                              size_t len,
+                              struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        if (version != SSPI_STATE_VERSION
+            || len % sizeof(int32_t) != 0
+            || token == 0)
+                return false;
+
+        uint8_t const *const bytes = state;
+
+        for (size_t offset = 0; offset < len; offset += sizeof(int32_t)) {
+                int32_t index;
+
+                // The state is not necessarily aligned.
+                memcpy(&index, bytes + offset, sizeof(index));
+
+                struct sspi_interface_info *const info =
+                        sspi_interface_info_get(index);
+
+                if (info == NULL)
+                        return false;
+
+                if (l_queue_find(info->tokens,
+                                 sspi_token_match,
+                                 L_UINT_TO_PTR(token)) == NULL
+                    && !l_queue_insert(info->tokens,
+                                       L_UINT_TO_PTR(token),
+                                       sspi_token_compare,
+                                       NULL))
+                        return false;
+        }
+
+        return true;
+}
+
 static struct mptcpd_plugin_ops const pm_ops = {
         .new_connection         = sspi_new_connection,
         .connection_established = sspi_connection_established,
@@ -809,7 +930,9 @@ static struct mptcpd_plugin_ops const pm_ops = {
         .subflow_closed         = sspi_subflow_closed,
         .subflow_priority       = sspi_subflow_priority,
         .listener_created       = sspi_listener_created,
-        .listener_closed        = sspi_listener_closed
+        .listener_closed        = sspi_listener_closed,
+        .export_state           = sspi_export_state,
+        .import_state           = sspi_import_state
 };
 
 static int sspi_init(struct mptcpd_pm *pm)
@@ -14,11 +14,15 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
 #include <argp.h>
 #include <assert.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <arpa/inet.h>
 
 #include <ell/ell.h>
 
@@ -27,6 +31,8 @@
 #include <mptcpd/private/configuration.h>
 #include <mptcpd/private/network_monitor.h>
 
+#include "process.h"
+
 #ifdef HAVE_CONFIG_H
 # include <mptcpd/private/config.h>
 #endif
@@ -306,6 +312,72 @@ static void set_default_plugin(struct mptcpd_config *config,
         reset_string(&config->default_plugin, plugin);
 }
 
+/**
+ * @brief Set persistent state file path.
+ *
+ * @param[in,out] config Mptcpd configuration.
+ * @param[in]     path   Persistent state file path.  Ownership of
+ *                       memory is transferred to @a config.
+ */
+static void set_state_file(struct mptcpd_config *config, char *path)
+{
+        reset_string(&config->state_file, path);
+}
+
+/**
+ * @brief Set CPU affinity.
+ *
+ * @param[in,out] config Mptcpd configuration.
+ * @param[in]     cpus   CPU list.  Ownership of memory is
+ *                       transferred to @a config.
+ *
+ * @return @c true if @a cpus is a valid CPU list, and @c false
+ *         otherwise, in which case @a cpus is deallocated.
+ */
+static bool set_cpu_affinity(struct mptcpd_config *config, char *cpus)
+{
+        if (!mptcpd_cpu_list_foreach(cpus, NULL, NULL)) {
+                l_free(cpus);
+                return false;
+        }
+
+        reset_string(&config->cpu_affinity, cpus);
+
+        return true;
+}
+
+/**
+ * @brief Convert a scheduling policy name to a @c MPTCPD_SCHED_*
+ *        value.
+ *
+ * @param[in]  str    Scheduling policy name, i.e. "other", "fifo"
+ *                    or "rr".
+ * @param[out] policy Scheduling policy.
+ *
+ * @return @c true on successful conversion, and @c false otherwise.
+ */
+static bool sched_policy_from_string(char const *str, uint32_t *policy)
+{
+        static struct
+        {
+                char const *name;
+                uint32_t policy;
+        } const policies[] = {
+                { "other", MPTCPD_SCHED_OTHER },
+                { "fifo",  MPTCPD_SCHED_FIFO },
+                { "rr",    MPTCPD_SCHED_RR }
+        };
+
+        for (size_t i = 0; i < L_ARRAY_SIZE(policies); ++i) {
+                if (strcmp(str, policies[i].name) == 0) {
+                        *policy = policies[i].policy;
+                        return true;
+                }
+        }
+
+        return false;
+}
+
 /**
  * @brief Set plugins to load.
  *
@@ -330,6 +402,32 @@ static void set_plugins_to_load(struct mptcpd_config *config,
         l_free((char *) plugins);
 }
 
+/**
+ * @brief Convert a subflow limit string to an unsigned integer.
+ *
+ * @param[in]  str   Non-negative decimal integer string.
+ * @param[out] limit Converted value.
+ *
+ * @return @c true on successful conversion, and @c false otherwise.
+ */
+static bool limit_from_string(char const *str, uint32_t *limit)
+{
+        assert(limit != NULL);
+
+        char *end = NULL;
+
+        errno = 0;
+        unsigned long const value = strtoul(str, &end, 10);
+
+        if (errno != 0 || end == str || *end != '\0'
+            || strchr(str, '-') != NULL || value > UINT32_MAX)
+                return false;
+
+        *limit = value;
+
+        return true;
+}
+
 // ---------------------------------------------------------------
 // Command line options
 // ---------------------------------------------------------------
@@ -363,6 +461,39 @@ static char const doc[] =
 
 /// Command line option key for "--load-plugins"
 #define MPTCPD_LOAD_PLUGINS_KEY 0x104
+
+/// Command line option key for "--max-subflows"
+#define MPTCPD_MAX_SUBFLOWS_KEY 0x105
+
+/// Command line option key for "--max-subflows-per-interface"
+#define MPTCPD_MAX_SUBFLOWS_PER_IF_KEY 0x106
+
+/// Command line option key for "--join-limit-per-interface"
+#define MPTCPD_JOIN_LIMIT_PER_IF_KEY 0x107
+
+/// Command line option key for "--join-limit-per-destination"
+#define MPTCPD_JOIN_LIMIT_PER_DEST_KEY 0x108
+
+/// Command line option key for "--join-jitter"
+#define MPTCPD_JOIN_JITTER_KEY 0x109
+
+/// Command line option key for "--state-file"
+#define MPTCPD_STATE_FILE_KEY 0x10a
+
+/// Command line option key for "--stall-threshold"
+#define MPTCPD_STALL_THRESHOLD_KEY 0x10b
+
+/// Command line option key for "--cpu-affinity"
+#define MPTCPD_CPU_AFFINITY_KEY 0x10c
+
+/// Command line option key for "--sched-policy"
+#define MPTCPD_SCHED_POLICY_KEY 0x10d
+
+/// Command line option key for "--sched-priority"
+#define MPTCPD_SCHED_PRIORITY_KEY 0x10e
+
+/// Command line option key for "--lock-memory"
+#define MPTCPD_LOCK_MEMORY_KEY 0x10f
 ///@}
 
 static struct argp_option const options[] = {
@@ -406,6 +537,81 @@ static struct argp_option const options[] = {
           "Specify which plugins to load, e.g. --load-plugins=addr_adv,"
           "sspi",
           0 },
+        { "max-subflows",
+          MPTCPD_MAX_SUBFLOWS_KEY,
+          "NUM",
+          0,
+          "Maximum number of subflows per connection created by "
+          "path manager plugins, e.g. --max-subflows=8",
+          0 },
+        { "max-subflows-per-interface",
+          MPTCPD_MAX_SUBFLOWS_PER_IF_KEY,
+          "NUM",
+          0,
+          "Maximum number of subflows per connection created through "
+          "a single network interface, e.g. "
+          "--max-subflows-per-interface=2",
+          0 },
+        { "join-limit-per-interface",
+          MPTCPD_JOIN_LIMIT_PER_IF_KEY,
+          "NUM",
+          0,
+          "Maximum number of concurrent subflow joins through a "
+          "single network interface, e.g. --join-limit-per-interface=4",
+          0 },
+        { "join-limit-per-destination",
+          MPTCPD_JOIN_LIMIT_PER_DEST_KEY,
+          "NUM",
+          0,
+          "Maximum number of concurrent subflow joins to a single "
+          "remote address, e.g. --join-limit-per-destination=2",
+          0 },
+        { "join-jitter",
+          MPTCPD_JOIN_JITTER_KEY,
+          "MSEC",
+          0,
+          "Maximum random delay in milliseconds before creating a "
+          "subflow, e.g. --join-jitter=20",
+          0 },
+        { "state-file",
+          MPTCPD_STATE_FILE_KEY,
+          "FILE",
+          0,
+          "Save state to FILE on shutdown and restore it on startup, "
+          "e.g. --state-file=/run/mptcpd/state",
+          0 },
+        { "stall-threshold",
+          MPTCPD_STALL_THRESHOLD_KEY,
+          "MSEC",
+          0,
+          "Log event loop stalls of at least MSEC milliseconds, "
+          "e.g. --stall-threshold=50",
+          0 },
+        { "cpu-affinity",
+          MPTCPD_CPU_AFFINITY_KEY,
+          "CPUS",
+          0,
+          "Run on the listed CPUs only, e.g. --cpu-affinity=0-1,4",
+          0 },
+        { "sched-policy",
+          MPTCPD_SCHED_POLICY_KEY,
+          "POLICY",
+          0,
+          "Set scheduling policy to POLICY (other, fifo or rr), "
+          "e.g. --sched-policy=fifo",
+          0 },
+        { "sched-priority",
+          MPTCPD_SCHED_PRIORITY_KEY,
+          "NUM",
+          0,
+          "Set real-time scheduling priority, e.g. --sched-priority=10",
+          0 },
+        { "lock-memory",
+          MPTCPD_LOCK_MEMORY_KEY,
+          0,
+          0,
+          "Lock memory and prefault memory pools",
+          0 },
         { 0 }
 };
 
@@ -456,6 +662,86 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
 
                 set_plugins_to_load(config, l_strdup(arg));
                 break;
+        case MPTCPD_MAX_SUBFLOWS_KEY:
+                if (!limit_from_string(arg, &config->max_subflows))
+                        argp_error(state,
+                                   "Invalid maximum subflows: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_MAX_SUBFLOWS_PER_IF_KEY:
+                if (!limit_from_string(arg,
+                                       &config->max_subflows_per_interface))
+                        argp_error(state,
+                                   "Invalid maximum subflows per "
+                                   "interface: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_JOIN_LIMIT_PER_IF_KEY:
+                if (!limit_from_string(arg,
+                                       &config->join_limit_per_interface))
+                        argp_error(state,
+                                   "Invalid subflow join limit per "
+                                   "interface: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_JOIN_LIMIT_PER_DEST_KEY:
+                if (!limit_from_string(arg,
+                                       &config->join_limit_per_destination))
+                        argp_error(state,
+                                   "Invalid subflow join limit per "
+                                   "destination: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_JOIN_JITTER_KEY:
+                if (!limit_from_string(arg, &config->join_jitter))
+                        argp_error(state,
+                                   "Invalid subflow join jitter: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_STATE_FILE_KEY:
+                if (strlen(arg) == 0)
+                        argp_error(state,
+                                   "Empty state file command line "
+                                   "option.");
+
+                set_state_file(config, l_strdup(arg));
+                break;
+        case MPTCPD_STALL_THRESHOLD_KEY:
+                if (!limit_from_string(arg, &config->stall_threshold))
+                        argp_error(state,
+                                   "Invalid stall threshold: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_CPU_AFFINITY_KEY:
+                if (!set_cpu_affinity(config, l_strdup(arg)))
+                        argp_error(state,
+                                   "Invalid CPU affinity: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_SCHED_POLICY_KEY:
+                if (!sched_policy_from_string(arg, &config->sched_policy))
+                        argp_error(state,
+                                   "Unknown scheduling policy: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_SCHED_PRIORITY_KEY:
+                if (!limit_from_string(arg, &config->sched_priority))
+                        argp_error(state,
+                                   "Invalid scheduling priority: \"%s\"",
+                                   arg);
+
+                break;
+        case MPTCPD_LOCK_MEMORY_KEY:
+                config->lock_memory = true;
+                break;
         default:
                 return ARGP_ERR_UNKNOWN;
         };
@@ -563,6 +849,22 @@ static void parse_config_plugin_dir(struct mptcpd_config *config,
                 set_plugin_dir(config, plugin_dir);
 }
 
+static void parse_config_state_file(struct mptcpd_config *config,
+                                    struct l_settings const *settings,
+                                    char const *group)
+{
+        if (config->state_file != NULL)
+                return;  // Previously set, e.g. via command line.
+
+        char *const state_file =
+                l_settings_get_string(settings,
+                                      group,
+                                      "state-file");
+
+        if (state_file != NULL)
+                set_state_file(config, state_file);
+}
+
 static void parse_config_addr_flags(struct mptcpd_config *config,
                                     struct l_settings const *settings,
                                     char const *group)
@@ -635,6 +937,529 @@ static void parse_config_plugins_to_load(
                 set_plugins_to_load(config, plugins_to_load);
 }
 
+static void parse_config_limit(uint32_t *limit,
+                               struct l_settings const *settings,
+                               char const *group,
+                               char const *key)
+{
+        if (*limit != 0)
+                return;  // Previously set, e.g. via command line.
+
+        unsigned int value = 0;
+
+        if (!l_settings_has_key(settings, group, key))
+                return;
+
+        if (l_settings_get_uint(settings, group, key, &value))
+                *limit = value;
+        else
+                l_warn("Invalid \"%s\" value in configuration file.",
+                       key);
+}
+
+static void parse_config_process(struct mptcpd_config *config,
+                                 struct l_settings const *settings,
+                                 char const *group)
+{
+        // Settings previously set, e.g. via command line, are kept.
+        if (config->cpu_affinity == NULL) {
+                char *const cpus =
+                        l_settings_get_string(settings,
+                                              group,
+                                              "cpu-affinity");
+
+                if (cpus != NULL && !set_cpu_affinity(config, cpus))
+                        l_warn("Invalid \"cpu-affinity\" value in "
+                               "configuration file.");
+        }
+
+        if (config->sched_policy == MPTCPD_SCHED_DEFAULT) {
+                char *const policy =
+                        l_settings_get_string(settings,
+                                              group,
+                                              "sched-policy");
+
+                if (policy != NULL
+                    && !sched_policy_from_string(policy,
+                                                 &config->sched_policy))
+                        l_warn("Unknown \"sched-policy\" value in "
+                               "configuration file.");
+
+                l_free(policy);
+        }
+
+        parse_config_limit(&config->sched_priority,
+                           settings,
+                           group,
+                           "sched-priority");
+
+        if (!config->lock_memory
+            && l_settings_has_key(settings, group, "lock-memory")
+            && !l_settings_get_bool(settings,
+                                    group,
+                                    "lock-memory",
+                                    &config->lock_memory))
+                l_warn("Invalid \"lock-memory\" value in "
+                       "configuration file.");
+}
+
+/**
+ * @brief Deallocate a @c mptcpd_interface_policy object.
+ *
+ * @param[in,out] data Interface policy to be deallocated.
+ */
+static void interface_policy_destroy(void *data)
+{
+        struct mptcpd_interface_policy *const policy = data;
+
+        if (policy == NULL)
+                return;
+
+        l_free(policy->pattern);
+        l_free(policy);
+}
+
+/**
+ * @brief Duplicate a @c mptcpd_interface_policy object.
+ *
+ * @param[in] data      Interface policy to be duplicated.
+ * @param[in] user_data Queue to append the duplicate to.
+ */
+static void interface_policy_copy(void *data, void *user_data)
+{
+        struct mptcpd_interface_policy const *const src = data;
+        struct l_queue *const dst = user_data;
+
+        struct mptcpd_interface_policy *const policy =
+                l_memdup(src, sizeof(*src));
+
+        policy->pattern = l_strdup(src->pattern);
+
+        l_queue_push_tail(dst, policy);
+}
+
+/**
+ * @brief Parse a network interface policy group.
+ *
+ * Interface policy groups are named "interface <pattern>", where
+ * @c <pattern> is a shell-style wildcard pattern matched against
+ * network interface names, e.g.:
+ *
+ * @code
+ * [interface wwan*]
+ * cost=10
+ * backup=true
+ * max-subflows=1
+ * @endcode
+ *
+ * @param[in,out] config   Mptcpd configuration.
+ * @param[in]     settings Mptcpd configuration file settings.
+ * @param[in]     group    Configuration file group name.
+ */
+static void parse_config_interface_policy(
+        struct mptcpd_config *config,
+        struct l_settings const *settings,
+        char const *group)
+{
+        static char const prefix[] = "interface ";
+
+        if (!l_str_has_prefix(group, prefix))
+                return;
+
+        char const *pattern = group + sizeof(prefix) - 1;
+
+        while (*pattern == ' ')
+                ++pattern;
+
+        if (*pattern == '\0') {
+                l_warn("Ignoring interface policy without a pattern.");
+                return;
+        }
+
+        struct mptcpd_interface_policy *const policy =
+                l_new(struct mptcpd_interface_policy, 1);
+
+        policy->pattern = l_strdup(pattern);
+
+        if (l_settings_has_key(settings, group, "cost")
+            && !l_settings_get_uint(settings,
+                                    group,
+                                    "cost",
+                                    &policy->cost))
+                l_warn("Invalid \"cost\" value for interface "
+                       "policy \"%s\".", pattern);
+
+        if (l_settings_has_key(settings, group, "backup")
+            && !l_settings_get_bool(settings,
+                                    group,
+                                    "backup",
+                                    &policy->backup))
+                l_warn("Invalid \"backup\" value for interface "
+                       "policy \"%s\".", pattern);
+
+        if (l_settings_has_key(settings, group, "max-subflows")
+            && !l_settings_get_uint(settings,
+                                    group,
+                                    "max-subflows",
+                                    &policy->max_subflows))
+                l_warn("Invalid \"max-subflows\" value for interface "
+                       "policy \"%s\".", pattern);
+
+        if (config->interface_policies == NULL)
+                config->interface_policies = l_queue_new();
+
+        l_queue_push_tail(config->interface_policies, policy);
+}
+
+/**
+ * @brief Log a network interface policy.
+ *
+ * @param[in] data      Interface policy.
+ * @param[in] user_data Unused.
+ */
+static void interface_policy_log(void *data, void *user_data)
+{
+        (void) user_data;
+
+        struct mptcpd_interface_policy const *const policy = data;
+
+        l_debug("interface policy \"%s\": cost %u%s, max subflows %u",
+                policy->pattern,
+                policy->cost,
+                policy->backup ? ", backup" : "",
+                policy->max_subflows);
+}
+
+void mptcpd_config_parse_interface_policies(
+        struct mptcpd_config *config,
+        struct l_settings const *settings)
+{
+        if (config->interface_policies != NULL)
+                return;  // Previously set.
+
+        char **const groups = l_settings_get_groups(settings);
+
+        if (groups == NULL)
+                return;
+
+        for (char **group = groups; *group != NULL; ++group)
+                parse_config_interface_policy(config, settings, *group);
+
+        l_strfreev(groups);
+}
+
+/**
+ * @brief Deallocate a @c mptcpd_plugin_rule object.
+ *
+ * @param[in,out] data Plugin selection rule to be deallocated.
+ */
+static void plugin_rule_destroy(void *data)
+{
+        struct mptcpd_plugin_rule *const rule = data;
+
+        if (rule == NULL)
+                return;
+
+        l_free(rule->name);
+        l_free(rule->plugin);
+        l_free(rule);
+}
+
+/**
+ * @brief Duplicate a @c mptcpd_plugin_rule object.
+ *
+ * @param[in] data      Plugin selection rule to be duplicated.
+ * @param[in] user_data Queue to append the duplicate to.
+ */
+static void plugin_rule_copy(void *data, void *user_data)
+{
+        struct mptcpd_plugin_rule const *const src = data;
+        struct l_queue *const dst = user_data;
+
+        struct mptcpd_plugin_rule *const rule =
+                l_memdup(src, sizeof(*src));
+
+        rule->name   = l_strdup(src->name);
+        rule->plugin = l_strdup(src->plugin);
+
+        l_queue_push_tail(dst, rule);
+}
+
+/**
+ * @brief Parse an IP address prefix, e.g. "192.0.2.0/24".
+ *
+ * @param[in]  str    Address prefix string.  The prefix length may
+ *                    be omitted to match a single address.
+ * @param[out] addr   Address prefix.
+ * @param[out] length Address prefix length in bits.
+ *
+ * @return @c true on success, and @c false otherwise.
+ */
+static bool parse_prefix(char const *str,
+                         struct sockaddr_storage *addr,
+                         uint8_t *length)
+{
+        char *const s = l_strdup(str);
+        char *const slash = strchr(s, '/');
+
+        if (slash != NULL)
+                *slash = '\0';
+
+        memset(addr, 0, sizeof(*addr));
+
+        struct sockaddr_in  *const addr4 = (struct sockaddr_in *)  addr;
+        struct sockaddr_in6 *const addr6 = (struct sockaddr_in6 *) addr;
+
+        unsigned long max_len = 0;
+
+        if (inet_pton(AF_INET, s, &addr4->sin_addr) == 1) {
+                addr4->sin_family = AF_INET;
+                max_len = 32;
+        } else if (inet_pton(AF_INET6, s, &addr6->sin6_addr) == 1) {
+                addr6->sin6_family = AF_INET6;
+                max_len = 128;
+        }
+
+        unsigned long len = max_len;
+        bool ok = max_len != 0;
+
+        if (ok && slash != NULL) {
+                char *end = NULL;
+
+                errno = 0;
+                len = strtoul(slash + 1, &end, 10);
+
+                ok = errno == 0
+                        && end != slash + 1
+                        && *end == '\0'
+                        && len <= max_len;
+        }
+
+        l_free(s);
+
+        if (ok)
+                *length = len;
+
+        return ok;
+}
+
+/**
+ * @brief Parse a port number of a plugin selection rule.
+ *
+ * @param[out] port     Port number in host byte order, unchanged if
+ *                      not set.
+ * @param[in]  settings Mptcpd configuration file settings.
+ * @param[in]  group    Configuration file group name.
+ * @param[in]  key      Configuration file key.
+ *
+ * @return @c false if the port number is invalid, and @c true
+ *         otherwise.
+ */
+static bool parse_config_port(uint16_t *port,
+                              struct l_settings const *settings,
+                              char const *group,
+                              char const *key)
+{
+        if (!l_settings_has_key(settings, group, key))
+                return true;
+
+        unsigned int value = 0;
+
+        if (!l_settings_get_uint(settings, group, key, &value)
+            || value == 0
+            || value > UINT16_MAX)
+                return false;
+
+        *port = value;
+
+        return true;
+}
+
+/**
+ * @brief Parse a path manager plugin selection rule group.
+ *
+ * Plugin selection rule groups are named "connection <name>", e.g.:
+ *
+ * @code
+ * [connection web]
+ * plugin=sspi
+ * local-port=443
+ * server-side=true
+ *
+ * [connection lan]
+ * plugin=fullmesh
+ * remote-address=10.0.0.0/8
+ * @endcode
+ *
+ * @param[in,out] config   Mptcpd configuration.
+ * @param[in]     settings Mptcpd configuration file settings.
+ * @param[in]     group    Configuration file group name.
+ */
+static void parse_config_plugin_rule(
+        struct mptcpd_config *config,
+        struct l_settings const *settings,
+        char const *group)
+{
+        static char const prefix[] = "connection ";
+
+        if (!l_str_has_prefix(group, prefix))
+                return;
+
+        char const *name = group + sizeof(prefix) - 1;
+
+        while (*name == ' ')
+                ++name;
+
+        char *const plugin =
+                l_settings_get_string(settings, group, "plugin");
+
+        if (plugin == NULL || *plugin == '\0') {
+                l_warn("Ignoring plugin selection rule \"%s\" "
+                       "without a plugin.", name);
+                l_free(plugin);
+                return;
+        }
+
+        struct mptcpd_plugin_rule *const rule =
+                l_new(struct mptcpd_plugin_rule, 1);
+
+        rule->name        = l_strdup(name);
+        rule->plugin      = plugin;
+        rule->server_side = true;
+        rule->client_side = true;
+
+        bool ok = true;
+
+        char *const remote =
+                l_settings_get_string(settings, group, "remote-address");
+
+        if (remote != NULL
+            && !parse_prefix(remote,
+                             &rule->remote_prefix,
+                             &rule->remote_prefix_len)) {
+                l_warn("Invalid \"remote-address\" value for plugin "
+                       "selection rule \"%s\".", name);
+                ok = false;
+        }
+
+        l_free(remote);
+
+        if (!parse_config_port(&rule->local_port,
+                               settings,
+                               group,
+                               "local-port")) {
+                l_warn("Invalid \"local-port\" value for plugin "
+                       "selection rule \"%s\".", name);
+                ok = false;
+        }
+
+        if (!parse_config_port(&rule->remote_port,
+                               settings,
+                               group,
+                               "remote-port")) {
+                l_warn("Invalid \"remote-port\" value for plugin "
+                       "selection rule \"%s\".", name);
+                ok = false;
+        }
+
+        if (l_settings_has_key(settings, group, "server-side")) {
+                bool server_side = false;
+
+                if (l_settings_get_bool(settings,
+                                        group,
+                                        "server-side",
+                                        &server_side)) {
+                        rule->server_side = server_side;
+                        rule->client_side = !server_side;
+                } else {
+                        l_warn("Invalid \"server-side\" value for "
+                               "plugin selection rule \"%s\".", name);
+                        ok = false;
+                }
+        }
+
+        // Don't apply a rule more broadly than intended.
+        if (!ok) {
+                l_warn("Ignoring plugin selection rule \"%s\".", name);
+                plugin_rule_destroy(rule);
+                return;
+        }
+
+        if (config->plugin_rules == NULL)
+                config->plugin_rules = l_queue_new();
+
+        l_queue_push_tail(config->plugin_rules, rule);
+}
+
+/**
+ * @brief Log a path manager plugin selection rule.
+ *
+ * @param[in] data      Plugin selection rule.
+ * @param[in] user_data Unused.
+ */
+static void plugin_rule_log(void *data, void *user_data)
+{
+        (void) user_data;
+
+        struct mptcpd_plugin_rule const *const rule = data;
+
+        char addr[INET6_ADDRSTRLEN] = "any";
+        void const *src = NULL;
+
+        if (rule->remote_prefix.ss_family == AF_INET) {
+                struct sockaddr_in const *const sa =
+                        (struct sockaddr_in const *) &rule->remote_prefix;
+
+                src = &sa->sin_addr;
+        } else if (rule->remote_prefix.ss_family == AF_INET6) {
+                struct sockaddr_in6 const *const sa =
+                        (struct sockaddr_in6 const *) &rule->remote_prefix;
+
+                src = &sa->sin6_addr;
+        }
+
+        if (src != NULL)
+                (void) inet_ntop(rule->remote_prefix.ss_family,
+                                 src,
+                                 addr,
+                                 sizeof(addr));
+
+        l_debug("plugin selection rule \"%s\": plugin %s, "
+                "remote address %s/%u, local port %u, remote port %u%s",
+                rule->name,
+                rule->plugin,
+                addr,
+                rule->remote_prefix_len,
+                rule->local_port,
+                rule->remote_port,
+                rule->server_side && rule->client_side ? ""
+                : (rule->server_side ? ", server side" : ", client side"));
+}
+
+/**
+ * @brief Parse path manager plugin selection rule groups.
+ *
+ * @param[in,out] config   Mptcpd configuration.
+ * @param[in]     settings Mptcpd configuration file settings.
+ */
+static void parse_config_plugin_rules(
+        struct mptcpd_config *config,
+        struct l_settings const *settings)
+{
+        if (config->plugin_rules != NULL)
+                return;  // Previously set.
+
+        char **const groups = l_settings_get_groups(settings);
+
+        if (groups == NULL)
+                return;
+
+        for (char **group = groups; *group != NULL; ++group)
+                parse_config_plugin_rule(config, settings, *group);
+
+        l_strfreev(groups);
+}
+
 /**
  * @brief Parse configuration file.
  *
@@ -679,6 +1504,52 @@ static bool parse_config_file(struct mptcpd_config *config,
 
                 // Plugins to load.
                 parse_config_plugins_to_load(config, settings, group);
+
+                // Subflow limits.
+                parse_config_limit(&config->max_subflows,
+                                   settings,
+                                   group,
+                                   "max-subflows");
+
+                parse_config_limit(&config->max_subflows_per_interface,
+                                   settings,
+                                   group,
+                                   "max-subflows-per-interface");
+
+                // Subflow join pacing.
+                parse_config_limit(&config->join_limit_per_interface,
+                                   settings,
+                                   group,
+                                   "join-limit-per-interface");
+
+                parse_config_limit(&config->join_limit_per_destination,
+                                   settings,
+                                   group,
+                                   "join-limit-per-destination");
+
+                parse_config_limit(&config->join_jitter,
+                                   settings,
+                                   group,
+                                   "join-jitter");
+
+                // Persistent state.
+                parse_config_state_file(config, settings, group);
+
+                // Event loop latency monitoring.
+                parse_config_limit(&config->stall_threshold,
+                                   settings,
+                                   group,
+                                   "stall-threshold");
+
+                // Process scheduling and memory.
+                parse_config_process(config, settings, group);
+
+                // Network interface policies.
+                mptcpd_config_parse_interface_policies(config,
+                                                       settings);
+
+                // Path manager plugin selection rules.
+                parse_config_plugin_rules(config, settings);
         } else {
                 l_debug("Unable to load mptcpd settings from file '%s'",
                         filename);
@@ -754,6 +1625,59 @@ static bool merge_config(struct mptcpd_config       *dst,
         if (dst->default_plugin == NULL)
                 dst->default_plugin = l_strdup(src->default_plugin);
 
+        if (dst->max_subflows == 0)
+                dst->max_subflows = src->max_subflows;
+
+        if (dst->max_subflows_per_interface == 0)
+                dst->max_subflows_per_interface =
+                        src->max_subflows_per_interface;
+
+        if (dst->join_limit_per_interface == 0)
+                dst->join_limit_per_interface =
+                        src->join_limit_per_interface;
+
+        if (dst->join_limit_per_destination == 0)
+                dst->join_limit_per_destination =
+                        src->join_limit_per_destination;
+
+        if (dst->join_jitter == 0)
+                dst->join_jitter = src->join_jitter;
+
+        if (dst->state_file == NULL)
+                dst->state_file = l_strdup(src->state_file);
+
+        if (dst->stall_threshold == 0)
+                dst->stall_threshold = src->stall_threshold;
+
+        if (dst->cpu_affinity == NULL)
+                dst->cpu_affinity = l_strdup(src->cpu_affinity);
+
+        if (dst->sched_policy == MPTCPD_SCHED_DEFAULT)
+                dst->sched_policy = src->sched_policy;
+
+        if (dst->sched_priority == 0)
+                dst->sched_priority = src->sched_priority;
+
+        if (!dst->lock_memory)
+                dst->lock_memory = src->lock_memory;
+
+        if (dst->interface_policies == NULL
+            && src->interface_policies != NULL) {
+                dst->interface_policies = l_queue_new();
+
+                l_queue_foreach(src->interface_policies,
+                                interface_policy_copy,
+                                dst->interface_policies);
+        }
+
+        if (dst->plugin_rules == NULL && src->plugin_rules != NULL) {
+                dst->plugin_rules = l_queue_new();
+
+                l_queue_foreach(src->plugin_rules,
+                                plugin_rule_copy,
+                                dst->plugin_rules);
+        }
+
         if (dst->plugins_to_load == NULL &&
                         src->plugins_to_load != NULL){
                 dst->plugins_to_load = l_queue_new();
@@ -825,7 +1749,12 @@ struct mptcpd_config *mptcpd_config_create(int argc, char *argv[])
                 && merge_config(config, &def_config)
                 && check_config(config);
 
+        l_queue_destroy(sys_config.interface_policies,
+                        interface_policy_destroy);
+        l_queue_destroy(sys_config.plugin_rules, plugin_rule_destroy);
         l_queue_destroy(sys_config.plugins_to_load, l_free);
+        l_free(sys_config.cpu_affinity);
+        l_free(sys_config.state_file);
         l_free(sys_config.default_plugin);
         l_free(sys_config.plugin_dir);
 
@@ -855,6 +1784,52 @@ struct mptcpd_config *mptcpd_config_create(int argc, char *argv[])
                 l_debug("notify flags: %s",
                         notify_flags_string(config->notify_flags, flags, sizeof(flags)));
 
+        if (config->max_subflows)
+                l_debug("maximum subflows: %u", config->max_subflows);
+
+        if (config->max_subflows_per_interface)
+                l_debug("maximum subflows per interface: %u",
+                        config->max_subflows_per_interface);
+
+        if (config->join_limit_per_interface)
+                l_debug("subflow join limit per interface: %u",
+                        config->join_limit_per_interface);
+
+        if (config->join_limit_per_destination)
+                l_debug("subflow join limit per destination: %u",
+                        config->join_limit_per_destination);
+
+        if (config->join_jitter)
+                l_debug("subflow join jitter: %u ms", config->join_jitter);
+
+        if (config->state_file != NULL)
+                l_debug("state file: %s", config->state_file);
+
+        if (config->stall_threshold)
+                l_debug("event loop stall threshold: %u ms",
+                        config->stall_threshold);
+
+        if (config->cpu_affinity != NULL)
+                l_debug("CPU affinity: %s", config->cpu_affinity);
+
+        if (config->sched_policy != MPTCPD_SCHED_DEFAULT)
+                l_debug("scheduling policy: %u, priority: %u",
+                        config->sched_policy,
+                        config->sched_priority);
+
+        if (config->lock_memory)
+                l_debug("lock memory: yes");
+
+        if (config->interface_policies != NULL)
+                l_queue_foreach(config->interface_policies,
+                                interface_policy_log,
+                                NULL);
+
+        if (config->plugin_rules != NULL)
+                l_queue_foreach(config->plugin_rules,
+                                plugin_rule_log,
+                                NULL);
+
         if (config->plugins_to_load){
                 char *const str =
                         plugins_to_load_string(config->plugins_to_load);
@@ -871,12 +1846,144 @@ void mptcpd_config_destroy(struct mptcpd_config *config)
         if (config == NULL)
                 return;
 
+        l_queue_destroy(config->interface_policies,
+                        interface_policy_destroy);
+        l_queue_destroy(config->plugin_rules, plugin_rule_destroy);
         l_queue_destroy(config->plugins_to_load, l_free);
+        l_free(config->cpu_affinity);
+        l_free(config->state_file);
         l_free(config->default_plugin);
         l_free(config->plugin_dir);
         l_free(config);
 }
 
+// ---------------------------------------------------------------
+// Configuration comparison
+// ---------------------------------------------------------------
+
+/// Compare two possibly @c NULL strings.
+static bool string_equal(char const *a, char const *b)
+{
+        if (a == NULL || b == NULL)
+                return a == b;
+
+        return strcmp(a, b) == 0;
+}
+
+static bool plugin_name_equal(void const *a, void const *b)
+{
+        return string_equal(a, b);
+}
+
+static bool interface_policy_equal(void const *a, void const *b)
+{
+        struct mptcpd_interface_policy const *const lhs = a;
+        struct mptcpd_interface_policy const *const rhs = b;
+
+        return string_equal(lhs->pattern, rhs->pattern)
+                && lhs->cost         == rhs->cost
+                && lhs->backup       == rhs->backup
+                && lhs->max_subflows == rhs->max_subflows;
+}
+
+static bool plugin_rule_equal(void const *a, void const *b)
+{
+        struct mptcpd_plugin_rule const *const lhs = a;
+        struct mptcpd_plugin_rule const *const rhs = b;
+
+        return string_equal(lhs->name, rhs->name)
+                && string_equal(lhs->plugin, rhs->plugin)
+                && memcmp(&lhs->remote_prefix,
+                          &rhs->remote_prefix,
+                          sizeof(lhs->remote_prefix)) == 0
+                && lhs->remote_prefix_len == rhs->remote_prefix_len
+                && lhs->local_port        == rhs->local_port
+                && lhs->remote_port       == rhs->remote_port
+                && lhs->server_side       == rhs->server_side
+                && lhs->client_side       == rhs->client_side;
+}
+
+/**
+ * @brief Compare two lists element by element.
+ *
+ * A @c NULL list is equivalent to an empty one.
+ */
+static bool queue_equal(struct l_queue const *a,
+                        struct l_queue const *b,
+                        bool (*equal)(void const *, void const *))
+{
+        struct l_queue_entry const *lhs =
+                l_queue_get_entries((struct l_queue *) a);
+        struct l_queue_entry const *rhs =
+                l_queue_get_entries((struct l_queue *) b);
+
+        for (; lhs != NULL && rhs != NULL; lhs = lhs->next, rhs = rhs->next)
+                if (!equal(lhs->data, rhs->data))
+                        return false;
+
+        return lhs == rhs;  // Both lists exhausted.
+}
+
+uint32_t mptcpd_config_diff(struct mptcpd_config const *from,
+                            struct mptcpd_config const *to)
+{
+        assert(from != NULL);
+        assert(to != NULL);
+
+        uint32_t changes = 0;
+
+        if (from->log_set != to->log_set)
+                changes |= MPTCPD_CONFIG_CHANGED_LOG;
+
+        if (from->addr_flags != to->addr_flags)
+                changes |= MPTCPD_CONFIG_CHANGED_ADDR_FLAGS;
+
+        if (from->notify_flags != to->notify_flags)
+                changes |= MPTCPD_CONFIG_CHANGED_NOTIFY_FLAGS;
+
+        if (!string_equal(from->plugin_dir, to->plugin_dir)
+            || !string_equal(from->default_plugin, to->default_plugin)
+            || !queue_equal(from->plugins_to_load,
+                            to->plugins_to_load,
+                            plugin_name_equal))
+                changes |= MPTCPD_CONFIG_CHANGED_PLUGINS;
+
+        if (from->max_subflows != to->max_subflows
+            || from->max_subflows_per_interface
+               != to->max_subflows_per_interface)
+                changes |= MPTCPD_CONFIG_CHANGED_SUBFLOW_LIMITS;
+
+        if (from->join_limit_per_interface != to->join_limit_per_interface
+            || from->join_limit_per_destination
+               != to->join_limit_per_destination
+            || from->join_jitter != to->join_jitter)
+                changes |= MPTCPD_CONFIG_CHANGED_JOIN_LIMITS;
+
+        if (!queue_equal(from->interface_policies,
+                         to->interface_policies,
+                         interface_policy_equal))
+                changes |= MPTCPD_CONFIG_CHANGED_INTERFACE_POLICIES;
+
+        if (!queue_equal(from->plugin_rules,
+                         to->plugin_rules,
+                         plugin_rule_equal))
+                changes |= MPTCPD_CONFIG_CHANGED_PLUGIN_RULES;
+
+        if (!string_equal(from->state_file, to->state_file))
+                changes |= MPTCPD_CONFIG_CHANGED_STATE_FILE;
+
+        if (from->stall_threshold != to->stall_threshold)
+                changes |= MPTCPD_CONFIG_CHANGED_STALL_THRESHOLD;
+
+        if (!string_equal(from->cpu_affinity, to->cpu_affinity)
+            || from->sched_policy   != to->sched_policy
+            || from->sched_priority != to->sched_priority
+            || from->lock_memory    != to->lock_memory)
+                changes |= MPTCPD_CONFIG_CHANGED_PROCESS;
+
+        return changes;
+}
+
 
 /*
   Local Variables:
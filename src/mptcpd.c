@@ -19,7 +19,15 @@
 
 #include <mptcpd/private/configuration.h>
 
+#ifdef HAVE_BUILTIN_PLUGINS
+# include <mptcpd/private/plugin.h>
+# include "builtin.h"
+#endif
+
 #include "path_manager.h"
+#include "process.h"
+#include "service.h"
+#include "state.h"
 
 
 // Handle termination gracefully.
@@ -33,52 +41,182 @@ static void signal_handler(uint32_t signo, void *user_data)
         case SIGINT:
         case SIGTERM:
                 l_debug("\nTerminating %s", (char const *) user_data);
+                mptcpd_service_stopping();
                 l_main_quit();
                 break;
         }
 }
 
+/**
+ * @struct reload_info
+ *
+ * @brief Information needed to reload the mptcpd configuration.
+ */
+struct reload_info
+{
+        /// Command line argument count.
+        int argc;
+
+        /// Command line argument vector.
+        char **argv;
+
+        /// Configuration currently in use.
+        struct mptcpd_config *config;
+
+        /// Path manager to be reconfigured.
+        struct mptcpd_pm *pm;
+
+        /// A reload has been scheduled but has not run yet.
+        bool pending;
+};
+
+static void reload_config(struct l_idle *idle, void *user_data)
+{
+        (void) idle;
+
+        struct reload_info *const info = user_data;
+        uint64_t const start = l_time_now();
+
+        info->pending = false;
+
+        /*
+          Parse the command line and configuration files again so
+          that command line options keep overriding the
+          configuration files.
+        */
+        struct mptcpd_config *const config =
+                mptcpd_config_create(info->argc, info->argv);
+
+        bool succeeded = false;
+
+        if (config == NULL) {
+                // Restore the logger reset by the failed parse.
+                if (info->config->log_set != NULL)
+                        info->config->log_set();
+
+                l_error("Unable to parse configuration, keeping the "
+                        "current one.");
+        } else {
+                succeeded = mptcpd_pm_reconfigure(info->pm, config);
+
+                if ((mptcpd_config_diff(info->config, config)
+                     & MPTCPD_CONFIG_CHANGED_PROCESS)
+                    && !mptcpd_process_configure(config))
+                        succeeded = false;
+
+                mptcpd_config_destroy(info->config);
+                info->config = config;
+        }
+
+        mptcpd_pm_record_reload(info->pm,
+                                succeeded,
+                                l_time_diff(start, l_time_now()));
+
+        mptcpd_service_reloaded(succeeded);
+}
+
+// Reload the configuration on request.
+static void reload_handler(void *user_data)
+{
+        struct reload_info *const info = user_data;
+
+        if (info->pending)
+                return;
+
+        l_info("Reloading configuration");
+
+        /*
+          Plugin operations are only called from the main event loop.
+          Defer the reload until the loop is idle so that callbacks
+          into the outgoing plugins have drained before they are
+          unloaded.
+        */
+        if (l_idle_oneshot(reload_config, info, NULL)) {
+                info->pending = true;
+
+                mptcpd_service_reloading();
+        } else {
+                l_error("Unable to schedule configuration reload.");
+        }
+}
+
 int main(int argc, char *argv[])
 {
         int result = EXIT_SUCCESS;
 
-        struct mptcpd_config *const config =
-                mptcpd_config_create(argc, argv);
+        uint64_t const start = l_time_now();
+
+        struct reload_info info = {
+                .argc   = argc,
+                .argv   = argv,
+                .config = mptcpd_config_create(argc, argv)
+        };
 
-        if (config == NULL)
+        if (info.config == NULL)
                 return EXIT_FAILURE;
 
         if (!l_main_init()) {
-                mptcpd_config_destroy(config);
+                mptcpd_config_destroy(info.config);
                 return EXIT_FAILURE;
         }
 
+        /*
+          Readiness is reported to systemd once the path manager has
+          completed its asynchronous initialization.
+        */
+        mptcpd_service_init(start);
+
+        /*
+          Failure to apply process settings, e.g. due to missing
+          privileges, is logged but is not fatal.
+        */
+        (void) mptcpd_process_configure(info.config);
+
+        mptcpd_service_phase("configuration");
+
+#ifdef HAVE_BUILTIN_PLUGINS
+        // Plugins linked into mptcpd are loaded without dlopen().
+        mptcpd_plugin_register_builtin(_builtin_plugins);
+#endif
+
         // Initialize the path manager.
-        struct mptcpd_pm *const pm = mptcpd_pm_create(config);
+        struct mptcpd_pm *const pm = mptcpd_pm_create(info.config);
 
         if (pm == NULL) {
                 result = EXIT_FAILURE;
                 goto exit;
         }
 
+        info.pm = pm;
+
+        mptcpd_service_phase("path manager");
+
         /**
          * @todo Start D-Bus once we support a mptcpd D-Bus API.
          *
-         * @todo Make this daemon socket-activatable when using
-         *       systemd.
-         *
          * @todo Should we daemonize the the mptcpd process the
          *       canonical way - fork() then orphan to make it owned by
          *       the 'init' process, among other steps - when systemd
          *       isn't used?
          */
 
+        struct l_signal *const reload =
+                l_signal_create(SIGHUP, reload_handler, &info, NULL);
+
+        if (reload == NULL)
+                l_warn("Configuration reload on SIGHUP is unavailable.");
+
         // Start the main event loop.
         result = l_main_run_with_signal(signal_handler, argv[0]);
 
+        l_signal_remove(reload);
+
         if (result == EXIT_FAILURE)
                 l_error("Main event loop failed.");
 
+        // Export plugin connection state while plugins are loaded.
+        (void) mptcpd_state_save(pm);
+
         mptcpd_pm_destroy(pm);
 
 exit:
@@ -87,7 +225,9 @@ exit:
          *       reading the configuration, e.g. after the path
          *       manager has been initialized.
          */
-        mptcpd_config_destroy(config);
+        mptcpd_config_destroy(info.config);
+
+        mptcpd_service_exit();
 
         if (!l_main_exit())
                 result = EXIT_FAILURE;
@@ -12,14 +12,17 @@
 #include <linux/limits.h>
 
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/sendfile.h>
 
 #include <argp.h>
+#include <dirent.h>
 #include <dlfcn.h>
 #include <errno.h>
 #include <error.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,11 +32,16 @@
 # include <mptcpd/private/config.h>
 #endif
 
+#include "mptcpwrap.h"
+
 #define SYSTEMD_ENV_VAR		"Environment="
 #define SYSTEMD_UNIT_VAR	"FragmentPath="
 #define SYSTEMD_SERVICE_TAG	"[Service]"
 #define SYSTEMCTL_SHOW		"systemctl show -p FragmentPath "
+#define SYSTEMD_CGROUP_VAR	"ControlGroup="
+#define SYSTEMCTL_SHOW_CGROUP	"systemctl show -p ControlGroup "
 #define PRELOAD_VAR		"LD_PRELOAD="
+#define POLICY_VAR		"MPTCPWRAP_POLICY="
 #define MPTCPWRAP_ENV		"LD_PRELOAD="PKGLIBDIR"/libmptcpwrap.so.0.0."LIBREVISION
 
 /* Program documentation. */
@@ -42,16 +50,25 @@ static char args_doc[] = "CMD";
 static char doc[] =
         "mptcpize - a tool to enable MPTCP usage on unmodified legacy services\v"
         "Available CMDs:\n"
-        "\trun [-d] prog [<args>]    Run target program with specified\n"
+        "\trun [-d] [-p policy] prog [<args>]\n"
+        "\t                          Run target program with specified\n"
         "\t                          arguments, forcing MPTCP socket usage\n"
         "\t                          instead of TCP.  If the '-d' argument\n"
         "\t                          is provided, dump messages on stderr\n"
-        "\t                          when a TCP socket is forced to MPTCP.\n\n"
+        "\t                          when a TCP socket is forced to MPTCP.\n"
+        "\t                          The '-p' argument sets socket options\n"
+        "\t                          applied to MPTCP sockets, either as a\n"
+        "\t                          policy file path or as comma separated\n"
+        "\t                          options, e.g. 'nodelay=1,sndbuf=65536'.\n\n"
         "\tenable <unit>             Update the systemd <unit>, forcing\n"
         "\t                          the given service to run under the\n"
         "\t                          above launcher.\n\n"
         "\tdisable <unit>            Update the systemd <unit>, removing\n"
-        "\t                          the above launcher.\n";
+        "\t                          the above launcher.\n\n"
+        "\tstats <pid|unit>          Show the number of sockets upgraded\n"
+        "\t                          to MPTCP by the above launcher in the\n"
+        "\t                          given process, or in the processes of\n"
+        "\t                          the given systemd <unit>.\n";
 
 static struct argp const argp = { 0, 0, args_doc, doc, 0, 0, 0 };
 
@@ -63,10 +80,19 @@ static void help(void)
 static int run(int argc, char *av[])
 {
 	int i, nr = 0, debug = 0;
-	char **envp, **argv;
+	char **envp, **argv, *policy = NULL;
 
-	if (argc > 0 && strcmp(av[0], "-d") == 0) {
-		debug = 1;
+	while (argc > 0) {
+		if (strcmp(av[0], "-d") == 0) {
+			debug = 1;
+		} else if (strcmp(av[0], "-p") == 0 && argc > 1) {
+			if (asprintf(&policy, POLICY_VAR"%s", av[1]) < 0)
+				error(1, errno, "can't allocate policy string");
+			argc--;
+			av++;
+		} else {
+			break;
+		}
 		argc--;
 		av++;
 	}
@@ -80,16 +106,18 @@ static int run(int argc, char *av[])
 	// build environment, copying the current one ...
 	while (environ[nr])
 		nr++;
-	envp = calloc(nr + 3, sizeof(char *));
+	envp = calloc(nr + 4, sizeof(char *));
 	if (!envp)
 		error(1, errno, "can't allocate env list");
 
-	// ... filtering out any 'LD_PRELOAD' ...
+	// ... filtering out any 'LD_PRELOAD' and overridden policy ...
 	nr = 0;
 	i = 0;
 	while (environ[nr]) {
 		if (strncmp(environ[nr], PRELOAD_VAR,
-			    strlen(PRELOAD_VAR)) != 0) {
+			    strlen(PRELOAD_VAR)) != 0 &&
+		    (!policy || strncmp(environ[nr], POLICY_VAR,
+					strlen(POLICY_VAR)) != 0)) {
 			envp[i] = environ[nr];
 			i++;
 		}
@@ -99,9 +127,11 @@ static int run(int argc, char *av[])
 	// ... appending the mptcpwrap preload...
 	envp[i++] = MPTCPWRAP_ENV;
 
-	// ... and enable dbg if needed
+	// ... and enable dbg and socket options policy if needed
 	if (debug)
 		envp[i++] = "MPTCPWRAP_DEBUG=1";
+	if (policy)
+		envp[i++] = policy;
 
 	// build the NULL terminated arg list
 	argv = calloc(argc + 1, sizeof(char *));
@@ -112,32 +142,28 @@ static int run(int argc, char *av[])
 	return execvpe(argv[0], argv, envp);
 }
 
-static char *locate_unit(const char *name)
+// fetch the 'var' property of the given unit, via the 'show' command
+static char *unit_property(const char *name, const char *show, const char *var)
 {
 	char *cmd, *line = NULL;
 	FILE *systemctl;
 	size_t len = 0;
 	ssize_t read;
 
-	/* check for existing unit file */
-	if (access(name, R_OK) == 0)
-		return strdup(name);
-
-	/* this is supposed to be an unit name */
-	len = strlen(name) + 1 + strlen(SYSTEMCTL_SHOW);
+	len = strlen(name) + 1 + strlen(show);
 	cmd = malloc(len);
 	if (!cmd)
 		error(1, 0, "can't allocate systemctl command string");
 
-	sprintf(cmd, SYSTEMCTL_SHOW"%s", name);
+	sprintf(cmd, "%s%s", show, name);
 	systemctl = popen(cmd, "r");
 	if (!systemctl)
 		error(1, errno, "can't execute %s", cmd);
 
 	free(cmd);
 	while ((read = getline(&line, &len, systemctl)) != -1) {
-		if (strncmp(line, SYSTEMD_UNIT_VAR, strlen(SYSTEMD_UNIT_VAR)) == 0) {
-			char *ret = strdup(&line[strlen(SYSTEMD_UNIT_VAR)]);
+		if (strncmp(line, var, strlen(var)) == 0) {
+			char *ret = strdup(&line[strlen(var)]);
 			if (!ret)
 				error(1, errno, "failed to duplicate string");
 
@@ -145,20 +171,34 @@ static char *locate_unit(const char *name)
 			len = strlen(ret);
 			if (len > 0 && ret[len - 1] == '\n')
 				ret[--len] = 0;
-			if (len == 0)
-				error(1, 0, "can't find unit file for service %s", name);
 			free(line);
 			pclose(systemctl);
 			return ret;
 		}
 	}
 
-	error(1, 0, "can't find FragmentPath attribute for unit %s", name);
+	error(1, 0, "can't find %.*s attribute for unit %s",
+	      (int)strlen(var) - 1, var, name);
 
 	// never reached: just silence gcc
 	return NULL;
 }
 
+static char *locate_unit(const char *name)
+{
+	char *ret;
+
+	/* check for existing unit file */
+	if (access(name, R_OK) == 0)
+		return strdup(name);
+
+	/* this is supposed to be an unit name */
+	ret = unit_property(name, SYSTEMCTL_SHOW, SYSTEMD_UNIT_VAR);
+	if (*ret == 0)
+		error(1, 0, "can't find unit file for service %s", name);
+	return ret;
+}
+
 static int unit_update(int argc, char *argv[], int enable)
 {
 	char *unit, *line = NULL;
@@ -250,6 +290,226 @@ static int disable(int argc, char *argv[])
 	return unit_update(argc, argv, 0);
 }
 
+// copy the statistics libmptcpwrap exports for the given process
+static int read_stats(pid_t pid, struct mptcpwrap_stats *out)
+{
+	const struct mptcpwrap_stats *s;
+	char name[32];
+	struct stat st;
+	int fd, f;
+
+	snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int)pid);
+	fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(*s)) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+
+	s = mmap(NULL, sizeof(*s), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (s == MAP_FAILED)
+		return -1;
+
+	if (__atomic_load_n(&s->magic, __ATOMIC_ACQUIRE) != MPTCPWRAP_STATS_MAGIC ||
+	    s->version != MPTCPWRAP_STATS_VERSION || s->pid != pid) {
+		munmap((void *)s, sizeof(*s));
+		errno = EINVAL;
+		return -1;
+	}
+
+	// the counters keep changing while being read
+	memset(out, 0, sizeof(*out));
+	out->starttime = s->starttime;
+	for (f = 0; f < MPTCPWRAP_FAMILIES; f++) {
+		out->family[f].upgraded =
+			__atomic_load_n(&s->family[f].upgraded, __ATOMIC_RELAXED);
+		out->family[f].skipped =
+			__atomic_load_n(&s->family[f].skipped, __ATOMIC_RELAXED);
+		out->family[f].fallback =
+			__atomic_load_n(&s->family[f].fallback, __ATOMIC_RELAXED);
+		out->family[f].fallback_cached =
+			__atomic_load_n(&s->family[f].fallback_cached,
+					__ATOMIC_RELAXED);
+	}
+
+	munmap((void *)s, sizeof(*s));
+	return 0;
+}
+
+static void print_stats(const char *title, const struct mptcpwrap_stats *s)
+{
+	static const char * const families[] = { "ipv4", "ipv6" };
+	int f;
+
+	printf("%s\n", title);
+	printf("  %-6s %12s %12s %12s %16s\n", "",
+	       "upgraded", "skipped", "fallback", "fallback_cached");
+	for (f = 0; f < MPTCPWRAP_FAMILIES; f++)
+		printf("  %-6s %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+		       " %16" PRIu64 "\n", families[f],
+		       s->family[f].upgraded, s->family[f].skipped,
+		       s->family[f].fallback, s->family[f].fallback_cached);
+}
+
+static void add_stats(struct mptcpwrap_stats *total,
+		      const struct mptcpwrap_stats *s)
+{
+	int f;
+
+	for (f = 0; f < MPTCPWRAP_FAMILIES; f++) {
+		total->family[f].upgraded += s->family[f].upgraded;
+		total->family[f].skipped += s->family[f].skipped;
+		total->family[f].fallback += s->family[f].fallback;
+		total->family[f].fallback_cached += s->family[f].fallback_cached;
+	}
+}
+
+// remove the statistics left behind by processes that exited without
+// running the libmptcpwrap destructor, e.g. through _exit(), a crash or
+// SIGKILL, except those of the given PID
+static void remove_stale_stats(pid_t keep)
+{
+	struct mptcpwrap_stats s;
+	struct dirent *d;
+	char name[32];
+	DIR *dir;
+	int pid;
+
+	dir = opendir("/dev/shm");
+	if (!dir)
+		return;
+
+	while ((d = readdir(dir)) != NULL) {
+		if (sscanf(d->d_name, "mptcpwrap.%d", &pid) != 1 ||
+		    pid <= 0 || pid == keep)
+			continue;
+
+		snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, pid);
+		if (strcmp(name + 1, d->d_name) != 0)
+			continue;
+
+		// segments being initialized are not valid yet, and those
+		// of other users can't be removed
+		if (read_stats(pid, &s) < 0 ||
+		    s.starttime == mptcpwrap_starttime(pid))
+			continue;
+
+		shm_unlink(name);
+	}
+	closedir(dir);
+}
+
+static int pid_stats(pid_t pid)
+{
+	struct mptcpwrap_stats s;
+	char title[64], name[32];
+	int running;
+
+	if (read_stats(pid, &s) < 0)
+		error(1, errno, "can't read mptcpwrap statistics of pid %d", (int)pid);
+
+	// statistics of crashed processes are left behind, and their
+	// PID may have been reused by another process since.  They are
+	// shown one last time.
+	running = s.starttime == mptcpwrap_starttime(pid);
+	snprintf(title, sizeof(title), "pid %d%s", (int)pid,
+		 running ? "" : " (not running)");
+	print_stats(title, &s);
+
+	if (!running) {
+		snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int)pid);
+		shm_unlink(name);
+	}
+	return 0;
+}
+
+static FILE *open_cgroup_procs(const char *cgroup)
+{
+	// cgroup v2, hybrid and legacy hierarchies
+	static const char * const roots[] = {
+		"/sys/fs/cgroup", "/sys/fs/cgroup/unified", "/sys/fs/cgroup/systemd"
+	};
+	char path[PATH_MAX];
+	FILE *procs;
+	size_t i;
+
+	for (i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+		snprintf(path, sizeof(path), "%s%s/cgroup.procs", roots[i], cgroup);
+		procs = fopen(path, "re");
+		if (procs)
+			return procs;
+	}
+	return NULL;
+}
+
+static int unit_stats(const char *unit)
+{
+	struct mptcpwrap_stats s, total;
+	int nr = 0, missing = 0;
+	char *cgroup, title[64];
+	FILE *procs;
+	int pid;
+
+	cgroup = unit_property(unit, SYSTEMCTL_SHOW_CGROUP, SYSTEMD_CGROUP_VAR);
+	if (*cgroup == 0)
+		error(1, 0, "unit %s is not running", unit);
+
+	procs = open_cgroup_procs(cgroup);
+	if (!procs)
+		error(1, errno, "can't list the processes of unit %s", unit);
+
+	memset(&total, 0, sizeof(total));
+	while (fscanf(procs, "%d", &pid) == 1) {
+		// skip statistics left behind by an earlier process
+		if (read_stats(pid, &s) < 0 ||
+		    s.starttime != mptcpwrap_starttime(pid)) {
+			missing++;
+			continue;
+		}
+
+		snprintf(title, sizeof(title), "pid %d", pid);
+		print_stats(title, &s);
+		add_stats(&total, &s);
+		nr++;
+	}
+	fclose(procs);
+	free(cgroup);
+
+	if (nr > 1)
+		print_stats("total", &total);
+	if (missing > 0)
+		printf("%d process(es) without mptcpwrap statistics\n", missing);
+	if (nr == 0)
+		error(1, 0, "no process of unit %s uses mptcpwrap", unit);
+	return 0;
+}
+
+static int stats(int argc, char *argv[])
+{
+	char *end;
+	long pid;
+
+	if (argc < 1) {
+		fprintf(stderr, "missing pid or unit argument\n");
+		help();
+		return -1;
+	}
+
+	errno = 0;
+	pid = strtol(argv[0], &end, 10);
+	if (errno == 0 && end != argv[0] && *end == 0 && pid > 0 && pid <= INT32_MAX) {
+		remove_stale_stats(pid);
+		return pid_stats(pid);
+	}
+
+	remove_stale_stats(0);
+	return unit_stats(argv[0]);
+}
+
 int main(int argc, char *argv[])
 {
 	int idx;
@@ -268,6 +528,8 @@ int main(int argc, char *argv[])
 			return enable(--argc, ++argv);
 		else if (strcmp(argv[0], "disable") == 0)
 			return disable(--argc, ++argv);
+		else if (strcmp(argv[0], "stats") == 0)
+			return stats(--argc, ++argv);
 		else if (strcmp(argv[0], "help") == 0) {
 			help();
 			return 0;
@@ -7,20 +7,740 @@
  * Copyright (c) 2021, Red Hat, Inc.
  */
 
+// not _GNU_SOURCE, which changes the connect() prototype
+#define _DEFAULT_SOURCE
+
 #include <sys/syscall.h>
 #include <sys/socket.h>
 
+#include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <linux/net.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mptcpwrap.h"
+
+#ifndef IPPROTO_MPTCP
+#define IPPROTO_MPTCP (IPPROTO_TCP + 256)
+#endif
+
+#define likely(x) __builtin_expect(!!(x), 1)
+#define unlikely(x) __builtin_expect(!!(x), 0)
+
+// maximum congestion control algorithm name length, including the NUL
+#define CONGESTION_NAME_MAX 16
+
+// maximum number of destination allowlist rules
+#define ALLOW_RULES_MAX 32
+
+// sockets whose upgrade is deferred are tracked up to this fd number
+#define DEFERRED_FDS_MAX 65536
+#define BITS_PER_LONG (8 * sizeof(unsigned long))
+
+// seconds MPTCP socket creation is skipped after it failed
+#define MPTCP_RETRY_INTERVAL 5
+
+/**
+ * configuration is parsed once when the library is loaded and is
+ * read-only afterwards, keeping getenv() off the socket() path
+ */
+static int initialized;
+static int debug;			// MPTCPWRAP_DEBUG is set
+
+/**
+ * socket options applied to each MPTCP socket when it's created, so
+ * that later setsockopt() calls from the application still take
+ * precedence.  Parsed once when the library is loaded.
+ */
+static struct {
+	int nodelay;			// TCP_NODELAY, -1 if unset
+	int sndbuf;			// SO_SNDBUF, 0 if unset
+	int rcvbuf;			// SO_RCVBUF, 0 if unset
+	int notsent_lowat;		// TCP_NOTSENT_LOWAT, -1 if unset
+	char congestion[CONGESTION_NAME_MAX]; // TCP_CONGESTION, "" if unset
+	int active;			// at least one option is set
+} policy = { .nodelay = -1, .notsent_lowat = -1 };
+
+/**
+ * destination allowlist: when at least one rule is set, TCP sockets
+ * are only upgraded to MPTCP at connect() time, and only if the
+ * destination matches a rule
+ */
+struct allow_rule {
+	int family;			// AF_INET, AF_INET6 or AF_UNSPEC for any
+	uint32_t addr[4];		// masked prefix, network byte order
+	uint32_t mask[4];
+	in_port_t port;			// network byte order, 0 for any
+};
+
+static struct allow_rule allow_rules[ALLOW_RULES_MAX];
+static int allow_rules_nr;
+
+// TCP sockets that may be upgraded to MPTCP at connect() time
+static unsigned long deferred_fds[DEFERRED_FDS_MAX / BITS_PER_LONG];
+
+/**
+ * MPTCP socket creation fails when MPTCP is disabled in the network
+ * namespace (net.mptcp.enabled=0) or not built in the kernel.  TCP
+ * sockets are created instead, and the failure is remembered for
+ * MPTCP_RETRY_INTERVAL seconds to avoid a failing syscall per socket.
+ */
+static long mptcp_retry_time;		// CLOCK_MONOTONIC_COARSE seconds
+
+/**
+ * per-process counters, exported in a shared memory segment named
+ * after the PID so that 'mptcpize stats' can read them.  The segment
+ * is only created once a TCP socket is seen, so that processes not
+ * using TCP, e.g. shell scripts started by a service, don't get one.
+ */
+static struct mptcpwrap_stats local_stats;	// if the segment is missing
+static struct mptcpwrap_stats *stats;		// NULL until created
+static int stats_creating;
+static pid_t stats_owner;			// PID that created the segment
+
+static int parse_int(const char *str, int min, int *value)
+{
+	char *end;
+	long v;
+
+	errno = 0;
+	v = strtol(str, &end, 0);
+	if (errno != 0 || end == str || *end != '\0' || v < min || v > 0x7fffffff)
+		return -1;
+
+	*value = v;
+	return 0;
+}
+
+static char *trim(char *str)
+{
+	char *end;
+
+	while (*str == ' ' || *str == '\t')
+		str++;
+
+	end = str + strlen(str);
+	while (end > str && (end[-1] == ' ' || end[-1] == '\t' ||
+			     end[-1] == '\n' || end[-1] == '\r'))
+		*--end = '\0';
+
+	return str;
+}
+
+// parse an allowlist rule, i.e. "PREFIX[/LEN][@PORT]" or "@PORT"
+static int parse_allow_rule(char *value)
+{
+	struct allow_rule rule = { .family = AF_UNSPEC };
+	char *port = strchr(value, '@'), *len;
+	int prefix_len, max_len, v;
+	unsigned char addr[16];
+
+	if (allow_rules_nr == ALLOW_RULES_MAX)
+		return -1;
+
+	if (port) {
+		*port++ = '\0';
+		if (parse_int(port, 1, &v) < 0 || v > 65535)
+			return -1;
+		rule.port = htons(v);
+	}
+
+	if (*value == '\0') {
+		if (!port)
+			return -1;
+		goto add_rule;
+	}
+
+	len = strchr(value, '/');
+	if (len)
+		*len++ = '\0';
+
+	if (inet_pton(AF_INET, value, addr) == 1) {
+		rule.family = AF_INET;
+		max_len = 32;
+	} else if (inet_pton(AF_INET6, value, addr) == 1) {
+		rule.family = AF_INET6;
+		max_len = 128;
+	} else {
+		return -1;
+	}
+
+	prefix_len = max_len;
+	if (len && (parse_int(len, 0, &prefix_len) < 0 || prefix_len > max_len))
+		return -1;
+
+	for (int i = 0; i < max_len / 32; i++) {
+		int bits = prefix_len - 32 * i;
+
+		if (bits > 32)
+			bits = 32;
+		rule.mask[i] = bits <= 0 ? 0 : htonl(0xffffffffu << (32 - bits));
+		memcpy(&rule.addr[i], &addr[4 * i], sizeof(rule.addr[i]));
+		rule.addr[i] &= rule.mask[i];
+	}
+
+add_rule:
+	allow_rules[allow_rules_nr++] = rule;
+	return 0;
+}
+
+// parse a single "key=value" policy option
+static void parse_option(char *option)
+{
+	char *key, *value = strchr(option, '=');
+	int ret = -1;
+
+	key = trim(option);
+	if (*key == '\0')
+		return;
+
+	if (value) {
+		*value++ = '\0';
+		key = trim(key);
+		value = trim(value);
+
+		if (strcmp(key, "allow") == 0) {
+			if (parse_allow_rule(value) < 0)
+				fprintf(stderr, "mptcpwrap: ignoring invalid "
+						"allow rule '%s'\n", value);
+			return;
+		}
+
+		if (strcmp(key, "nodelay") == 0)
+			ret = parse_int(value, 0, &policy.nodelay);
+		else if (strcmp(key, "sndbuf") == 0)
+			ret = parse_int(value, 1, &policy.sndbuf);
+		else if (strcmp(key, "rcvbuf") == 0)
+			ret = parse_int(value, 1, &policy.rcvbuf);
+		else if (strcmp(key, "notsent_lowat") == 0)
+			ret = parse_int(value, 0, &policy.notsent_lowat);
+		else if (strcmp(key, "congestion") == 0 && *value != '\0' &&
+			 strlen(value) < sizeof(policy.congestion)) {
+			strcpy(policy.congestion, value);
+			ret = 0;
+		}
+	}
+
+	if (ret < 0)
+		fprintf(stderr, "mptcpwrap: ignoring invalid policy option "
+				"'%s'\n", key);
+	else
+		policy.active = 1;
+}
+
+// parse comma separated policy options
+static void parse_options(char *options)
+{
+	char *saveptr = NULL;
+
+	for (char *option = strtok_r(options, ",", &saveptr); option;
+	     option = strtok_r(NULL, ",", &saveptr))
+		parse_option(option);
+}
+
+// parse a policy file, with one or more options per line
+static void parse_policy_file(const char *path)
+{
+	char *line = NULL;
+	size_t len = 0;
+	FILE *f;
+
+	f = fopen(path, "re");
+	if (!f) {
+		fprintf(stderr, "mptcpwrap: can't open policy file %s: %s\n",
+			path, strerror(errno));
+		return;
+	}
+
+	while (getline(&line, &len, f) != -1) {
+		char *comment = strchr(line, '#');
+
+		if (comment)
+			*comment = '\0';
+		parse_options(line);
+	}
+
+	free(line);
+	fclose(f);
+}
+
+static struct mptcpwrap_stats *create_stats(void)
+{
+	struct mptcpwrap_stats *s;
+	int fd, saved_errno = errno;
+	pid_t pid = getpid();
+	uint64_t starttime = mptcpwrap_starttime(pid);
+	struct stat st;
+	char name[32];
+
+	snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int)pid);
+	fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		goto fail;
+
+	// don't trust a segment planted by another user
+	if (fstat(fd, &st) < 0 || st.st_uid != geteuid() ||
+	    (st.st_size != sizeof(*s) && ftruncate(fd, sizeof(*s)) < 0)) {
+		close(fd);
+		goto fail;
+	}
+
+	s = mmap(NULL, sizeof(*s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (s == MAP_FAILED)
+		goto fail;
+
+	// the segment may be left over by the program this process ran
+	// before exec(), whose counters are kept, or by a process that
+	// exited without removing it and whose PID was reused
+	if (s->magic != MPTCPWRAP_STATS_MAGIC ||
+	    s->version != MPTCPWRAP_STATS_VERSION || s->pid != pid ||
+	    s->starttime != starttime) {
+		memset(s, 0, sizeof(*s));
+		s->version = MPTCPWRAP_STATS_VERSION;
+		s->pid = pid;
+		s->starttime = starttime;
+		__atomic_store_n(&s->magic, MPTCPWRAP_STATS_MAGIC,
+				 __ATOMIC_RELEASE);
+	}
+
+	stats_owner = pid;
+	errno = saved_errno;
+	return s;
+
+fail:
+	if (unlikely(debug))
+		fprintf(stderr, "mptcpwrap: can't create statistics %s: %s\n",
+			name, strerror(errno));
+	errno = saved_errno;
+	return &local_stats;
+}
+
+static struct mptcpwrap_family_stats *family_stats(int family)
+{
+	struct mptcpwrap_stats *s = __atomic_load_n(&stats, __ATOMIC_ACQUIRE);
+	int creating = 0;
+
+	if (unlikely(!s)) {
+		// counts seen by other threads meanwhile are not exported
+		if (!__atomic_compare_exchange_n(&stats_creating, &creating, 1,
+						 0, __ATOMIC_ACQ_REL,
+						 __ATOMIC_RELAXED))
+			s = &local_stats;
+		else {
+			s = create_stats();
+			__atomic_store_n(&stats, s, __ATOMIC_RELEASE);
+		}
+	}
+
+	return &s->family[family == AF_INET6 ? MPTCPWRAP_INET6 :
+					       MPTCPWRAP_INET];
+}
+
+#define count(family, counter) \
+	__atomic_fetch_add(&family_stats(family)->counter, 1, __ATOMIC_RELAXED)
+
+// the child gets its own segment, if it uses TCP sockets at all
+static void stats_atfork_child(void)
+{
+	if (stats && stats != &local_stats)
+		munmap(stats, sizeof(*stats));
+	memset(&local_stats, 0, sizeof(local_stats));
+	stats = NULL;
+	stats_creating = 0;
+	stats_owner = 0;
+}
+
+static void __attribute__((destructor)) mptcpwrap_fini(void)
+{
+	char name[32];
+
+	if (stats_owner == 0)
+		return;
+
+	snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int)stats_owner);
+	shm_unlink(name);
+}
+
+/**
+ * MPTCPWRAP_POLICY holds either the path of a policy file or comma
+ * separated options, e.g. "nodelay=1,sndbuf=262144".
+ */
+static void __attribute__((constructor)) mptcpwrap_init(void)
+{
+	const char *env;
+	char *options;
+
+	if (initialized)
+		return;
+	initialized = 1;
+
+	debug = getenv("MPTCPWRAP_DEBUG") != NULL;
+	pthread_atfork(NULL, NULL, stats_atfork_child);
+
+	env = getenv("MPTCPWRAP_POLICY");
+	if (!env || *env == '\0')
+		return;
+
+	if (*env == '/') {
+		parse_policy_file(env);
+		return;
+	}
+
+	options = strdup(env);
+	if (!options)
+		return;
+
+	parse_options(options);
+	free(options);
+}
+
+static void apply_option(int fd, int level, int name, const void *value,
+			 socklen_t len, const char *name_str)
+{
+	// bypass our own setsockopt() wrapper
+	if (syscall(__NR_setsockopt, fd, level, name, value, len) < 0 &&
+	    unlikely(debug))
+		fprintf(stderr, "mptcpwrap: can't set %s on fd %d: %s\n",
+			name_str, fd, strerror(errno));
+}
+
+static void apply_policy(int fd)
+{
+	int saved_errno = errno;
+
+	if (policy.nodelay >= 0)
+		apply_option(fd, IPPROTO_TCP, TCP_NODELAY, &policy.nodelay,
+			     sizeof(policy.nodelay), "TCP_NODELAY");
+	if (policy.sndbuf > 0)
+		apply_option(fd, SOL_SOCKET, SO_SNDBUF, &policy.sndbuf,
+			     sizeof(policy.sndbuf), "SO_SNDBUF");
+	if (policy.rcvbuf > 0)
+		apply_option(fd, SOL_SOCKET, SO_RCVBUF, &policy.rcvbuf,
+			     sizeof(policy.rcvbuf), "SO_RCVBUF");
+	if (policy.notsent_lowat >= 0)
+		apply_option(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+			     &policy.notsent_lowat,
+			     sizeof(policy.notsent_lowat), "TCP_NOTSENT_LOWAT");
+	if (policy.congestion[0] != '\0')
+		apply_option(fd, IPPROTO_TCP, TCP_CONGESTION,
+			     policy.congestion, strlen(policy.congestion),
+			     "TCP_CONGESTION");
+
+	errno = saved_errno;
+}
+
+static void set_deferred(int fd, int deferred)
+{
+	unsigned long bit;
+
+	if (fd < 0 || fd >= DEFERRED_FDS_MAX)
+		return;
+
+	bit = 1UL << (fd % BITS_PER_LONG);
+	if (deferred)
+		__atomic_fetch_or(&deferred_fds[fd / BITS_PER_LONG], bit,
+				  __ATOMIC_RELAXED);
+	else
+		__atomic_fetch_and(&deferred_fds[fd / BITS_PER_LONG], ~bit,
+				   __ATOMIC_RELAXED);
+}
+
+static int is_deferred(int fd)
+{
+	if (fd < 0 || fd >= DEFERRED_FDS_MAX)
+		return 0;
+
+	return (__atomic_load_n(&deferred_fds[fd / BITS_PER_LONG],
+				__ATOMIC_RELAXED) >> (fd % BITS_PER_LONG)) & 1;
+}
+
+static long now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) < 0)
+		return 0;
+	return ts.tv_sec;
+}
+
+static int mptcp_unavailable(int family)
+{
+	long retry = __atomic_load_n(&mptcp_retry_time, __ATOMIC_RELAXED);
+
+	if (retry == 0)
+		return 0;
+	if (now() < retry) {
+		count(family, fallback_cached);
+		return 1;
+	}
+	__atomic_store_n(&mptcp_retry_time, 0, __ATOMIC_RELAXED);
+	return 0;
+}
+
+// errors meaning the kernel won't create MPTCP sockets right now
+static int mptcp_failed(int err)
+{
+	return err == EPROTONOSUPPORT || err == ENOPROTOOPT || err == EINVAL;
+}
+
+static void set_mptcp_unavailable(int family, int err)
+{
+	__atomic_store_n(&mptcp_retry_time, now() + MPTCP_RETRY_INTERVAL,
+			 __ATOMIC_RELAXED);
+	count(family, fallback);
+
+	if (unlikely(debug))
+		fprintf(stderr, "mptcpwrap: can't create MPTCP sockets: %s, "
+				"falling back to TCP for %d seconds\n",
+			strerror(err), MPTCP_RETRY_INTERVAL);
+}
+
+// check whether the destination matches an allowlist rule
+static int allowed(const struct sockaddr *addr, socklen_t len)
+{
+	uint32_t dst[4];
+	in_port_t port;
+	int family, words;
+
+	if (addr->sa_family == AF_INET && len >= sizeof(struct sockaddr_in)) {
+		const struct sockaddr_in *sin = (const void *)addr;
+
+		family = AF_INET;
+		words = 1;
+		port = sin->sin_port;
+		memcpy(dst, &sin->sin_addr, sizeof(sin->sin_addr));
+	} else if (addr->sa_family == AF_INET6 &&
+		   len >= sizeof(struct sockaddr_in6)) {
+		const struct sockaddr_in6 *sin6 = (const void *)addr;
+
+		port = sin6->sin6_port;
+		if (IN6_IS_ADDR_V4MAPPED(&sin6->sin6_addr)) {
+			family = AF_INET;
+			words = 1;
+			memcpy(dst, &sin6->sin6_addr.s6_addr[12], sizeof(dst[0]));
+		} else {
+			family = AF_INET6;
+			words = 4;
+			memcpy(dst, &sin6->sin6_addr, sizeof(dst));
+		}
+	} else {
+		return 0;
+	}
+
+	for (int i = 0; i < allow_rules_nr; i++) {
+		const struct allow_rule *rule = &allow_rules[i];
+		int w = 0;
+
+		if (rule->port && rule->port != port)
+			continue;
+		if (rule->family == AF_UNSPEC)
+			return 1;
+		if (rule->family != family)
+			continue;
+
+		while (w < words && (dst[w] & rule->mask[w]) == rule->addr[w])
+			w++;
+		if (w == words)
+			return 1;
+	}
+
+	return 0;
+}
+
+// the kernel reports twice the value that was set
+#define COPY_HALVED	0x1
+
+// socket options copied from a TCP socket to its MPTCP replacement
+static const struct {
+	int level;
+	int name;
+	int flags;
+} copied_options[] = {
+	{ SOL_SOCKET,	SO_REUSEADDR,		0 },
+	{ SOL_SOCKET,	SO_REUSEPORT,		0 },
+	{ SOL_SOCKET,	SO_KEEPALIVE,		0 },
+	{ SOL_SOCKET,	SO_LINGER,		0 },
+	{ SOL_SOCKET,	SO_RCVTIMEO,		0 },
+	{ SOL_SOCKET,	SO_SNDTIMEO,		0 },
+	{ SOL_SOCKET,	SO_PRIORITY,		0 },
+	{ SOL_SOCKET,	SO_MARK,		0 },
+	{ SOL_SOCKET,	SO_SNDBUF,		COPY_HALVED },
+	{ SOL_SOCKET,	SO_RCVBUF,		COPY_HALVED },
+#ifdef SO_BINDTOIFINDEX
+	{ SOL_SOCKET,	SO_BINDTOIFINDEX,	0 },
+#endif
+	// older kernels only support binding by name
+	{ SOL_SOCKET,	SO_BINDTODEVICE,	0 },
+	{ IPPROTO_IP,	IP_TOS,			0 },
+	{ IPPROTO_IPV6,	IPV6_TCLASS,		0 },
+	{ IPPROTO_IPV6,	IPV6_V6ONLY,		0 },
+	{ IPPROTO_TCP,	TCP_NODELAY,		0 },
+	{ IPPROTO_TCP,	TCP_KEEPIDLE,		0 },
+	{ IPPROTO_TCP,	TCP_KEEPINTVL,		0 },
+	{ IPPROTO_TCP,	TCP_KEEPCNT,		0 },
+	{ IPPROTO_TCP,	TCP_CONGESTION,		0 },
+};
+
+/**
+ * only options whose value differs from the one of the new socket,
+ * i.e. that were set by the application, are copied.  Copying the
+ * default buffer sizes would turn off their autotuning.
+ */
+static void copy_options(int from, int to)
+{
+	for (size_t i = 0; i < sizeof(copied_options) / sizeof(copied_options[0]); i++) {
+		char value[32], current[32];
+		socklen_t len = sizeof(value), current_len = sizeof(current);
+		int level = copied_options[i].level;
+		int name = copied_options[i].name;
+
+		// best effort: not every option is supported by MPTCP, or
+		// by the address family
+		if (getsockopt(from, level, name, value, &len) < 0)
+			continue;
+
+		if (getsockopt(to, level, name, current, &current_len) == 0 &&
+		    current_len == len && memcmp(current, value, len) == 0)
+			continue;
+
+		if ((copied_options[i].flags & COPY_HALVED) &&
+		    len == sizeof(int)) {
+			int halved;
+
+			memcpy(&halved, value, sizeof(halved));
+			halved /= 2;
+			memcpy(value, &halved, sizeof(halved));
+		}
+
+		(void)syscall(__NR_setsockopt, to, level, name, value, len);
+	}
+}
+
+/**
+ * whether the application bound the socket to a local address or
+ * port itself, e.g. to a source address with IP_BIND_ADDRESS_NO_PORT,
+ * which leaves the port unset until connect()
+ */
+static int explicitly_bound(struct sockaddr_storage const *local)
+{
+	if (local->ss_family == AF_INET) {
+		struct sockaddr_in const *sin = (struct sockaddr_in const *)local;
+
+		return sin->sin_port != 0 ||
+		       sin->sin_addr.s_addr != htonl(INADDR_ANY);
+	}
+
+	if (local->ss_family == AF_INET6) {
+		struct sockaddr_in6 const *sin6 = (struct sockaddr_in6 const *)local;
+
+		return sin6->sin6_port != 0 ||
+		       !IN6_IS_ADDR_UNSPECIFIED(&sin6->sin6_addr);
+	}
+
+	return 0;
+}
+
+/**
+ * replace the TCP socket with a new MPTCP socket, keeping the file
+ * descriptor number.  The TCP socket is kept on any failure.
+ *
+ * epoll tracks the replaced socket rather than the file descriptor
+ * number, so an epoll registration made before connect() is lost.
+ */
+static void upgrade_socket(int fd)
+{
+	struct sockaddr_storage local;
+	socklen_t len = sizeof(local);
+	int saved_errno = errno, protocol = 0, fd_flags, fl_flags, type;
+	int mptcp;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PROTOCOL, &protocol, &len) < 0 ||
+	    protocol != IPPROTO_TCP)
+		goto out;
+
+	// the MPTCP socket can't take over an explicitly bound address
+	len = sizeof(local);
+	if (getsockname(fd, (struct sockaddr *)&local, &len) < 0)
+		goto out;
+	if (explicitly_bound(&local)) {
+		count(local.ss_family, skipped);
+		goto out;
+	}
+
+	fd_flags = fcntl(fd, F_GETFD);
+	fl_flags = fcntl(fd, F_GETFL);
+	if (fd_flags < 0 || fl_flags < 0)
+		goto out;
+
+	type = SOCK_STREAM;
+	if (fl_flags & O_NONBLOCK)
+		type |= SOCK_NONBLOCK;
+
+	if (mptcp_unavailable(local.ss_family))
+		goto out;
+
+	mptcp = syscall(__NR_socket, local.ss_family, type, IPPROTO_MPTCP);
+	if (mptcp < 0) {
+		if (mptcp_failed(errno))
+			set_mptcp_unavailable(local.ss_family, errno);
+		goto out;
+	}
+
+	copy_options(fd, mptcp);
+	if (policy.active)
+		apply_policy(mptcp);
+
+	if (dup2(mptcp, fd) < 0) {
+		close(mptcp);
+		goto out;
+	}
+	close(mptcp);
+
+	// dup2() clears the close-on-exec flag
+	if (fd_flags & FD_CLOEXEC)
+		(void)fcntl(fd, F_SETFD, fd_flags);
+
+	count(local.ss_family, upgraded);
+	if (unlikely(debug))
+		fprintf(stderr, "mptcpwrap: upgraded fd %d to IPPROTO_MPTCP "
+				"at connect()\n", fd);
+
+out:
+	errno = saved_errno;
+}
+
+static int is_mptcp(int fd)
+{
+	int protocol = 0, saved_errno = errno;
+	socklen_t len = sizeof(protocol);
+	int ret;
+
+	ret = getsockopt(fd, SOL_SOCKET, SO_PROTOCOL, &protocol, &len);
+	errno = saved_errno;
+	return ret == 0 && protocol == IPPROTO_MPTCP;
+}
 
 // libtool will make every symbol hidden by default
 int __attribute__((visibility("default"))) socket(int family, int type, int protocol)
 {
 	int ret, orig_protocol = protocol;
 
+	// other libraries' constructors may create sockets before ours runs
+	if (unlikely(!initialized))
+		mptcpwrap_init();
+
 	// the 'type' field may encode socket flags
 	if ((family != AF_INET && family != AF_INET6) ||
 	    (type & 0xff)  != SOCK_STREAM)
@@ -30,14 +750,106 @@ int __attribute__((visibility("default"))) socket(int family, int type, int prot
 	if (protocol != 0 && protocol != IPPROTO_TCP)
 		goto do_socket;
 
-	protocol = IPPROTO_TCP + 256;
+	// defer the upgrade until the destination is known
+	if (allow_rules_nr > 0) {
+		ret = syscall(__NR_socket, family, type, protocol);
+		set_deferred(ret, 1);
+		return ret;
+	}
+
+	if (mptcp_unavailable(family))
+		goto do_socket;
+
+	protocol = IPPROTO_MPTCP;
 
 do_socket:
 	ret = syscall(__NR_socket, family, type, protocol);
-	if (getenv("MPTCPWRAP_DEBUG") && protocol != orig_protocol)
+
+	/*
+	 * fall back to the protocol the application asked for.  Only
+	 * cache the failure when that works: EINVAL may as well come from
+	 * bogus arguments, which the application should see as usual.
+	 */
+	if (unlikely(ret < 0) && protocol != orig_protocol &&
+	    mptcp_failed(errno)) {
+		int err = errno;
+
+		protocol = orig_protocol;
+		ret = syscall(__NR_socket, family, type, protocol);
+		if (ret >= 0)
+			set_mptcp_unavailable(family, err);
+	} else if (ret >= 0 && protocol != orig_protocol) {
+		count(family, upgraded);
+	}
+
+	if (allow_rules_nr > 0)
+		set_deferred(ret, 0);
+	if (unlikely(debug) && protocol != orig_protocol)
 		fprintf(stderr, "mptcpwrap: changing socket protocol from 0x%x "
 				"to 0x%x (IPPROTO_MPTCP) for family 0x%x "
 				"type 0x%x fd %d\n", orig_protocol, protocol,
 				family, type, ret);
+
+	if (ret >= 0 && policy.active && protocol != orig_protocol)
+		apply_policy(ret);
+
+	return ret;
+}
+
+int __attribute__((visibility("default")))
+connect(int fd, const struct sockaddr *addr, socklen_t len)
+{
+	if (allow_rules_nr > 0 && addr && is_deferred(fd)) {
+		set_deferred(fd, 0);
+		if (allowed(addr, len))
+			upgrade_socket(fd);
+		else
+			count(addr->sa_family, skipped);
+	}
+
+	return syscall(__NR_connect, fd, addr, len);
+}
+
+/**
+ * TCP level options older kernels reject on MPTCP sockets, that only
+ * tune performance, so that the application works the same without
+ * them.
+ */
+static int tunable_tcp_option(int name)
+{
+	switch (name) {
+	case TCP_NODELAY:
+	case TCP_CORK:
+	case TCP_KEEPIDLE:
+	case TCP_KEEPINTVL:
+	case TCP_KEEPCNT:
+	case TCP_NOTSENT_LOWAT:
+	case TCP_CONGESTION:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Older kernels reject some TCP level socket options on MPTCP
+ * sockets, e.g. TCP_NODELAY.  Let the application carry on as it
+ * would with a TCP socket instead of failing.  Options that change
+ * the socket semantics, e.g. TCP_FASTOPEN or TCP_REPAIR, still fail
+ * so that the application can handle it.
+ */
+int __attribute__((visibility("default")))
+setsockopt(int fd, int level, int name, const void *value, socklen_t len)
+{
+	int ret = syscall(__NR_setsockopt, fd, level, name, value, len);
+
+	if (ret < 0 && level == IPPROTO_TCP && tunable_tcp_option(name) &&
+	    (errno == EOPNOTSUPP || errno == ENOPROTOOPT) && is_mptcp(fd)) {
+		if (unlikely(debug))
+			fprintf(stderr, "mptcpwrap: ignoring unsupported TCP "
+					"option %d on MPTCP fd %d\n", name, fd);
+		ret = 0;
+	}
+
 	return ret;
 }
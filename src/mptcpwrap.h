@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file mptcpwrap.h
+ *
+ * @brief per-process statistics shared by libmptcpwrap and mptcpize
+ *
+ * Copyright (c) 2026, Red Hat, Inc.
+ */
+
+#ifndef MPTCPWRAP_H
+#define MPTCPWRAP_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+// shm_open() name of the statistics of the given PID
+#define MPTCPWRAP_STATS_NAME	"/mptcpwrap.%d"
+#define MPTCPWRAP_STATS_MAGIC	0x4d505457	// "MPTW"
+#define MPTCPWRAP_STATS_VERSION	2
+
+enum {
+	MPTCPWRAP_INET,
+	MPTCPWRAP_INET6,
+	MPTCPWRAP_FAMILIES
+};
+
+/**
+ * counters are only updated with relaxed atomic operations by the
+ * wrapped process, and may be read at any time
+ */
+struct mptcpwrap_family_stats {
+	uint64_t upgraded;		// MPTCP sockets created instead of TCP
+	uint64_t skipped;		// TCP sockets not upgraded at connect()
+	uint64_t fallback;		// MPTCP socket creation failed
+	uint64_t fallback_cached;	// MPTCP skipped after a recent failure
+};
+
+struct mptcpwrap_stats {
+	uint32_t magic;			// written last, once initialized
+	uint32_t version;
+	int32_t pid;
+	uint32_t reserved;
+	uint64_t starttime;		// tells apart processes with this PID
+	struct mptcpwrap_family_stats family[MPTCPWRAP_FAMILIES];
+};
+
+/**
+ * start time of the given process in clock ticks since boot, as
+ * found in /proc/pid/stat, or 0 if the process doesn't exist
+ *
+ * it doesn't change across exec(), unlike the PID of a process that
+ * exited, which may be reused by a new one.  The shared memory
+ * segments don't survive a reboot, so the boot doesn't need to be
+ * identified as well.
+ */
+static inline uint64_t mptcpwrap_starttime(pid_t pid)
+{
+	char path[32], buf[1024], *p;
+	ssize_t len;
+	int fd, field;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 0;
+
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return 0;
+	buf[len] = '\0';
+
+	// the command name in parentheses may contain both spaces and
+	// parentheses, and is followed by the starttime 20 fields later
+	p = strrchr(buf, ')');
+	for (field = 0; p && field < 20; field++)
+		p = strchr(p + 1, ' ');
+
+	return p ? strtoull(p + 1, NULL, 10) : 0;
+}
+
+#endif /* MPTCPWRAP_H */
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -33,16 +33,37 @@
 #include <mptcpd/private/configuration.h>
 #include <mptcpd/private/addr_info.h>
 #include <mptcpd/private/listener_manager.h>
+#include <mptcpd/private/sock_diag.h>
+#include <mptcpd/private/endpoint_cache.h>
+#include <mptcpd/private/subflow_scheduler.h>
+#include <mptcpd/private/join_stats.h>
+#include <mptcpd/private/plugin_policy.h>
+#include <mptcpd/private/loop_monitor.h>
+#include <mptcpd/sock_diag.h>
 
 // For netlink events.  Same API applies to multipath-tcp.org kernel.
 #include <mptcpd/private/mptcp_upstream.h>
 
 #include "path_manager.h"
 #include "netlink_pm.h"
+#include "service.h"
+#include "state.h"
 
 
 static unsigned int const FAMILY_TIMEOUT_SECONDS = 10;
 
+/// MPTCP subflow metrics collection interval in milliseconds.
+static unsigned int const DIAG_INTERVAL_MS = 1000;
+
+/// Maximum number of peers in the remote endpoint cache.
+static unsigned int const ECACHE_CAPACITY = 1024;
+
+/// Lifetime of remote endpoint cache entries in milliseconds.
+static unsigned int const ECACHE_TTL_MS = 10 * 60 * 1000;
+
+/// Half-life of subflow join statistics in milliseconds.
+static unsigned int const JSTATS_HALF_LIFE_MS = 10 * 60 * 1000;
+
 /**
  * @brief Validate generic netlink attribute size.
  *
@@ -250,10 +271,20 @@ static void handle_connection_created(struct pm_event_attrs const *attrs,
                 return;
         }
 
-        static char const *const pm_name = NULL;
         bool const server_side =
                 (attrs->server_side != NULL ? *attrs->server_side : false);
 
+        // NULL plugin name selects the default plugin.
+        char const *const pm_name =
+                mptcpd_plugin_policy_select(pm->policy,
+                                            (struct sockaddr *) &laddr,
+                                            (struct sockaddr *) &raddr,
+                                            server_side);
+
+        (void) mptcpd_ecache_track(pm->ecache,
+                                   *attrs->token,
+                                   (struct sockaddr *) &raddr);
+
         mptcpd_plugin_new_connection(pm_name,
                                      *attrs->token,
                                      (struct sockaddr *) &laddr,
@@ -327,6 +358,10 @@ static void handle_connection_closed(struct pm_event_attrs const *attrs,
                 return;
         }
 
+        mptcpd_ecache_untrack(pm->ecache, *attrs->token);
+        mptcpd_state_forget(pm, *attrs->token);
+        mptcpd_sched_cancel(pm->sched, *attrs->token);
+
         mptcpd_plugin_connection_closed(*attrs->token, pm);
 }
 
@@ -361,6 +396,11 @@ static void handle_new_addr(struct pm_event_attrs const *attrs,
                 return;
         }
 
+        (void) mptcpd_ecache_add(pm->ecache,
+                                 *attrs->token,
+                                 *attrs->raddr_id,
+                                 (struct sockaddr *) &addr);
+
         mptcpd_plugin_new_address(*attrs->token,
                                   *attrs->raddr_id,
                                   (struct sockaddr *) &addr,
@@ -384,6 +424,10 @@ static void handle_addr_removed(struct pm_event_attrs const *attrs,
                 return;
         }
 
+        (void) mptcpd_ecache_remove(pm->ecache,
+                                    *attrs->token,
+                                    *attrs->raddr_id);
+
         mptcpd_plugin_address_removed(*attrs->token, *attrs->raddr_id, pm);
 }
 
@@ -447,6 +491,28 @@ static bool handle_subflow(struct pm_event_attrs const *attrs,
         return true;
 }
 
+/**
+ * @brief Get the network interface index subflow join outcomes are
+ *        recorded under.
+ *
+ * Plugins query the join statistics with the index the network
+ * monitor associates with the local address, whereas the kernel
+ * only reports the index of the interface a subflow was bound to,
+ * which is usually @c 0.  Fall back to the latter for local
+ * addresses that aren't monitored.
+ */
+static int join_index(struct pm_event_attrs const *attrs,
+                      struct sockaddr const *laddr,
+                      struct mptcpd_pm const *pm)
+{
+        int const index = mptcpd_pm_addr_to_index(pm, laddr);
+
+        if (index != 0)
+                return index;
+
+        return attrs->index ? *attrs->index : 0;
+}
+
 static void handle_new_subflow(struct pm_event_attrs const *attrs,
                                struct mptcpd_pm *pm)
 {
@@ -468,6 +534,19 @@ static void handle_new_subflow(struct pm_event_attrs const *attrs,
         if (!handle_subflow(attrs, &laddr, &raddr))
                 return;
 
+        mptcpd_sched_complete(pm->sched,
+                              *attrs->token,
+                              (struct sockaddr *) &laddr,
+                              (struct sockaddr *) &raddr,
+                              true);
+
+        mptcpd_jstats_record(pm->jstats,
+                             join_index(attrs,
+                                        (struct sockaddr *) &laddr,
+                                        pm),
+                             (struct sockaddr *) &raddr,
+                             true);
+
         mptcpd_plugin_new_subflow(*attrs->token,
                                   (struct sockaddr *) &laddr,
                                   (struct sockaddr *) &raddr,
@@ -496,6 +575,24 @@ static void handle_subflow_closed(struct pm_event_attrs const *attrs,
         if (!handle_subflow(attrs, &laddr, &raddr))
                 return;
 
+        mptcpd_sched_complete(pm->sched,
+                              *attrs->token,
+                              (struct sockaddr *) &laddr,
+                              (struct sockaddr *) &raddr,
+                              false);
+
+        /*
+          Only subflows closed with an error count as failed joins,
+          e.g. MP_JOIN SYN timeouts or resets from middleboxes.
+        */
+        if (attrs->error != NULL && *attrs->error != 0)
+                mptcpd_jstats_record(pm->jstats,
+                                     join_index(attrs,
+                                                (struct sockaddr *) &laddr,
+                                                pm),
+                                     (struct sockaddr *) &raddr,
+                                     false);
+
         mptcpd_plugin_subflow_closed(*attrs->token,
                                      (struct sockaddr *) &laddr,
                                      (struct sockaddr *) &raddr,
@@ -614,7 +711,7 @@ static void handle_listener_closed(struct pm_event_attrs const *attrs,
 }
 #endif  // HAVE_UPSTREAM_KERNEL
 
-static void handle_mptcp_event(struct l_genl_msg *msg, void *user_data)
+void mptcpd_pm_handle_event(struct l_genl_msg *msg, void *user_data)
 {
         int const cmd = l_genl_msg_get_command(msg);
 
@@ -625,6 +722,8 @@ static void handle_mptcp_event(struct l_genl_msg *msg, void *user_data)
 
         struct mptcpd_pm *const pm = user_data;
 
+        mptcpd_loopmon_enter("genl", cmd);
+
         switch (cmd) {
         case MPTCP_EVENT_CREATED:
                 handle_connection_created(&attrs, pm);
@@ -672,6 +771,8 @@ static void handle_mptcp_event(struct l_genl_msg *msg, void *user_data)
                 l_error("Unhandled MPTCP event: %d", cmd);
                 break;
         };
+
+        mptcpd_loopmon_leave();
 }
 
 #ifdef HAVE_UPSTREAM_KERNEL
@@ -733,15 +834,38 @@ static void notify_pm_not_ready(void *data, void *user_data)
                 ops->not_ready(pm, info->user_data);
 }
 
+/**
+ * @brief Report readiness to the service manager.
+ *
+ * Mptcpd is ready once the plugins have been loaded and subscribed
+ * to MPTCP events, and the addresses that existed at startup have
+ * been reported to them.
+ */
+static void update_readiness(struct mptcpd_pm *pm)
+{
+        if (pm->initialized && pm->nm_synced)
+                mptcpd_service_ready();
+}
+
+static void nm_synced(void *user_data)
+{
+        struct mptcpd_pm *const pm = user_data;
+
+        pm->nm_synced = true;
+
+        mptcpd_service_phase("network");
+
+        update_readiness(pm);
+}
+
 static void complete_pm_init(void *data)
 {
         struct mptcpd_pm *const pm = data;
 
         /**
-         * @bug Mptcpd plugins should only be loaded once at process
-         *      start.  The @c mptcpd_plugin_load() function only
-         *      loads the functions once, and only reloads after
-         *      @c mptcpd_plugin_unload() is called.
+         * @note The @c mptcpd_plugin_load() function only loads
+         *       plugins once.  Use @c mptcpd_pm_reconfigure() to
+         *       reload them afterward.
          */
         if (!mptcpd_plugin_load(pm->config->plugin_dir,
                                 pm->config->default_plugin,
@@ -754,13 +878,21 @@ static void complete_pm_init(void *data)
                 exit(EXIT_FAILURE);
         }
 
+        pm->plugins_loaded = true;
+
+        /*
+          Resume where a previous mptcpd run left off before MPTCP
+          events start flowing to the plugins.
+        */
+        mptcpd_state_restore(pm);
+
         /*
           Register callbacks for MPTCP generic netlink multicast
           notifications.
         */
         pm->id = l_genl_family_register(pm->family,
                                         pm->netlink_pm->group,
-                                        handle_mptcp_event,
+                                        mptcpd_pm_handle_event,
                                         pm,
                                         NULL /* destroy */);
 
@@ -774,6 +906,14 @@ static void complete_pm_init(void *data)
         }
 
         l_queue_foreach(pm->event_ops, notify_pm_ready, pm);
+
+        if (!pm->initialized) {
+                pm->initialized = true;
+
+                mptcpd_service_phase("plugins");
+
+                update_readiness(pm);
+        }
 }
 
 /**
@@ -908,11 +1048,30 @@ static void family_timeout(struct l_timeout *timeout, void *user_data)
 }
 
 static struct mptcpd_nm_ops const _nm_ops = {
-        .new_interface    = mptcpd_plugin_new_interface,
-        .update_interface = mptcpd_plugin_update_interface,
-        .delete_interface = mptcpd_plugin_delete_interface,
-        .new_address      = mptcpd_plugin_new_local_address,
-        .delete_address   = mptcpd_plugin_delete_local_address,
+        .new_interface      = mptcpd_plugin_new_interface,
+        .update_interface   = mptcpd_plugin_update_interface,
+        .delete_interface   = mptcpd_plugin_delete_interface,
+        .new_address        = mptcpd_plugin_new_local_address,
+        .delete_address     = mptcpd_plugin_delete_local_address,
+        .link_state_changed = mptcpd_plugin_link_state_changed,
+};
+
+/**
+ * @brief Keep MPTCP metrics collection running.
+ *
+ * The subflow creation scheduler prioritizes queued requests based on
+ * the most recent metrics snapshot, but doesn't need to be notified
+ * of new snapshots.
+ */
+static void sched_snapshot(struct mptcpd_diag_snapshot const *snapshot,
+                           void *user_data)
+{
+        (void) snapshot;
+        (void) user_data;
+}
+
+static struct mptcpd_diag_ops const _sched_diag_ops = {
+        .snapshot = sched_snapshot
 };
 
 struct mptcpd_pm *mptcpd_pm_create(struct mptcpd_config const *config)
@@ -985,6 +1144,8 @@ struct mptcpd_pm *mptcpd_pm_create(struct mptcpd_config const *config)
                 return NULL;
         }
 
+        mptcpd_nm_notify_synced(pm->nm, nm_synced, pm);
+
         // Create mptcpd address ID manager.
         pm->idm = mptcpd_idm_create();
 
@@ -1003,6 +1164,75 @@ struct mptcpd_pm *mptcpd_pm_create(struct mptcpd_config const *config)
                 return NULL;
         }
 
+        /*
+          Create the MPTCP metrics collector.  Metrics are only
+          collected once a plugin subscribes to them.
+        */
+        pm->diag = mptcpd_diag_create(DIAG_INTERVAL_MS);
+
+        if (pm->diag == NULL) {
+                mptcpd_pm_destroy(pm);
+                l_error("Unable to create metrics collector.");
+                return NULL;
+        }
+
+        // Remember addresses announced by peers across connections.
+        pm->ecache = mptcpd_ecache_create(ECACHE_CAPACITY, ECACHE_TTL_MS);
+
+        if (pm->ecache == NULL) {
+                mptcpd_pm_destroy(pm);
+                l_error("Unable to create remote endpoint cache.");
+                return NULL;
+        }
+
+        // Track which paths subflows can be established over.
+        pm->jstats = mptcpd_jstats_create(JSTATS_HALF_LIFE_MS);
+
+        if (pm->jstats == NULL) {
+                mptcpd_pm_destroy(pm);
+                l_error("Unable to create subflow join statistics.");
+                return NULL;
+        }
+
+        // Pace subflow creation requests made by plugins.
+        struct mptcpd_sched_limits const limits = {
+                .per_interface   = config->join_limit_per_interface,
+                .per_destination = config->join_limit_per_destination,
+                .jitter          = config->join_jitter
+        };
+
+        pm->sched = mptcpd_pm_sched_create(pm, &limits);
+
+        if (pm->sched == NULL
+            || ((limits.per_interface != 0 || limits.per_destination != 0)
+                && !mptcpd_diag_register_ops(pm->diag,
+                                             &_sched_diag_ops,
+                                             NULL))) {
+                mptcpd_pm_destroy(pm);
+                l_error("Unable to create subflow creation scheduler.");
+                return NULL;
+        }
+
+        // Select path manager plugins per connection.
+        if (!l_queue_isempty(config->plugin_rules)) {
+                pm->policy =
+                        mptcpd_plugin_policy_create(config->plugin_rules);
+
+                if (pm->policy == NULL) {
+                        mptcpd_pm_destroy(pm);
+                        l_error("Unable to create plugin selection "
+                                "policy.");
+                        return NULL;
+                }
+        }
+
+        // Watch for event loop stalls.
+        if (!mptcpd_loopmon_start(config->stall_threshold)) {
+                mptcpd_pm_destroy(pm);
+                l_error("Unable to monitor event loop latency.");
+                return NULL;
+        }
+
         pm->event_ops = l_queue_new();
 
         return pm;
@@ -1018,9 +1248,20 @@ void mptcpd_pm_destroy(struct mptcpd_pm *pm)
          *      exit, or at least after the last @c mptcpd_pm object
          *      has been destroyed.
          */
+        mptcpd_state_discard(pm);
         mptcpd_plugin_unload(pm);
 
+        if (pm->config != NULL && pm->config->stall_threshold != 0)
+                mptcpd_loopmon_log_stats();
+
+        mptcpd_loopmon_stop();
+
         l_queue_destroy(pm->event_ops, l_free);
+        mptcpd_plugin_policy_destroy(pm->policy);
+        mptcpd_sched_destroy(pm->sched);
+        mptcpd_jstats_destroy(pm->jstats);
+        mptcpd_ecache_destroy(pm->ecache);
+        mptcpd_diag_destroy(pm->diag);
         mptcpd_lm_destroy(pm->lm);
         mptcpd_idm_destroy(pm->idm);
         mptcpd_nm_destroy(pm->nm);
@@ -1031,6 +1272,138 @@ void mptcpd_pm_destroy(struct mptcpd_pm *pm)
 }
 
 
+/**
+ * @brief Names of configuration parameter groups, for logging.
+ */
+static struct
+{
+        uint32_t change;
+        char const *name;
+} const _config_changes[] = {
+        { MPTCPD_CONFIG_CHANGED_LOG,                "log" },
+        { MPTCPD_CONFIG_CHANGED_ADDR_FLAGS,         "address flags" },
+        { MPTCPD_CONFIG_CHANGED_NOTIFY_FLAGS,       "notify flags" },
+        { MPTCPD_CONFIG_CHANGED_PLUGINS,            "plugins" },
+        { MPTCPD_CONFIG_CHANGED_SUBFLOW_LIMITS,     "subflow limits" },
+        { MPTCPD_CONFIG_CHANGED_JOIN_LIMITS,        "join limits" },
+        { MPTCPD_CONFIG_CHANGED_INTERFACE_POLICIES, "interface policies" },
+        { MPTCPD_CONFIG_CHANGED_PLUGIN_RULES,       "plugin selection rules" },
+        { MPTCPD_CONFIG_CHANGED_STATE_FILE,         "state file" },
+        { MPTCPD_CONFIG_CHANGED_STALL_THRESHOLD,    "stall threshold" },
+        { MPTCPD_CONFIG_CHANGED_PROCESS,            "process scheduling" }
+};
+
+static bool sched_needs_diag(struct mptcpd_config const *config)
+{
+        return config->join_limit_per_interface != 0
+                || config->join_limit_per_destination != 0;
+}
+
+static bool reconfigure_sched(struct mptcpd_pm *pm,
+                              struct mptcpd_config const *config)
+{
+        struct mptcpd_sched_limits const limits = {
+                .per_interface   = config->join_limit_per_interface,
+                .per_destination = config->join_limit_per_destination,
+                .jitter          = config->join_jitter
+        };
+
+        mptcpd_sched_set_limits(pm->sched, &limits);
+
+        bool const had_diag   = sched_needs_diag(pm->config);
+        bool const needs_diag = sched_needs_diag(config);
+
+        if (had_diag && !needs_diag)
+                (void) mptcpd_diag_unregister_ops(pm->diag,
+                                                  &_sched_diag_ops,
+                                                  NULL);
+        else if (!had_diag && needs_diag
+                 && !mptcpd_diag_register_ops(pm->diag,
+                                              &_sched_diag_ops,
+                                              NULL)) {
+                l_error("Unable to collect metrics for subflow "
+                        "creation scheduler.");
+
+                return false;
+        }
+
+        return true;
+}
+
+bool mptcpd_pm_reconfigure(struct mptcpd_pm *pm,
+                           struct mptcpd_config const *config)
+{
+        assert(pm != NULL);
+        assert(config != NULL);
+
+        uint32_t const changes = mptcpd_config_diff(pm->config, config);
+        bool result = true;
+
+        for (size_t i = 0; i < L_ARRAY_SIZE(_config_changes); ++i)
+                if (changes & _config_changes[i].change)
+                        l_info("Configuration changed: %s",
+                               _config_changes[i].name);
+
+        if (changes & MPTCPD_CONFIG_CHANGED_NOTIFY_FLAGS)
+                mptcpd_nm_set_notify_flags(pm->nm, config->notify_flags);
+
+        if ((changes & MPTCPD_CONFIG_CHANGED_JOIN_LIMITS)
+            && !reconfigure_sched(pm, config))
+                result = false;
+
+        if ((changes & MPTCPD_CONFIG_CHANGED_STALL_THRESHOLD)
+            && !mptcpd_loopmon_start(config->stall_threshold))
+                result = false;
+
+        if (changes & MPTCPD_CONFIG_CHANGED_PLUGIN_RULES) {
+                mptcpd_plugin_policy_destroy(pm->policy);
+                pm->policy =
+                        mptcpd_plugin_policy_create(config->plugin_rules);
+        }
+
+        /*
+          Address flags and the remaining parameters are read from
+          the configuration when needed.
+        */
+        pm->config = config;
+
+        /*
+          Always reload plugins, even if the configuration is
+          unchanged, so that replaced plugin binaries are picked up.
+          Plugins not loaded yet will be loaded with the new
+          configuration.
+        */
+        if (pm->plugins_loaded
+            && !mptcpd_plugin_reload(config->plugin_dir,
+                                     config->default_plugin,
+                                     config->plugins_to_load,
+                                     pm)) {
+                l_error("Unable to reload path manager plugins.");
+                result = false;
+        }
+
+        return result;
+}
+
+void mptcpd_pm_record_reload(struct mptcpd_pm *pm,
+                             bool succeeded,
+                             uint64_t duration)
+{
+        struct mptcpd_pm_reload_stats *const stats = &pm->reload_stats;
+
+        if (succeeded)
+                ++stats->succeeded;
+        else
+                ++stats->failed;
+
+        stats->last_duration  = duration;
+        stats->last_succeeded = succeeded;
+
+        l_info("Configuration reload %s in %" PRIu64 " us",
+               succeeded ? "succeeded" : "failed",
+               duration);
+}
+
 /*
   Local Variables:
   c-file-style: "linux"
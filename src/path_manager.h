@@ -13,6 +13,7 @@
 
 struct mptcpd_pm;
 struct mptcpd_config;
+struct l_genl_msg;
 
 /**
  * @brief Create a path manager.
@@ -35,6 +36,58 @@ mptcpd_pm_create(struct mptcpd_config const *config);
  */
 void mptcpd_pm_destroy(struct mptcpd_pm *pm);
 
+/**
+ * @brief Apply a new mptcpd configuration.
+ *
+ * Compare @a config to the configuration currently used by the path
+ * manager, and apply the differences in place to the network
+ * monitor, the subflow creation scheduler and the plugin selection
+ * rules.  Path manager plugins are always reloaded with the plugin
+ * settings of @a config, even if they are unchanged, which also picks
+ * up replaced plugin binaries.
+ *
+ * The path manager uses @a config from then on, even if some changes
+ * could not be applied, so the previous configuration may be
+ * destroyed once this function returns.
+ *
+ * @param[in,out] pm     Path manager.
+ * @param[in]     config New mptcpd configuration.
+ *
+ * @return @c true if all changes were applied, and @c false
+ *         otherwise.
+ *
+ * @note Plugins are unloaded, so this function must not be called
+ *       from within a plugin operation.  Call it from an idle
+ *       callback to let pending events drain first.
+ */
+bool mptcpd_pm_reconfigure(struct mptcpd_pm *pm,
+                           struct mptcpd_config const *config);
+
+/**
+ * @brief Record the outcome of a configuration reload.
+ *
+ * @param[in,out] pm        Path manager.
+ * @param[in]     succeeded Whether the reload succeeded.
+ * @param[in]     duration  Duration of the reload in microseconds.
+ *
+ * @see mptcpd_pm_get_reload_stats()
+ */
+void mptcpd_pm_record_reload(struct mptcpd_pm *pm,
+                             bool succeeded,
+                             uint64_t duration);
+
+/**
+ * @brief Handle a MPTCP generic netlink event.
+ *
+ * @param[in]     msg       MPTCP generic netlink event message.
+ * @param[in,out] user_data Path manager the event is for.
+ *
+ * @note This function is only exported for the mptcpd unit tests.
+ *       The path manager handles the events it receives from the
+ *       kernel on its own.
+ */
+void mptcpd_pm_handle_event(struct l_genl_msg *msg, void *user_data);
+
 
 #endif /* MPTCPD_PATH_MANAGER_H */
 
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/process.c
+ *
+ * @brief mptcpd process scheduling and memory settings.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#define _GNU_SOURCE  ///< For CPU affinity support in <sched.h>.
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/capability.h>
+
+#ifdef HAVE_MALLOPT
+# include <malloc.h>
+#endif
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/configuration.h>
+
+#include "process.h"
+
+
+/**
+ * @brief Amount of stack memory prefaulted after locking memory.
+ *
+ * Generously covers the deepest call chains of the event handlers.
+ */
+#define PREFAULT_STACK_SIZE (128 * 1024)
+
+/**
+ * @brief Amount of heap memory prefaulted after locking memory.
+ *
+ * The prefaulted memory is kept by the allocator, and serves
+ * allocations made while handling events without page faults.
+ */
+#define PREFAULT_HEAP_SIZE (1024 * 1024)
+
+/**
+ * @struct process_info
+ *
+ * @brief Process settings in effect before mptcpd changed them.
+ */
+struct process_info
+{
+        /// CPU affinity at mptcpd start.
+        cpu_set_t affinity;
+
+        /// @c affinity is valid.
+        bool affinity_saved;
+
+        /// Scheduling policy was changed.
+        bool sched_changed;
+
+        /// Process memory is locked.
+        bool memory_locked;
+};
+
+static struct process_info _process;
+
+// ----------------------------------------------------------------------
+
+bool mptcpd_cpu_list_foreach(char const *list,
+                             mptcpd_cpu_func callback,
+                             void *user_data)
+{
+        if (list == NULL || *list == '\0')
+                return false;
+
+        char const *s = list;
+
+        for (;;) {
+                char *end = NULL;
+
+                if (!isdigit((unsigned char) *s))
+                        return false;
+
+                errno = 0;
+                unsigned long const first = strtoul(s, &end, 10);
+                unsigned long last = first;
+
+                if (*end == '-') {
+                        s = end + 1;
+
+                        if (!isdigit((unsigned char) *s))
+                                return false;
+
+                        last = strtoul(s, &end, 10);
+                }
+
+                if (errno != 0 || last < first || last >= CPU_SETSIZE)
+                        return false;
+
+                if (callback != NULL)
+                        for (unsigned long cpu = first; cpu <= last; ++cpu)
+                                callback(cpu, user_data);
+
+                if (*end == '\0')
+                        return true;
+
+                if (*end != ',')
+                        return false;
+
+                s = end + 1;
+        }
+}
+
+static void add_cpu(unsigned int cpu, void *user_data)
+{
+        CPU_SET(cpu, (cpu_set_t *) user_data);
+}
+
+static bool set_affinity(char const *list)
+{
+        if (!_process.affinity_saved) {
+                if (sched_getaffinity(0,
+                                      sizeof(_process.affinity),
+                                      &_process.affinity) != 0) {
+                        l_error("Unable to get CPU affinity: %s",
+                                strerror(errno));
+                        return false;
+                }
+
+                _process.affinity_saved = true;
+        }
+
+        cpu_set_t cpus;
+
+        if (list == NULL) {
+                // Revert to the CPU affinity mptcpd started with.
+                cpus = _process.affinity;
+        } else {
+                CPU_ZERO(&cpus);
+
+                if (!mptcpd_cpu_list_foreach(list, add_cpu, &cpus)) {
+                        l_error("Invalid CPU affinity: %s", list);
+                        return false;
+                }
+        }
+
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+                l_error("Unable to set CPU affinity to %s: %s",
+                        list != NULL ? list : "initial CPUs",
+                        strerror(errno));
+                return false;
+        }
+
+        if (list != NULL)
+                l_info("CPU affinity: %s", list);
+
+        return true;
+}
+
+static bool set_scheduler(uint32_t policy, uint32_t priority)
+{
+        int sched_policy = SCHED_OTHER;
+        char const *name = "SCHED_OTHER";
+
+        if (policy == MPTCPD_SCHED_FIFO) {
+                sched_policy = SCHED_FIFO;
+                name = "SCHED_FIFO";
+        } else if (policy == MPTCPD_SCHED_RR) {
+                sched_policy = SCHED_RR;
+                name = "SCHED_RR";
+        } else if (policy == MPTCPD_SCHED_DEFAULT
+                   && !_process.sched_changed) {
+                if (priority != 0)
+                        l_warn("Scheduling priority ignored without a "
+                               "real-time scheduling policy.");
+
+                return true;
+        }
+
+        struct sched_param param = { .sched_priority = 0 };
+
+        if (sched_policy != SCHED_OTHER) {
+                int const min = sched_get_priority_min(sched_policy);
+                int const max = sched_get_priority_max(sched_policy);
+
+                param.sched_priority = priority == 0 ? min : (int) priority;
+
+                if (priority > (uint32_t) max
+                    || param.sched_priority < min) {
+                        l_error("Scheduling priority %u out of range "
+                                "[%d, %d] for %s.",
+                                priority,
+                                min,
+                                max,
+                                name);
+                        return false;
+                }
+        }
+
+        if (sched_setscheduler(0, sched_policy, &param) != 0) {
+                l_error("Unable to set scheduling policy %s: %s",
+                        name,
+                        strerror(errno));
+                return false;
+        }
+
+        _process.sched_changed = (sched_policy != SCHED_OTHER);
+
+        l_info("Scheduling policy: %s, priority %d",
+               name,
+               param.sched_priority);
+
+        return true;
+}
+
+/**
+ * @brief Touch stack pages so that they are mapped and locked.
+ */
+static void __attribute__((noinline)) prefault_stack(void)
+{
+        volatile char stack[PREFAULT_STACK_SIZE];
+        size_t const page_size = (size_t) sysconf(_SC_PAGESIZE);
+
+        for (size_t i = 0; i < sizeof(stack); i += page_size)
+                stack[i] = 0;
+}
+
+/**
+ * @brief Fault in a heap memory pool kept by the allocator.
+ */
+static void prefault_heap(void)
+{
+#ifdef HAVE_MALLOPT
+        /*
+          Keep freed memory in the heap instead of returning it to
+          the kernel, and serve large allocations from the heap too,
+          so that the prefaulted pool is reused.
+        */
+        (void) mallopt(M_TRIM_THRESHOLD, -1);
+        (void) mallopt(M_MMAP_MAX, 0);
+#endif
+
+        size_t const page_size = (size_t) sysconf(_SC_PAGESIZE);
+        char *const pool = l_malloc(PREFAULT_HEAP_SIZE);
+
+        for (size_t i = 0; i < PREFAULT_HEAP_SIZE; i += page_size)
+                ((char volatile *) pool)[i] = 0;
+
+        l_free(pool);
+}
+
+/**
+ * @brief Check if all current and future memory may be locked.
+ *
+ * Locking memory with a finite @c RLIMIT_MEMLOCK resource limit and
+ * without the @c CAP_IPC_LOCK capability would make memory
+ * allocations fail once the limit is reached, rather than the
+ * @c mlockall() call itself.
+ */
+static bool can_lock_memory(void)
+{
+        struct rlimit limit;
+
+        if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0
+            && limit.rlim_cur == RLIM_INFINITY)
+                return true;
+
+        struct __user_cap_header_struct header = {
+                .version = _LINUX_CAPABILITY_VERSION_3,
+                .pid     = 0
+        };
+
+        struct __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3];
+
+        if (syscall(SYS_capget, &header, data) != 0) {
+                l_error("Unable to get process capabilities: %s",
+                        strerror(errno));
+                return false;
+        }
+
+        return (data[CAP_TO_INDEX(CAP_IPC_LOCK)].effective
+                & CAP_TO_MASK(CAP_IPC_LOCK)) != 0;
+}
+
+static bool lock_memory(bool lock)
+{
+        if (!lock) {
+                if (_process.memory_locked && munlockall() != 0) {
+                        l_error("Unable to unlock memory: %s",
+                                strerror(errno));
+                        return false;
+                }
+
+                _process.memory_locked = false;
+
+                return true;
+        }
+
+        if (_process.memory_locked)
+                return true;
+
+        if (!can_lock_memory()) {
+                l_error("Refusing to lock memory without the "
+                        "CAP_IPC_LOCK capability or an unlimited "
+                        "RLIMIT_MEMLOCK resource limit.");
+                return false;
+        }
+
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+                l_error("Unable to lock memory: %s", strerror(errno));
+                return false;
+        }
+
+        _process.memory_locked = true;
+
+        prefault_stack();
+        prefault_heap();
+
+        l_info("Memory locked, %d KiB of stack and %d KiB of heap "
+               "prefaulted",
+               PREFAULT_STACK_SIZE / 1024,
+               PREFAULT_HEAP_SIZE / 1024);
+
+        return true;
+}
+
+bool mptcpd_process_configure(struct mptcpd_config const *config)
+{
+        bool result = true;
+
+        if ((config->cpu_affinity != NULL || _process.affinity_saved)
+            && !set_affinity(config->cpu_affinity))
+                result = false;
+
+        if (!set_scheduler(config->sched_policy, config->sched_priority))
+                result = false;
+
+        if (!lock_memory(config->lock_memory))
+                result = false;
+
+        return result;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/process.h
+ *
+ * @brief mptcpd process scheduling and memory settings (internal).
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_PROCESS_H
+#define MPTCPD_PROCESS_H
+
+#include <stdbool.h>
+
+
+struct mptcpd_config;
+
+/**
+ * @brief CPU list iteration callback type.
+ *
+ * @param[in] cpu       CPU number.
+ * @param[in] user_data Data passed to @c mptcpd_cpu_list_foreach().
+ */
+typedef void (*mptcpd_cpu_func)(unsigned int cpu, void *user_data);
+
+/**
+ * @brief Iterate over the CPUs in a CPU list.
+ *
+ * @param[in] list      Comma separated list of CPU numbers and
+ *                      inclusive ranges of CPU numbers, e.g.
+ *                      @c "0-3,6".
+ * @param[in] callback  Function called for each CPU in @a list, or
+ *                      @c NULL to only validate @a list.
+ * @param[in] user_data Data passed to @a callback.
+ *
+ * @return @c true if @a list is a valid, non-empty CPU list, and
+ *         @c false otherwise, in which case @a callback may have
+ *         been called for some CPUs.
+ */
+bool mptcpd_cpu_list_foreach(char const *list,
+                             mptcpd_cpu_func callback,
+                             void *user_data);
+
+/**
+ * @brief Apply process scheduling and memory settings.
+ *
+ * Set the CPU affinity, the scheduling policy and priority, and lock
+ * the process memory according to @a config, and report the applied
+ * settings.  Settings removed from the configuration since a
+ * previous call are reverted.  Settings that cannot be applied, e.g.
+ * due to missing privileges, are reported but do not prevent the
+ * others from being applied.
+ *
+ * @param[in] config Mptcpd configuration.
+ *
+ * @return @c true if all settings were applied, and @c false
+ *         otherwise.
+ */
+bool mptcpd_process_configure(struct mptcpd_config const *config);
+
+
+#endif /* MPTCPD_PROCESS_H */
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
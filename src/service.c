@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/service.c
+ *
+ * @brief mptcpd service manager notification.
+ *
+ * Implements the systemd service notification protocol, see
+ * sd_notify(3), without depending on libsystemd.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <ell/ell.h>
+
+#include "service.h"
+
+
+/// Maximum number of recorded startup phases.
+#define SERVICE_MAX_PHASES 8
+
+/**
+ * @struct service_phase
+ *
+ * @brief Startup phase timing.
+ */
+struct service_phase
+{
+        /// Phase name.
+        char const *name;
+
+        /// Phase duration in microseconds.
+        uint64_t duration;
+};
+
+/**
+ * @struct service_info
+ *
+ * @brief Service manager notification state.
+ */
+struct service_info
+{
+        /// Notification socket, or -1 if not started by systemd.
+        int fd;
+
+        /// Address of the systemd notification socket.
+        struct sockaddr_un addr;
+
+        /// Length of @c addr.
+        socklen_t addr_len;
+
+        /// Watchdog heartbeat timeout, if the watchdog is enabled.
+        struct l_timeout *watchdog;
+
+        /// Watchdog heartbeat interval in milliseconds.
+        uint64_t interval;
+
+        /// Time of the last watchdog heartbeat.
+        uint64_t heartbeat;
+
+        /// Process start time.
+        uint64_t start;
+
+        /// Completion time of the last startup phase.
+        uint64_t mark;
+
+        /// Startup phase timings.
+        struct service_phase phases[SERVICE_MAX_PHASES];
+
+        /// Number of entries in @c phases.
+        size_t phase_count;
+
+        /// READY=1 has been sent.
+        bool ready;
+};
+
+static struct service_info _service = { .fd = -1 };
+
+/**
+ * @brief Send a message to the service manager.
+ *
+ * @param[in] fmt printf()-style format of newline separated
+ *                @c VARIABLE=value assignments.
+ */
+static void service_notify(char const *fmt, ...)
+        __attribute__((format(printf, 1, 2)));
+
+static void service_notify(char const *fmt, ...)
+{
+        if (_service.fd == -1)
+                return;
+
+        char msg[512];
+
+        va_list ap;
+        va_start(ap, fmt);
+        int const len = vsnprintf(msg, sizeof(msg), fmt, ap);
+        va_end(ap);
+
+        if (len < 0 || (size_t) len >= sizeof(msg)) {
+                l_error("Service notification too long.");
+                return;
+        }
+
+        if (sendto(_service.fd,
+                   msg,
+                   (size_t) len,
+                   MSG_NOSIGNAL,
+                   (struct sockaddr const *) &_service.addr,
+                   _service.addr_len) == -1)
+                l_debug("Unable to notify service manager: %s",
+                        strerror(errno));
+}
+
+/**
+ * @brief Send a watchdog heartbeat from the event loop.
+ *
+ * Heartbeats are only sent while the event loop dispatches timeouts
+ * so that a stalled loop is caught by the systemd watchdog.
+ */
+static void watchdog_heartbeat(struct l_timeout *timeout, void *user_data)
+{
+        (void) user_data;
+
+        uint64_t const now = l_time_now();
+        uint64_t const lag =
+                l_time_diff(_service.heartbeat, now) / L_USEC_PER_MSEC;
+
+        _service.heartbeat = now;
+
+        service_notify("WATCHDOG=1");
+
+        // Half of the interval is the margin before systemd steps in.
+        if (lag > _service.interval + _service.interval / 2)
+                l_warn("Event loop lagged %" PRIu64 " ms behind the "
+                       "service watchdog.",
+                       lag - _service.interval);
+
+        l_timeout_modify_ms(timeout, _service.interval);
+}
+
+static bool connect_notify_socket(char const *path)
+{
+        size_t const len = strlen(path);
+
+        // Filesystem or abstract namespace socket.
+        if ((path[0] != '/' && path[0] != '@')
+            || len < 2
+            || len >= sizeof(_service.addr.sun_path)) {
+                l_error("Invalid NOTIFY_SOCKET: %s", path);
+                return false;
+        }
+
+        _service.addr.sun_family = AF_UNIX;
+        memcpy(_service.addr.sun_path, path, len);
+
+        _service.addr_len = offsetof(struct sockaddr_un, sun_path) + len;
+
+        if (path[0] == '@')
+                _service.addr.sun_path[0] = '\0';
+        else
+                ++_service.addr_len;  // Include the terminating NUL.
+
+        _service.fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (_service.fd == -1) {
+                l_error("Unable to create service notification "
+                        "socket: %s",
+                        strerror(errno));
+                return false;
+        }
+
+        return true;
+}
+
+static void start_watchdog(void)
+{
+        char const *const pid = getenv("WATCHDOG_PID");
+
+        // The watchdog may be meant for another process.
+        if (pid != NULL && strtol(pid, NULL, 10) != (long) getpid())
+                return;
+
+        char const *const usec = getenv("WATCHDOG_USEC");
+
+        if (usec == NULL)
+                return;
+
+        char *end = NULL;
+        errno = 0;
+        unsigned long long const timeout = strtoull(usec, &end, 10);
+
+        if (errno != 0 || end == usec || *end != '\0' || timeout == 0) {
+                l_error("Invalid WATCHDOG_USEC: %s", usec);
+                return;
+        }
+
+        // Heartbeat twice per watchdog timeout, as systemd suggests.
+        _service.interval = timeout / L_USEC_PER_MSEC / 2;
+
+        if (_service.interval == 0)
+                _service.interval = 1;
+
+        _service.heartbeat = l_time_now();
+        _service.watchdog  = l_timeout_create_ms(_service.interval,
+                                                 watchdog_heartbeat,
+                                                 NULL,
+                                                 NULL);
+
+        if (_service.watchdog == NULL)
+                l_error("Unable to start service watchdog heartbeat.");
+        else
+                l_debug("Service watchdog heartbeat every %" PRIu64
+                        " ms.",
+                        _service.interval);
+}
+
+void mptcpd_service_init(uint64_t start)
+{
+        _service.start = start;
+        _service.mark  = start;
+
+        char const *const path = getenv("NOTIFY_SOCKET");
+
+        if (path == NULL || !connect_notify_socket(path))
+                return;
+
+        start_watchdog();
+}
+
+void mptcpd_service_phase(char const *name)
+{
+        if (_service.ready
+            || _service.phase_count == L_ARRAY_SIZE(_service.phases))
+                return;
+
+        uint64_t const now = l_time_now();
+
+        struct service_phase *const phase =
+                &_service.phases[_service.phase_count++];
+
+        phase->name     = name;
+        phase->duration = l_time_diff(_service.mark, now);
+
+        _service.mark = now;
+
+        l_debug("Startup phase \"%s\" took %" PRIu64 " us.",
+                name,
+                phase->duration);
+}
+
+void mptcpd_service_ready(void)
+{
+        if (_service.ready)
+                return;
+
+        _service.ready = true;
+
+        // Startup phase timings, e.g. "plugins 1.234 ms, ...".
+        char timings[256] = "";
+        size_t len = 0;
+
+        for (size_t i = 0; i < _service.phase_count; ++i) {
+                struct service_phase const *const phase =
+                        &_service.phases[i];
+
+                int const n = snprintf(timings + len,
+                                       sizeof(timings) - len,
+                                       "%s%s %" PRIu64 ".%03" PRIu64
+                                       " ms",
+                                       i == 0 ? "" : ", ",
+                                       phase->name,
+                                       phase->duration / 1000,
+                                       phase->duration % 1000);
+
+                if (n < 0 || (size_t) n >= sizeof(timings) - len)
+                        break;
+
+                len += (size_t) n;
+        }
+
+        uint64_t const total = l_time_diff(_service.start, _service.mark);
+
+        l_info("Ready in %" PRIu64 ".%03" PRIu64 " ms (%s).",
+               total / 1000,
+               total % 1000,
+               timings);
+
+        service_notify("READY=1\n"
+                       "STATUS=Ready in %" PRIu64 ".%03" PRIu64
+                       " ms (%s)",
+                       total / 1000,
+                       total % 1000,
+                       timings);
+}
+
+void mptcpd_service_reloading(void)
+{
+        struct timespec ts;
+
+        // systemd expects CLOCK_MONOTONIC, unlike l_time_now().
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+                return;
+
+        service_notify("RELOADING=1\n"
+                       "STATUS=Reloading configuration\n"
+                       "MONOTONIC_USEC=%" PRIu64,
+                       (uint64_t) (ts.tv_sec * L_USEC_PER_SEC
+                                   + ts.tv_nsec / L_NSEC_PER_USEC));
+}
+
+void mptcpd_service_reloaded(bool succeeded)
+{
+        service_notify("READY=1\n"
+                       "STATUS=%s",
+                       succeeded
+                       ? "Configuration reloaded"
+                       : "Configuration reload failed");
+}
+
+void mptcpd_service_stopping(void)
+{
+        service_notify("STOPPING=1\n"
+                       "STATUS=Shutting down");
+}
+
+void mptcpd_service_exit(void)
+{
+        l_timeout_remove(_service.watchdog);
+        _service.watchdog = NULL;
+
+        if (_service.fd != -1) {
+                (void) close(_service.fd);
+                _service.fd = -1;
+        }
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/service.h
+ *
+ * @brief mptcpd service manager notification (internal).
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_SERVICE_H
+#define MPTCPD_SERVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * @brief Prepare service manager notifications.
+ *
+ * Connect to the systemd notification socket and start sending
+ * watchdog heartbeats from the event loop if requested by the
+ * service manager through the @c NOTIFY_SOCKET and
+ * @c WATCHDOG_USEC environment variables.  Startup phase timings
+ * are still recorded when mptcpd was not started by systemd.
+ *
+ * @param[in] start Process start time, as returned by
+ *                  @c l_time_now().
+ *
+ * @note Call after @c l_main_init().
+ */
+void mptcpd_service_init(uint64_t start);
+
+/**
+ * @brief Record the completion of a startup phase.
+ *
+ * The duration of a phase is the time elapsed since the previous
+ * phase completed, or since the process started for the first one.
+ * Phases completed after mptcpd is ready are not recorded.
+ *
+ * @param[in] name Phase name, with static storage duration.
+ */
+void mptcpd_service_phase(char const *name);
+
+/**
+ * @brief Report that mptcpd is ready.
+ *
+ * Send @c READY=1 along with the startup phase timings to the
+ * service manager.  Only the first call has an effect.
+ */
+void mptcpd_service_ready(void);
+
+/**
+ * @brief Report that mptcpd is reloading its configuration.
+ */
+void mptcpd_service_reloading(void);
+
+/**
+ * @brief Report that mptcpd finished reloading its configuration.
+ *
+ * @param[in] succeeded Whether the reload succeeded.
+ */
+void mptcpd_service_reloaded(bool succeeded);
+
+/**
+ * @brief Report that mptcpd is shutting down.
+ */
+void mptcpd_service_stopping(void);
+
+/**
+ * @brief Stop service manager notifications.
+ */
+void mptcpd_service_exit(void);
+
+
+#endif /* MPTCPD_SERVICE_H */
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
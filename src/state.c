@@ -0,0 +1,627 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/state.c
+ *
+ * @brief mptcpd persistent state.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <mptcpd/private/config.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/path_manager.h>
+#include <mptcpd/private/configuration.h>
+#include <mptcpd/private/plugin.h>
+#include <mptcpd/private/id_manager.h>
+#include <mptcpd/private/listener_manager.h>
+#include <mptcpd/private/endpoint_cache.h>
+#include <mptcpd/private/sock_diag.h>
+#include <mptcpd/private/state_file.h>
+#include <mptcpd/sock_diag.h>
+
+#include "state.h"
+
+
+/**
+ * @name State File Record Types
+ */
+///@{
+/// MPTCP address ID, @c struct @c state_addr_id.
+#define STATE_ADDR_ID    1
+
+/// MPTCP listener, @c struct @c state_addr.
+#define STATE_LISTENER   2
+
+/// Address announced by a peer, @c struct @c state_endpoint.
+#define STATE_ENDPOINT   3
+
+/// MPTCP connection, @c struct @c state_connection.
+#define STATE_CONNECTION 4
+///@}
+
+/// Maximum length of a plugin name in a connection record.
+#define STATE_NAME_MAX 255
+
+/**
+ * @struct state_addr
+ *
+ * @brief IP address and port in a state file record.
+ */
+struct state_addr
+{
+        /// IPv4 or IPv6 address in network byte order.
+        uint8_t addr[16];
+
+        /// Address family, or zero if unset.
+        uint16_t family;
+
+        /// Port in network byte order.
+        uint16_t port;
+
+        /// Reserved, zero.
+        uint32_t reserved;
+};
+
+/**
+ * @struct state_addr_id
+ *
+ * @brief MPTCP address ID record.
+ */
+struct state_addr_id
+{
+        /// Local IP address.
+        struct state_addr addr;
+
+        /// MPTCP address ID.
+        uint32_t id;
+
+        /// Reserved, zero.
+        uint32_t reserved;
+};
+
+/**
+ * @struct state_endpoint
+ *
+ * @brief Remote endpoint cache record.
+ */
+struct state_endpoint
+{
+        /// Peer primary address.
+        struct state_addr primary;
+
+        /// Address announced by the peer.
+        struct state_addr addr;
+
+        /// Remaining lifetime in milliseconds.
+        uint32_t lifetime;
+
+        /// Remote address ID.
+        uint32_t id;
+};
+
+/**
+ * @struct state_connection
+ *
+ * @brief MPTCP connection record.
+ *
+ * Followed by @c name_len bytes of plugin name, without a
+ * terminating NUL, and @c len bytes of plugin connection state.
+ */
+struct state_connection
+{
+        /// MPTCP connection token.
+        uint32_t token;
+
+        /// Plugin-defined state format version.
+        uint32_t version;
+
+        /// Length of the plugin connection state in bytes.
+        uint32_t len;
+
+        /// Length of the plugin name in bytes.
+        uint16_t name_len;
+
+        /// Reserved, zero.
+        uint16_t reserved;
+
+        /// Peer primary address, if known.
+        struct state_addr raddr;
+};
+
+/**
+ * @struct mptcpd_state_restore
+ *
+ * @brief Restored state pending validation against the kernel.
+ */
+struct mptcpd_state_restore
+{
+        /// Tokens of restored MPTCP connections not seen yet.
+        struct l_hashmap *tokens;
+
+        /// Deferred validation cleanup, once validation completed.
+        struct l_idle *idle;
+};
+
+/**
+ * @struct state_restore_info
+ *
+ * @brief Convenience structure to bundle state restoration
+ *        information.
+ */
+struct state_restore_info
+{
+        /// Mptcpd path manager object.
+        struct mptcpd_pm *const pm;
+
+        /// Number of restored MPTCP address IDs.
+        size_t ids;
+
+        /// Number of restored listeners.
+        size_t listeners;
+
+        /// Number of restored peer addresses.
+        size_t endpoints;
+
+        /// Number of restored MPTCP connections.
+        size_t connections;
+};
+
+// ----------------------------------------------------------------------
+
+static void addr_to_state(struct sockaddr const *sa, struct state_addr *s)
+{
+        memset(s, 0, sizeof(*s));
+
+        if (sa == NULL)
+                return;
+
+        if (sa->sa_family == AF_INET) {
+                struct sockaddr_in const *const sa4 =
+                        (struct sockaddr_in const *) sa;
+
+                memcpy(s->addr, &sa4->sin_addr, sizeof(sa4->sin_addr));
+                s->port = sa4->sin_port;
+        } else if (sa->sa_family == AF_INET6) {
+                struct sockaddr_in6 const *const sa6 =
+                        (struct sockaddr_in6 const *) sa;
+
+                memcpy(s->addr, &sa6->sin6_addr, sizeof(sa6->sin6_addr));
+                s->port = sa6->sin6_port;
+        } else {
+                return;
+        }
+
+        s->family = sa->sa_family;
+}
+
+static bool addr_from_state(struct state_addr const *s,
+                            struct sockaddr_storage *ss)
+{
+        memset(ss, 0, sizeof(*ss));
+
+        if (s->family == AF_INET) {
+                struct sockaddr_in *const sa4 = (struct sockaddr_in *) ss;
+
+                memcpy(&sa4->sin_addr, s->addr, sizeof(sa4->sin_addr));
+                sa4->sin_port = s->port;
+        } else if (s->family == AF_INET6) {
+                struct sockaddr_in6 *const sa6 = (struct sockaddr_in6 *) ss;
+
+                memcpy(&sa6->sin6_addr, s->addr, sizeof(sa6->sin6_addr));
+                sa6->sin6_port = s->port;
+        } else {
+                return false;
+        }
+
+        ss->ss_family = s->family;
+
+        return true;
+}
+
+// ----------------------------------------------------------------------
+//                               Save
+// ----------------------------------------------------------------------
+
+static void save_addr_id(struct sockaddr const *sa,
+                         mptcpd_aid_t id,
+                         void *user_data)
+{
+        struct state_addr_id r = { .id = id };
+
+        addr_to_state(sa, &r.addr);
+
+        (void) mptcpd_state_writer_add(user_data,
+                                       STATE_ADDR_ID,
+                                       &r,
+                                       sizeof(r));
+}
+
+static void save_listener(struct sockaddr const *sa, void *user_data)
+{
+        struct state_addr r;
+
+        addr_to_state(sa, &r);
+
+        (void) mptcpd_state_writer_add(user_data,
+                                       STATE_LISTENER,
+                                       &r,
+                                       sizeof(r));
+}
+
+static void save_endpoint(struct sockaddr const *primary,
+                          mptcpd_aid_t id,
+                          struct sockaddr const *addr,
+                          unsigned int lifetime,
+                          void *user_data)
+{
+        struct state_endpoint r = {
+                .lifetime = lifetime,
+                .id       = id
+        };
+
+        addr_to_state(primary, &r.primary);
+        addr_to_state(addr, &r.addr);
+
+        (void) mptcpd_state_writer_add(user_data,
+                                       STATE_ENDPOINT,
+                                       &r,
+                                       sizeof(r));
+}
+
+/**
+ * @struct state_save_info
+ *
+ * @brief Convenience structure to bundle connection save information.
+ */
+struct state_save_info
+{
+        /// State file writer.
+        struct mptcpd_state_writer *const w;
+
+        /// Mptcpd path manager object.
+        struct mptcpd_pm *const pm;
+};
+
+static void save_connection(mptcpd_token_t token,
+                            char const *name,
+                            uint32_t version,
+                            void const *state,
+                            size_t len,
+                            void *user_data)
+{
+        struct state_save_info const *const info = user_data;
+
+        size_t const name_len = name == NULL ? 0 : strlen(name);
+
+        if (name_len > STATE_NAME_MAX || len > UINT32_MAX) {
+                l_warn("State of connection 0x%" PRIx32 " not saved.",
+                       token);
+                return;
+        }
+
+        struct state_connection r = {
+                .token    = token,
+                .version  = version,
+                .len      = (uint32_t) len,
+                .name_len = (uint16_t) name_len
+        };
+
+        addr_to_state(mptcpd_ecache_get_primary(info->pm->ecache, token),
+                      &r.raddr);
+
+        size_t const size = sizeof(r) + name_len + len;
+        uint8_t *const buf = l_malloc(size);
+
+        memcpy(buf, &r, sizeof(r));
+
+        if (name_len != 0)
+                memcpy(buf + sizeof(r), name, name_len);
+
+        if (len != 0)
+                memcpy(buf + sizeof(r) + name_len, state, len);
+
+        (void) mptcpd_state_writer_add(info->w, STATE_CONNECTION, buf, size);
+
+        l_free(buf);
+}
+
+bool mptcpd_state_save(struct mptcpd_pm *pm)
+{
+        char const *const path = pm->config->state_file;
+
+        if (path == NULL || !pm->plugins_loaded)
+                return true;
+
+        struct mptcpd_state_writer *const w = mptcpd_state_writer_create();
+
+        mptcpd_idm_foreach(pm->idm, save_addr_id, w);
+        mptcpd_lm_foreach(pm->lm, save_listener, w);
+        mptcpd_ecache_dump(pm->ecache, save_endpoint, w);
+
+        struct state_save_info info = { .w = w, .pm = pm };
+
+        mptcpd_plugin_export_states(save_connection, &info, pm);
+
+        bool const saved = mptcpd_state_writer_commit(w, path);
+
+        mptcpd_state_writer_destroy(w);
+
+        if (saved)
+                l_debug("State saved to %s.", path);
+
+        return saved;
+}
+
+// ----------------------------------------------------------------------
+//                              Restore
+// ----------------------------------------------------------------------
+
+static void restore_addr_id(void const *data, size_t len, void *user_data)
+{
+        struct state_addr_id const *const r = data;
+        struct state_restore_info *const info = user_data;
+        struct sockaddr_storage ss;
+
+        if (len != sizeof(*r)
+            || r->id == 0 || r->id > UINT8_MAX
+            || !addr_from_state(&r->addr, &ss))
+                return;
+
+        // Address IDs synchronized from the kernel take precedence.
+        if (mptcpd_idm_restore_id(info->pm->idm,
+                                  (struct sockaddr *) &ss,
+                                  (mptcpd_aid_t) r->id))
+                ++info->ids;
+}
+
+static void restore_listener(void const *data, size_t len, void *user_data)
+{
+        struct state_addr const *const r = data;
+        struct state_restore_info *const info = user_data;
+        struct sockaddr_storage ss;
+
+        if (len != sizeof(*r) || !addr_from_state(r, &ss))
+                return;
+
+        // Binding fails if the address is no longer local.
+        if (mptcpd_lm_restore(info->pm->lm, (struct sockaddr *) &ss) == 0)
+                ++info->listeners;
+}
+
+static void restore_endpoint(void const *data, size_t len, void *user_data)
+{
+        struct state_endpoint const *const r = data;
+        struct state_restore_info *const info = user_data;
+        struct sockaddr_storage primary, addr;
+
+        if (len != sizeof(*r)
+            || r->id > UINT8_MAX
+            || !addr_from_state(&r->primary, &primary)
+            || !addr_from_state(&r->addr, &addr))
+                return;
+
+        if (mptcpd_ecache_restore(info->pm->ecache,
+                                  (struct sockaddr *) &primary,
+                                  (mptcpd_aid_t) r->id,
+                                  (struct sockaddr *) &addr,
+                                  r->lifetime))
+                ++info->endpoints;
+}
+
+static void restore_connection(void const *data,
+                               size_t len,
+                               void *user_data)
+{
+        struct state_connection const *const r = data;
+        struct state_restore_info *const info = user_data;
+        struct mptcpd_pm *const pm = info->pm;
+
+        if (len < sizeof(*r)
+            || len - sizeof(*r) != (size_t) r->name_len + r->len
+            || r->name_len > STATE_NAME_MAX)
+                return;
+
+        char name[STATE_NAME_MAX + 1];
+        uint8_t const *const payload = (uint8_t const *) (r + 1);
+
+        memcpy(name, payload, r->name_len);
+        name[r->name_len] = '\0';
+
+        void const *const state =
+                r->len == 0 ? NULL : payload + r->name_len;
+
+        if (!mptcpd_plugin_restore_connection(r->token,
+                                              r->name_len == 0
+                                              ? NULL
+                                              : name,
+                                              r->version,
+                                              state,
+                                              r->len,
+                                              pm))
+                return;
+
+        struct sockaddr_storage raddr;
+
+        if (addr_from_state(&r->raddr, &raddr))
+                (void) mptcpd_ecache_track(pm->ecache,
+                                           r->token,
+                                           (struct sockaddr *) &raddr);
+
+        (void) l_hashmap_insert(pm->restore->tokens,
+                                L_UINT_TO_PTR(r->token),
+                                L_UINT_TO_PTR(1));
+
+        ++info->connections;
+}
+
+// ----------------------------------------------------------------------
+//                             Validation
+// ----------------------------------------------------------------------
+
+static void finish_validation(struct l_idle *idle, void *user_data)
+{
+        (void) idle;
+
+        mptcpd_state_discard(user_data);
+}
+
+static void close_stale(void const *key, void *value, void *user_data)
+{
+        (void) value;
+
+        mptcpd_token_t const token = L_PTR_TO_UINT(key);
+        struct mptcpd_pm *const pm = user_data;
+
+        l_debug("Restored connection 0x%" PRIx32 " no longer exists.",
+                token);
+
+        mptcpd_plugin_connection_closed(token, pm);
+        mptcpd_ecache_untrack(pm->ecache, token);
+}
+
+/**
+ * @brief Validate restored state against the first metrics snapshot.
+ *
+ * Restored connections missing from the snapshot were closed while
+ * mptcpd was not running, and restored listeners not claimed by
+ * a plugin by now are no longer needed.
+ */
+static void validate_snapshot(struct mptcpd_diag_snapshot const *snapshot,
+                              void *user_data)
+{
+        struct mptcpd_pm *const pm = user_data;
+        struct mptcpd_state_restore *const restore = pm->restore;
+
+        if (restore->idle != NULL)
+                return;  // Already validated.
+
+        struct mptcpd_diag_connections const *const conns =
+                &snapshot->connections;
+
+        for (size_t i = 0; i < conns->count; ++i)
+                (void) l_hashmap_remove(restore->tokens,
+                                        L_UINT_TO_PTR(conns->token[i]));
+
+        unsigned int const stale = l_hashmap_size(restore->tokens);
+
+        l_hashmap_foreach(restore->tokens, close_stale, pm);
+
+        unsigned int const released = mptcpd_lm_release_restored(pm->lm);
+
+        l_debug("Restored state validated: %u stale connections, "
+                "%u unclaimed listeners.",
+                stale,
+                released);
+
+        // Metrics collector operations can't be unregistered here.
+        restore->idle = l_idle_create(finish_validation, pm, NULL);
+}
+
+static struct mptcpd_diag_ops const _validate_ops = {
+        .snapshot = validate_snapshot
+};
+
+void mptcpd_state_restore(struct mptcpd_pm *pm)
+{
+        char const *const path = pm->config->state_file;
+
+        if (path == NULL)
+                return;
+
+        uint64_t const start = l_time_now();
+
+        struct mptcpd_state_file *const sf = mptcpd_state_file_open(path);
+
+        if (sf == NULL)
+                return;
+
+        // Never restore the same state twice, e.g. after a crash.
+        if (unlink(path) != 0)
+                l_warn("Unable to remove state file %s: %s",
+                       path,
+                       strerror(errno));
+
+        struct state_restore_info info = { .pm = pm };
+
+        pm->restore = l_new(struct mptcpd_state_restore, 1);
+        pm->restore->tokens = l_hashmap_new();
+
+        (void) mptcpd_state_file_foreach(sf,
+                                         STATE_ADDR_ID,
+                                         restore_addr_id,
+                                         &info);
+        (void) mptcpd_state_file_foreach(sf,
+                                         STATE_LISTENER,
+                                         restore_listener,
+                                         &info);
+        (void) mptcpd_state_file_foreach(sf,
+                                         STATE_ENDPOINT,
+                                         restore_endpoint,
+                                         &info);
+
+        // MPTCP connections do not survive a reboot.
+        if (mptcpd_state_file_same_boot(sf))
+                (void) mptcpd_state_file_foreach(sf,
+                                                 STATE_CONNECTION,
+                                                 restore_connection,
+                                                 &info);
+
+        mptcpd_state_file_close(sf);
+
+        l_info("Restored %zu address IDs, %zu listeners, "
+               "%zu peer addresses and %zu connections "
+               "in %" PRIu64 " us.",
+               info.ids,
+               info.listeners,
+               info.endpoints,
+               info.connections,
+               l_time_now() - start);
+
+        if ((info.connections == 0 && info.listeners == 0)
+            || !mptcpd_diag_register_ops(pm->diag, &_validate_ops, pm))
+                mptcpd_state_discard(pm);
+}
+
+void mptcpd_state_forget(struct mptcpd_pm *pm, mptcpd_token_t token)
+{
+        if (pm->restore != NULL)
+                (void) l_hashmap_remove(pm->restore->tokens,
+                                        L_UINT_TO_PTR(token));
+}
+
+void mptcpd_state_discard(struct mptcpd_pm *pm)
+{
+        struct mptcpd_state_restore *const restore = pm->restore;
+
+        if (restore == NULL)
+                return;
+
+        (void) mptcpd_diag_unregister_ops(pm->diag, &_validate_ops, pm);
+
+        // Unclaimed listeners would otherwise be kept open forever.
+        (void) mptcpd_lm_release_restored(pm->lm);
+
+        l_idle_remove(restore->idle);
+        l_hashmap_destroy(restore->tokens, NULL);
+        l_free(restore);
+
+        pm->restore = NULL;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
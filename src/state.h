@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file src/state.h
+ *
+ * @brief mptcpd persistent state (internal).
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#ifndef MPTCPD_STATE_H
+#define MPTCPD_STATE_H
+
+#include <stdbool.h>
+
+#include <mptcpd/types.h>
+
+
+struct mptcpd_pm;
+
+/**
+ * @brief Save path manager state to the configured state file.
+ *
+ * Save the MPTCP address ID map, the listeners, the remote endpoint
+ * cache and the state of each MPTCP connection exported by the path
+ * manager plugins.  Nothing is saved if no state file is configured,
+ * or if the plugins were never loaded, in which case a state file
+ * from a previous run is left untouched.
+ *
+ * @param[in] pm Path manager.
+ *
+ * @return @c true if the state was saved or there was nothing to
+ *         save, and @c false on error.
+ *
+ * @note Call this function prior to @c mptcpd_pm_destroy() since
+ *       connection state is exported by the loaded plugins.
+ */
+bool mptcpd_state_save(struct mptcpd_pm *pm);
+
+/**
+ * @brief Restore path manager state from the configured state file.
+ *
+ * The state file is removed once read so that it is never restored
+ * twice.  Address IDs are only restored for addresses and IDs not
+ * already known to the kernel, and listeners only for addresses that
+ * are still local.  Connections are only restored if the state file
+ * was written during the current boot.  They are handed over to the
+ * plugins right away, and validated against the kernel once the
+ * first MPTCP metrics collection round completes.  Connections that
+ * no longer exist by then are reported as closed.
+ *
+ * @param[in,out] pm Path manager, with plugins loaded.
+ */
+void mptcpd_state_restore(struct mptcpd_pm *pm);
+
+/**
+ * @brief Stop validating a restored MPTCP connection.
+ *
+ * @param[in,out] pm    Path manager.
+ * @param[in]     token Token of a closed MPTCP connection.
+ */
+void mptcpd_state_forget(struct mptcpd_pm *pm, mptcpd_token_t token);
+
+/**
+ * @brief Release restored state pending validation.
+ *
+ * @param[in,out] pm Path manager.
+ */
+void mptcpd_state_discard(struct mptcpd_pm *pm);
+
+
+#endif /* MPTCPD_STATE_H */
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
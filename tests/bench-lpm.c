@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file bench-lpm.c
+ *
+ * @brief Benchmark IP address longest prefix match tables against a
+ *        linear prefix scan.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/lpm.h>
+
+
+/// Number of lookups per measurement.
+#define LOOKUPS (1U << 20)
+
+struct prefix
+{
+        uint32_t addr;  // Host byte order.
+        uint8_t len;
+};
+
+static uint32_t _seed = 1;
+
+// Deterministic xorshift pseudo-random numbers for reproducible runs.
+static uint32_t next_random(void)
+{
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 17;
+        _seed ^= _seed << 5;
+
+        return _seed;
+}
+
+static uint32_t prefix_mask(uint8_t len)
+{
+        return len == 0 ? 0 : UINT32_C(0xFFFFFFFF) << (32 - len);
+}
+
+// Baseline: scan all prefixes, keeping the longest match.
+static struct prefix const *linear_lookup(struct prefix const *prefixes,
+                                          size_t count,
+                                          uint32_t addr)
+{
+        struct prefix const *best = NULL;
+
+        for (size_t i = 0; i < count; ++i) {
+                struct prefix const *const p = &prefixes[i];
+
+                if ((addr & prefix_mask(p->len)) == p->addr
+                    && (best == NULL || p->len > best->len))
+                        best = p;
+        }
+
+        return best;
+}
+
+static double elapsed_ns(struct timespec const *start,
+                         struct timespec const *end)
+{
+        return (double) (end->tv_sec - start->tv_sec) * 1e9
+                + (double) (end->tv_nsec - start->tv_nsec);
+}
+
+static void bench(size_t count)
+{
+        struct prefix *const prefixes = l_new(struct prefix, count);
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+
+        for (size_t i = 0; i < count; ++i) {
+                uint8_t const len = (uint8_t) (8 + next_random() % 25);
+
+                /*
+                  Duplicate prefixes are harmless since lookup
+                  results are compared by address and length.
+                */
+                prefixes[i].len  = len;
+                prefixes[i].addr = next_random() & prefix_mask(len);
+
+                struct sockaddr_in const sa = {
+                        .sin_family = AF_INET,
+                        .sin_addr   = {
+                                .s_addr = htonl(prefixes[i].addr)
+                        }
+                };
+
+                assert(mptcpd_lpm_insert(lpm,
+                                         (struct sockaddr const *) &sa,
+                                         len,
+                                         &prefixes[i]));
+        }
+
+        struct mptcpd_lpm_snapshot *const snapshot =
+                mptcpd_lpm_snapshot(lpm);
+
+        mptcpd_lpm_destroy(lpm);
+
+        /*
+          Look up addresses inside known prefixes half of the time so
+          that both matches and misses are measured.
+        */
+        struct sockaddr_in *const addrs =
+                l_new(struct sockaddr_in, LOOKUPS);
+
+        for (size_t i = 0; i < LOOKUPS; ++i) {
+                uint32_t addr = next_random();
+
+                if (i % 2 == 0) {
+                        struct prefix const *const p =
+                                &prefixes[next_random() % count];
+
+                        addr = p->addr | (addr & ~prefix_mask(p->len));
+                }
+
+                addrs[i].sin_family      = AF_INET;
+                addrs[i].sin_addr.s_addr = htonl(addr);
+        }
+
+        struct timespec start, end;
+        size_t trie_hits = 0;
+        size_t linear_hits = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (size_t i = 0; i < LOOKUPS; ++i)
+                if (mptcpd_lpm_lookup(snapshot,
+                                      (struct sockaddr const *) &addrs[i]))
+                        ++trie_hits;
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double const trie_ns = elapsed_ns(&start, &end) / LOOKUPS;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (size_t i = 0; i < LOOKUPS; ++i)
+                if (linear_lookup(prefixes,
+                                  count,
+                                  ntohl(addrs[i].sin_addr.s_addr)))
+                        ++linear_hits;
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double const linear_ns = elapsed_ns(&start, &end) / LOOKUPS;
+
+        // Both lookups must agree on the longest matching prefix.
+        assert(trie_hits == linear_hits);
+
+        for (size_t i = 0; i < LOOKUPS; i += 97) {
+                struct prefix const *const p =
+                        mptcpd_lpm_lookup(
+                                snapshot,
+                                (struct sockaddr const *) &addrs[i]);
+                struct prefix const *const q =
+                        linear_lookup(prefixes,
+                                      count,
+                                      ntohl(addrs[i].sin_addr.s_addr));
+
+                assert((p == NULL) == (q == NULL));
+                assert(p == NULL
+                       || (p->addr == q->addr && p->len == q->len));
+        }
+
+        printf("%6zu prefixes: trie %7.1f ns, linear %9.1f ns "
+               "per lookup, %zu%% hits\n",
+               count,
+               trie_ns,
+               linear_ns,
+               trie_hits * 100 / LOOKUPS);
+
+        mptcpd_lpm_snapshot_destroy(snapshot);
+        l_free(addrs);
+        l_free(prefixes);
+}
+
+int main(void)
+{
+        static size_t const counts[] = { 16, 64, 256, 1024, 4096 };
+
+        for (size_t i = 0; i < L_ARRAY_SIZE(counts); ++i)
+                bench(counts[i]);
+
+        return 0;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
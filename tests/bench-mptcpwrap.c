@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file bench-mptcpwrap.c
+ *
+ * @brief Benchmark socket() overhead with and without libmptcpwrap
+ *        preloaded.
+ *
+ * Usage: bench-mptcpwrap path/to/libmptcpwrap.so
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+
+
+/// Number of sockets created per batch.
+#define BATCH 256
+
+/// Number of timed batches.
+#define BATCHES 200
+
+/**
+ * @brief Number of environment variables added before measuring.
+ *
+ * Services commonly run with large environments, which makes
+ * repeated @c getenv() calls costly.
+ */
+#define ENV_VARS 256
+
+/// Set in the environment of the measuring child processes.
+#define CHILD_ENV "BENCH_MPTCPWRAP_CHILD"
+
+static double elapsed_ns(struct timespec const *start,
+                         struct timespec const *end)
+{
+        return (double) (end->tv_sec - start->tv_sec) * 1e9
+                + (double) (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * @brief Measure the average @c socket() call time.
+ *
+ * Sockets are closed outside of the measured interval.
+ */
+static double bench_socket(int type)
+{
+        int fds[BATCH];
+        double total = 0;
+
+        for (int b = 0; b < BATCHES; ++b) {
+                struct timespec start, end;
+
+                clock_gettime(CLOCK_MONOTONIC, &start);
+
+                for (int i = 0; i < BATCH; ++i)
+                        fds[i] = socket(AF_INET, type, 0);
+
+                clock_gettime(CLOCK_MONOTONIC, &end);
+
+                total += elapsed_ns(&start, &end);
+
+                for (int i = 0; i < BATCH; ++i) {
+                        assert(fds[i] != -1);
+                        close(fds[i]);
+                }
+        }
+
+        return total / ((double) BATCH * BATCHES);
+}
+
+static void measure(void)
+{
+        char const *const preload = getenv("LD_PRELOAD");
+
+        for (int i = 0; i < ENV_VARS; ++i) {
+                char name[32];
+
+                snprintf(name, sizeof(name), "BENCH_MPTCPWRAP_VAR%d", i);
+                setenv(name, "value", 0);
+        }
+
+        // Warm up.
+        (void) bench_socket(SOCK_DGRAM);
+
+        /*
+          Datagram sockets are passed through by the wrapper, so any
+          difference is the wrapper overhead.  Stream sockets are
+          upgraded to MPTCP, which has a higher kernel cost of its
+          own.
+        */
+        double const dgram  = bench_socket(SOCK_DGRAM);
+        double const stream = bench_socket(SOCK_STREAM);
+
+        printf("%-12s socket(SOCK_DGRAM) %7.1f ns, "
+               "socket(SOCK_STREAM) %7.1f ns\n",
+               preload != NULL ? "mptcpwrap:" : "baseline:",
+               dgram,
+               stream);
+}
+
+static void run(char const *self, char const *preload)
+{
+        pid_t const pid = fork();
+        assert(pid != -1);
+
+        if (pid == 0) {
+                setenv(CHILD_ENV, "1", 1);
+
+                if (preload != NULL)
+                        setenv("LD_PRELOAD", preload, 1);
+                else
+                        unsetenv("LD_PRELOAD");
+
+                execl(self, self, (char *) NULL);
+                _exit(EXIT_FAILURE);
+        }
+
+        int status = 0;
+        assert(waitpid(pid, &status, 0) == pid);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+        if (getenv(CHILD_ENV) != NULL) {
+                measure();
+                return 0;
+        }
+
+        if (argc != 2 || strstr(argv[1], "libmptcpwrap.so") == NULL) {
+                fprintf(stderr, "Usage: %s path/to/libmptcpwrap.so\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        run(argv[0], NULL);
+        run(argv[0], argv[1]);
+
+        return 0;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
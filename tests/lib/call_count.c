@@ -25,6 +25,7 @@ void call_count_reset(struct plugin_call_count *p)
         p->new_interface          = 0;
         p->update_interface       = 0;
         p->delete_interface       = 0;
+        p->link_state_changed     = 0;
         p->new_local_address      = 0;
         p->delete_local_address   = 0;
 }
@@ -44,6 +45,7 @@ bool call_count_all_positive(struct plugin_call_count const *p)
                 && p->new_interface          >= 0
                 && p->update_interface       >= 0
                 && p->delete_interface       >= 0
+                && p->link_state_changed     >= 0
                 && p->new_local_address      >= 0
                 && p->delete_local_address   >= 0;
 }
@@ -78,6 +80,7 @@ bool call_count_is_equal(struct plugin_call_count const *lhs,
             && lhs->new_interface          == rhs->new_interface
             && lhs->update_interface       == rhs->update_interface
             && lhs->delete_interface       == rhs->delete_interface
+            && lhs->link_state_changed     == rhs->link_state_changed
             && lhs->new_local_address      == rhs->new_local_address
             && lhs->delete_local_address   == rhs->delete_local_address;
 }
@@ -92,6 +92,10 @@ void call_plugin_ops(struct plugin_call_count const *count,
         for (int i = 0; i < count->delete_interface; ++i)
                 mptcpd_plugin_delete_interface(args->interface, args->pm);
 
+        for (int i = 0; i < count->link_state_changed; ++i)
+                mptcpd_plugin_link_state_changed(args->interface,
+                                                 args->pm);
+
         for (int i = 0; i < count->new_local_address; ++i)
                 mptcpd_plugin_new_local_address(args->interface,
                                                 args->laddr,
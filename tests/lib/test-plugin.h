@@ -55,6 +55,7 @@ struct plugin_call_count
         int new_interface;
         int update_interface;
         int delete_interface;
+        int link_state_changed;
         int new_local_address;
         int delete_local_address;
         ///@}
@@ -118,6 +119,7 @@ static struct plugin_call_count const test_count_2 = {
         .new_interface          = 1,
         .update_interface       = 2,
         .delete_interface       = 1,
+        .link_state_changed     = 1,
         .new_local_address      = 3,
         .delete_local_address   = 1
 };
@@ -168,6 +170,17 @@ static bool           const test_server_side_4 = false;
 // For verifying that a plugin will not be dispatched.
 static mptcpd_token_t const test_bad_token  = 0xFFFFFFFF;
 
+/**
+ * @brief Connections created before a plugin with deferred
+ *        initialization is ready.
+ *
+ * The first connection uses token 1, the next token 2, etc.  Only
+ * the first @c test_pending_replayed connections are buffered for
+ * the plugin, i.e. the limit in the mptcpd plugin framework.
+ */
+static mptcpd_token_t const test_pending_created  = 5000;
+static mptcpd_token_t const test_pending_replayed = 4096;
+
 /*
   Mptcpd Test IP Address Notes
   ============================
@@ -11,8 +11,12 @@
 #include <assert.h>
 
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -21,6 +25,12 @@
 #include <netdb.h>
 #include <errno.h>
 
+#include "../src/mptcpwrap.h"    // INTERNAL!
+
+#ifndef IP_BIND_ADDRESS_NO_PORT
+# define IP_BIND_ADDRESS_NO_PORT 24
+#endif
+
 
 struct socket_data
 {
@@ -82,7 +92,278 @@ static void test_socket_data(struct socket_data const *data)
         assert(verified);
 }
 
-int main(void)
+/**
+ * @brief Socket options policy applied by libmptcpwrap.
+ *
+ * The test script passes this policy through the
+ * @c MPTCPWRAP_POLICY environment variable.
+ */
+#define TEST_NOTSENT_LOWAT 16384
+
+static void test_policy(void)
+{
+        int const fd = socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd != -1);
+        assert(verify_protocol(fd, true));
+
+        int value = 0;
+        socklen_t len = sizeof(value);
+
+        assert(getsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, &len) == 0);
+        assert(value == 1);
+
+        len = sizeof(value);
+        assert(getsockopt(fd,
+                          IPPROTO_TCP,
+                          TCP_NOTSENT_LOWAT,
+                          &value,
+                          &len) == 0);
+        assert(value == TEST_NOTSENT_LOWAT);
+
+        // Options set by the application take precedence.
+        value = 0;
+        assert(setsockopt(fd,
+                          IPPROTO_TCP,
+                          TCP_NODELAY,
+                          &value,
+                          sizeof(value)) == 0);
+
+        /*
+          Only rejected options that tune performance are ignored.
+          Others must fail as they would without the wrapper.
+        */
+        static int const unknown_tcp_option = 9999;
+
+        value = 1;
+        assert(setsockopt(fd,
+                          IPPROTO_TCP,
+                          unknown_tcp_option,
+                          &value,
+                          sizeof(value)) == -1);
+        assert(errno == EOPNOTSUPP || errno == ENOPROTOOPT);
+
+        close(fd);
+}
+
+static int get_protocol(int fd)
+{
+        int protocol = 0;
+        socklen_t len = sizeof(protocol);
+
+        assert(getsockopt(fd, SOL_SOCKET, SO_PROTOCOL, &protocol, &len) == 0);
+
+        return protocol;
+}
+
+/**
+ * @brief Connect to the listening socket through the given loopback
+ *        address, and verify the resulting socket protocol.
+ */
+static void test_connect(int listener,
+                         char const *address,
+                         bool expect_mptcp)
+{
+        struct sockaddr_in addr = { .sin_family = AF_INET };
+        socklen_t len = sizeof(addr);
+
+        assert(getsockname(listener, (struct sockaddr *) &addr, &len) == 0);
+        assert(inet_pton(AF_INET, address, &addr.sin_addr) == 1);
+
+        int const fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        assert(fd != -1);
+
+        // The upgrade is deferred until the destination is known.
+        assert(get_protocol(fd) == IPPROTO_TCP);
+
+        static int const sndbuf = 65536;
+        static int const tos = 0x10;
+
+        assert(setsockopt(fd,
+                          SOL_SOCKET,
+                          SO_SNDBUF,
+                          &sndbuf,
+                          sizeof(sndbuf)) == 0);
+        assert(setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0);
+
+        assert(connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+
+        assert(get_protocol(fd)
+               == (expect_mptcp ? IPPROTO_TCP + 256 : IPPROTO_TCP));
+
+        // The close-on-exec flag survives the upgrade.
+        assert(fcntl(fd, F_GETFD) & FD_CLOEXEC);
+
+        // Socket options set by the application survive it too.
+        int value = 0;
+        len = sizeof(value);
+        assert(getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &value, &len) == 0);
+        assert(value == 2 * sndbuf);  // Doubled by the kernel.
+
+        len = sizeof(value);
+        assert(getsockopt(fd, IPPROTO_IP, IP_TOS, &value, &len) == 0);
+        assert(value == tos);
+
+        close(fd);
+}
+
+/**
+ * @brief Verify that a socket bound to a source address, but not to
+ *        a port, is not upgraded, as done by proxies.
+ */
+static void test_connect_bound(int listener, char const *address)
+{
+        struct sockaddr_in addr = { .sin_family = AF_INET };
+        socklen_t len = sizeof(addr);
+
+        assert(getsockname(listener, (struct sockaddr *) &addr, &len) == 0);
+        assert(inet_pton(AF_INET, address, &addr.sin_addr) == 1);
+
+        int const fd = socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd != -1);
+
+        static int const enable = 1;
+
+        assert(setsockopt(fd,
+                          IPPROTO_IP,
+                          IP_BIND_ADDRESS_NO_PORT,
+                          &enable,
+                          sizeof(enable)) == 0);
+
+        struct sockaddr_in local = {
+                .sin_family = AF_INET,
+                .sin_addr   = { .s_addr = htonl(INADDR_LOOPBACK) }
+        };
+
+        assert(bind(fd, (struct sockaddr *) &local, sizeof(local)) == 0);
+
+        assert(connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+
+        // The application's choice of source address is kept.
+        assert(get_protocol(fd) == IPPROTO_TCP);
+
+        len = sizeof(local);
+        assert(getsockname(fd, (struct sockaddr *) &local, &len) == 0);
+        assert(local.sin_addr.s_addr == htonl(INADDR_LOOPBACK));
+
+        close(fd);
+}
+
+static void test_allow(void)
+{
+        int const listener = socket(AF_INET, SOCK_STREAM, 0);
+        assert(listener != -1);
+
+        struct sockaddr_in addr = {
+                .sin_family = AF_INET,
+                .sin_addr   = { .s_addr = htonl(INADDR_ANY) }
+        };
+
+        assert(bind(listener, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+        assert(listen(listener, 2) == 0);
+
+        // Only 127.0.0.2 is allowed by the test policy.
+        test_connect(listener, "127.0.0.2", true);
+        test_connect(listener, "127.0.0.1", false);
+        test_connect_bound(listener, "127.0.0.2");
+
+        close(listener);
+}
+
+/**
+ * @brief Verify the statistics exported by libmptcpwrap for this
+ *        process.
+ */
+static void test_stats(uint64_t upgraded,
+                       uint64_t upgraded6,
+                       uint64_t fallback,
+                       uint64_t fallback_cached)
+{
+        char name[32];
+        snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int) getpid());
+
+        int const fd = shm_open(name, O_RDONLY, 0);
+        assert(fd != -1);
+
+        struct mptcpwrap_stats const *const s =
+                mmap(NULL, sizeof(*s), PROT_READ, MAP_SHARED, fd, 0);
+        assert(s != MAP_FAILED);
+        close(fd);
+
+        assert(s->magic == MPTCPWRAP_STATS_MAGIC);
+        assert(s->version == MPTCPWRAP_STATS_VERSION);
+        assert(s->pid == getpid());
+        assert(s->starttime == mptcpwrap_starttime(getpid()));
+
+        struct mptcpwrap_family_stats const *const inet =
+                &s->family[MPTCPWRAP_INET];
+        struct mptcpwrap_family_stats const *const inet6 =
+                &s->family[MPTCPWRAP_INET6];
+
+        assert(inet->upgraded == upgraded);
+        assert(inet6->upgraded == upgraded6);
+        assert(inet->fallback == fallback);
+        assert(inet->fallback_cached == fallback_cached);
+
+        munmap((void *) s, sizeof(*s));
+}
+
+/**
+ * @brief Verify that TCP sockets are created when the kernel refuses
+ *        to create MPTCP sockets, e.g. with net.mptcp.enabled=0.
+ */
+/**
+ * @brief Leave statistics of an earlier process with the PID of this
+ *        process behind, as if it was killed.
+ *
+ * libmptcpwrap must start counting from zero instead of adopting
+ * them.
+ */
+static void plant_stale_stats(void)
+{
+        char name[32];
+        snprintf(name, sizeof(name), MPTCPWRAP_STATS_NAME, (int) getpid());
+
+        int const fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+        assert(fd != -1);
+
+        struct mptcpwrap_stats *s = NULL;
+        assert(ftruncate(fd, sizeof(*s)) == 0);
+
+        s = mmap(NULL, sizeof(*s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        assert(s != MAP_FAILED);
+        close(fd);
+
+        s->magic     = MPTCPWRAP_STATS_MAGIC;
+        s->version   = MPTCPWRAP_STATS_VERSION;
+        s->pid       = getpid();
+        s->starttime = mptcpwrap_starttime(getpid()) + 1;
+
+        for (int f = 0; f < MPTCPWRAP_FAMILIES; ++f)
+                s->family[f].upgraded = 100;
+
+        munmap(s, sizeof(*s));
+}
+
+static void test_fallback(void)
+{
+        // The first call fails over, the others reuse the failure.
+        for (int i = 0; i < 3; ++i) {
+                int const fd = socket(AF_INET, SOCK_STREAM, 0);
+                assert(fd != -1);
+                assert(get_protocol(fd) == IPPROTO_TCP);
+
+                close(fd);
+        }
+
+        // Bogus arguments still fail as they would without MPTCP.
+        errno = 0;
+        assert(socket(AF_INET, SOCK_STREAM | 0x80000000, 0) == -1);
+        assert(errno == EINVAL);
+
+        test_stats(0, 0, 1, 3);
+}
+
+int main(int argc, char *argv[])
 {
         /*
           libmptcpwrap.so should be preloaded when running this
@@ -94,6 +375,24 @@ int main(void)
         assert(LD_PRELOAD != NULL);
         assert(strstr(LD_PRELOAD, "libmptcpwrap.so") != NULL);
 
+        // Sockets are only upgraded at connect() with an allowlist.
+        if (argc > 1 && strcmp(argv[1], "allow") == 0) {
+                fprintf(stderr, "Test case allow: ");
+                test_allow();
+                fprintf(stderr, "PASS\n");
+                return 0;
+        }
+
+        // MPTCP is disabled in the network namespace.
+        if (argc > 1 && strcmp(argv[1], "fallback") == 0) {
+                fprintf(stderr, "Test case fallback: ");
+                test_fallback();
+                fprintf(stderr, "PASS\n");
+                return 0;
+        }
+
+        plant_stale_stats();
+
         /*
           MPTCP is only injected when using the SOCK_STREAM socket
           type and a protocol value of 0 or IPPROTO_TCP.
@@ -116,6 +415,17 @@ int main(void)
                 fprintf(stderr, "PASS\n");
         }
 
+        // Two IPv4 and two IPv6 sockets were upgraded above.
+        fprintf(stderr, "Test case stats: ");
+        test_stats(2, 2, 0, 0);
+        fprintf(stderr, "PASS\n");
+
+        if (argc > 1 && strcmp(argv[1], "policy") == 0) {
+                fprintf(stderr, "Test case policy: ");
+                test_policy();
+                fprintf(stderr, "PASS\n");
+        }
+
         return 0;
 }
 
@@ -144,6 +144,13 @@ void plugin_noop_delete_interface(struct mptcpd_interface const *i,
         (void) pm;
 }
 
+void plugin_noop_link_state_changed(struct mptcpd_interface const *i,
+                                    struct mptcpd_pm *pm)
+{
+        (void) i;
+        (void) pm;
+}
+
 void plugin_noop_new_local_address(struct mptcpd_interface const *i,
                                    struct sockaddr const *sa,
                                    struct mptcpd_pm *pm)
@@ -176,6 +183,7 @@ static struct mptcpd_plugin_ops const pm_ops = {
         .new_interface          = plugin_noop_new_interface,
         .update_interface       = plugin_noop_update_interface,
         .delete_interface       = plugin_noop_delete_interface,
+        .link_state_changed     = plugin_noop_link_state_changed,
         .new_local_address      = plugin_noop_new_local_address,
         .delete_local_address   = plugin_noop_delete_local_address
 };
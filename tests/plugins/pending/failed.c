@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file failed.c
+ *
+ * @brief MPTCP path manager test plugin with an @c init function
+ *        that fails after registering its operations.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <mptcpd/plugin.h>
+
+#include "test-plugin.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Number of connections seen by the plugin.
+static mptcpd_token_t connections;
+
+static void plugin_failed_new_connection(mptcpd_token_t token,
+                                         struct sockaddr const *laddr,
+                                         struct sockaddr const *raddr,
+                                         bool server_side,
+                                         struct mptcpd_pm *pm)
+{
+        (void) laddr;
+        (void) raddr;
+        (void) server_side;
+        (void) pm;
+
+        // Events are delivered immediately, in order.
+        assert(token == connections + 1);
+
+        ++connections;
+}
+
+static struct mptcpd_plugin_ops const pm_ops = {
+        .new_connection = plugin_failed_new_connection
+};
+
+static int plugin_failed_init(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        if (!mptcpd_plugin_register_ops("failed", &pm_ops))
+                return -1;
+
+        /*
+          A failure other than MPTCPD_PLUGIN_INIT_PENDING must not
+          cause events to be buffered for this plugin.
+        */
+        return 1;
+}
+
+static void plugin_failed_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        // No connections were buffered or dropped.
+        assert(connections == test_pending_created + 1);
+}
+
+MPTCPD_PLUGIN_DEFINE(plugin_failed,
+                     "test plugin for failed init with registered ops",
+                     MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                     plugin_failed_init,
+                     plugin_failed_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
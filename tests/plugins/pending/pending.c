@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file pending.c
+ *
+ * @brief MPTCP test plugin with deferred initialization.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <ell/ell.h>
+
+#include <mptcpd/plugin.h>
+
+#include "test-plugin.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Plugin initialization completed.
+static bool ready;
+
+/// Number of connections seen by the plugin.
+static mptcpd_token_t connections;
+
+static void plugin_pending_new_connection(mptcpd_token_t token,
+                                          struct sockaddr const *laddr,
+                                          struct sockaddr const *raddr,
+                                          bool server_side,
+                                          struct mptcpd_pm *pm)
+{
+        (void) laddr;
+        (void) raddr;
+        (void) server_side;
+        (void) pm;
+
+        // Events created in the meantime are held back until ready.
+        assert(ready);
+
+        /*
+          Buffered connections are replayed in the order they were
+          created, followed by those created once the plugin is ready.
+        */
+        if (connections < test_pending_replayed)
+                assert(token == connections + 1);
+        else
+                assert(token == test_pending_created + 1);
+
+        ++connections;
+}
+
+static struct mptcpd_plugin_ops const pm_ops = {
+        .new_connection = plugin_pending_new_connection
+};
+
+static void plugin_pending_ready(struct l_idle *idle, void *user_data)
+{
+        (void) idle;
+
+        struct mptcpd_pm *const pm = user_data;
+
+        // No events were delivered before the plugin was ready.
+        assert(connections == 0);
+
+        ready = true;
+
+        mptcpd_plugin_ready(&pm_ops, pm);
+
+        assert(connections == test_pending_replayed);
+}
+
+static int plugin_pending_init(struct mptcpd_pm *pm)
+{
+        if (!mptcpd_plugin_register_stage(&pm_ops)
+            || !l_idle_oneshot(plugin_pending_ready, pm, NULL))
+                return -1;
+
+        // Complete initialization from the event loop.
+        return MPTCPD_PLUGIN_INIT_PENDING;
+}
+
+static void plugin_pending_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        // Buffered connections, followed by one created once ready.
+        assert(ready);
+        assert(connections == test_pending_replayed + 1);
+}
+
+MPTCPD_PLUGIN_DEFINE(plugin_pending,
+                     "test plugin with deferred initialization",
+                     MPTCPD_PLUGIN_PRIORITY_HIGH,  // ahead of the chain
+                     plugin_pending_init,
+                     plugin_pending_exit)
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
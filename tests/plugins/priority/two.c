@@ -205,6 +205,15 @@ void plugin_two_delete_interface(struct mptcpd_interface const *i,
         ++call_count.delete_interface;
 }
 
+void plugin_two_link_state_changed(struct mptcpd_interface const *i,
+                                   struct mptcpd_pm *pm)
+{
+        (void) i;
+        (void) pm;
+
+        ++call_count.link_state_changed;
+}
+
 void plugin_two_new_local_address(struct mptcpd_interface const *i,
                                   struct sockaddr const *sa,
                                   struct mptcpd_pm *pm)
@@ -241,6 +250,7 @@ static struct mptcpd_plugin_ops const pm_ops = {
         .new_interface          = plugin_two_new_interface,
         .update_interface       = plugin_two_update_interface,
         .delete_interface       = plugin_two_delete_interface,
+        .link_state_changed     = plugin_two_link_state_changed,
         .new_local_address      = plugin_two_new_local_address,
         .delete_local_address   = plugin_two_delete_local_address
 };
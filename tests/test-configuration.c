@@ -108,6 +108,26 @@ static void test_load_plugins(void const *test_data)
         RUN_CONFIG(argv);
 }
 
+static void test_max_subflows(void const *test_data)
+{
+        (void) test_data;
+
+        static char *argv[] = {
+                TEST_PROGRAM_NAME,
+                "--max-subflows=4",
+                "--max-subflows-per-interface", "2"
+        };
+
+        struct mptcpd_config *const config =
+                mptcpd_config_create(L_ARRAY_SIZE(argv), argv);
+        assert(config != NULL);
+
+        assert(config->max_subflows == 4);
+        assert(config->max_subflows_per_interface == 2);
+
+        mptcpd_config_destroy(config);
+}
+
 static void test_multi_arg(void const *test_data)
 {
         (void) test_data;
@@ -141,6 +161,192 @@ static void test_multi_arg(void const *test_data)
         mptcpd_config_destroy(config);
 }
 
+static void test_diff(void const *test_data)
+{
+        (void) test_data;
+
+        static char *argv1[] = {
+                TEST_PROGRAM_NAME,
+                "--notify-flags=skip_link_local",
+                "--max-subflows=4"
+        };
+
+        static char *argv2[] = {
+                TEST_PROGRAM_NAME,
+                "--notify-flags=skip_link_local",
+                "--max-subflows=8",
+                "--path-manager", "foo"
+        };
+
+        struct mptcpd_config *const config1 =
+                mptcpd_config_create(L_ARRAY_SIZE(argv1), argv1);
+        struct mptcpd_config *const config2 =
+                mptcpd_config_create(L_ARRAY_SIZE(argv1), argv1);
+        struct mptcpd_config *const config3 =
+                mptcpd_config_create(L_ARRAY_SIZE(argv2), argv2);
+
+        assert(config1 != NULL);
+        assert(config2 != NULL);
+        assert(config3 != NULL);
+
+        assert(mptcpd_config_diff(config1, config2) == 0);
+
+        uint32_t const changes = mptcpd_config_diff(config1, config3);
+
+        assert(changes == (MPTCPD_CONFIG_CHANGED_PLUGINS
+                           | MPTCPD_CONFIG_CHANGED_SUBFLOW_LIMITS));
+        assert(mptcpd_config_diff(config3, config1) == changes);
+
+        mptcpd_config_destroy(config3);
+        mptcpd_config_destroy(config2);
+        mptcpd_config_destroy(config1);
+}
+
+static void test_process(void const *test_data)
+{
+        (void) test_data;
+
+        static char *argv[] = {
+                TEST_PROGRAM_NAME,
+                "--cpu-affinity=0-1,4",
+                "--sched-policy=fifo",
+                "--sched-priority=10",
+                "--lock-memory"
+        };
+
+        struct mptcpd_config *const config =
+                mptcpd_config_create(L_ARRAY_SIZE(argv), argv);
+        assert(config != NULL);
+
+        assert(config->cpu_affinity != NULL);
+        assert(strcmp(config->cpu_affinity, "0-1,4") == 0);
+        assert(config->sched_policy == MPTCPD_SCHED_FIFO);
+        assert(config->sched_priority == 10);
+        assert(config->lock_memory);
+
+        static char *default_argv[] = { TEST_PROGRAM_NAME };
+
+        struct mptcpd_config *const default_config =
+                mptcpd_config_create(L_ARRAY_SIZE(default_argv),
+                                     default_argv);
+        assert(default_config != NULL);
+
+        assert(mptcpd_config_diff(default_config, config)
+               & MPTCPD_CONFIG_CHANGED_PROCESS);
+
+        mptcpd_config_destroy(default_config);
+        mptcpd_config_destroy(config);
+}
+
+static struct mptcpd_config *parse_interface_policies(char const *data)
+{
+        static char *argv[] = { TEST_PROGRAM_NAME };
+
+        struct mptcpd_config *const config =
+                mptcpd_config_create(L_ARRAY_SIZE(argv), argv);
+        assert(config != NULL);
+        assert(config->interface_policies == NULL);
+
+        struct l_settings *const settings = l_settings_new();
+        assert(l_settings_load_from_data(settings, data, strlen(data)));
+
+        mptcpd_config_parse_interface_policies(config, settings);
+
+        l_settings_free(settings);
+
+        return config;
+}
+
+static void test_interface_policies(void const *test_data)
+{
+        (void) test_data;
+
+        static char const data[] =
+                "[core]\n"
+                "log=stderr\n"
+                "[interface wwan*]\n"
+                "cost=10\n"
+                "backup=true\n"
+                "max-subflows=1\n"
+                "[interface eth0]\n";
+
+        struct mptcpd_config *const config = parse_interface_policies(data);
+
+        assert(l_queue_length(config->interface_policies) == 2);
+
+        struct mptcpd_interface_policy const *policy =
+                l_queue_peek_head(config->interface_policies);
+
+        assert(strcmp(policy->pattern, "wwan*") == 0);
+        assert(policy->cost == 10);
+        assert(policy->backup);
+        assert(policy->max_subflows == 1);
+
+        policy = l_queue_peek_tail(config->interface_policies);
+
+        assert(strcmp(policy->pattern, "eth0") == 0);
+        assert(policy->cost == 0);
+        assert(!policy->backup);
+        assert(policy->max_subflows == 0);
+
+        // Policies already set take precedence.
+        struct l_settings *const settings = l_settings_new();
+        assert(l_settings_load_from_data(settings,
+                                         "[interface wlan0]\n",
+                                         strlen("[interface wlan0]\n")));
+
+        mptcpd_config_parse_interface_policies(config, settings);
+        assert(l_queue_length(config->interface_policies) == 2);
+
+        l_settings_free(settings);
+
+        // A different set of policies is a configuration change.
+        static char const other_data[] =
+                "[interface wwan*]\n"
+                "cost=20\n";
+
+        struct mptcpd_config *const other =
+                parse_interface_policies(other_data);
+
+        assert(mptcpd_config_diff(config, other)
+               == MPTCPD_CONFIG_CHANGED_INTERFACE_POLICIES);
+
+        mptcpd_config_destroy(other);
+        mptcpd_config_destroy(config);
+}
+
+static void test_bad_interface_policies(void const *test_data)
+{
+        (void) test_data;
+
+        static char const data[] =
+                "[interface]\n"
+                "cost=10\n"
+                "[interface   ]\n"
+                "cost=10\n"
+                "[interfaces wlan*]\n"
+                "cost=10\n"
+                "[interface wwan*]\n"
+                "cost=-1\n"
+                "backup=maybe\n"
+                "max-subflows=lots\n";
+
+        struct mptcpd_config *const config = parse_interface_policies(data);
+
+        // Groups without a pattern or the exact prefix are ignored.
+        assert(l_queue_length(config->interface_policies) == 1);
+
+        // Malformed values are left at their defaults.
+        struct mptcpd_interface_policy const *const policy =
+                l_queue_peek_head(config->interface_policies);
+
+        assert(strcmp(policy->pattern, "wwan*") == 0);
+        assert(policy->cost == 0);
+        assert(!policy->backup);
+        assert(policy->max_subflows == 0);
+
+        mptcpd_config_destroy(config);
+}
 
 static void test_config_file(void const *test_data)
 {
@@ -176,7 +382,12 @@ int main(int argc, char *argv[])
         l_test_add("plugin dir",   test_plugin_dir,   NULL);
         l_test_add("path manager", test_path_manager, NULL);
         l_test_add("load plugins", test_load_plugins, NULL);
+        l_test_add("max subflows", test_max_subflows, NULL);
         l_test_add("multi arg",    test_multi_arg,    NULL);
+        l_test_add("diff",         test_diff,         NULL);
+        l_test_add("process",      test_process,      NULL);
+        l_test_add("interface policies",     test_interface_policies,     NULL);
+        l_test_add("bad interface policies", test_bad_interface_policies, NULL);
         l_test_add("config file",  test_config_file,  NULL);
         l_test_add("debug",        test_debug,        NULL);
 
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-endpoint-cache.c
+ *
+ * @brief mptcpd remote endpoint cache test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <time.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/endpoint_cache.h>
+#include <mptcpd/endpoint_cache.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+// Cache lifetime in milliseconds large enough to not expire in tests.
+static unsigned int const ttl = 60 * 1000;
+
+static struct sockaddr_in const peer1 = {
+        .sin_family = AF_INET,
+        .sin_port   = 0x3412,
+        .sin_addr   = { .s_addr = 0x010200C0 }  // 192.0.2.1
+};
+
+static struct sockaddr_in const peer2 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x020200C0 }  // 192.0.2.2
+};
+
+static struct sockaddr_in6 const peer3 = {
+        .sin6_family = AF_INET6,
+        .sin6_addr   = { .s6_addr = { [0]  = 0x20,
+                                      [1]  = 0x01,
+                                      [2]  = 0x0D,
+                                      [3]  = 0xB8,
+                                      [15] = 0x03 }  // 2001:DB8::3
+        }
+};
+
+static struct sockaddr_in const announced1 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x0B6433C6 }  // 198.51.100.11
+};
+
+static struct sockaddr_in6 const announced2 = {
+        .sin6_family = AF_INET6,
+        .sin6_port   = 0x5612,
+        .sin6_addr   = { .s6_addr = { [0]  = 0x20,
+                                      [1]  = 0x01,
+                                      [2]  = 0x0D,
+                                      [3]  = 0xB8,
+                                      [15] = 0x0C }  // 2001:DB8::C
+        }
+};
+
+static mptcpd_token_t const token1 = 0x12345678;
+static mptcpd_token_t const token2 = 0x23456789;
+static mptcpd_token_t const token3 = 0x3456789A;
+
+static mptcpd_aid_t const id1 = 3;
+static mptcpd_aid_t const id2 = 5;
+
+#define SA(x) ((struct sockaddr const *) &(x))
+
+// ----------------------------------------------------------------
+
+struct cache_data
+{
+        size_t count;
+        mptcpd_aid_t ids[2];
+};
+
+static void collect(mptcpd_aid_t id,
+                    struct sockaddr const *addr,
+                    void *user_data)
+{
+        struct cache_data *const data = user_data;
+
+        assert(data->count < L_ARRAY_SIZE(data->ids));
+
+        if (id == id1) {
+                struct sockaddr_in const *const sa =
+                        (struct sockaddr_in const *) addr;
+
+                assert(sa->sin_family == AF_INET);
+                assert(sa->sin_addr.s_addr == announced1.sin_addr.s_addr);
+        } else {
+                assert(id == id2);
+
+                struct sockaddr_in6 const *const sa =
+                        (struct sockaddr_in6 const *) addr;
+
+                assert(sa->sin6_family == AF_INET6);
+                assert(sa->sin6_port == announced2.sin6_port);
+                assert(memcmp(&sa->sin6_addr,
+                              &announced2.sin6_addr,
+                              sizeof(sa->sin6_addr)) == 0);
+        }
+
+        data->ids[data->count++] = id;
+}
+
+static size_t count_cached(struct mptcpd_ecache *cache,
+                           struct sockaddr const *primary)
+{
+        struct cache_data data = { .count = 0 };
+
+        size_t const count =
+                mptcpd_ecache_foreach(cache, primary, collect, &data);
+
+        assert(count == data.count);
+
+        return count;
+}
+
+// ----------------------------------------------------------------
+
+static void test_bad_args(void const *test_data)
+{
+        (void) test_data;
+
+        assert(mptcpd_ecache_create(0, ttl) == NULL);
+        assert(mptcpd_ecache_create(1, 0) == NULL);
+
+        struct mptcpd_ecache *const cache = mptcpd_ecache_create(1, ttl);
+        assert(cache != NULL);
+
+        struct sockaddr const unspec = { .sa_family = AF_UNSPEC };
+
+        assert(!mptcpd_ecache_track(NULL, token1, SA(peer1)));
+        assert(!mptcpd_ecache_track(cache, token1, NULL));
+        assert(!mptcpd_ecache_track(cache, token1, &unspec));
+
+        assert(!mptcpd_ecache_add(NULL, token1, id1, SA(announced1)));
+        assert(!mptcpd_ecache_add(cache, token1, id1, NULL));
+
+        // Untracked connection.
+        assert(!mptcpd_ecache_add(cache, token1, id1, SA(announced1)));
+        assert(!mptcpd_ecache_remove(cache, token1, id1));
+
+        assert(mptcpd_ecache_foreach(NULL, SA(peer1), collect, NULL)
+               == 0);
+        assert(mptcpd_ecache_foreach(cache, NULL, collect, NULL) == 0);
+        assert(mptcpd_ecache_foreach(cache, SA(peer1), NULL, NULL) == 0);
+
+        mptcpd_ecache_untrack(NULL, token1);
+        mptcpd_ecache_destroy(cache);
+        mptcpd_ecache_destroy(NULL);
+}
+
+static void test_add_remove(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_ecache *const cache = mptcpd_ecache_create(4, ttl);
+        assert(cache != NULL);
+
+        assert(mptcpd_ecache_track(cache, token1, SA(peer1)));
+        assert(mptcpd_ecache_add(cache, token1, id1, SA(announced1)));
+        assert(mptcpd_ecache_add(cache, token1, id2, SA(announced2)));
+
+        // Re-announcement replaces the existing entry.
+        assert(mptcpd_ecache_add(cache, token1, id2, SA(announced2)));
+
+        mptcpd_ecache_untrack(cache, token1);
+
+        // Cached addresses outlive the connection.
+        assert(count_cached(cache, SA(peer1)) == 2);
+
+        // Lookups ignore the port.
+        struct sockaddr_in peer = peer1;
+        peer.sin_port = 0;
+        assert(count_cached(cache, SA(peer)) == 2);
+
+        assert(count_cached(cache, SA(peer2)) == 0);
+
+        // Subsequent connection to the same peer.
+        assert(mptcpd_ecache_track(cache, token2, SA(peer1)));
+        assert(mptcpd_ecache_remove(cache, token2, id1));
+        assert(!mptcpd_ecache_remove(cache, token2, id1));
+        assert(count_cached(cache, SA(peer1)) == 1);
+
+        mptcpd_ecache_untrack(cache, token2);
+        mptcpd_ecache_destroy(cache);
+}
+
+static void test_lru(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_ecache *const cache = mptcpd_ecache_create(2, ttl);
+        assert(cache != NULL);
+
+        assert(mptcpd_ecache_track(cache, token1, SA(peer1)));
+        assert(mptcpd_ecache_track(cache, token2, SA(peer2)));
+        assert(mptcpd_ecache_track(cache, token3, SA(peer3)));
+
+        assert(mptcpd_ecache_add(cache, token1, id1, SA(announced1)));
+        assert(mptcpd_ecache_add(cache, token2, id1, SA(announced1)));
+
+        // Make peer1 the most recently used peer.
+        assert(count_cached(cache, SA(peer1)) == 1);
+
+        // Evicts peer2, the least recently used peer.
+        assert(mptcpd_ecache_add(cache, token3, id2, SA(announced2)));
+
+        assert(count_cached(cache, SA(peer2)) == 0);
+        assert(count_cached(cache, SA(peer1)) == 1);
+        assert(count_cached(cache, SA(peer3)) == 1);
+
+        mptcpd_ecache_destroy(cache);
+}
+
+static void test_expiry(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_ecache *const cache = mptcpd_ecache_create(1, 1);
+        assert(cache != NULL);
+
+        assert(mptcpd_ecache_track(cache, token1, SA(peer1)));
+        assert(mptcpd_ecache_add(cache, token1, id1, SA(announced1)));
+
+        struct timespec const delay = { .tv_nsec = 5 * 1000 * 1000 };
+        (void) nanosleep(&delay, NULL);
+
+        assert(count_cached(cache, SA(peer1)) == 0);
+
+        mptcpd_ecache_destroy(cache);
+}
+
+int main(int argc, char *argv[])
+{
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("bad args",   test_bad_args,   NULL);
+        l_test_add("add/remove", test_add_remove, NULL);
+        l_test_add("LRU",        test_lru,        NULL);
+        l_test_add("expiry",     test_expiry,     NULL);
+
+        return l_test_run();
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-failover.c
+ *
+ * @brief mptcpd fast failover path manager plugin test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <net/if.h>
+#include <arpa/inet.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/path_manager.h>     // INTERNAL!
+#include <mptcpd/private/netlink_pm.h>       // INTERNAL!
+#include <mptcpd/private/network_monitor.h>  // INTERNAL!
+#include <mptcpd/private/plugin.h>           // INTERNAL!
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/path_manager.h>
+#include <mptcpd/plugin.h>
+
+/*
+  Compile the plugin into this test, as done for plugins selected
+  through the --enable-builtin-plugins configure option.
+*/
+#include "../plugins/path_managers/failover.c"
+
+#undef NDEBUG
+#include <assert.h>
+
+
+// -------------------------------------------------------------------
+
+/**
+ * @struct cmd_calls
+ *
+ * @brief Path management commands issued by the plugin.
+ */
+struct cmd_calls
+{
+        /// Number of @c add_subflow commands.
+        int add_subflow;
+
+        /// Number of @c remove_subflow commands.
+        int remove_subflow;
+
+        /// Number of @c set_backup commands.
+        int set_backup;
+
+        /// Backup priority of the last @c set_backup command.
+        bool backup;
+};
+
+static struct cmd_calls calls;
+
+static int add_subflow(struct mptcpd_pm *pm,
+                       mptcpd_token_t token,
+                       mptcpd_aid_t local_address_id,
+                       mptcpd_aid_t remote_address_id,
+                       struct sockaddr const *local_addr,
+                       struct sockaddr const *remote_addr,
+                       bool backup)
+{
+        (void) pm;
+        (void) token;
+        (void) local_address_id;
+        (void) remote_address_id;
+        (void) local_addr;
+        (void) remote_addr;
+        (void) backup;
+
+        ++calls.add_subflow;
+
+        return 0;
+}
+
+static int remove_subflow(struct mptcpd_pm *pm,
+                          mptcpd_token_t token,
+                          struct sockaddr const *local_addr,
+                          struct sockaddr const *remote_addr)
+{
+        (void) pm;
+        (void) token;
+        (void) local_addr;
+        (void) remote_addr;
+
+        ++calls.remove_subflow;
+
+        return 0;
+}
+
+static int set_backup(struct mptcpd_pm *pm,
+                      mptcpd_token_t token,
+                      struct sockaddr const *local_addr,
+                      struct sockaddr const *remote_addr,
+                      bool backup)
+{
+        (void) pm;
+        (void) token;
+        (void) local_addr;
+        (void) remote_addr;
+
+        ++calls.set_backup;
+        calls.backup = backup;
+
+        return 0;
+}
+
+static struct mptcpd_pm_cmd_ops const cmd_ops = {
+        .add_subflow    = add_subflow,
+        .remove_subflow = remove_subflow,
+        .set_backup     = set_backup
+};
+
+static struct mptcpd_netlink_pm const netlink_pm = {
+        .name    = "test",
+        .group   = "test",
+        .cmd_ops = &cmd_ops
+};
+
+// -------------------------------------------------------------------
+
+/// Local address on the loopback network interface.
+static struct sockaddr_in laddr1;
+
+/// Local address not assigned to any monitored network interface.
+static struct sockaddr_in laddr2;
+
+/// Remote address.
+static struct sockaddr_in raddr;
+
+/// Loopback network interface, losing its carrier in the tests.
+static struct mptcpd_interface lo = { .carrier = false };
+
+static void init_addr(struct sockaddr_in *addr,
+                      char const *ip,
+                      in_port_t port)
+{
+        addr->sin_family = AF_INET;
+        addr->sin_port   = htons(port);
+
+        assert(inet_pton(AF_INET, ip, &addr->sin_addr) == 1);
+}
+
+#define SA(addr) ((struct sockaddr const *) &(addr))
+
+static void handle_synced(void *user_data)
+{
+        (void) user_data;
+
+        l_main_quit();
+}
+
+static void handle_timeout(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        l_main_quit();
+}
+
+// -------------------------------------------------------------------
+
+/**
+ * @brief Fail over to a surviving backup subflow on loss of carrier.
+ */
+static void test_failover_backup(struct mptcpd_pm *pm)
+{
+        static mptcpd_token_t const token = 0x1;
+
+        memset(&calls, 0, sizeof(calls));
+
+        mptcpd_plugin_new_connection(NULL,
+                                     token,
+                                     SA(laddr1),
+                                     SA(raddr),
+                                     false,
+                                     pm);
+        mptcpd_plugin_new_subflow(token, SA(laddr2), SA(raddr), true, pm);
+
+        // Only loss of carrier triggers a failover.
+        lo.carrier = true;
+        mptcpd_plugin_link_state_changed(&lo, pm);
+        assert(calls.set_backup == 0);
+
+        lo.carrier = false;
+        mptcpd_plugin_link_state_changed(&lo, pm);
+
+        // The lost subflow is dropped, and the backup one promoted.
+        assert(calls.remove_subflow == 1);
+        assert(calls.set_backup == 1);
+        assert(!calls.backup);
+
+        struct mptcpd_pm_failover_stats const *const stats =
+                mptcpd_pm_get_failover_stats(pm);
+
+        assert(stats->started == 1);
+        assert(stats->completed == 1);
+        assert(stats->max_duration >= stats->last_duration);
+        assert(stats->total_duration == stats->last_duration);
+
+        // Removal of the interface doesn't trigger another failover.
+        mptcpd_plugin_delete_interface(&lo, pm);
+
+        assert(calls.remove_subflow == 1);
+        assert(calls.set_backup == 1);
+        assert(stats->started == 1);
+
+        mptcpd_plugin_connection_closed(token, pm);
+}
+
+/**
+ * @brief Keep the last subflow until a replacement is established.
+ */
+static void test_failover_replace(struct mptcpd_pm *pm)
+{
+        static mptcpd_token_t const token = 0x2;
+
+        memset(&calls, 0, sizeof(calls));
+
+        mptcpd_plugin_new_connection(NULL,
+                                     token,
+                                     SA(laddr1),
+                                     SA(raddr),
+                                     false,
+                                     pm);
+
+        mptcpd_plugin_link_state_changed(&lo, pm);
+
+        // The last subflow is demoted to backup rather than removed.
+        assert(calls.remove_subflow == 0);
+        assert(calls.set_backup == 1);
+        assert(calls.backup);
+
+        struct mptcpd_pm_failover_stats const *const stats =
+                mptcpd_pm_get_failover_stats(pm);
+
+        assert(stats->started == 2);
+        assert(stats->completed == 1);
+
+        mptcpd_plugin_delete_interface(&lo, pm);
+
+        assert(calls.set_backup == 1);
+        assert(stats->started == 2);
+
+        // The replacement subflow completes the failover.
+        mptcpd_plugin_new_subflow(token, SA(laddr2), SA(raddr), false, pm);
+
+        assert(calls.remove_subflow == 1);
+        assert(stats->completed == 2);
+        assert(stats->max_duration >= stats->last_duration);
+
+        mptcpd_plugin_connection_closed(token, pm);
+}
+
+/**
+ * @brief Connections initiated by the peer are left alone.
+ */
+static void test_failover_server_side(struct mptcpd_pm *pm)
+{
+        static mptcpd_token_t const token = 0x3;
+
+        memset(&calls, 0, sizeof(calls));
+
+        mptcpd_plugin_new_connection(NULL,
+                                     token,
+                                     SA(laddr1),
+                                     SA(raddr),
+                                     true,
+                                     pm);
+
+        mptcpd_plugin_link_state_changed(&lo, pm);
+
+        assert(calls.remove_subflow == 0);
+        assert(calls.set_backup == 0);
+        assert(mptcpd_pm_get_failover_stats(pm)->started == 2);
+
+        mptcpd_plugin_connection_closed(token, pm);
+}
+
+// -------------------------------------------------------------------
+
+int main(void)
+{
+        if (!l_main_init())
+                return -1;
+
+        l_log_set_stderr();
+        l_debug_enable("*");
+
+        init_addr(&laddr1, "127.0.0.1", 0x1234);
+        init_addr(&laddr2, "198.51.100.1", 0x5678);
+        init_addr(&raddr,  "192.0.2.1", 0x9abc);
+
+        lo.index = (int) if_nametoindex("lo");
+        assert(lo.index != 0);
+        l_strlcpy(lo.name, "lo", sizeof(lo.name));
+
+        /*
+          The plugin maps local addresses to network interfaces
+          through the network monitor.
+        */
+        struct mptcpd_nm *const nm = mptcpd_nm_create(0);
+        assert(nm != NULL);
+        assert(mptcpd_nm_monitor_loopback(nm, true));
+
+        mptcpd_nm_notify_synced(nm, handle_synced, NULL);
+
+        struct l_timeout *const timeout =
+                l_timeout_create(5, handle_timeout, NULL, NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(timeout);
+
+        /*
+          Path manager that issues path management commands to the
+          above stubs rather than to the kernel.  The MPTCP generic
+          netlink family is only checked against NULL to determine
+          if the path manager is ready.
+        */
+        struct mptcpd_pm pm = {
+                .netlink_pm = &netlink_pm,
+                .family     = (struct l_genl_family *) &netlink_pm,
+                .nm         = nm
+        };
+
+        assert(mptcpd_pm_addr_to_index(&pm, SA(laddr1)) == lo.index);
+
+        static struct mptcpd_plugin_desc const *const builtin[] = {
+                &MPTCPD_BUILTIN_PLUGIN_SYM(failover),
+                NULL
+        };
+
+        mptcpd_plugin_register_builtin(builtin);
+
+        // There is no plugin directory.  Only load the builtin plugin.
+        assert(mptcpd_plugin_load("/nonexistent", "failover", NULL, &pm));
+
+        test_failover_backup(&pm);
+        test_failover_replace(&pm);
+        test_failover_server_side(&pm);
+
+        mptcpd_plugin_unload(&pm);
+        mptcpd_plugin_register_builtin(NULL);
+        mptcpd_nm_destroy(nm);
+
+        return l_main_exit() ? 0 : -1;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
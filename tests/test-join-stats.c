@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-join-stats.c
+ *
+ * @brief mptcpd subflow join statistics test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <netinet/in.h>
+#include <time.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/join_stats.h>
+#include <mptcpd/join_stats.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+// Half-life in milliseconds large enough to not decay in tests.
+static unsigned int const half_life = 60 * 1000;
+
+static int const index1 = 1;
+static int const index2 = 2;
+
+static struct sockaddr_in const raddr1 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x0B6433C6 }  // 198.51.100.11
+};
+
+// Same /24 prefix as raddr1.
+static struct sockaddr_in const raddr2 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x166433C6 }  // 198.51.100.22
+};
+
+static struct sockaddr_in const raddr3 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x0B7100CB }  // 203.0.113.11
+};
+
+static struct sockaddr_in6 const raddr4 = {
+        .sin6_family = AF_INET6,
+        .sin6_addr   = { .s6_addr = { [0]  = 0x20,
+                                      [1]  = 0x01,
+                                      [2]  = 0x0D,
+                                      [3]  = 0xB8,
+                                      [15] = 0x0B }  // 2001:DB8::B
+        }
+};
+
+#define SA(x) ((struct sockaddr const *) &(x))
+
+// ----------------------------------------------------------------
+
+static void record_failures(struct mptcpd_jstats *js,
+                            int index,
+                            struct sockaddr const *raddr,
+                            int count)
+{
+        for (int i = 0; i < count; ++i)
+                mptcpd_jstats_record(js, index, raddr, false);
+}
+
+static void test_bad_args(void const *test_data)
+{
+        (void) test_data;
+
+        assert(mptcpd_jstats_create(0) == NULL);
+
+        struct sockaddr const unspec = { .sa_family = AF_UNSPEC };
+
+        // Unknown paths are always worth trying.
+        assert(mptcpd_jstats_should_try_subflow(NULL, index1, SA(raddr1)));
+
+        struct mptcpd_jstats *const js = mptcpd_jstats_create(half_life);
+        assert(js != NULL);
+
+        assert(mptcpd_jstats_should_try_subflow(js, index1, NULL));
+        assert(mptcpd_jstats_should_try_subflow(js, index1, &unspec));
+
+        mptcpd_jstats_record(NULL, index1, SA(raddr1), false);
+        mptcpd_jstats_record(js, index1, NULL, false);
+        record_failures(js, index1, &unspec, 10);
+
+        mptcpd_jstats_destroy(js);
+        mptcpd_jstats_destroy(NULL);
+}
+
+static void test_failures(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_jstats *const js = mptcpd_jstats_create(half_life);
+        assert(js != NULL);
+
+        assert(mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        // Too few failures to give up on the path.
+        record_failures(js, index1, SA(raddr1), 2);
+        assert(mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        record_failures(js, index1, SA(raddr1), 1);
+        assert(!mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        // Paths are tracked per remote prefix.
+        assert(!mptcpd_jstats_should_try_subflow(js, index1, SA(raddr2)));
+        assert(mptcpd_jstats_should_try_subflow(js, index1, SA(raddr3)));
+
+        // Paths are tracked per local interface.
+        assert(mptcpd_jstats_should_try_subflow(js, index2, SA(raddr1)));
+
+        record_failures(js, index1, SA(raddr4), 3);
+        assert(!mptcpd_jstats_should_try_subflow(js, index1, SA(raddr4)));
+        assert(mptcpd_jstats_should_try_subflow(js, index2, SA(raddr4)));
+
+        mptcpd_jstats_destroy(js);
+}
+
+static void test_successes(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_jstats *const js = mptcpd_jstats_create(half_life);
+        assert(js != NULL);
+
+        record_failures(js, index1, SA(raddr1), 3);
+        assert(!mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        // Occasional successful joins keep the path in use.
+        mptcpd_jstats_record(js, index1, SA(raddr1), true);
+        assert(mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        record_failures(js, index1, SA(raddr1), 3);
+        assert(!mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        mptcpd_jstats_destroy(js);
+}
+
+static void test_decay(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_jstats *const js = mptcpd_jstats_create(1);
+        assert(js != NULL);
+
+        record_failures(js, index1, SA(raddr1), 3);
+
+        struct timespec const delay = { .tv_nsec = 5 * 1000 * 1000 };
+        (void) nanosleep(&delay, NULL);
+
+        // Failed joins are forgotten over time.
+        assert(mptcpd_jstats_should_try_subflow(js, index1, SA(raddr1)));
+
+        mptcpd_jstats_destroy(js);
+}
+
+int main(int argc, char *argv[])
+{
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("bad args",  test_bad_args,  NULL);
+        l_test_add("failures",  test_failures,  NULL);
+        l_test_add("successes", test_successes, NULL);
+        l_test_add("decay",     test_decay,     NULL);
+
+        return l_test_run();
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
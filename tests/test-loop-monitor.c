@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-loop-monitor.c
+ *
+ * @brief mptcpd event loop latency monitor test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/loop_monitor.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Stall threshold used by the tests, in milliseconds.
+#define TEST_THRESHOLD 20
+
+/// Keep the event loop busy for @a msec milliseconds.
+static void busy_wait(unsigned int msec)
+{
+        uint64_t const start = l_time_now();
+
+        while (l_time_diff(start, l_time_now()) < msec * L_USEC_PER_MSEC)
+                ;
+}
+
+static uint64_t count(uint64_t const *histogram)
+{
+        uint64_t total = 0;
+
+        for (unsigned int i = 0; i < MPTCPD_LOOPMON_BUCKETS; ++i)
+                total += histogram[i];
+
+        return total;
+}
+
+static void test_handlers(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_loopmon_stats const *const stats =
+                mptcpd_loopmon_get_stats();
+
+        // Handlers aren't measured while the monitor is stopped.
+        mptcpd_loopmon_enter("test", 1);
+        mptcpd_loopmon_leave();
+        assert(count(stats->work) == 0);
+
+        assert(mptcpd_loopmon_start(TEST_THRESHOLD));
+
+        // Fast handler.
+        mptcpd_loopmon_enter("test", 1);
+        mptcpd_loopmon_leave();
+
+        assert(count(stats->work) == 1);
+        assert(stats->stalls == 0);
+
+        // Slow handler, with a nested handler accounted to it.
+        mptcpd_loopmon_enter("test", 2);
+        busy_wait(TEST_THRESHOLD + 10);
+        mptcpd_loopmon_enter("nested", 3);
+        mptcpd_loopmon_leave();
+        mptcpd_loopmon_leave();
+
+        assert(count(stats->work) == 2);
+        assert(stats->stalls == 1);
+        assert(stats->max_work >= (TEST_THRESHOLD + 10) * L_USEC_PER_MSEC);
+
+        // Unbalanced leave calls are ignored.
+        mptcpd_loopmon_leave();
+        assert(count(stats->work) == 2);
+
+        // A zero threshold stops the monitor.
+        assert(mptcpd_loopmon_start(0));
+
+        mptcpd_loopmon_enter("test", 1);
+        mptcpd_loopmon_leave();
+        assert(count(stats->work) == 2);
+}
+
+static void stall_loop(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        // Stall the event loop outside of monitored handlers.
+        busy_wait(TEST_THRESHOLD * 3);
+}
+
+static void quit_loop(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        l_main_quit();
+}
+
+static void test_lag(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_loopmon_stats const *const stats =
+                mptcpd_loopmon_get_stats();
+
+        uint64_t const stalls = stats->stalls;
+
+        assert(mptcpd_loopmon_start(TEST_THRESHOLD));
+
+        struct l_timeout *const stall =
+                l_timeout_create_ms(TEST_THRESHOLD / 2,
+                                    stall_loop,
+                                    NULL,
+                                    NULL);
+
+        struct l_timeout *const quit =
+                l_timeout_create_ms(TEST_THRESHOLD * 10,
+                                    quit_loop,
+                                    NULL,
+                                    NULL);
+
+        assert(stall != NULL);
+        assert(quit != NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(quit);
+        l_timeout_remove(stall);
+
+        mptcpd_loopmon_stop();
+
+        // The stall delayed at least one lag probe.
+        assert(count(stats->lag) > 0);
+        assert(stats->stalls > stalls);
+        assert(stats->max_lag >= TEST_THRESHOLD * L_USEC_PER_MSEC);
+
+        mptcpd_loopmon_log_stats();
+}
+
+int main(int argc, char *argv[])
+{
+        if (!l_main_init())
+                return -1;
+
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("handlers", test_handlers, NULL);
+        l_test_add("lag",      test_lag,      NULL);
+
+        int const result = l_test_run();
+
+        return l_main_exit() && result == 0 ? 0 : -1;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
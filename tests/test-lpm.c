@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-lpm.c
+ *
+ * @brief mptcpd IP address longest prefix match table test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/lpm.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+#define SA(x) ((struct sockaddr const *) &(x))
+
+static struct sockaddr_in addr4(char const *addr)
+{
+        struct sockaddr_in sa = { .sin_family = AF_INET };
+
+        assert(inet_pton(AF_INET, addr, &sa.sin_addr) == 1);
+
+        return sa;
+}
+
+static struct sockaddr_in6 addr6(char const *addr)
+{
+        struct sockaddr_in6 sa = { .sin6_family = AF_INET6 };
+
+        assert(inet_pton(AF_INET6, addr, &sa.sin6_addr) == 1);
+
+        return sa;
+}
+
+static void *lookup4(struct mptcpd_lpm_snapshot const *snapshot,
+                     char const *addr)
+{
+        struct sockaddr_in const sa = addr4(addr);
+
+        return mptcpd_lpm_lookup(snapshot, SA(sa));
+}
+
+static void *lookup6(struct mptcpd_lpm_snapshot const *snapshot,
+                     char const *addr)
+{
+        struct sockaddr_in6 const sa = addr6(addr);
+
+        return mptcpd_lpm_lookup(snapshot, SA(sa));
+}
+
+static void insert4(struct mptcpd_lpm *lpm,
+                    char const *prefix,
+                    uint8_t len,
+                    void *value)
+{
+        struct sockaddr_in const sa = addr4(prefix);
+
+        assert(mptcpd_lpm_insert(lpm, SA(sa), len, value));
+}
+
+static void insert6(struct mptcpd_lpm *lpm,
+                    char const *prefix,
+                    uint8_t len,
+                    void *value)
+{
+        struct sockaddr_in6 const sa = addr6(prefix);
+
+        assert(mptcpd_lpm_insert(lpm, SA(sa), len, value));
+}
+
+static char a, b, c, d, e, f;
+
+static void test_bad_args(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+        assert(lpm != NULL);
+
+        struct sockaddr_in const sa4 = addr4("192.0.2.0");
+        struct sockaddr_in6 const sa6 = addr6("2001:db8::");
+
+        assert(!mptcpd_lpm_insert(NULL, SA(sa4), 24, &a));
+        assert(!mptcpd_lpm_insert(lpm, NULL, 24, &a));
+        assert(!mptcpd_lpm_insert(lpm, SA(sa4), 24, NULL));
+        assert(!mptcpd_lpm_insert(lpm, SA(sa4), 33, &a));
+        assert(!mptcpd_lpm_insert(lpm, SA(sa6), 129, &a));
+
+        assert(mptcpd_lpm_remove(lpm, SA(sa4), 24) == NULL);
+        assert(mptcpd_lpm_snapshot(NULL) == NULL);
+        assert(mptcpd_lpm_lookup(NULL, SA(sa4)) == NULL);
+
+        struct mptcpd_lpm_snapshot *const snapshot =
+                mptcpd_lpm_snapshot(lpm);
+        assert(snapshot != NULL);
+
+        // Empty table.
+        assert(mptcpd_lpm_lookup(snapshot, SA(sa4)) == NULL);
+        assert(mptcpd_lpm_lookup(snapshot, SA(sa6)) == NULL);
+        assert(mptcpd_lpm_lookup(snapshot, NULL) == NULL);
+
+        mptcpd_lpm_snapshot_destroy(snapshot);
+        mptcpd_lpm_destroy(lpm);
+}
+
+static void test_ipv4(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+
+        // Inserted out of order, with host bits set.
+        insert4(lpm, "192.0.2.129", 25, &c);
+        insert4(lpm, "192.0.2.1",   32, &d);
+        insert4(lpm, "0.0.0.0",      0, &a);
+        insert4(lpm, "192.0.0.0",   12, &b);
+        insert4(lpm, "10.1.2.3",    20, &e);
+
+        struct mptcpd_lpm_snapshot *const snapshot =
+                mptcpd_lpm_snapshot(lpm);
+
+        mptcpd_lpm_destroy(lpm);  // Snapshot is independent.
+
+        assert(lookup4(snapshot, "203.0.113.1")   == &a);
+        assert(lookup4(snapshot, "192.15.255.255") == &b);
+        assert(lookup4(snapshot, "192.16.0.0")    == &a);
+        assert(lookup4(snapshot, "192.0.2.0")     == &b);
+        assert(lookup4(snapshot, "192.0.2.1")     == &d);
+        assert(lookup4(snapshot, "192.0.2.2")     == &b);
+        assert(lookup4(snapshot, "192.0.2.128")   == &c);
+        assert(lookup4(snapshot, "192.0.2.255")   == &c);
+        assert(lookup4(snapshot, "10.1.0.0")      == &e);
+        assert(lookup4(snapshot, "10.1.15.255")   == &e);
+        assert(lookup4(snapshot, "10.1.16.0")     == &a);
+
+        // IPv4 prefixes do not match IPv6 addresses.
+        assert(lookup6(snapshot, "::") == NULL);
+
+        mptcpd_lpm_snapshot_destroy(snapshot);
+}
+
+static void test_ipv6(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+
+        insert6(lpm, "2001:db8::",          32, &a);
+        insert6(lpm, "2001:db8:0:1::",      64, &b);
+        insert6(lpm, "2001:db8:0:1::1",    128, &c);
+        insert6(lpm, "2001:db8:8000::",     33, &d);
+
+        struct mptcpd_lpm_snapshot *const snapshot =
+                mptcpd_lpm_snapshot(lpm);
+
+        mptcpd_lpm_destroy(lpm);
+
+        assert(lookup6(snapshot, "2001:db8::5")         == &a);
+        assert(lookup6(snapshot, "2001:db8:0:1::2")     == &b);
+        assert(lookup6(snapshot, "2001:db8:0:1::1")     == &c);
+        assert(lookup6(snapshot, "2001:db8:8000::1")    == &d);
+        assert(lookup6(snapshot, "2001:db8:7fff::1")    == &a);
+        assert(lookup6(snapshot, "2001:db9::")          == NULL);
+        assert(lookup4(snapshot, "32.1.13.184")         == NULL);
+
+        mptcpd_lpm_snapshot_destroy(snapshot);
+}
+
+static void test_update(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_lpm *const lpm = mptcpd_lpm_create();
+
+        insert4(lpm, "198.51.100.0", 24, &a);
+        insert4(lpm, "198.51.0.0",   16, &b);
+
+        struct mptcpd_lpm_snapshot *const old = mptcpd_lpm_snapshot(lpm);
+
+        // Replace and remove prefixes.
+        insert4(lpm, "198.51.100.0", 24, &e);
+
+        struct sockaddr_in const sa = addr4("198.51.0.0");
+        assert(mptcpd_lpm_remove(lpm, SA(sa), 16) == &b);
+        assert(mptcpd_lpm_remove(lpm, SA(sa), 16) == NULL);
+
+        insert6(lpm, "::", 0, &f);
+
+        struct mptcpd_lpm_snapshot *const new = mptcpd_lpm_snapshot(lpm);
+
+        mptcpd_lpm_destroy(lpm);
+
+        // Existing snapshots are unaffected by table changes.
+        assert(lookup4(old, "198.51.100.1") == &a);
+        assert(lookup4(old, "198.51.1.1")   == &b);
+        assert(lookup6(old, "2001:db8::1")  == NULL);
+
+        assert(lookup4(new, "198.51.100.1") == &e);
+        assert(lookup4(new, "198.51.1.1")   == NULL);
+        assert(lookup6(new, "2001:db8::1")  == &f);
+
+        mptcpd_lpm_snapshot_destroy(old);
+        mptcpd_lpm_snapshot_destroy(new);
+}
+
+int main(int argc, char *argv[])
+{
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("bad args", test_bad_args, NULL);
+        l_test_add("IPv4",     test_ipv4,     NULL);
+        l_test_add("IPv6",     test_ipv6,     NULL);
+        l_test_add("update",   test_update,   NULL);
+
+        return l_test_run();
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -52,6 +52,9 @@ struct foreach_data
          *        count.
          */
         int count;
+
+        /// Initial network dump completion callback call count.
+        int synced;
 };
 
 /**
@@ -85,12 +88,12 @@ static void dump_addr(void *data, void *user_data)
 }
 
 /**
- * @brief @c mptcpd_nm_foreach_interface() test callback function.
+ * @brief Dump network interface information for debug logging
+ *        purposes.
  *
- * @param[in] if   Network interface information.
- * @param[in] data User supplied data.
+ * @param[in] i Network interface information.
  */
-static void check_interface(struct mptcpd_interface const *i, void *data)
+static void dump_interface(struct mptcpd_interface const *i)
 {
         assert(i != NULL);
 
@@ -111,6 +114,17 @@ static void check_interface(struct mptcpd_interface const *i, void *data)
                 l_debug("  addrs:");
                 l_queue_foreach(i->addrs, dump_addr, NULL);
         }
+}
+
+/**
+ * @brief @c mptcpd_nm_foreach_interface() test callback function.
+ *
+ * @param[in] if   Network interface information.
+ * @param[in] data User supplied data.
+ */
+static void check_interface(struct mptcpd_interface const *i, void *data)
+{
+        dump_interface(i);
 
         /*
           Only network interfaces that are up and running should be
@@ -177,6 +191,15 @@ static void idle_callback(struct l_idle *idle, void *user_data)
                 l_main_quit();
 }
 
+static void handle_synced(void *user_data)
+{
+        struct foreach_data *const data = user_data;
+
+        assert(data->cup == coffee);
+
+        ++data->synced;
+}
+
 static void handle_new_interface(struct mptcpd_interface const *i,
                                  void *user_data)
 {
@@ -202,7 +225,22 @@ static void handle_delete_interface(struct mptcpd_interface const *i,
 {
         l_debug("delete_interface event occurred.");
 
-        check_interface(i, NULL);
+        // Deleted interfaces may no longer be up and running.
+        dump_interface(i);
+
+        assert((int const *) user_data == &coffee);
+}
+
+static void handle_link_state_changed(struct mptcpd_interface const *i,
+                                      void *user_data)
+{
+        l_debug("link_state_changed event occurred.");
+        l_debug("  operstate: %u, carrier: %s, mtu: %u",
+                i->operstate,
+                i->carrier ? "up" : "down",
+                i->mtu);
+
+        dump_interface(i);
 
         assert((int const *) user_data == &coffee);
 }
@@ -256,11 +294,12 @@ int main(void)
 
         static struct mptcpd_nm_ops const nm_events[] = {
                 {
-                        .new_interface    = handle_new_interface,
-                        .update_interface = handle_update_interface,
-                        .delete_interface = handle_delete_interface,
-                        .new_address      = handle_new_address,
-                        .delete_address   = handle_delete_address
+                        .new_interface      = handle_new_interface,
+                        .update_interface   = handle_update_interface,
+                        .delete_interface   = handle_delete_interface,
+                        .new_address        = handle_new_address,
+                        .delete_address     = handle_delete_address,
+                        .link_state_changed = handle_link_state_changed
                 },
                 {
                         .new_interface    = handle_new_interface,
@@ -285,7 +324,8 @@ int main(void)
                          && ops->update_interface == NULL
                          && ops->delete_interface == NULL
                          && ops->new_address      == NULL
-                         && ops->delete_address   == NULL);
+                         && ops->delete_address   == NULL
+                         && ops->link_state_changed == NULL);
 
                 bool const registered =
                         mptcpd_nm_register_ops(nm, ops, (void *) &coffee);
@@ -293,8 +333,21 @@ int main(void)
                 assert(registered || (all_null_ops && !registered));
         }
 
+        /*
+          Operations unknown to callers compiled against an older
+          header, e.g. existing plugin binaries, are ignored.
+        */
+        static struct mptcpd_nm_ops const link_only = {
+                .link_state_changed = handle_link_state_changed
+        };
+
+        assert(!(mptcpd_nm_register_ops)(nm, &link_only, NULL));
+        assert(!mptcpd_nm_register_ops_size(nm, &link_only, 1, NULL));
+
         struct foreach_data data = { .nm = nm, .cup = coffee };
 
+        mptcpd_nm_notify_synced(nm, handle_synced, &data);
+
         // Prepare to iterate over all monitored network interfaces.
         struct l_idle *const idle =
                 l_idle_create(idle_callback, &data, NULL);
@@ -308,6 +361,9 @@ int main(void)
         // Make sure the foreach test callback was actually called.
         assert(data.count > 0);
 
+        // The initial network dump should have completed once.
+        assert(data.synced == 1);
+
         return l_main_exit() ? 0 : -1;
 }
 
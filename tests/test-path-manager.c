@@ -8,6 +8,8 @@
  */
 
 #include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
 
 #include <ell/ell.h>
 
@@ -16,7 +18,10 @@
 #include "../src/path_manager.h"           // INTERNAL!
 #include <mptcpd/private/configuration.h>  // INTERNAL!
 #include <mptcpd/private/path_manager.h>   // INTERNAL!
+#include <mptcpd/private/mptcp_upstream.h>  // INTERNAL!
 #include <mptcpd/path_manager.h>
+#include <mptcpd/network_monitor.h>
+#include <mptcpd/join_stats.h>
 
 #undef NDEBUG
 #include <assert.h>
@@ -132,6 +137,162 @@ static void test_pm_destroy(void const *test_data)
         mptcpd_pm_destroy(info->pm);
 }
 
+/**
+ * @struct join_interface
+ *
+ * @brief Monitored network interface with an IPv4 address.
+ */
+struct join_interface
+{
+        /// Network interface index.
+        int index;
+
+        /// IPv4 address assigned to the network interface.
+        struct sockaddr_in addr;
+};
+
+static void get_join_interface(struct mptcpd_interface const *i,
+                               void *data)
+{
+        struct join_interface *const j = data;
+
+        if (j->index != 0)
+                return;
+
+        for (struct l_queue_entry const *e = l_queue_get_entries(i->addrs);
+             e != NULL;
+             e = e->next) {
+                struct sockaddr const *const sa = e->data;
+
+                if (sa->sa_family == AF_INET) {
+                        memcpy(&j->addr, sa, sizeof(j->addr));
+                        j->index = i->index;
+
+                        return;
+                }
+        }
+}
+
+static void join_event(struct mptcpd_pm *pm,
+                       uint8_t cmd,
+                       struct sockaddr_in const *laddr,
+                       struct sockaddr_in const *raddr,
+                       uint8_t error)
+{
+        static mptcpd_token_t const token = 0x12345678;
+        static uint8_t const backup = 0;
+
+        // The kernel reports a zero index for unbound subflows.
+        static int32_t const unbound = 0;
+
+        uint16_t const family = AF_INET;
+
+        struct l_genl_msg *const msg = l_genl_msg_new(cmd);
+
+        bool const appended =
+                l_genl_msg_append_attr(msg,
+                                       MPTCP_ATTR_TOKEN,
+                                       sizeof(token),
+                                       &token)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_FAMILY,
+                                          sizeof(family),
+                                          &family)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_SADDR4,
+                                          sizeof(laddr->sin_addr.s_addr),
+                                          &laddr->sin_addr.s_addr)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_SPORT,
+                                          sizeof(laddr->sin_port),
+                                          &laddr->sin_port)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_DADDR4,
+                                          sizeof(raddr->sin_addr.s_addr),
+                                          &raddr->sin_addr.s_addr)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_DPORT,
+                                          sizeof(raddr->sin_port),
+                                          &raddr->sin_port)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_BACKUP,
+                                          sizeof(backup),
+                                          &backup)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_IF_IDX,
+                                          sizeof(unbound),
+                                          &unbound)
+                && l_genl_msg_append_attr(msg,
+                                          MPTCP_ATTR_ERROR,
+                                          sizeof(error),
+                                          &error);
+
+        assert(appended);
+
+        mptcpd_pm_handle_event(msg, pm);
+
+        l_genl_msg_unref(msg);
+}
+
+static void test_pm_join_stats(void const *test_data)
+{
+        struct test_info *const info = (struct test_info *) test_data;
+        struct mptcpd_pm *const pm = info->pm;
+
+        struct join_interface j = { .index = 0 };
+
+        mptcpd_nm_foreach_interface(mptcpd_pm_get_nm(pm),
+                                    get_join_interface,
+                                    &j);
+
+        if (j.index == 0) {
+                l_warn("No monitored IPv4 address.  "
+                       "Join statistics test skipped.");
+
+                return;
+        }
+
+        j.addr.sin_port = htons(0x1234);
+
+        struct sockaddr_in raddr = {
+                .sin_family = AF_INET,
+                .sin_port   = htons(0x5678)
+        };
+
+        assert(inet_pton(AF_INET, "192.0.2.1", &raddr.sin_addr) == 1);
+
+        struct sockaddr const *const sa = (struct sockaddr const *) &raddr;
+        struct mptcpd_jstats *const js = mptcpd_pm_get_jstats(pm);
+
+        assert(mptcpd_pm_addr_to_index(pm,
+                                       (struct sockaddr const *) &j.addr)
+               == j.index);
+
+        // Repeated join failures reported through netlink events ...
+        for (int i = 0; i < 8; ++i)
+                join_event(pm,
+                           MPTCP_EVENT_SUB_CLOSED,
+                           &j.addr,
+                           &raddr,
+                           ETIMEDOUT);
+
+        // ... must be visible under the network monitor index.
+        assert(!mptcpd_jstats_should_try_subflow(js, j.index, sa));
+        assert(mptcpd_jstats_should_try_subflow(js, 0, sa));
+
+        // Subflows closed without an error aren't failed joins.
+        assert(inet_pton(AF_INET, "198.51.100.1", &raddr.sin_addr) == 1);
+
+        for (int i = 0; i < 8; ++i)
+                join_event(pm,
+                           MPTCP_EVENT_SUB_CLOSED,
+                           &j.addr,
+                           &raddr,
+                           0);
+
+        assert(mptcpd_jstats_should_try_subflow(js, j.index, sa));
+}
+
 // -------------------------------------------------------------------
 
 static void test_pm_internals(struct l_genl_family_info const *info,
@@ -230,6 +391,9 @@ int main(void)
 
         (void) l_main_run();
 
+        if (mptcpd_pm_ready(info.pm))
+                test_pm_join_stats(&info);
+
         test_pm_destroy(&info);
 
         /*
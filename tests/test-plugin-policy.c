@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-plugin-policy.c
+ *
+ * @brief mptcpd per-connection plugin selection test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <string.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/configuration.h>
+#include <mptcpd/private/plugin_policy.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+#define SA(x) ((struct sockaddr const *) &(x))
+
+static struct mptcpd_plugin_rule *rule_new(char const *plugin,
+                                           char const *prefix,
+                                           uint8_t prefix_len,
+                                           uint16_t local_port,
+                                           uint16_t remote_port)
+{
+        struct mptcpd_plugin_rule *const r =
+                l_new(struct mptcpd_plugin_rule, 1);
+
+        r->name        = l_strdup(plugin);
+        r->plugin      = l_strdup(plugin);
+        r->local_port  = local_port;
+        r->remote_port = remote_port;
+        r->server_side = true;
+        r->client_side = true;
+
+        if (prefix != NULL) {
+                struct sockaddr_in *const sa4 =
+                        (struct sockaddr_in *) &r->remote_prefix;
+                struct sockaddr_in6 *const sa6 =
+                        (struct sockaddr_in6 *) &r->remote_prefix;
+
+                if (inet_pton(AF_INET, prefix, &sa4->sin_addr) == 1) {
+                        sa4->sin_family = AF_INET;
+                } else {
+                        assert(inet_pton(AF_INET6,
+                                         prefix,
+                                         &sa6->sin6_addr) == 1);
+                        sa6->sin6_family = AF_INET6;
+                }
+
+                r->remote_prefix_len = prefix_len;
+        }
+
+        return r;
+}
+
+static void rule_destroy(void *data)
+{
+        struct mptcpd_plugin_rule *const r = data;
+
+        l_free(r->name);
+        l_free(r->plugin);
+        l_free(r);
+}
+
+static struct sockaddr_in addr4(char const *addr, uint16_t port)
+{
+        struct sockaddr_in sa = {
+                .sin_family = AF_INET,
+                .sin_port   = htons(port)
+        };
+
+        assert(inet_pton(AF_INET, addr, &sa.sin_addr) == 1);
+
+        return sa;
+}
+
+static struct sockaddr_in6 addr6(char const *addr, uint16_t port)
+{
+        struct sockaddr_in6 sa = {
+                .sin6_family = AF_INET6,
+                .sin6_port   = htons(port)
+        };
+
+        assert(inet_pton(AF_INET6, addr, &sa.sin6_addr) == 1);
+
+        return sa;
+}
+
+static bool selects(struct mptcpd_plugin_policy const *policy,
+                    struct sockaddr const *laddr,
+                    struct sockaddr const *raddr,
+                    bool server_side,
+                    char const *expected)
+{
+        char const *const name =
+                mptcpd_plugin_policy_select(policy,
+                                            laddr,
+                                            raddr,
+                                            server_side);
+
+        if (expected == NULL)
+                return name == NULL;
+
+        return name != NULL && strcmp(name, expected) == 0;
+}
+
+static void test_empty(void const *test_data)
+{
+        (void) test_data;
+
+        assert(mptcpd_plugin_policy_create(NULL) == NULL);
+
+        struct l_queue *const rules = l_queue_new();
+
+        assert(mptcpd_plugin_policy_create(rules) == NULL);
+
+        l_queue_destroy(rules, NULL);
+
+        struct sockaddr_in const raddr = addr4("192.0.2.1", 80);
+
+        // No policy means no rule matches.
+        assert(mptcpd_plugin_policy_select(NULL, NULL, SA(raddr), false)
+               == NULL);
+}
+
+static void test_select(void const *test_data)
+{
+        (void) test_data;
+
+        struct l_queue *const rules = l_queue_new();
+
+        struct mptcpd_plugin_rule *const server =
+                rule_new("web", NULL, 0, 443, 0);
+        server->client_side = false;
+
+        l_queue_push_tail(rules, server);
+        l_queue_push_tail(rules, rule_new("host", "192.0.2.1", 32, 0, 0));
+        l_queue_push_tail(rules, rule_new("net", "192.0.2.0", 24, 0, 0));
+        l_queue_push_tail(rules,
+                          rule_new("ssh", "198.51.100.0", 24, 0, 22));
+        l_queue_push_tail(rules, rule_new("v6", "2001:db8::", 32, 0, 0));
+
+        struct mptcpd_plugin_policy *const policy =
+                mptcpd_plugin_policy_create(rules);
+
+        l_queue_destroy(rules, rule_destroy);
+
+        assert(policy != NULL);
+
+        struct sockaddr_in const l443  = addr4("203.0.113.1", 443);
+        struct sockaddr_in const l8080 = addr4("203.0.113.1", 8080);
+
+        struct sockaddr_in const host  = addr4("192.0.2.1", 5000);
+        struct sockaddr_in const net   = addr4("192.0.2.99", 5000);
+        struct sockaddr_in const ssh   = addr4("198.51.100.7", 22);
+        struct sockaddr_in const nossh = addr4("198.51.100.7", 23);
+        struct sockaddr_in const other = addr4("203.0.113.99", 22);
+
+        struct sockaddr_in6 const l6   = addr6("2001:db8:1::1", 8080);
+        struct sockaddr_in6 const v6   = addr6("2001:db8:2::2", 5000);
+        struct sockaddr_in6 const nov6 = addr6("2001:db9::2", 5000);
+
+        // Earlier rules take precedence over later ones.
+        assert(selects(policy, SA(l443), SA(host), true, "web"));
+        assert(selects(policy, SA(l443), SA(host), false, "host"));
+
+        // Longer and shorter prefixes.
+        assert(selects(policy, SA(l8080), SA(host), true, "host"));
+        assert(selects(policy, SA(l8080), SA(net), true, "net"));
+
+        // Remote address prefix and port.
+        assert(selects(policy, SA(l8080), SA(ssh), false, "ssh"));
+        assert(selects(policy, SA(l8080), SA(nossh), false, NULL));
+        assert(selects(policy, SA(l8080), SA(other), false, NULL));
+
+        // IPv6
+        assert(selects(policy, SA(l6), SA(v6), false, "v6"));
+        assert(selects(policy, SA(l6), SA(nov6), false, NULL));
+
+        mptcpd_plugin_policy_destroy(policy);
+}
+
+static void test_max_rules(void const *test_data)
+{
+        (void) test_data;
+
+        struct l_queue *const rules = l_queue_new();
+
+        for (int i = 0; i < 33; ++i)
+                l_queue_push_tail(rules,
+                                  rule_new("ignored",
+                                           NULL,
+                                           0,
+                                           (uint16_t) (1000 + i),
+                                           0));
+
+        struct mptcpd_plugin_policy *const policy =
+                mptcpd_plugin_policy_create(rules);
+
+        l_queue_destroy(rules, rule_destroy);
+
+        assert(policy != NULL);
+
+        struct sockaddr_in const raddr = addr4("192.0.2.1", 80);
+        struct sockaddr_in const last  = addr4("192.0.2.2", 1031);
+        struct sockaddr_in const over  = addr4("192.0.2.2", 1032);
+
+        assert(selects(policy, SA(last), SA(raddr), false, "ignored"));
+
+        // Rules beyond the maximum are not used.
+        assert(selects(policy, SA(over), SA(raddr), false, NULL));
+
+        mptcpd_plugin_policy_destroy(policy);
+}
+
+int main(int argc, char *argv[])
+{
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("empty",     test_empty,     NULL);
+        l_test_add("select",    test_select,    NULL);
+        l_test_add("max rules", test_max_rules, NULL);
+
+        return l_test_run();
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
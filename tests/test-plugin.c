@@ -315,12 +315,500 @@ static void test_null_plugin_ops(void const *test_data)
         mptcpd_plugin_new_interface(interface, pm);
         mptcpd_plugin_update_interface(interface, pm);
         mptcpd_plugin_delete_interface(interface, pm);
+        mptcpd_plugin_link_state_changed(interface, pm);
         mptcpd_plugin_new_local_address(interface, laddr, pm);
         mptcpd_plugin_delete_local_address(interface, laddr, pm);
 
         mptcpd_plugin_unload(pm);
 }
 
+/// Number of path manager events seen by the chain stage.
+static int stage_calls;
+
+/// Number of path manager events seen by the chained plugin.
+static int chain_calls;
+
+static bool stage_filter(struct mptcpd_plugin_event *event,
+                         struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        ++stage_calls;
+
+        // Mark all subflows as backup, and veto address removal.
+        event->backup = true;
+
+        return event->type != MPTCPD_PLUGIN_ADDRESS_REMOVED;
+}
+
+static void chain_new_connection(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool server_side,
+                                 struct mptcpd_pm *pm)
+{
+        (void) token;
+        (void) laddr;
+        (void) raddr;
+        (void) server_side;
+        (void) pm;
+
+        // The stage is ahead of this plugin in the chain.
+        assert(stage_calls == 1);
+
+        ++chain_calls;
+}
+
+static void chain_address_removed(mptcpd_token_t token,
+                                  mptcpd_aid_t id,
+                                  struct mptcpd_pm *pm)
+{
+        (void) token;
+        (void) id;
+        (void) pm;
+
+        ++chain_calls;
+}
+
+static void chain_new_subflow(mptcpd_token_t token,
+                              struct sockaddr const *laddr,
+                              struct sockaddr const *raddr,
+                              bool backup,
+                              struct mptcpd_pm *pm)
+{
+        (void) token;
+        (void) laddr;
+        (void) raddr;
+        (void) pm;
+
+        // Modified by the stage.
+        assert(backup);
+
+        ++chain_calls;
+}
+
+/**
+ * @brief Verify plugin chaining.
+ *
+ * Confirm that chain stages observe, modify and veto events before
+ * they reach plugins later in the chain.
+ */
+static void test_plugin_chain(void const *test_data)
+{
+        (void) test_data;
+
+        static char const        dir[]          = TEST_PLUGIN_DIR_NOOP;
+        static char const *const default_plugin = NULL;
+        struct mptcpd_pm *const pm = NULL;
+
+        static struct mptcpd_plugin_ops const stage_ops = {
+                .filter = stage_filter
+        };
+
+        static struct mptcpd_plugin_ops const chain_ops = {
+                .new_connection  = chain_new_connection,
+                .address_removed = chain_address_removed,
+                .new_subflow     = chain_new_subflow
+        };
+
+        // Plugins must be loaded first.
+        assert(!mptcpd_plugin_register_stage(&stage_ops));
+
+        bool const loaded = mptcpd_plugin_load(dir, default_plugin, NULL, pm);
+        assert(loaded);
+
+        assert(!mptcpd_plugin_register_stage(NULL));
+
+        // Stage operations must at least include the filter.
+        assert(!mptcpd_plugin_register_stage_size(
+                       &stage_ops,
+                       offsetof(struct mptcpd_plugin_ops, filter)));
+
+        assert(mptcpd_plugin_register_stage(&stage_ops));
+
+        char const name[] = "chain";
+        assert(mptcpd_plugin_register_ops(name, &chain_ops));
+
+        // Unused dummy arguments.
+        static mptcpd_token_t const token = 0x12345678;
+        static mptcpd_aid_t const id = 0;
+        static struct sockaddr const *const laddr = NULL;
+        static struct sockaddr const *const raddr = NULL;
+        static bool server_side = false;
+
+        stage_calls = 0;
+        chain_calls = 0;
+
+        mptcpd_plugin_new_connection(name,
+                                     token,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+        assert(stage_calls == 1 && chain_calls == 1);
+
+        mptcpd_plugin_new_subflow(token, laddr, raddr, false, pm);
+        assert(stage_calls == 2 && chain_calls == 2);
+
+        mptcpd_plugin_address_removed(token, id, pm);
+        assert(stage_calls == 3 && chain_calls == 2);
+
+        mptcpd_plugin_unload(pm);
+}
+
+static bool count_filter(struct mptcpd_plugin_event *event,
+                         struct mptcpd_pm *pm)
+{
+        (void) event;
+        (void) pm;
+
+        ++stage_calls;
+
+        return true;
+}
+
+static void count_new_connection(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool server_side,
+                                 struct mptcpd_pm *pm)
+{
+        (void) token;
+        (void) laddr;
+        (void) raddr;
+        (void) server_side;
+        (void) pm;
+
+        ++chain_calls;
+}
+
+/**
+ * @brief Verify registration of plugin operations with their size.
+ *
+ * Confirm that operations added to @c struct @c mptcpd_plugin_ops
+ * after a plugin was compiled are ignored.
+ */
+static void test_plugin_ops_size(void const *test_data)
+{
+        (void) test_data;
+
+        static char const        dir[]          = TEST_PLUGIN_DIR_NOOP;
+        static char const *const default_plugin = NULL;
+        struct mptcpd_pm *const pm = NULL;
+
+        static struct mptcpd_plugin_ops const ops = {
+                .new_connection = count_new_connection,
+                .filter         = count_filter
+        };
+
+        bool const loaded = mptcpd_plugin_load(dir, default_plugin, NULL, pm);
+        assert(loaded);
+
+        // Smaller than any version of the plugin operations.
+        assert(!mptcpd_plugin_register_ops_size("small", &ops, 1));
+
+        // Plugin compiled before the filter operation existed.
+        assert((mptcpd_plugin_register_ops)("compat", &ops));
+
+        static struct sockaddr const *const laddr = NULL;
+        static struct sockaddr const *const raddr = NULL;
+        static bool server_side = false;
+
+        stage_calls = 0;
+        chain_calls = 0;
+
+        mptcpd_plugin_new_connection("compat",
+                                     0x1,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+        assert(stage_calls == 0 && chain_calls == 1);
+
+        // Plugin compiled against the current header.
+        static struct mptcpd_plugin_ops const current_ops = {
+                .new_connection = count_new_connection,
+                .filter         = count_filter
+        };
+
+        assert(mptcpd_plugin_register_ops("current", &current_ops));
+
+        mptcpd_plugin_new_connection("current",
+                                     0x2,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+        assert(stage_calls == 1 && chain_calls == 2);
+
+        mptcpd_plugin_unload(pm);
+}
+
+/**
+ * @brief Verify plugin reload.
+ *
+ * Confirm that plugins are reloaded, and that existing connections
+ * remain mapped to a plugin afterward.
+ */
+static void test_plugin_reload(void const *test_data)
+{
+        (void) test_data;
+
+        static char const        dir[]          = TEST_PLUGIN_DIR_NOOP;
+        static char const *const default_plugin = NULL;
+        struct mptcpd_pm *const pm = NULL;
+
+        // Nothing to reload yet.
+        assert(!mptcpd_plugin_reload(dir, default_plugin, NULL, pm));
+
+        bool const loaded = mptcpd_plugin_load(dir, default_plugin, NULL, pm);
+        assert(loaded);
+
+        // Unused dummy arguments.
+        static mptcpd_token_t const token = 0x12345678;
+        static struct sockaddr const *const laddr = NULL;
+        static struct sockaddr const *const raddr = NULL;
+        static bool server_side = false;
+
+        mptcpd_plugin_new_connection(default_plugin,
+                                     token,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+
+        assert(mptcpd_plugin_reload(dir, default_plugin, NULL, pm));
+
+        // Previous plugins are restored on reload failure.
+        assert(!mptcpd_plugin_reload(TEST_PLUGIN_DIR_BAD,
+                                     default_plugin,
+                                     NULL,
+                                     pm));
+
+        // Connection is still mapped to a plugin.
+        assert(!mptcpd_plugin_restore_connection(token,
+                                                 NULL,
+                                                 0,
+                                                 NULL,
+                                                 0,
+                                                 pm));
+
+        // New connections are mapped to the restored default plugin.
+        assert(mptcpd_plugin_restore_connection(token + 1,
+                                                NULL,
+                                                0,
+                                                NULL,
+                                                0,
+                                                pm));
+        mptcpd_plugin_connection_closed(token + 1, pm);
+
+        // Dispatch to the reloaded plugin.
+        mptcpd_plugin_connection_established(token,
+                                             laddr,
+                                             raddr,
+                                             server_side,
+                                             pm);
+        mptcpd_plugin_connection_closed(token, pm);
+
+        mptcpd_plugin_unload(pm);
+}
+
+/// Number of times connection state was exported.
+static int export_calls;
+
+/// Token of the connection state was last exported for.
+static mptcpd_token_t export_token;
+
+static void *export_state(mptcpd_token_t token,
+                          uint32_t *version,
+                          size_t *len,
+                          struct mptcpd_pm *pm)
+{
+        (void) version;
+        (void) len;
+        (void) pm;
+
+        ++export_calls;
+        export_token = token;
+
+        return NULL;  // No state to hand over.
+}
+
+static void ignore_state(mptcpd_token_t token,
+                         char const *name,
+                         uint32_t version,
+                         void const *state,
+                         size_t len,
+                         void *user_data)
+{
+        (void) token;
+        (void) name;
+        (void) version;
+        (void) state;
+        (void) len;
+        (void) user_data;
+}
+
+/**
+ * @brief Verify that closed connections are not handed over.
+ *
+ * Confirm that the state of closed connections is neither exported
+ * on plugin reload nor when saving state.
+ */
+static void test_plugin_reload_closed(void const *test_data)
+{
+        (void) test_data;
+
+        static char const        dir[]          = TEST_PLUGIN_DIR_NOOP;
+        static char const *const default_plugin = NULL;
+        struct mptcpd_pm *const pm = NULL;
+
+        static struct mptcpd_plugin_ops const ops = {
+                .export_state = export_state
+        };
+
+        bool const loaded = mptcpd_plugin_load(dir, default_plugin, NULL, pm);
+        assert(loaded);
+
+        char const name[] = "export";
+        assert(mptcpd_plugin_register_ops(name, &ops));
+
+        // Unused dummy arguments.
+        static mptcpd_token_t const open_token   = 0x1;
+        static mptcpd_token_t const closed_token = 0x2;
+        static struct sockaddr const *const laddr = NULL;
+        static struct sockaddr const *const raddr = NULL;
+        static bool server_side = false;
+
+        mptcpd_plugin_new_connection(name,
+                                     open_token,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+        mptcpd_plugin_new_connection(name,
+                                     closed_token,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+        mptcpd_plugin_connection_closed(closed_token, pm);
+
+        export_calls = 0;
+        mptcpd_plugin_export_states(ignore_state, NULL, pm);
+        assert(export_calls == 1 && export_token == open_token);
+
+        export_calls = 0;
+        assert(mptcpd_plugin_reload(dir, default_plugin, NULL, pm));
+        assert(export_calls == 1 && export_token == open_token);
+
+        // The closed connection is no longer mapped to a plugin.
+        assert(mptcpd_plugin_restore_connection(closed_token,
+                                                NULL,
+                                                0,
+                                                NULL,
+                                                0,
+                                                pm));
+
+        mptcpd_plugin_connection_closed(closed_token, pm);
+        mptcpd_plugin_connection_closed(open_token, pm);
+
+        mptcpd_plugin_unload(pm);
+}
+
+/// Number of connections seen by the test chain stage.
+static mptcpd_token_t stage_connections;
+
+static void stage_new_connection(mptcpd_token_t token,
+                                 struct sockaddr const *laddr,
+                                 struct sockaddr const *raddr,
+                                 bool server_side,
+                                 struct mptcpd_pm *pm)
+{
+        (void) laddr;
+        (void) raddr;
+        (void) server_side;
+        (void) pm;
+
+        assert(token == stage_connections + 1);
+
+        ++stage_connections;
+}
+
+/**
+ * @brief Verify deferred plugin initialization.
+ *
+ * Confirm that MPTCP connection events are buffered for a plugin
+ * whose @c init function returned @c MPTCPD_PLUGIN_INIT_PENDING
+ * without holding up the rest of the plugin chain, and that they are
+ * replayed in order once the plugin is ready.  Events beyond the
+ * buffer limit are dropped.  Other @c init failures must not be
+ * mistaken for deferred initialization.
+ *
+ * The plugins assert the events they see when unloaded.
+ */
+static void test_plugin_pending(void const *test_data)
+{
+        (void) test_data;
+
+        static char const        dir[]          = TEST_PLUGIN_DIR_PENDING;
+        static char const *const default_plugin = NULL;
+        struct mptcpd_pm *const pm = NULL;
+
+        static struct mptcpd_plugin_ops const ops = {
+                .new_connection = stage_new_connection
+        };
+
+        /*
+          The pending plugin completes initialization from the event
+          loop.
+        */
+        assert(l_main_init());
+
+        bool const loaded = mptcpd_plugin_load(dir, default_plugin, NULL, pm);
+        assert(loaded);
+
+        assert(mptcpd_plugin_register_stage(&ops));
+
+        // Unused dummy arguments.
+        static char const name[] = "failed";
+        static struct sockaddr const *const laddr = NULL;
+        static struct sockaddr const *const raddr = NULL;
+        static bool server_side = false;
+
+        stage_connections = 0;
+
+        for (mptcpd_token_t token = 1;
+             token <= test_pending_created;
+             ++token)
+                mptcpd_plugin_new_connection(name,
+                                             token,
+                                             laddr,
+                                             raddr,
+                                             server_side,
+                                             pm);
+
+        // The rest of the chain didn't wait for the pending plugin.
+        assert(stage_connections == test_pending_created);
+
+        // Let the pending plugin replay its buffered events.
+        l_main_iterate(0);
+
+        mptcpd_plugin_new_connection(name,
+                                     test_pending_created + 1,
+                                     laddr,
+                                     raddr,
+                                     server_side,
+                                     pm);
+
+        assert(stage_connections == test_pending_created + 1);
+
+        // Test assertions will be triggered during plugin unload.
+        mptcpd_plugin_unload(pm);
+
+        assert(l_main_exit());
+}
+
 /**
  * @brief Verify graceful handling of @c NULL plugin directory.
  */
@@ -361,6 +849,73 @@ static void test_bad_plugins(void const *test_data)
         assert(!loaded);
 }
 
+/// Number of times the builtin plugin was initialized and finalized.
+static int builtin_init_calls;
+static int builtin_exit_calls;
+
+static struct mptcpd_plugin_ops const builtin_ops;
+
+static int builtin_init(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        ++builtin_init_calls;
+
+        return mptcpd_plugin_register_ops("builtin", &builtin_ops)
+                ? 0 : -1;
+}
+
+static void builtin_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        ++builtin_exit_calls;
+}
+
+/**
+ * @brief Verify loading of plugins linked into mptcpd.
+ *
+ * Plugins linked into mptcpd should be loaded without a plugin
+ * directory.
+ */
+static void test_builtin_plugins(void const *test_data)
+{
+        (void) test_data;
+
+        static struct mptcpd_plugin_desc const desc = {
+                .name        = "builtin",
+                .description = "builtin test plugin",
+                .priority    = MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                .init        = builtin_init,
+                .exit        = builtin_exit
+        };
+
+        static struct mptcpd_plugin_desc const *const plugins[] = {
+                &desc,
+                NULL
+        };
+
+        char const *const dir                       = "/nonexistent";
+        char const *const default_plugin            = "builtin";
+        struct l_queue const *const plugins_to_load = NULL;
+        struct mptcpd_pm *const pm                  = NULL;
+
+        mptcpd_plugin_register_builtin(plugins);
+
+        bool const loaded =
+                mptcpd_plugin_load(dir,
+                                   default_plugin,
+                                   plugins_to_load,
+                                   pm);
+        assert(loaded);
+        assert(builtin_init_calls == 1);
+
+        mptcpd_plugin_unload(pm);
+        assert(builtin_exit_calls == 1);
+
+        mptcpd_plugin_register_builtin(NULL);
+}
+
 int main(int argc, char *argv[])
 {
         l_test_init(&argc, &argv);
@@ -372,8 +927,14 @@ int main(int argc, char *argv[])
         l_test_add("nonexistent plugin", test_nonexistent_plugins, NULL);
         l_test_add("plugin dispatch",    test_plugin_dispatch,     NULL);
         l_test_add("null plugin ops",    test_null_plugin_ops,     NULL);
+        l_test_add("plugin chain",       test_plugin_chain,        NULL);
+        l_test_add("plugin ops size",    test_plugin_ops_size,     NULL);
+        l_test_add("plugin reload",      test_plugin_reload,       NULL);
+        l_test_add("reload closed",      test_plugin_reload_closed, NULL);
+        l_test_add("plugin pending",     test_plugin_pending,      NULL);
         l_test_add("null plugin dir",    test_null_plugin_dir,     NULL);
         l_test_add("bad plugins",        test_bad_plugins,         NULL);
+        l_test_add("builtin plugins",    test_builtin_plugins,     NULL);
 
         return l_test_run();
 }
@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-sock-diag.c
+ *
+ * @brief mptcpd metrics collector test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <inttypes.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/sock_diag.h>
+#include <mptcpd/sock_diag.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Test user "data".
+static int const coffee = 0xc0ffee;
+
+/// Metrics collection interval in milliseconds.
+static unsigned int const interval = 10;
+
+/// Number of collection rounds to wait for.
+static uint64_t const max_rounds = 3;
+
+/// Collection round after which the main loop is exited.
+static uint64_t last_round;
+
+/// Number of snapshot callback calls.
+static uint64_t snapshot_count;
+
+static void check_snapshot(struct mptcpd_diag_snapshot const *s)
+{
+        struct mptcpd_diag_connections const *const c = &s->connections;
+
+        size_t subflows = 0;
+
+        // Subflows of each connection must be contiguous.
+        for (size_t i = 0; i < c->count; ++i) {
+                assert(c->subflows[i] > 0);
+                assert(c->first[i] == subflows);
+
+                for (size_t j = c->first[i];
+                     j < c->first[i] + c->subflows[i];
+                     ++j)
+                        assert(s->subflows.token[j] == c->token[i]);
+
+                subflows += c->subflows[i];
+        }
+
+        assert(subflows == s->subflows.count);
+}
+
+static void handle_snapshot(struct mptcpd_diag_snapshot const *s,
+                            void *user_data)
+{
+        l_debug("snapshot event occurred: round %" PRIu64
+                ", %zu connections, %zu subflows",
+                s->round,
+                s->connections.count,
+                s->subflows.count);
+
+        assert((int const *) user_data == &coffee);
+        assert(s->round == ++snapshot_count);
+
+        check_snapshot(s);
+
+        if (s->round == last_round)
+                l_main_quit();
+}
+
+static void handle_timeout(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        l_main_quit();
+}
+
+int main(void)
+{
+        if (!l_main_init())
+                return -1;
+
+        l_log_set_stderr();
+        l_debug_enable("*");
+
+        assert(mptcpd_diag_create(0) == NULL);  // Bad arg
+
+        struct mptcpd_diag *const diag = mptcpd_diag_create(interval);
+        assert(diag);
+
+        assert(mptcpd_diag_get_snapshot(NULL) == NULL);  // Bad arg
+        assert(mptcpd_diag_get_snapshot(diag) == NULL);  // No rounds
+
+        static struct mptcpd_diag_ops const diag_ops = {
+                .snapshot = handle_snapshot
+        };
+
+        static struct mptcpd_diag_ops const null_ops = {
+                .snapshot = NULL
+        };
+
+        // Bad args
+        assert(!mptcpd_diag_register_ops(NULL, &diag_ops, NULL));
+        assert(!mptcpd_diag_register_ops(diag, NULL, NULL));
+        assert(!mptcpd_diag_register_ops(diag, &null_ops, NULL));
+
+        assert(mptcpd_diag_register_ops(diag,
+                                        &diag_ops,
+                                        (void *) &coffee));
+
+        last_round = max_rounds;
+
+        // Bail out if collection stalls.
+        struct l_timeout *const timeout =
+                l_timeout_create(5, handle_timeout, NULL, NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(timeout);
+
+        assert(snapshot_count == max_rounds);
+
+        struct mptcpd_diag_snapshot const *const s =
+                mptcpd_diag_get_snapshot(diag);
+
+        assert(s != NULL);
+        assert(s->round == max_rounds);
+
+        // Connections are found at their position in the snapshot.
+        struct mptcpd_diag_connections const *const c = &s->connections;
+        mptcpd_token_t unknown = 0;
+        size_t index;
+
+        for (size_t i = 0; i < c->count; ++i) {
+                assert(mptcpd_diag_find_connection(diag,
+                                                   c->token[i],
+                                                   &index));
+                assert(index == i);
+
+                if (c->token[i] >= unknown)
+                        unknown = c->token[i] + 1;
+        }
+
+        assert(!mptcpd_diag_find_connection(diag, unknown, &index));
+
+        // Bad args
+        assert(!mptcpd_diag_find_connection(NULL, unknown, &index));
+        assert(!mptcpd_diag_find_connection(diag, unknown, NULL));
+
+        assert(mptcpd_diag_unregister_ops(diag,
+                                          &diag_ops,
+                                          (void *) &coffee));
+        assert(!mptcpd_diag_unregister_ops(diag,
+                                           &diag_ops,
+                                           (void *) &coffee));
+
+        // Collection stops once no ops are registered.
+        struct l_timeout *const idle =
+                l_timeout_create_ms(interval * 10,
+                                    handle_timeout,
+                                    NULL,
+                                    NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(idle);
+
+        assert(mptcpd_diag_get_snapshot(diag) == s);
+        assert(s->round == max_rounds);
+
+        // ... and resumes once ops are registered again.
+        last_round = max_rounds + 1;
+
+        assert(mptcpd_diag_register_ops(diag,
+                                        &diag_ops,
+                                        (void *) &coffee));
+
+        struct l_timeout *const resume =
+                l_timeout_create(5, handle_timeout, NULL, NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(resume);
+
+        assert(snapshot_count == last_round);
+
+        mptcpd_diag_destroy(diag);
+
+        return l_main_exit() ? 0 : -1;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-state-file.c
+ *
+ * @brief mptcpd persistent state file test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#define _POSIX_C_SOURCE 200809L  ///< For mkdtemp().
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/state_file.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Record types used by the tests.
+enum {
+        TYPE_A = 1,
+        TYPE_B,
+        TYPE_C
+};
+
+struct record_info
+{
+        char buf[64];
+        size_t count;
+};
+
+static void append_record(void const *data, size_t len, void *user_data)
+{
+        struct record_info *const info = user_data;
+
+        // Payloads are aligned for direct access through structures.
+        assert(((uintptr_t) data % 8) == 0 || len == 0);
+        assert(strlen(info->buf) + len < sizeof(info->buf));
+
+        strncat(info->buf, data, len);
+        ++info->count;
+}
+
+static char *make_path(char *dir)
+{
+        assert(mkdtemp(dir) != NULL);
+
+        return l_strdup_printf("%s/state", dir);
+}
+
+static void remove_path(char const *dir, char *path)
+{
+        (void) unlink(path);
+        assert(rmdir(dir) == 0);
+
+        l_free(path);
+}
+
+static void commit(char const *path)
+{
+        struct mptcpd_state_writer *const w = mptcpd_state_writer_create();
+
+        assert(mptcpd_state_writer_add(w, TYPE_A, "a1", 2));
+        assert(mptcpd_state_writer_add(w, TYPE_B, "b1-long-record", 14));
+        assert(mptcpd_state_writer_add(w, TYPE_A, "a2", 2));
+        assert(mptcpd_state_writer_add(w, TYPE_B, NULL, 0));
+
+        assert(mptcpd_state_writer_commit(w, path));
+
+        mptcpd_state_writer_destroy(w);
+}
+
+static void test_bad_args(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_state_writer *const w = mptcpd_state_writer_create();
+
+        assert(!mptcpd_state_writer_add(NULL, TYPE_A, "x", 1));
+        assert(!mptcpd_state_writer_add(w, 0, "x", 1));
+        assert(!mptcpd_state_writer_add(w, TYPE_A, NULL, 1));
+        assert(!mptcpd_state_writer_commit(w, NULL));
+        assert(!mptcpd_state_writer_commit(NULL, "/nonexistent"));
+
+        mptcpd_state_writer_destroy(w);
+
+        assert(mptcpd_state_file_open(NULL) == NULL);
+        assert(mptcpd_state_file_open("/nonexistent/state") == NULL);
+        assert(!mptcpd_state_file_same_boot(NULL));
+        assert(mptcpd_state_file_foreach(NULL,
+                                         TYPE_A,
+                                         append_record,
+                                         NULL) == 0);
+}
+
+static void test_round_trip(void const *test_data)
+{
+        (void) test_data;
+
+        char dir[] = "/tmp/test-state-file.XXXXXX";
+        char *const path = make_path(dir);
+
+        commit(path);
+
+        struct mptcpd_state_file *const sf = mptcpd_state_file_open(path);
+        assert(sf != NULL);
+
+        struct record_info a = { .count = 0 };
+        struct record_info b = { .count = 0 };
+        struct record_info c = { .count = 0 };
+
+        assert(mptcpd_state_file_foreach(sf, TYPE_A, append_record, &a)
+               == 2);
+        assert(mptcpd_state_file_foreach(sf, TYPE_B, append_record, &b)
+               == 2);
+        assert(mptcpd_state_file_foreach(sf, TYPE_C, append_record, &c)
+               == 0);
+
+        // Records are visited in the order they were added.
+        assert(strcmp(a.buf, "a1a2") == 0);
+        assert(strcmp(b.buf, "b1-long-record") == 0);
+
+        // The mapping outlives removal of the file.
+        (void) unlink(path);
+        assert(mptcpd_state_file_foreach(sf, TYPE_A, append_record, &c)
+               == 2);
+
+        mptcpd_state_file_close(sf);
+
+        remove_path(dir, path);
+}
+
+static void test_same_boot(void const *test_data)
+{
+        (void) test_data;
+
+        char dir[] = "/tmp/test-state-file.XXXXXX";
+        char *const path = make_path(dir);
+
+        commit(path);
+
+        struct mptcpd_state_file *const sf = mptcpd_state_file_open(path);
+        assert(sf != NULL);
+
+        // Only meaningful where the boot ID is available.
+        if (access("/proc/sys/kernel/random/boot_id", R_OK) == 0)
+                assert(mptcpd_state_file_same_boot(sf));
+
+        mptcpd_state_file_close(sf);
+
+        remove_path(dir, path);
+}
+
+static void test_corrupt(void const *test_data)
+{
+        (void) test_data;
+
+        char dir[] = "/tmp/test-state-file.XXXXXX";
+        char *const path = make_path(dir);
+
+        commit(path);
+
+        int const fd = open(path, O_RDWR);
+        assert(fd != -1);
+
+        off_t const size = lseek(fd, 0, SEEK_END);
+        assert(size > 0);
+
+        // Flip a byte in the last record.
+        char byte;
+        assert(pread(fd, &byte, 1, size - 4) == 1);
+        byte ^= 0x5a;
+        assert(pwrite(fd, &byte, 1, size - 4) == 1);
+
+        assert(mptcpd_state_file_open(path) == NULL);
+
+        // Truncated files are rejected as well.
+        assert(ftruncate(fd, size / 2) == 0);
+        assert(mptcpd_state_file_open(path) == NULL);
+
+        // Not a state file.
+        assert(ftruncate(fd, 0) == 0);
+        assert(pwrite(fd, "garbage", 7, 0) == 7);
+        assert(mptcpd_state_file_open(path) == NULL);
+
+        (void) close(fd);
+
+        remove_path(dir, path);
+}
+
+static void test_replace(void const *test_data)
+{
+        (void) test_data;
+
+        char dir[] = "/tmp/test-state-file.XXXXXX";
+        char *const path = make_path(dir);
+
+        commit(path);
+
+        struct mptcpd_state_file *const old = mptcpd_state_file_open(path);
+        assert(old != NULL);
+
+        // Committing replaces the file without affecting readers.
+        struct mptcpd_state_writer *const w = mptcpd_state_writer_create();
+        assert(mptcpd_state_writer_add(w, TYPE_C, "c1", 2));
+        assert(mptcpd_state_writer_commit(w, path));
+        mptcpd_state_writer_destroy(w);
+
+        struct mptcpd_state_file *const new = mptcpd_state_file_open(path);
+        assert(new != NULL);
+
+        struct record_info info = { .count = 0 };
+
+        assert(mptcpd_state_file_foreach(old, TYPE_A, append_record, &info)
+               == 2);
+        assert(mptcpd_state_file_foreach(new, TYPE_A, append_record, &info)
+               == 0);
+        assert(mptcpd_state_file_foreach(new, TYPE_C, append_record, &info)
+               == 1);
+        assert(strcmp(info.buf, "a1a2c1") == 0);
+
+        mptcpd_state_file_close(old);
+        mptcpd_state_file_close(new);
+
+        remove_path(dir, path);
+}
+
+int main(int argc, char *argv[])
+{
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("bad args",   test_bad_args,   NULL);
+        l_test_add("round trip", test_round_trip, NULL);
+        l_test_add("same boot",  test_same_boot,  NULL);
+        l_test_add("corrupt",    test_corrupt,    NULL);
+        l_test_add("replace",    test_replace,    NULL);
+
+        return l_test_run();
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
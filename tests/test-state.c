@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-state.c
+ *
+ * @brief mptcpd persistent state test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ell/ell.h>
+
+#include "../src/state.h"                  // INTERNAL!
+#include <mptcpd/private/configuration.h>  // INTERNAL!
+#include <mptcpd/private/path_manager.h>   // INTERNAL!
+#include <mptcpd/private/plugin.h>         // INTERNAL!
+#include <mptcpd/private/sock_diag.h>      // INTERNAL!
+#include <mptcpd/plugin.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+/// Metrics collection interval in milliseconds.
+static unsigned int const interval = 100;
+
+/// Connection still open when state is saved.
+static mptcpd_token_t const open_token = 0xfeedface;
+
+/// Connection closed before state is saved.
+static mptcpd_token_t const closed_token = 0xdeadbeef;
+
+/// Number of connections handed over to the plugin.
+static int imports;
+
+/// Number of connections reported as closed to the plugin.
+static int closes;
+
+// -------------------------------------------------------------------
+
+static void state_connection_closed(mptcpd_token_t token,
+                                    struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        ++closes;
+
+        // The restored connection doesn't exist in the kernel.
+        if (token == open_token)
+                l_main_quit();
+}
+
+static void *state_export_state(mptcpd_token_t token,
+                                uint32_t *version,
+                                size_t *len,
+                                struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        *version = 1;
+        *len     = sizeof(token);
+
+        return l_memdup(&token, sizeof(token));
+}
+
+static bool state_import_state(mptcpd_token_t token,
+                               uint32_t version,
+                               void const *state,
+                               size_t len,
+                               struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        assert(token == open_token);
+        assert(version == 1);
+        assert(len == sizeof(token));
+        assert(memcmp(state, &token, len) == 0);
+
+        ++imports;
+
+        return true;
+}
+
+static struct mptcpd_plugin_ops const state_ops = {
+        .connection_closed = state_connection_closed,
+        .export_state      = state_export_state,
+        .import_state      = state_import_state
+};
+
+static int state_init(struct mptcpd_pm *pm)
+{
+        (void) pm;
+
+        return mptcpd_plugin_register_ops("state", &state_ops) ? 0 : -1;
+}
+
+static void state_exit(struct mptcpd_pm *pm)
+{
+        (void) pm;
+}
+
+// -------------------------------------------------------------------
+
+static void handle_timeout(struct l_timeout *timeout, void *user_data)
+{
+        (void) timeout;
+        (void) user_data;
+
+        l_main_quit();
+}
+
+/**
+ * @brief Simulate a mptcpd restart.
+ *
+ * Save state, reload the plugins as a new mptcpd process would, and
+ * restore the saved state.
+ */
+static void restart(struct mptcpd_pm *pm)
+{
+        assert(mptcpd_state_save(pm));
+
+        mptcpd_plugin_unload(pm);
+
+        assert(mptcpd_plugin_load("/nonexistent", "state", NULL, pm));
+
+        imports = 0;
+        closes  = 0;
+
+        mptcpd_state_restore(pm);
+}
+
+int main(void)
+{
+        if (!l_main_init())
+                return -1;
+
+        l_log_set_stderr();
+        l_debug_enable("*");
+
+        char path[] = "/tmp/test-state.XXXXXX";
+        int const fd = mkstemp(path);
+        assert(fd != -1);
+        (void) close(fd);
+
+        struct mptcpd_config config = { .state_file = path };
+
+        struct mptcpd_pm pm = {
+                .config         = &config,
+                .diag           = mptcpd_diag_create(interval),
+                .plugins_loaded = true
+        };
+
+        assert(pm.diag != NULL);
+
+        static struct mptcpd_plugin_desc const desc = {
+                .name        = "state",
+                .description = "state test plugin",
+                .priority    = MPTCPD_PLUGIN_PRIORITY_DEFAULT,
+                .init        = state_init,
+                .exit        = state_exit
+        };
+
+        static struct mptcpd_plugin_desc const *const plugins[] = {
+                &desc,
+                NULL
+        };
+
+        mptcpd_plugin_register_builtin(plugins);
+
+        assert(mptcpd_plugin_load("/nonexistent", "state", NULL, &pm));
+
+        mptcpd_plugin_new_connection(NULL,
+                                     open_token,
+                                     NULL,
+                                     NULL,
+                                     false,
+                                     &pm);
+        mptcpd_plugin_new_connection(NULL,
+                                     closed_token,
+                                     NULL,
+                                     NULL,
+                                     false,
+                                     &pm);
+        mptcpd_plugin_connection_closed(closed_token, &pm);
+
+        // Only the open connection is saved and restored.
+        restart(&pm);
+        assert(imports == 1);
+        assert(pm.restore != NULL);
+
+        /*
+          The restored connection is reported as closed once missing
+          from the first metrics snapshot.
+        */
+        struct l_timeout *const timeout =
+                l_timeout_create(5, handle_timeout, NULL, NULL);
+
+        (void) l_main_run();
+
+        l_timeout_remove(timeout);
+
+        assert(closes == 1);
+
+        mptcpd_state_discard(&pm);
+
+        // The stale connection is not saved again.
+        restart(&pm);
+        assert(imports == 0);
+        assert(pm.restore == NULL);
+
+        mptcpd_plugin_unload(&pm);
+        mptcpd_plugin_register_builtin(NULL);
+        mptcpd_diag_destroy(pm.diag);
+
+        (void) unlink(path);
+
+        return l_main_exit() ? 0 : -1;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/
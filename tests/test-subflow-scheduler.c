@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/**
+ * @file test-subflow-scheduler.c
+ *
+ * @brief mptcpd subflow creation scheduler test.
+ *
+ * Copyright (c) 2026, Intel Corporation
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include <ell/ell.h>
+
+#include <mptcpd/private/subflow_scheduler.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+
+// Local addresses on network interfaces 1 and 2.
+static struct sockaddr_in const laddr1 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x010200C0 }  // 192.0.2.1
+};
+
+static struct sockaddr_in const laddr2 = {
+        .sin_family = AF_INET,
+        .sin_addr   = { .s_addr = 0x020200C0 }  // 192.0.2.2
+};
+
+static struct sockaddr_in const raddr = {
+        .sin_family = AF_INET,
+        .sin_port   = 0x3412,
+        .sin_addr   = { .s_addr = 0x0B6433C6 }  // 198.51.100.11
+};
+
+static mptcpd_token_t const token1 = 0x12345678;
+static mptcpd_token_t const token2 = 0x23456789;
+static mptcpd_token_t const token3 = 0x3456789A;
+
+// Token whose subflow creation requests are rejected.
+static mptcpd_token_t const bad_token = 0xDEADBEEF;
+
+/// Number of requests issued through the scheduler callbacks.
+static unsigned int issue_count;
+
+/// Token of the most recently issued request.
+static mptcpd_token_t last_token;
+
+// ----------------------------------------------------------------
+
+static int issue(struct mptcpd_sched_request const *req, void *user_data)
+{
+        (void) user_data;
+
+        if (req->token == bad_token)
+                return EAGAIN;
+
+        ++issue_count;
+        last_token = req->token;
+
+        return 0;
+}
+
+static int get_index(struct sockaddr const *laddr, void *user_data)
+{
+        (void) user_data;
+
+        struct sockaddr_in const *const sa =
+                (struct sockaddr_in const *) laddr;
+
+        // The interface index is the last IPv4 address octet.
+        return (int) (sa->sin_addr.s_addr >> 24);
+}
+
+static uint64_t get_weight(mptcpd_token_t token, void *user_data)
+{
+        (void) user_data;
+
+        return token == token3 ? 5 : 1;
+}
+
+static struct mptcpd_sched_ops const ops = {
+        .issue      = issue,
+        .get_index  = get_index,
+        .get_weight = get_weight
+};
+
+static void init_request(struct mptcpd_sched_request *req,
+                         mptcpd_token_t token,
+                         struct sockaddr_in const *laddr)
+{
+        memset(req, 0, sizeof(*req));
+
+        req->token = token;
+
+        memcpy(&req->laddr, laddr, sizeof(*laddr));
+        memcpy(&req->raddr, &raddr, sizeof(raddr));
+}
+
+static void schedule(struct mptcpd_sched *sched,
+                     mptcpd_token_t token,
+                     struct sockaddr_in const *laddr)
+{
+        struct mptcpd_sched_request req;
+
+        init_request(&req, token, laddr);
+
+        assert(mptcpd_sched_add_subflow(sched, &req) == 0);
+}
+
+// ----------------------------------------------------------------
+
+static void test_bad_args(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_sched_limits const limits = { .per_interface = 1 };
+        struct mptcpd_sched_ops const no_ops = { .issue = NULL };
+
+        assert(mptcpd_sched_create(NULL, &ops, NULL) == NULL);
+        assert(mptcpd_sched_create(&limits, NULL, NULL) == NULL);
+        assert(mptcpd_sched_create(&limits, &no_ops, NULL) == NULL);
+
+        struct mptcpd_sched_request req;
+        init_request(&req, token1, &laddr1);
+
+        assert(mptcpd_sched_add_subflow(NULL, &req) == EINVAL);
+        assert(mptcpd_sched_get_stats(NULL) == NULL);
+
+        mptcpd_sched_complete(NULL,
+                              token1,
+                              (struct sockaddr const *) &laddr1,
+                              (struct sockaddr const *) &raddr,
+                              true);
+        mptcpd_sched_cancel(NULL, token1);
+        mptcpd_sched_destroy(NULL);
+}
+
+static void test_passthrough(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_sched_limits const limits = { .per_interface = 0 };
+
+        struct mptcpd_sched *const sched =
+                mptcpd_sched_create(&limits, &ops, NULL);
+        assert(sched != NULL);
+
+        issue_count = 0;
+        last_token  = 0;
+
+        struct mptcpd_sched_request req;
+        init_request(&req, token1, &laddr1);
+
+        assert(mptcpd_sched_add_subflow(sched, &req) == 0);
+        assert(mptcpd_sched_add_subflow(sched, &req) == 0);
+        assert(issue_count == 2);
+
+        req.token = bad_token;
+        assert(mptcpd_sched_add_subflow(sched, &req) == EAGAIN);
+
+        // Requests are not tracked when scheduling is disabled.
+        assert(mptcpd_sched_get_stats(sched)->issued == 0);
+
+        mptcpd_sched_destroy(sched);
+}
+
+static void test_interface_limit(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_sched_limits const limits = { .per_interface = 1 };
+
+        struct mptcpd_sched *const sched =
+                mptcpd_sched_create(&limits, &ops, NULL);
+        assert(sched != NULL);
+
+        issue_count = 0;
+        last_token  = 0;
+
+        struct mptcpd_sched_request req;
+        init_request(&req, bad_token, &laddr1);
+
+        // Errors are reported if the request is issued right away.
+        assert(mptcpd_sched_add_subflow(sched, &req) == EAGAIN);
+
+        schedule(sched, token1, &laddr1);
+        assert(issue_count == 1);
+
+        // Interface 1 is busy.
+        schedule(sched, token2, &laddr1);
+        assert(issue_count == 1);
+
+        // Interface 2 is not.
+        schedule(sched, token3, &laddr2);
+        assert(issue_count == 2);
+        assert(last_token == token3);
+
+        // Unrelated subflow.
+        mptcpd_sched_complete(sched,
+                              token2,
+                              (struct sockaddr const *) &laddr1,
+                              (struct sockaddr const *) &raddr,
+                              true);
+        assert(issue_count == 2);
+
+        mptcpd_sched_complete(sched,
+                              token1,
+                              (struct sockaddr const *) &laddr1,
+                              (struct sockaddr const *) &raddr,
+                              true);
+        assert(issue_count == 3);
+        assert(last_token == token2);
+
+        struct mptcpd_sched_stats const *const stats =
+                mptcpd_sched_get_stats(sched);
+
+        assert(stats->issued == 3);
+        assert(stats->deferred == 1);
+        assert(stats->established == 1);
+        assert(stats->failed == 1);
+
+        mptcpd_sched_destroy(sched);
+}
+
+static void test_priority(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_sched_limits const limits = { .per_destination = 1 };
+
+        struct mptcpd_sched *const sched =
+                mptcpd_sched_create(&limits, &ops, NULL);
+        assert(sched != NULL);
+
+        issue_count = 0;
+        last_token  = 0;
+
+        struct mptcpd_sched_request req;
+        init_request(&req, token1, &laddr1);
+
+        assert(mptcpd_sched_add_subflow(sched, &req) == 0);
+        assert(issue_count == 1);
+
+        // Same destination through any interface is busy.
+        schedule(sched, token2, &laddr2);
+        schedule(sched, token3, &laddr2);
+        assert(issue_count == 1);
+
+        // Heavier connection goes first.
+        mptcpd_sched_complete(sched,
+                              token1,
+                              (struct sockaddr const *) &laddr1,
+                              (struct sockaddr const *) &raddr,
+                              false);
+        assert(issue_count == 2);
+        assert(last_token == token3);
+
+        // Closing a connection releases its slot.
+        mptcpd_sched_cancel(sched, token3);
+        assert(issue_count == 3);
+        assert(last_token == token2);
+
+        struct mptcpd_sched_stats const *const stats =
+                mptcpd_sched_get_stats(sched);
+
+        assert(stats->issued == 3);
+        assert(stats->deferred == 2);
+        assert(stats->established == 0);
+        assert(stats->failed == 1);
+
+        mptcpd_sched_destroy(sched);
+}
+
+static void test_set_limits(void const *test_data)
+{
+        (void) test_data;
+
+        struct mptcpd_sched_limits const limits = { .per_interface = 1 };
+
+        struct mptcpd_sched *const sched =
+                mptcpd_sched_create(&limits, &ops, NULL);
+        assert(sched != NULL);
+
+        issue_count = 0;
+        last_token  = 0;
+
+        schedule(sched, token1, &laddr1);
+        schedule(sched, token2, &laddr1);
+        schedule(sched, token3, &laddr1);
+        assert(issue_count == 1);
+
+        // Raising the limit issues queued requests allowed by it.
+        struct mptcpd_sched_limits const raised = { .per_interface = 2 };
+
+        mptcpd_sched_set_limits(sched, &raised);
+        assert(issue_count == 2);
+        assert(last_token == token3);
+
+        // Disabling the limit issues all queued requests.
+        struct mptcpd_sched_limits const none = { .per_interface = 0 };
+
+        mptcpd_sched_set_limits(sched, &none);
+        assert(issue_count == 3);
+        assert(last_token == token2);
+
+        mptcpd_sched_set_limits(NULL, &none);
+        mptcpd_sched_set_limits(sched, NULL);
+
+        mptcpd_sched_destroy(sched);
+}
+
+int main(int argc, char *argv[])
+{
+        // The scheduler arms timers for join timeouts.
+        if (!l_main_init())
+                return -1;
+
+        l_log_set_stderr();
+
+        l_test_init(&argc, &argv);
+
+        l_test_add("bad args",        test_bad_args,        NULL);
+        l_test_add("passthrough",     test_passthrough,     NULL);
+        l_test_add("interface limit", test_interface_limit, NULL);
+        l_test_add("priority",        test_priority,        NULL);
+        l_test_add("set limits",      test_set_limits,      NULL);
+
+        int const result = l_test_run();
+
+        return l_main_exit() ? result : -1;
+}
+
+
+/*
+  Local Variables:
+  c-file-style: "linux"
+  End:
+*/